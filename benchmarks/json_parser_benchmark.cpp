@@ -0,0 +1,111 @@
+#include "utils/json_parser.h"
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace sohbet;
+
+// The per-field scanner handlers used before JsonDocument: one linear
+// find() over the whole body for every field read.
+static std::string legacyExtractJsonField(const std::string& json, const std::string& field) {
+    std::string search_key = "\"" + field + "\"";
+    size_t key_pos = json.find(search_key);
+    if (key_pos == std::string::npos) {
+        return "";
+    }
+    size_t colon_pos = json.find(':', key_pos);
+    if (colon_pos == std::string::npos) {
+        return "";
+    }
+    size_t value_start = colon_pos + 1;
+    while (value_start < json.length() && (json[value_start] == ' ' || json[value_start] == '\t')) {
+        value_start++;
+    }
+    if (value_start >= json.length()) {
+        return "";
+    }
+    if (json[value_start] == '"') {
+        value_start++;
+        size_t value_end = value_start;
+        while (value_end < json.length() && json[value_end] != '"') {
+            if (json[value_end] == '\\' && value_end + 1 < json.length()) {
+                value_end += 2;
+            } else {
+                value_end++;
+            }
+        }
+        if (value_end >= json.length()) {
+            return "";
+        }
+        return json.substr(value_start, value_end - value_start);
+    }
+    if (std::isdigit(json[value_start]) || json[value_start] == '-') {
+        size_t value_end = value_start;
+        while (value_end < json.length() && std::isdigit(json[value_end])) {
+            value_end++;
+        }
+        return json.substr(value_start, value_end - value_start);
+    }
+    return "";
+}
+
+static const std::vector<std::string> UPDATE_USER_FIELDS = {
+    "name", "position", "phone_number", "university", "department", "enrollment_year", "primary_language"
+};
+
+template <typename Fn>
+static void run(const char* name, int iterations, Fn fn) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink += fn();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << name << ": " << (elapsed * 1e9 / iterations) << " ns/request"
+              << " (checksum " << sink << ")" << std::endl;
+}
+
+static void benchmarkBody(const char* label, const std::string& body, int iterations) {
+    std::cout << label << " (" << body.size() << " bytes)" << std::endl;
+
+    run("extractJsonField x7", iterations, [&]() {
+        size_t total = 0;
+        for (const auto& field : UPDATE_USER_FIELDS) {
+            total += legacyExtractJsonField(body, field).size();
+        }
+        return total;
+    });
+
+    run("JsonDocument       ", iterations, [&]() {
+        size_t total = 0;
+        utils::JsonDocument doc = utils::JsonDocument::parse(body);
+        for (const auto& field : UPDATE_USER_FIELDS) {
+            if (field == "enrollment_year") {
+                total += doc.getInt(field).has_value() ? 4 : 0;
+            } else {
+                total += doc.getString(field).value_or("").size();
+            }
+        }
+        return total;
+    });
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    // PUT /api/users/:id profile update
+    std::string profile = R"({"name":"Elif Yılmaz","position":"Araştırma Görevlisi",)"
+                          R"("phone_number":"+90 555 123 45 67","university":"Orta Doğu Teknik Üniversitesi",)"
+                          R"("department":"Bilgisayar Mühendisliği","enrollment_year":2021,)"
+                          R"("primary_language":"Turkish","additional_languages":["English","German"]})";
+
+    // Same fields after a long free-text bio, as sent by the profile editor
+    std::string with_bio = R"({"bio":")" + std::string(2000, 'x') + R"(",)" + profile.substr(1);
+
+    benchmarkBody("Profile update", profile, iterations);
+    benchmarkBody("Profile update with 2 KB bio", with_bio, iterations / 4);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "utils/json_writer.h"
+#include "models/post.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sohbet;
+
+// Feed serialization as it was done before JsonWriter: ostringstream
+// concatenation with a per-character escaping loop for content only.
+static std::string legacyPostJson(const Post& post) {
+    std::ostringstream oss;
+    oss << "{";
+    if (post.getId().has_value()) {
+        oss << "\"id\":" << post.getId().value() << ",";
+    }
+    oss << "\"author_id\":" << post.getAuthorId() << ","
+        << "\"author_type\":\"" << post.getAuthorType() << "\","
+        << "\"content\":\"";
+    for (char c : post.getContent()) {
+        if (c == '"') oss << "\\\"";
+        else if (c == '\\') oss << "\\\\";
+        else if (c == '\n') oss << "\\n";
+        else if (c == '\r') oss << "\\r";
+        else if (c == '\t') oss << "\\t";
+        else oss << c;
+    }
+    oss << "\",\"visibility\":\"" << post.getVisibility() << "\"";
+    if (post.getCreatedAt().has_value()) {
+        oss << ",\"created_at\":\"" << post.getCreatedAt().value() << "\"";
+    }
+    oss << ",\"author\":{\"id\":" << post.getAuthorId();
+    if (post.getAuthorUsername().has_value()) {
+        oss << ",\"username\":\"" << post.getAuthorUsername().value() << "\"";
+    }
+    if (post.getAuthorName().has_value()) {
+        oss << ",\"name\":\"" << post.getAuthorName().value() << "\"";
+    }
+    oss << "}}";
+    return oss.str();
+}
+
+static std::string legacyFeed(const std::vector<Post>& posts) {
+    std::ostringstream oss;
+    oss << "{\"posts\":[";
+    for (size_t i = 0; i < posts.size(); ++i) {
+        oss << legacyPostJson(posts[i]);
+        if (i < posts.size() - 1) oss << ",";
+    }
+    oss << "],\"total\":" << posts.size() << "}";
+    return oss.str();
+}
+
+static std::string writerFeed(const std::vector<Post>& posts) {
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("posts").beginArray();
+    for (const auto& post : posts) {
+        post.writeJson(writer);
+    }
+    writer.endArray();
+    writer.field("total", posts.size());
+    writer.endObject();
+    return writer.str();
+}
+
+template <typename Fn>
+static void run(const char* name, int iterations, Fn fn) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        bytes += fn().size();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << name << ": "
+              << (elapsed * 1e6 / iterations) << " us/feed, "
+              << (bytes / elapsed / (1024.0 * 1024.0)) << " MiB/s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 2000;
+
+    // A 50-post feed with mixed ASCII/Turkish content and occasional escapes
+    std::vector<Post> posts;
+    for (int i = 0; i < 50; ++i) {
+        Post post(i % 7 + 1, "Bugün kütüphanede çalışma grubu var, katılmak isteyen? "
+                             "Konu: \"Veri Yapıları\" final hazırlığı.\nSaat 14:00, 3. kat. #ders #odtü");
+        post.setId(1000 + i);
+        post.setCreatedAt("2025-11-14 23:20:31");
+        post.setAuthorUsername("student_" + std::to_string(i % 7 + 1));
+        post.setAuthorName("Öğrenci " + std::to_string(i % 7 + 1));
+        posts.push_back(post);
+    }
+
+    std::cout << "JSON feed serialization (" << posts.size() << " posts, "
+              << iterations << " iterations)" << std::endl;
+
+    run("ostringstream", iterations, [&]() { return legacyFeed(posts); });
+    run("JsonWriter   ", iterations, [&]() { return writerFeed(posts); });
+
+    return 0;
+}
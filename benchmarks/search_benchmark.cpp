@@ -0,0 +1,153 @@
+#include "config/env.h"
+#include "db/database.h"
+#include "repositories/post_repository.h"
+#include "repositories/user_repository.h"
+#include "utils/lru_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace sohbet;
+
+// Seeds a corpus of generated posts (default 1M) owned by a dedicated
+// benchmark user and measures /api/search query shapes against it:
+//
+//   DATABASE_URL=postgres://... ./search_benchmark [posts] [--cleanup]
+//
+// Seeding is skipped when the corpus already has enough rows, so repeated
+// runs measure warm indexes. --cleanup deletes the corpus afterwards.
+
+static const char* BENCH_USERNAME = "search_benchmark";
+
+static int ensureBenchmarkUser(repositories::UserRepository& users) {
+    if (auto existing = users.findByUsername(BENCH_USERNAME)) {
+        return existing->getId().value_or(0);
+    }
+    User user(BENCH_USERNAME, "search_benchmark@example.invalid");
+    auto created = users.create(user, "search-benchmark-password");
+    return created.has_value() ? created->getId().value_or(0) : 0;
+}
+
+static int countPosts(db::Database& database, int author_id) {
+    db::Statement stmt(database, "SELECT COUNT(*) FROM posts WHERE author_id = ?");
+    stmt.bindInt(1, author_id);
+    return stmt.step() == SQLITE_ROW ? stmt.getInt(0) : 0;
+}
+
+static bool seedPosts(db::Database& database, int author_id, int count) {
+    // Word choice varies with g so terms have very different selectivity:
+    // "lecture" matches every post, "thesis" roughly one in 97
+    const std::string sql = R"(
+        INSERT INTO posts (author_id, author_type, content, visibility)
+        SELECT ?, 'user',
+               (ARRAY['calculus','physics','chemistry','biology','history','literature',
+                      'algorithms','databases','networks','statistics'])[1 + g % 10]
+               || ' lecture notes for week ' || (g % 14 + 1)
+               || CASE WHEN g % 97 = 0 THEN ' and thesis defense preparation' ELSE '' END
+               || CASE WHEN g % 3 = 0 THEN ' study group meets in the library tonight' ELSE ' exam next tuesday' END,
+               CASE WHEN g % 10 = 0 THEN 'friends' ELSE 'public' END
+        FROM generate_series(1, ?) AS g
+    )";
+    db::Statement stmt(database, sql);
+    stmt.bindInt(1, author_id);
+    stmt.bindInt(2, count);
+    return stmt.step() == SQLITE_DONE;
+}
+
+template <typename Fn>
+static void run(const char* name, int iterations, Fn fn) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    size_t sink = 0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        sink += fn();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    std::cout << "  " << name
+              << ": p50 " << samples[samples.size() / 2] << " ms"
+              << ", p95 " << samples[samples.size() * 95 / 100] << " ms"
+              << " (checksum " << sink << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int target = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    bool cleanup = argc > 2 && std::string(argv[2]) == "--cleanup";
+
+    auto database = std::make_shared<db::Database>(config::get_database_url());
+    if (!database->isOpen()) {
+        std::cerr << "Failed to connect to database" << std::endl;
+        return 1;
+    }
+
+    repositories::UserRepository users(database);
+    repositories::PostRepository posts(database);
+
+    int author_id = ensureBenchmarkUser(users);
+    if (author_id <= 0) {
+        std::cerr << "Failed to create benchmark user" << std::endl;
+        return 1;
+    }
+
+    int existing = countPosts(*database, author_id);
+    if (existing < target) {
+        std::cout << "Seeding " << (target - existing) << " posts..." << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        if (!seedPosts(*database, author_id, target - existing)) {
+            std::cerr << "Seeding failed: " << database->getLastError() << std::endl;
+            return 1;
+        }
+        database->execute("ANALYZE posts");
+        std::cout << "Seeded in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                  << " s" << std::endl;
+    }
+    std::cout << "Corpus: " << countPosts(*database, author_id) << " posts" << std::endl;
+
+    // Viewer is someone else, so the friends-only tenth is filtered out
+    const int viewer_id = author_id + 1;
+    const int iterations = 50;
+
+    for (const char* query : {"thesis defense", "library study group", "lecture"}) {
+        std::cout << "Query \"" << query << "\"" << std::endl;
+
+        run("first page (20)      ", iterations, [&]() {
+            return posts.search(query, viewer_id, 20).size();
+        });
+
+        run("page 5 via keyset    ", iterations / 5, [&]() {
+            std::vector<repositories::PostSearchResult> page = posts.search(query, viewer_id, 20);
+            for (int i = 1; i < 5 && !page.empty(); ++i) {
+                const auto& last = page.back();
+                page = posts.search(query, viewer_id, 20, last.rank, last.post.getId().value_or(0));
+            }
+            return page.size();
+        });
+    }
+
+    std::cout << "User search \"search benchmark\"" << std::endl;
+    run("first page (20)      ", iterations, [&]() {
+        return users.search("search benchmark", 20).size();
+    });
+
+    // Hot-query path in the server: serialized response served from the cache
+    utils::LruCache<std::string, std::string> cache(1024, std::chrono::seconds(30));
+    cache.put("all|20||0|lecture", std::string(8192, 'x'));
+    std::cout << "Cached response" << std::endl;
+    run("LruCache hit         ", iterations * 100, [&]() {
+        return cache.get("all|20||0|lecture")->size();
+    });
+
+    if (cleanup) {
+        db::Statement stmt(*database, "DELETE FROM posts WHERE author_id = ?");
+        stmt.bindInt(1, author_id);
+        stmt.step();
+        std::cout << "Removed benchmark corpus" << std::endl;
+    }
+
+    return 0;
+}
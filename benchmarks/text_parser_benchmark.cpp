@@ -0,0 +1,103 @@
+#include "utils/text_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace sohbet;
+
+// The regex-based extractors TextParser used before the scanner: a fresh
+// std::regex per call, walked with sregex_iterator.
+static std::set<std::string> legacyExtractHashtags(const std::string& text) {
+    std::set<std::string> hashtags;
+    std::regex hashtag_regex(R"(#([a-zA-Z0-9_]+))");
+    std::sregex_iterator iter(text.begin(), text.end(), hashtag_regex);
+    std::sregex_iterator end;
+    while (iter != end) {
+        std::string tag = (*iter)[1].str();
+        std::transform(tag.begin(), tag.end(), tag.begin(), ::tolower);
+        hashtags.insert(tag);
+        ++iter;
+    }
+    return hashtags;
+}
+
+static std::set<std::string> legacyExtractMentions(const std::string& text) {
+    std::set<std::string> mentions;
+    std::regex mention_regex(R"(@([a-zA-Z0-9_]+))");
+    std::sregex_iterator iter(text.begin(), text.end(), mention_regex);
+    std::sregex_iterator end;
+    while (iter != end) {
+        mentions.insert((*iter)[1].str());
+        ++iter;
+    }
+    return mentions;
+}
+
+static std::string legacyMakeClickable(const std::string& text) {
+    std::string result = std::regex_replace(text, std::regex(R"(#([a-zA-Z0-9_]+))"),
+        "<a href=\"/hashtags/$1\" class=\"hashtag\">#$1</a>");
+    return std::regex_replace(result, std::regex(R"(@([a-zA-Z0-9_]+))"),
+        "<a href=\"/users/$1\" class=\"mention\">@$1</a>");
+}
+
+template <typename Fn>
+static void run(const char* name, int iterations, Fn fn) {
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink += fn();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << name << ": " << (elapsed * 1e9 / iterations) << " ns/post"
+              << " (checksum " << sink << ")" << std::endl;
+}
+
+static void benchmarkPost(const char* label, const std::string& text, int iterations) {
+    std::cout << label << " (" << text.size() << " bytes)" << std::endl;
+
+    // handleCreatePost extracts hashtags and mentions from every post
+    run("regex tags+mentions  ", iterations, [&]() {
+        return legacyExtractHashtags(text).size() + legacyExtractMentions(text).size();
+    });
+    run("scanner tags+mentions", iterations, [&]() {
+        return utils::TextParser::extractHashtags(text).size() + utils::TextParser::extractMentions(text).size();
+    });
+    run("scanner tokenize     ", iterations, [&]() {
+        return utils::TextParser::tokenize(text).size();
+    });
+
+    run("regex makeClickable  ", iterations, [&]() {
+        return legacyMakeClickable(text).size();
+    });
+    run("scanner makeClickable", iterations, [&]() {
+        return utils::TextParser::makeClickable(text).size();
+    });
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20000;
+
+    std::string short_post = "Yarınki #Algoritmalar sınavı için @elif_y ve @can_demir ile kütüphanedeyiz. "
+                             "Notlar: https://odtu.edu.tr/ceng/315 #sınav #çalışmagrubu";
+
+    // Long-form post: announcement text with a few tags near the end
+    std::string long_post;
+    for (int i = 0; i < 12; ++i) {
+        long_post += "Bu dönem Bilgisayar Mühendisliği bölümünde yapılacak seminerlerin listesi "
+                     "duyuru panosunda ve bölüm sayfasında yayınlandı. ";
+    }
+    long_post += "Sorular için @bolum_sekreterligi. #seminer #ODTÜ #etkinlik https://ceng.metu.edu.tr/seminerler";
+
+    std::string no_tags(1500, 'a');
+    for (size_t i = 7; i < no_tags.size(); i += 8) no_tags[i] = ' ';
+
+    benchmarkPost("Short post with tags, mentions and a link", short_post, iterations);
+    benchmarkPost("Long announcement", long_post, iterations / 4);
+    benchmarkPost("Plain text, no tags", no_tags, iterations / 4);
+
+    return 0;
+}
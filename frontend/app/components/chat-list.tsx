@@ -5,7 +5,7 @@ import { Card, CardContent } from '@/app/components/ui/card'
 import { Avatar, AvatarFallback } from '@/app/components/avatar'
 import { ScrollArea } from '@/app/components/ui/scroll-area'
 import { useOnlineUsers } from '../lib/use-websocket'
-import { apiClient, Conversation } from '@/app/lib/api-client'
+import { apiClient, InboxEntry } from '@/app/lib/api-client'
 
 interface ChatListProps {
   currentUserId: number
@@ -13,8 +13,8 @@ interface ChatListProps {
   selectedConversationId?: number
 }
 
-export function ChatList({ currentUserId, onSelectConversation, selectedConversationId }: ChatListProps) {
-  const [conversations, setConversations] = useState<Conversation[]>([])
+export function ChatList({ onSelectConversation, selectedConversationId }: ChatListProps) {
+  const [conversations, setConversations] = useState<InboxEntry[]>([])
   const [loading, setLoading] = useState(true)
   
   // Use WebSocket hook to track online users
@@ -26,44 +26,9 @@ export function ChatList({ currentUserId, onSelectConversation, selectedConversa
 
   const fetchConversations = async () => {
     try {
-      const response = await apiClient.getConversations()
-      
+      const response = await apiClient.getInbox()
       if (response.data) {
-        const conversationsList = response.data.conversations || []
-        
-        // Fetch user details for each conversation
-        const conversationsWithUsers = await Promise.all(
-          conversationsList.map(async (conv: Conversation) => {
-            const otherUserId = conv.user1_id === currentUserId ? conv.user2_id : conv.user1_id
-            
-            try {
-              const userResponse = await apiClient.getUserById(otherUserId)
-              if (userResponse.data) {
-                return {
-                  ...conv,
-                  other_user: {
-                    id: otherUserId,
-                    username: userResponse.data.username || 'Unknown User',
-                    email: userResponse.data.email || ''
-                  }
-                }
-              }
-            } catch (error) {
-              console.error('Error fetching user:', error)
-            }
-            
-            return {
-              ...conv,
-              other_user: {
-                id: otherUserId,
-                username: 'Unknown User',
-                email: ''
-              }
-            }
-          })
-        )
-        
-        setConversations(conversationsWithUsers)
+        setConversations(response.data.conversations || [])
       }
     } catch (error) {
       console.error('Error fetching conversations:', error)
@@ -92,21 +57,21 @@ export function ChatList({ currentUserId, onSelectConversation, selectedConversa
     <ScrollArea className="h-full">
       <div className="space-y-2 p-4">
         {conversations.map((conversation) => {
-          const userIsOnline = conversation.other_user ? isOnline(conversation.other_user.id) : false
+          const userIsOnline = isOnline(conversation.other_user.id)
           
           return (
             <Card
-              key={conversation.id}
+              key={conversation.conversation_id}
               className={`cursor-pointer transition-colors hover:bg-accent ${
-                selectedConversationId === conversation.id ? 'bg-accent' : ''
+                selectedConversationId === conversation.conversation_id ? 'bg-accent' : ''
               }`}
-              onClick={() => onSelectConversation(conversation.id)}
+              onClick={() => onSelectConversation(conversation.conversation_id)}
             >
               <CardContent className="p-4 flex items-center gap-3">
                 <div className="relative">
                   <Avatar>
                     <AvatarFallback>
-                      {conversation.other_user?.username?.charAt(0).toUpperCase() || 'U'}
+                      {conversation.other_user.username?.charAt(0).toUpperCase() || 'U'}
                     </AvatarFallback>
                   </Avatar>
                   {userIsOnline && (
@@ -115,12 +80,19 @@ export function ChatList({ currentUserId, onSelectConversation, selectedConversa
                 </div>
                 <div className="flex-1 min-w-0">
                   <p className="font-medium truncate">
-                    {conversation.other_user?.username || 'Unknown User'}
+                    {conversation.other_user.username || 'Unknown User'}
                   </p>
                   <p className="text-sm text-muted-foreground truncate">
-                    {conversation.last_message_at ? new Date(conversation.last_message_at).toLocaleDateString('tr-TR') : 'No messages'}
+                    {conversation.last_message
+                      ? conversation.last_message.preview
+                      : new Date(conversation.last_message_at).toLocaleDateString('tr-TR')}
                   </p>
                 </div>
+                {conversation.unread_count > 0 && (
+                  <span className="rounded-full bg-primary px-2 py-0.5 text-xs text-primary-foreground">
+                    {conversation.unread_count}
+                  </span>
+                )}
               </CardContent>
             </Card>
           )
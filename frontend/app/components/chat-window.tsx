@@ -37,19 +37,19 @@ export function ChatWindow({ conversationId, currentUserId, otherUser }: ChatWin
   // Callback to handle incoming WebSocket messages
   const handleIncomingMessage = (incomingMessage: ChatMessagePayload) => {
     console.log('Adding incoming message to UI:', incomingMessage)
-    // Only add messages with id
-    if (!incomingMessage.id) {
+    // Messages not stored yet have no id, only a server seq
+    if (!incomingMessage.id && !incomingMessage.seq) {
       console.warn('Received message without id, skipping')
       return
     }
     const message: Message = {
       ...incomingMessage,
-      id: incomingMessage.id,
+      id: incomingMessage.id ?? 0,
       created_at: incomingMessage.created_at || new Date().toISOString()
     }
     setMessages(prev => {
       // Avoid duplicates by checking if message already exists
-      const exists = prev.some(m => m.id === message.id)
+      const exists = prev.some(m => (message.id && m.id === message.id) || (message.seq && m.seq === message.seq))
       if (exists) {
         return prev
       }
@@ -57,10 +57,20 @@ export function ChatWindow({ conversationId, currentUserId, otherUser }: ChatWin
     })
   }
 
+  const handleMessageStored = (seq: number, id: number) => {
+    setMessages(prev => prev.map(m => (m.seq === seq ? { ...m, id } : m)))
+  }
+
+  const handleMessageFailed = (seq: number) => {
+    setMessages(prev => prev.filter(m => m.seq !== seq))
+  }
+
   // Use WebSocket hook for real-time features
   const { sendMessage: sendWebSocketMessage, sendTyping, typingUsers } = useChatWebSocket(
     conversationId,
-    handleIncomingMessage
+    handleIncomingMessage,
+    handleMessageStored,
+    handleMessageFailed
   )
   
   // Check if other user is typing
@@ -195,7 +205,7 @@ export function ChatWindow({ conversationId, currentUserId, otherUser }: ChatWin
               
               return (
                 <div
-                  key={message.id}
+                  key={message.id || `seq-${message.seq}`}
                   className={`flex ${isOwn ? 'justify-end' : 'justify-start'}`}
                 >
                   <div
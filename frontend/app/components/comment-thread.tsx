@@ -18,11 +18,24 @@ interface CommentThreadProps {
   currentUserId?: number
 }
 
+// Rendering looks replies up by parent_id, so pages are kept as a flat list
+const flatten = (threads: Comment[]): Comment[] =>
+  threads.flatMap(c => [c, ...flatten(c.replies ?? [])])
+
+// Append a page, skipping comments already shown
+const appendComments = (existing: Comment[], page: Comment[]): Comment[] => {
+  const seen = new Set(existing.map(c => c.id))
+  return [...existing, ...flatten(page).filter(c => !seen.has(c.id))]
+}
+
 export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
   const [comments, setComments] = useState<Comment[]>([])
   const [loading, setLoading] = useState(true)
   const [replyingTo, setReplyingTo] = useState<number | null>(null)
   const [showCommentForm, setShowCommentForm] = useState(false)
+  const [nextCursor, setNextCursor] = useState<string | null>(null)
+  const [loadingMore, setLoadingMore] = useState(false)
+  const [expanding, setExpanding] = useState<number | null>(null)
 
   const canDeleteAnyComment = usePermission(PERMISSIONS.DELETE_ANY_COMMENT)
 
@@ -32,9 +45,10 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
 
   const fetchComments = async () => {
     try {
-      const response = await apiClient.getComments(postId)
+      const response = await apiClient.getCommentThreads(postId)
       if (response.data) {
-        setComments(response.data)
+        setComments(flatten(response.data.threads))
+        setNextCursor(response.data.next_cursor)
       }
     } catch (error) {
       console.error('Error fetching comments:', error)
@@ -43,6 +57,41 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
     }
   }
 
+  const loadMoreComments = async () => {
+    if (!nextCursor) return
+    setLoadingMore(true)
+    try {
+      const response = await apiClient.getCommentThreads(postId, nextCursor)
+      if (response.data) {
+        const page = response.data
+        setComments(prev => appendComments(prev, page.threads))
+        setNextCursor(page.next_cursor)
+      }
+    } catch (error) {
+      console.error('Error fetching more comments:', error)
+    } finally {
+      setLoadingMore(false)
+    }
+  }
+
+  // Replies past those loaded with the thread, continuing after the last one shown
+  const loadMoreReplies = async (commentId: number) => {
+    const shown = comments.filter(c => c.parent_id === commentId)
+    const cursor = shown.length > 0 ? shown[shown.length - 1].cursor : undefined
+    setExpanding(commentId)
+    try {
+      const response = await apiClient.getCommentReplies(commentId, cursor)
+      if (response.data) {
+        const page = response.data
+        setComments(prev => appendComments(prev, page.threads))
+      }
+    } catch (error) {
+      console.error('Error fetching replies:', error)
+    } finally {
+      setExpanding(null)
+    }
+  }
+
   const handleCommentCreated = () => {
     setShowCommentForm(false)
     setReplyingTo(null)
@@ -54,7 +103,7 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
 
     try {
       const response = await apiClient.deleteComment(commentId)
-      if (response.data || response.status === 200) {
+      if (response.data || response.status === 200 || response.status === 204) {
         // Remove the comment and all its replies
         const removeCommentAndReplies = (comments: Comment[], idToRemove: number): Comment[] => {
           const filtered = comments.filter(c => c.id !== idToRemove)
@@ -66,7 +115,10 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
           }
           return result
         }
-        setComments(removeCommentAndReplies(comments, commentId))
+        const parentId = comments.find(c => c.id === commentId)?.parent_id
+        setComments(removeCommentAndReplies(comments, commentId).map(c =>
+          c.id === parentId && c.reply_count ? { ...c, reply_count: c.reply_count - 1 } : c
+        ))
       }
     } catch (error) {
       console.error('Error deleting comment:', error)
@@ -92,6 +144,7 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
     const isOwner = currentUserId === comment.author_id
     const canDelete = isOwner || canDeleteAnyComment
     const replies = comments.filter(c => c.parent_id === comment.id)
+    const hiddenReplies = (comment.reply_count ?? 0) - replies.length
 
     return (
       <div key={comment.id} className={depth > 0 ? "ml-8 border-l-2 pl-4" : ""}>
@@ -154,6 +207,20 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
         </div>
 
         {replies.map(reply => renderComment(reply, depth + 1))}
+
+        {hiddenReplies > 0 && (
+          <Button
+            variant="ghost"
+            size="sm"
+            className="h-auto p-0 mb-2 ml-8 text-xs text-gray-600 hover:text-gray-900"
+            disabled={expanding === comment.id}
+            onClick={() => loadMoreReplies(comment.id)}
+          >
+            {expanding === comment.id
+              ? 'Loading replies...'
+              : `Show ${hiddenReplies} more ${hiddenReplies === 1 ? 'reply' : 'replies'}`}
+          </Button>
+        )}
       </div>
     )
   }
@@ -173,6 +240,18 @@ export function CommentThread({ postId, currentUserId }: CommentThreadProps) {
         </div>
       )}
 
+      {nextCursor && (
+        <Button
+          variant="ghost"
+          size="sm"
+          className="w-full"
+          disabled={loadingMore}
+          onClick={loadMoreComments}
+        >
+          {loadingMore ? 'Loading comments...' : 'Load more comments'}
+        </Button>
+      )}
+
       {showCommentForm ? (
         <div className="pt-4">
           <CommentForm
@@ -139,6 +139,8 @@ export interface Comment {
     name?: string;
   };
   replies?: Comment[];
+  reply_count?: number;
+  cursor?: string;  // Opaque; continues a page after this comment
 }
 
 export interface Group {
@@ -211,6 +213,19 @@ export interface Conversation {
   other_user?: User;
 }
 
+export interface InboxEntry {
+  conversation_id: number;
+  other_user: {
+    id: number;
+    username: string;
+    name?: string | null;
+    avatar_url?: string | null;
+  };
+  last_message: { id: number; sender_id: number; preview: string } | null;
+  last_message_at: string;
+  unread_count: number;
+}
+
 export interface Message {
   id: number;
   conversation_id: number;
@@ -518,6 +533,19 @@ class ApiClient {
     return this.request(`/api/posts/${postId}/comments`);
   }
 
+  // Threads with their first replies nested under `replies`, oldest first
+  async getCommentThreads(postId: number, cursor?: string): Promise<ApiResponse<{ threads: Comment[]; next_cursor: string | null }>> {
+    const query = cursor ? `&cursor=${encodeURIComponent(cursor)}` : '';
+    return this.request(`/api/posts/${postId}/comments?view=tree${query}`);
+  }
+
+  // One comment's replies in the same shape, for expanding it past what its
+  // thread page loaded; cursor is the id of the last reply already shown
+  async getCommentReplies(commentId: number, cursor?: string): Promise<ApiResponse<{ threads: Comment[]; next_cursor: string | null }>> {
+    const query = cursor ? `?cursor=${encodeURIComponent(cursor)}` : '';
+    return this.request(`/api/comments/${commentId}/replies${query}`);
+  }
+
   async createComment(postId: number, content: string): Promise<ApiResponse<Comment>> {
     return this.request(`/api/posts/${postId}/comments`, {
       method: 'POST',
@@ -620,6 +648,18 @@ class ApiClient {
     return this.request('/api/conversations');
   }
 
+  // Inbox: previews, unread counts and the other participant in one request
+  async getInbox(limit: number = 30, cursor?: string): Promise<ApiResponse<{ conversations: InboxEntry[]; next_cursor: string | null }>> {
+    const query = cursor ? `&cursor=${encodeURIComponent(cursor)}` : '';
+    return this.request(`/api/inbox?limit=${limit}${query}`);
+  }
+
+  async markConversationRead(conversationId: number): Promise<ApiResponse<void>> {
+    return this.request(`/api/conversations/${conversationId}/read`, {
+      method: 'PUT',
+    });
+  }
+
   async createConversation(otherUserId: number): Promise<ApiResponse<Conversation>> {
     return this.request('/api/conversations', {
       method: 'POST',
@@ -57,7 +57,9 @@ export function useWebSocketMessage(
  */
 export function useChatWebSocket(
   conversationId: number | null,
-  onMessageReceived?: (message: ChatMessagePayload) => void
+  onMessageReceived?: (message: ChatMessagePayload) => void,
+  onMessageStored?: (seq: number, id: number) => void,
+  onMessageFailed?: (seq: number) => void
 ) {
   const [typingUsers, setTypingUsers] = useState<Set<number>>(new Set());
 
@@ -73,6 +75,21 @@ export function useChatWebSocket(
     }
   });
 
+  // Messages arrive before they are stored; these report the outcome by seq
+  useWebSocketMessage('chat:message:ack', (message: WebSocketMessage) => {
+    const payload = message.payload;
+    if ('seq' in payload && 'id' in payload && payload.conversation_id === conversationId) {
+      onMessageStored?.(payload.seq as number, payload.id as number);
+    }
+  });
+
+  useWebSocketMessage('chat:message:failed', (message: WebSocketMessage) => {
+    const payload = message.payload;
+    if ('seq' in payload && payload.conversation_id === conversationId) {
+      onMessageFailed?.(payload.seq as number);
+    }
+  });
+
   // Handle typing indicators
   useWebSocketMessage('chat:typing', (message: WebSocketMessage) => {
     const payload = message.payload;
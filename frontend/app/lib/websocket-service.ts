@@ -7,6 +7,8 @@
 export type WebSocketMessageType =
   | 'chat:send'
   | 'chat:message'
+  | 'chat:message:ack'
+  | 'chat:message:failed'
   | 'chat:typing'
   | 'user:online'
   | 'user:offline'
@@ -24,7 +26,8 @@ export type WebSocketMessageType =
   | 'voice:user-video-toggled';
 
 export interface ChatMessagePayload {
-  id?: number;
+  id?: number | null;  // null until stored; chat:message:ack carries it
+  seq?: number;
   conversation_id: number;
   sender_id: number;
   content: string;
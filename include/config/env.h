@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <cstdlib>
 #include <stdexcept>
 #include <iostream>
@@ -59,6 +60,89 @@ inline std::string get_cors_origin() {
     return std::string(origin);
 }
 
+inline size_t get_compression_min_bytes() {
+    // Responses smaller than this are sent uncompressed; gzip framing and
+    // CPU time outweigh the savings on tiny bodies
+    const char* min_bytes = std::getenv("COMPRESSION_MIN_BYTES");
+    if (!min_bytes || std::string(min_bytes).empty()) {
+        return 1024;
+    }
+    return static_cast<size_t>(std::strtoull(min_bytes, nullptr, 10));
+}
+
+inline std::vector<std::string> get_database_replica_urls() {
+    // Comma-separated; read-only statements are spread across these
+    std::vector<std::string> urls;
+    const char* value = std::getenv("DATABASE_REPLICA_URLS");
+    if (!value) {
+        return urls;
+    }
+    std::string list(value);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        std::string url = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t first = url.find_first_not_of(" \t");
+        if (first != std::string::npos) {
+            urls.push_back(url.substr(first, url.find_last_not_of(" \t") - first + 1));
+        }
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return urls;
+}
+
+inline int get_replica_max_lag_ms() {
+    const char* lag = std::getenv("DB_REPLICA_MAX_LAG_MS");
+    if (!lag || std::string(lag).empty()) {
+        return 5000;
+    }
+    return std::atoi(lag);
+}
+
+inline size_t get_db_async_connections() {
+    // Each connection pipelines many queries, so a couple cover most loads
+    const char* connections = std::getenv("DB_ASYNC_CONNECTIONS");
+    if (!connections || std::string(connections).empty()) {
+        return 2;
+    }
+    return static_cast<size_t>(std::strtoull(connections, nullptr, 10));
+}
+
+inline size_t get_user_cache_size() {
+    const char* size = std::getenv("USER_CACHE_SIZE");
+    if (!size || std::string(size).empty()) {
+        return 20000;
+    }
+    return static_cast<size_t>(std::strtoull(size, nullptr, 10));
+}
+
+inline int get_user_cache_ttl_seconds() {
+    // Bounds how long another server's profile or password change goes unseen
+    const char* ttl = std::getenv("USER_CACHE_TTL_SECONDS");
+    if (!ttl || std::string(ttl).empty()) {
+        return 30;
+    }
+    return std::atoi(ttl);
+}
+
+inline size_t get_conversation_cache_size() {
+    const char* size = std::getenv("CONVERSATION_CACHE_SIZE");
+    if (!size || std::string(size).empty()) {
+        return 50000;
+    }
+    return static_cast<size_t>(std::strtoull(size, nullptr, 10));
+}
+
+inline int get_chat_commit_linger_ms() {
+    // Longer waits put more chat messages in each commit but delay their acks
+    const char* linger = std::getenv("CHAT_COMMIT_LINGER_MS");
+    if (!linger || std::string(linger).empty()) {
+        return 2;
+    }
+    return std::atoi(linger);
+}
+
 inline std::string get_database_url() {
     const char* url = std::getenv("DATABASE_URL");
     if (!url || std::string(url).empty()) {
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// libpq handles; the header stays free of libpq-fe.h
+struct pg_conn;
+struct pg_result;
+
+namespace sohbet {
+namespace db {
+
+/**
+ * One statement for AsyncClient
+ *
+ * Uses '?' placeholders like Statement, but parameters are bound in order
+ * rather than by index, so a query reads as a chain:
+ *
+ *     db::AsyncQuery("UPDATE conversations SET last_message_at = NOW() WHERE id = ?")
+ *         .bindInt(conversation_id)
+ */
+class AsyncQuery {
+public:
+    explicit AsyncQuery(const std::string& sql);
+
+    AsyncQuery& bindInt(int value);
+    AsyncQuery& bindInt64(long long value);
+    AsyncQuery& bindDouble(double value);
+    AsyncQuery& bindText(const std::string& value);
+    AsyncQuery& bindNull();
+    // Bind as a PostgreSQL array literal, for "= ANY(?::int[])"
+    AsyncQuery& bindIntArray(const std::vector<int>& values);
+
+    // SQL with $1, $2, ... placeholders
+    const std::string& sql() const { return sql_; }
+    const std::vector<std::optional<std::string>>& params() const { return params_; }
+
+private:
+    std::string sql_;
+    std::vector<std::optional<std::string>> params_;
+};
+
+/**
+ * Buffered result of one AsyncQuery
+ *
+ * Holds the libpq result itself, so reading it copies nothing until a value
+ * is fetched. Cheap to copy.
+ */
+class QueryResult {
+public:
+    QueryResult() = default;
+
+    bool ok() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    size_t rowCount() const;
+    size_t columnCount() const;
+    // Rows touched by INSERT/UPDATE/DELETE
+    size_t affectedRows() const;
+
+    // Column getters (row and column 0-indexed)
+    int getInt(size_t row, int column) const;
+    long long getInt64(size_t row, int column) const;
+    double getDouble(size_t row, int column) const;
+    std::string getText(size_t row, int column) const;
+    bool isNull(size_t row, int column) const;
+
+private:
+    friend class AsyncClient;
+
+    std::shared_ptr<pg_result> result_;
+    std::string error_;
+};
+
+/**
+ * Non-blocking PostgreSQL client using libpq pipeline mode
+ *
+ * A single I/O thread drives a few dedicated connections. Each submitted
+ * batch is written to one connection back to back, followed by a sync, so
+ * the queries in it cost one round trip together instead of one each, and
+ * later batches are sent without waiting for earlier ones to finish. Up to
+ * max_depth queries can be in flight per connection.
+ *
+ * A batch runs as one implicit transaction: if any query in it fails, the
+ * rest report an error and nothing in the batch is committed.
+ *
+ * Callbacks run on the I/O thread and must not block; they typically hand
+ * the results to a WebSocket send or set a promise. execute() and query()
+ * wrap submit() in a future for callers that do want to wait.
+ *
+ * This runs alongside Database/Statement, which keep their own connection.
+ */
+class AsyncClient {
+public:
+    using Callback = std::function<void(std::vector<QueryResult>)>;
+
+    AsyncClient(const std::string& connection_string, size_t connections = 2, size_t max_depth = 256);
+    ~AsyncClient();
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    /**
+     * Connect and start the I/O thread
+     * @return false if no connection could be opened
+     */
+    bool start();
+
+    /**
+     * Stop the I/O thread; queued and in-flight batches complete with an error
+     */
+    void stop();
+
+    bool isRunning() const { return running_; }
+
+    /**
+     * Queue a batch; done receives one result per query, in order
+     */
+    void submit(std::vector<AsyncQuery> batch, Callback done);
+
+    std::future<std::vector<QueryResult>> execute(std::vector<AsyncQuery> batch);
+    std::future<QueryResult> query(AsyncQuery query);
+
+    /**
+     * Batches waiting for a connection plus those in flight
+     */
+    size_t pending() const;
+
+private:
+    struct Batch;
+
+    struct Connection {
+        pg_conn* conn = nullptr;
+        std::deque<std::shared_ptr<Batch>> in_flight;  // Sent, in order
+        size_t queued_queries = 0;    // Queries in in_flight
+        size_t result_index = 0;      // Query of the front batch being read
+        bool has_result = false;      // Front query produced a result already
+        bool want_write = false;      // Output buffered in libpq
+        bool connecting = false;      // PQconnectPoll() handshake under way
+        short connect_events = 0;     // poll() events the handshake waits for
+        std::chrono::steady_clock::time_point connect_deadline;
+        std::chrono::steady_clock::time_point retry_at;
+    };
+
+    // Reconnects never block the I/O thread: startConnect() only begins the
+    // handshake, and continueConnect() advances it whenever poll() reports
+    // the socket ready
+    void startConnect(Connection& connection);
+    void continueConnect(Connection& connection);
+    void connectFailed(Connection& connection, const std::string& error);
+    void run();
+    void dispatch();
+    bool send(Connection& connection, const std::shared_ptr<Batch>& batch);
+    bool readResults(Connection& connection);
+    void reset(Connection& connection, const std::string& error);
+    void complete(const std::shared_ptr<Batch>& batch);
+    void fail(const std::shared_ptr<Batch>& batch, const std::string& error);
+    void wake();
+
+    std::string connection_string_;
+    size_t max_depth_;
+    std::vector<Connection> connections_;
+
+    mutable std::mutex mutex_;
+    std::deque<std::shared_ptr<Batch>> queue_;   // Submitted, not yet sent
+    std::atomic<size_t> in_flight_{0};
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    int wake_fds_[2] = {-1, -1};
+};
+
+} // namespace db
+} // namespace sohbet
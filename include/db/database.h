@@ -1,8 +1,12 @@
 #pragma once
 
 #include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 // SQLite compatibility constants (defined globally for backward compatibility)
@@ -14,12 +18,62 @@ constexpr int SQLITE_ERROR = 1;
 namespace sohbet {
 namespace db {
 
+class UnitOfWork;
+
+// Rewrite SQLite-style '?' placeholders as PostgreSQL $1, $2, ...
+std::string toPostgresPlaceholders(const std::string& sql);
+
+/**
+ * Where a Statement may run when read replicas are configured
+ */
+enum class Routing {
+    Auto,       // A replica if the SQL only reads, else the primary
+    ReadOnly,   // A replica; the caller vouches that the statement only reads
+    Primary     // Always the primary
+};
+
+// SELECT (or WITH ... SELECT) with no data-modifying clause, row lock or
+// sequence call, so it is safe to run on a replica
+bool isReadOnlyQuery(const std::string& sql);
+
+/**
+ * Health of one read replica as of the last Database::checkReplicas()
+ */
+struct ReplicaStatus {
+    size_t index;
+    bool healthy;
+    long long lag_ms;   // Replay lag; -1 when unreachable
+};
+
+/**
+ * Attributes this thread's statements to a user, for read-your-writes
+ *
+ * Once a user's statement writes to the primary, that user's reads stay on
+ * the primary for a short window, so a lagging replica never hides their
+ * own change from them. Scopes nest; the innermost wins.
+ */
+class SessionScope {
+public:
+    explicit SessionScope(int user_id);
+    ~SessionScope();
+
+    SessionScope(const SessionScope&) = delete;
+    SessionScope& operator=(const SessionScope&) = delete;
+
+    // User of the innermost scope on this thread, or 0
+    static int currentUser();
+
+private:
+    int previous_;
+};
+
 /**
  * RAII wrapper for PostgreSQL database connections
  */
 class Database {
 public:
-    explicit Database(const std::string& connection_string);
+    explicit Database(const std::string& connection_string,
+                      const std::vector<std::string>& replica_connection_strings = {});
     ~Database();
 
     // Non-copyable, movable
@@ -30,6 +84,7 @@ public:
 
     // Friend declaration for Statement to access private members
     friend class Statement;
+    friend class UnitOfWork;
 
     // Execute SQL statement
     bool execute(const std::string& sql);
@@ -49,21 +104,114 @@ public:
     // Get raw PostgreSQL connection handle
     pqxx::connection* getHandle() const { return conn_.get(); }
 
+    // Replicas more than max_lag behind stop taking reads, and a user's
+    // reads stay on the primary for twice that after they write
+    void setMaxReplicaLag(std::chrono::milliseconds max_lag);
+
+    // Reconnect unreachable replicas and re-measure lag; call periodically,
+    // from a thread that may block for a connect timeout
+    void checkReplicas();
+
+    // Keep user_id's reads on the primary after they wrote through another
+    // path (db::AsyncClient, or a batch written outside their SessionScope)
+    void recordWriteBy(int user_id);
+
+    size_t replicaCount() const { return replicas_.size(); }
+    std::vector<ReplicaStatus> replicaStatus() const;
+
 private:
+    struct Replica;
+
     std::unique_ptr<pqxx::connection> conn_;
     std::string connection_string_;
     mutable std::string last_error_;
     mutable long long last_insert_id_;
 
+    // One transaction at a time on the connection: held by a UnitOfWork for
+    // its whole scope, and by a standalone Statement until it commits
+    std::recursive_mutex mutex_;
+
+    std::vector<std::unique_ptr<Replica>> replicas_;
+    std::atomic<size_t> next_replica_{0};
+    std::chrono::milliseconds max_replica_lag_{5000};
+
+    // Last write per session user, for read-your-writes
+    std::mutex recent_writes_mutex_;
+    std::unordered_map<int, std::chrono::steady_clock::time_point> recent_writes_;
+    std::chrono::steady_clock::time_point recent_writes_pruned_;
+
+    // Lock the next healthy replica round-robin; nullptr if there is none
+    Replica* acquireReplica(std::unique_lock<std::recursive_mutex>& lock);
+    bool readsNeedPrimary();
+    void recordWrite();
+    void pruneRecentWrites(std::chrono::steady_clock::time_point now);   // recent_writes_mutex_ held
+
     void close();
 };
 
+/**
+ * Transaction scope spanning several repository calls
+ *
+ * While a UnitOfWork is open, every Statement (and Database::execute) on the
+ * same thread and database joins its transaction instead of opening and
+ * committing its own, so repositories take part without any changes. A
+ * UnitOfWork opened inside another becomes a savepoint: rolling it back
+ * undoes only its own statements.
+ *
+ * Nothing is committed until commit(); destroying an uncommitted scope rolls
+ * it back. A failed statement inside the scope makes commit() roll back and
+ * return false.
+ *
+ *     db::UnitOfWork unit(*database_);
+ *     auto post = post_repository_->create(post);
+ *     hashtag_repository_->linkTagsToPost(ids, post_id);
+ *     if (!unit.commit()) { ... nothing was written ... }
+ */
+class UnitOfWork {
+public:
+    explicit UnitOfWork(Database& db);
+    ~UnitOfWork();
+
+    UnitOfWork(const UnitOfWork&) = delete;
+    UnitOfWork& operator=(const UnitOfWork&) = delete;
+
+    // Commit (outermost) or release the savepoint (nested); false if the
+    // scope failed and was rolled back instead
+    bool commit();
+
+    // Roll back this scope's statements
+    void rollback();
+
+    bool isActive() const { return txn_ != nullptr && !finished_; }
+    bool isNested() const { return parent_ != nullptr; }
+    bool failed() const { return failed_; }
+
+    // Innermost open scope for db on this thread, or nullptr
+    static UnitOfWork* current(const Database& db);
+
+private:
+    friend class Statement;
+    friend class Database;
+
+    void markFailed() { failed_ = true; }
+    void finish();
+
+    Database& db_;
+    UnitOfWork* parent_;
+    std::unique_lock<std::recursive_mutex> lock_;
+    std::unique_ptr<pqxx::work> work_;                 // Outermost scope
+    std::unique_ptr<pqxx::subtransaction> savepoint_;  // Nested scope
+    pqxx::dbtransaction* txn_;
+    bool finished_;
+    bool failed_;
+};
+
 /**
  * RAII wrapper for PostgreSQL prepared statements
  */
 class Statement {
 public:
-    Statement(Database& db, const std::string& sql);
+    Statement(Database& db, const std::string& sql, Routing routing = Routing::Auto);
     ~Statement();
 
     // Non-copyable
@@ -75,6 +223,8 @@ public:
     bool bindDouble(int index, double value);
     bool bindText(int index, const std::string& value);
     bool bindNull(int index);
+    // Bind as a PostgreSQL array literal, for "= ANY(?::int[])"
+    bool bindIntArray(int index, const std::vector<int>& values);
 
     // Execution
     int step();  // Returns SQLITE_ROW (100), SQLITE_DONE (101), or SQLITE_ERROR
@@ -90,11 +240,19 @@ public:
     // Get number of affected rows (for UPDATE/DELETE/INSERT)
     size_t affectedRows() const;
 
-    bool isValid() const { return work_ != nullptr; }
+    bool isValid() const { return txn_ != nullptr; }
+
+    // Running on a read replica rather than the primary
+    bool onReplica() const { return replica_ != nullptr; }
 
 private:
     Database& db_;
-    std::unique_ptr<pqxx::work> work_;
+    UnitOfWork* unit_;                   // Joined scope, if any
+    Database::Replica* replica_;         // Replica serving this read, if any
+    std::unique_lock<std::recursive_mutex> lock_;
+    std::unique_ptr<pqxx::dbtransaction> work_;   // Own transaction when not in a scope
+    pqxx::transaction_base* txn_;
+    bool writes_;                        // Not known to be read-only
     std::string sql_;
     std::vector<std::string> params_;
     std::vector<bool> is_null_;  // Track which parameters are NULL
@@ -102,6 +260,10 @@ private:
     size_t current_row_;
     bool executed_;
     bool done_;
+
+    void beginOnReplica();
+    void beginOnPrimary();
+    bool retryOnPrimary();
 };
 
 } // namespace db
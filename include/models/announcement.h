@@ -5,6 +5,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Announcement {
 public:
     // Constructors
@@ -37,6 +39,7 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
     static Announcement fromJson(const std::string& json);
 
 private:
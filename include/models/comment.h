@@ -5,6 +5,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Comment {
 public:
     // Constructors
@@ -31,6 +33,9 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
+    // writeJson() without the enclosing braces, for callers adding fields
+    void writeJsonFields(utils::JsonWriter& writer) const;
     static Comment fromJson(const std::string& json);
 
 private:
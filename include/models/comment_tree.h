@@ -0,0 +1,63 @@
+#pragma once
+
+#include "models/comment.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sohbet {
+
+namespace utils { class JsonWriter; }
+
+/**
+ * One page of a post's comment threads (see CommentRepository::findThreads)
+ *
+ * Every comment of the page lives in a single vector rather than in
+ * separately allocated nodes: the top-level comments come first, and each
+ * comment's loaded replies are one contiguous run in sibling order, so
+ * walking a thread is index arithmetic over one allocation.
+ */
+class CommentTree {
+public:
+    struct Node {
+        Comment comment;
+        int depth = 0;
+        int reply_count = 0;         // All direct replies, loaded or not, counted at query time
+        long long created_at_us = 0; // Exact sort key (microseconds), for cursors
+        uint32_t first_reply = 0;    // Index of the first loaded reply
+        uint32_t loaded_replies = 0;
+
+        // Cursor of a page continuing after this comment among its
+        // siblings: "<created_at_us>:<id>"
+        std::string cursor() const;
+    };
+
+    CommentTree() = default;
+
+    /**
+     * Assemble a tree from rows in sibling order (e.g. ORDER BY depth,
+     * created_at, id). Rows at depth 0 are the threads (top-level comments,
+     * or the replies of one comment); other rows whose parent is not among
+     * the rows are dropped.
+     */
+    static CommentTree build(std::vector<Node> rows);
+
+    /**
+     * Depth-0 comments are nodes()[0, threadCount())
+     */
+    size_t threadCount() const { return thread_count_; }
+    const std::vector<Node>& nodes() const { return nodes_; }
+    bool empty() const { return nodes_.empty(); }
+
+    // Array of threads, each comment with reply_count and nested replies
+    std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
+
+private:
+    void writeNode(utils::JsonWriter& writer, uint32_t index) const;
+
+    std::vector<Node> nodes_;
+    size_t thread_count_ = 0;
+};
+
+} // namespace sohbet
@@ -3,9 +3,12 @@
 
 #include <string>
 #include <ctime>
+#include <optional>
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Conversation {
 public:
     int id;
@@ -19,9 +22,30 @@ public:
                  std::time_t created_at, std::time_t last_message_at);
 
     std::string to_json() const;
+    void write_json(utils::JsonWriter& writer) const;
     static Conversation from_json(const std::string& json);
 };
 
+// A conversation as one participant's inbox lists it (conversation_inbox row
+// joined with the other participant's profile)
+class InboxEntry {
+public:
+    int conversation_id = 0;
+    int other_user_id = 0;
+    std::string other_username;
+    std::optional<std::string> other_name;
+    std::optional<std::string> other_avatar_url;
+    int last_message_id = 0;           // 0 until the first message
+    int last_message_sender_id = 0;
+    std::string last_message_preview;  // First 140 characters
+    std::time_t last_message_at = 0;
+    long long last_message_at_us = 0;  // Exact sort key (microseconds), for cursors
+    int unread_count = 0;
+
+    std::string to_json() const;
+    void write_json(utils::JsonWriter& writer) const;
+};
+
 } // namespace sohbet
 
 #endif // SOHBET_MODELS_CONVERSATION_H
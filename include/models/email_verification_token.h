@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 /**
  * EmailVerificationToken model
  * Represents a token for verifying user email addresses
@@ -41,6 +43,7 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
 
 private:
     std::optional<int> id_;
@@ -5,6 +5,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Friendship {
 public:
     // Constructors
@@ -29,6 +31,7 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
     static Friendship fromJson(const std::string& json);
 
     // Status constants
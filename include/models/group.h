@@ -5,6 +5,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Group {
 public:
     // Constructors
@@ -31,6 +33,9 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
+    // Members only, so list handlers can append per-viewer fields
+    void writeJsonFields(utils::JsonWriter& writer) const;
     static Group fromJson(const std::string& json);
 
     // Privacy constants
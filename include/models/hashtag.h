@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Hashtag {
 public:
     // Constructors
@@ -31,6 +33,7 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
     static Hashtag fromJson(const std::string& json);
 
 private:
@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Message {
 public:
     int id;
@@ -25,6 +27,7 @@ public:
             std::time_t created_at, bool is_read_at_null = true, bool is_delivered_at_null = true);
 
     std::string to_json() const;
+    void write_json(utils::JsonWriter& writer) const;
     static Message from_json(const std::string& json);
 };
 
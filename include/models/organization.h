@@ -5,6 +5,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Organization {
 public:
     // Constructors
@@ -35,6 +37,7 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
     static Organization fromJson(const std::string& json);
 
     // Type constants
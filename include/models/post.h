@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class Post {
 public:
     // Constructors
@@ -42,6 +44,7 @@ public:
 
     // JSON serialization
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
     static Post fromJson(const std::string& json);
 
     // Visibility constants
@@ -7,6 +7,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class StudySession {
 public:
     int id;
@@ -36,6 +38,7 @@ public:
                  std::time_t created_at = 0, std::time_t updated_at = 0);
 
     std::string to_json() const;
+    void write_json(utils::JsonWriter& writer) const;
     static StudySession from_json(const std::string& json);
 };
 
@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class User {
 public:
     // Constructors
@@ -56,6 +58,7 @@ public:
 
     // JSON serialization (excludes password hash)
     std::string toJson() const;
+    void writeJson(utils::JsonWriter& writer) const;
     static User fromJson(const std::string& json);
 
     // Validation helpers
@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 class UserPresence {
 public:
     int id;
@@ -21,6 +23,7 @@ public:
                  std::time_t last_seen = 0, std::time_t updated_at = 0);
 
     std::string to_json() const;
+    void write_json(utils::JsonWriter& writer) const;
     static UserPresence from_json(const std::string& json);
 };
 
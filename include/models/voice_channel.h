@@ -6,6 +6,8 @@
 
 namespace sohbet {
 
+namespace utils { class JsonWriter; }
+
 /**
  * @brief Represents a voice channel in the system
  *
@@ -29,6 +31,7 @@ public:
      * @return JSON string representation of the voice channel
      */
     std::string to_json() const;
+    void write_json(utils::JsonWriter& writer) const;
 
     /**
      * @brief Create a VoiceChannel from JSON data
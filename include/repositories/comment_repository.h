@@ -1,7 +1,9 @@
 #pragma once
 
 #include "models/comment.h"
+#include "models/comment_tree.h"
 #include "db/database.h"
+#include "utils/lru_cache.h"
 #include <memory>
 #include <optional>
 #include <vector>
@@ -9,15 +11,44 @@
 namespace sohbet {
 namespace repositories {
 
+// Shape of one page of comment threads; the defaults are the cached shape
+struct CommentTreeQuery {
+    int threads = 20;               // Top-level comments per page
+    int max_depth = 3;              // Reply levels loaded below them
+    int replies_per_comment = 3;    // Replies loaded under each comment
+    int max_comments = 1000;        // Bound on the whole page
+
+    bool operator==(const CommentTreeQuery& other) const {
+        return threads == other.threads && max_depth == other.max_depth &&
+               replies_per_comment == other.replies_per_comment && max_comments == other.max_comments;
+    }
+};
+
 class CommentRepository {
 public:
-    explicit CommentRepository(std::shared_ptr<db::Database> database);
+    /**
+     * @param thread_cache_capacity Posts whose first page of threads is kept
+     *        in memory; writes through this repository invalidate it
+     */
+    explicit CommentRepository(std::shared_ptr<db::Database> database, size_t thread_cache_capacity = 2048);
 
     // CRUD operations
     std::optional<Comment> create(Comment& comment);
     std::optional<Comment> findById(int id);
     std::vector<Comment> findByPostId(int post_id, int limit = 100, int offset = 0);
     std::vector<Comment> findReplies(int parent_comment_id, int limit = 50, int offset = 0);
+
+    // A page of a post's threads with their replies, in one query. Threads
+    // are oldest first; the previous page's last (created_at_us, id)
+    // continues after it, even if that comment has since been deleted;
+    // after_id 0 starts over. First pages of the default shape are served
+    // from the cache.
+    std::shared_ptr<const CommentTree> findThreads(int post_id, const CommentTreeQuery& query = {},
+                                                   long long after_at_us = 0, int after_id = 0);
+    // The same for one comment's replies (query.threads of them per page),
+    // to expand a comment past what its thread page loaded. Not cached.
+    std::shared_ptr<const CommentTree> findReplyThreads(const Comment& parent, const CommentTreeQuery& query = {},
+                                                        long long after_at_us = 0, int after_id = 0);
     bool update(const Comment& comment);
     bool deleteById(int id);
     
@@ -26,6 +57,11 @@ public:
 
 private:
     std::shared_ptr<db::Database> database_;
+    utils::LruCache<int, std::shared_ptr<const CommentTree>> thread_cache_;
+
+    // parent_id 0 loads top-level threads
+    std::shared_ptr<const CommentTree> loadThreads(int post_id, int parent_id, const CommentTreeQuery& query,
+                                                   long long after_at_us, int after_id);
 };
 
 } // namespace repositories
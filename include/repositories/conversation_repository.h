@@ -3,6 +3,7 @@
 
 #include "db/database.h"
 #include "models/conversation.h"
+#include "utils/lru_cache.h"
 #include <vector>
 #include <memory>
 #include <optional>
@@ -12,25 +13,49 @@ namespace repositories {
 
 class ConversationRepository {
 public:
-    explicit ConversationRepository(std::shared_ptr<db::Database> database);
+    // Up to cache_capacity conversations are kept in memory, so the
+    // participant checks on the chat path rarely reach the database
+    explicit ConversationRepository(std::shared_ptr<db::Database> database, size_t cache_capacity = 50000);
 
     // Find or create conversation between two users
     std::optional<Conversation> findOrCreateConversation(int user1_id, int user2_id);
     
-    // Get a conversation by ID
+    // Get a conversation by ID (cached)
     std::optional<Conversation> getById(int id);
     
-    // Get all conversations for a user
+    // Get all conversations for a user, most recent first
     std::vector<Conversation> getUserConversations(int user_id);
+
+    // A page of the user's inbox, most recent first: preview, unread count
+    // and the other participant in one query. The previous page's last
+    // (last_message_at_us, conversation_id) continues after it, even if that
+    // conversation has moved since; before_conversation_id 0 starts at the top.
+    std::vector<InboxEntry> getInbox(int user_id, int limit = 30, long long before_at_us = 0,
+                                     int before_conversation_id = 0);
+
+    // Recompute previews and unread counts where the inbox drifted from
+    // messages; returns rows corrected
+    int repairInbox();
     
     // Update last_message_at timestamp
     bool updateLastMessageTime(int conversation_id);
+
+    // Update last_message_at for many conversations in one statement
+    bool updateLastMessageTimes(const std::vector<int>& conversation_ids);
     
     // Delete a conversation
     bool deleteConversation(int conversation_id);
 
+    // Bring the cached last_message_at up to now after the timestamp was
+    // bumped outside this repository (e.g. a db::AsyncClient send batch)
+    void touchCached(int conversation_id);
+
 private:
     std::shared_ptr<db::Database> database_;
+
+    // Participants never change, so entries only go stale in last_message_at,
+    // which the update methods and touchCached() keep current
+    utils::LruCache<int, Conversation> cache_;
     
     std::optional<Conversation> findConversation(int user1_id, int user2_id);
     Conversation createConversation(int user1_id, int user2_id);
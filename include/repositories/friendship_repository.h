@@ -5,6 +5,7 @@
 #include "db/database.h"
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace sohbet {
@@ -33,6 +34,12 @@ public:
     // Get friends (users) for a specific user
     std::vector<User> getFriendsForUser(int user_id);
 
+    // Ids of accepted friends only (presence fan-out)
+    std::vector<int> getFriendIds(int user_id);
+
+    // Every accepted friendship as (requester, addressee) (social graph load)
+    std::vector<std::pair<int, int>> findAcceptedPairs();
+
 private:
     std::shared_ptr<db::Database> database_;
 };
@@ -6,6 +6,7 @@
 #include <optional>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace sohbet {
 namespace repositories {
@@ -30,10 +31,18 @@ public:
     bool isMember(int group_id, int user_id);
     std::string getMemberRole(int group_id, int user_id);
     int getMemberCount(int group_id);
+    std::vector<int> getMemberIds(int group_id);
+
+    // Batched lookups for list pages (one query for all ids)
+    std::unordered_map<int, int> getMemberCounts(const std::vector<int>& group_ids);
+    std::unordered_map<int, std::string> getMemberRoles(const std::vector<int>& group_ids, int user_id);
     
     // Permission checks
     bool canUserManage(int group_id, int user_id);
 
+    // Recompute member_count where it drifted; returns groups corrected
+    int repairMemberCounts();
+
 private:
     std::shared_ptr<db::Database> database_;
 };
@@ -4,12 +4,20 @@
 #include "db/database.h"
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 #include <set>
 
 namespace sohbet {
 namespace repositories {
 
+// One tag use on a public post, for replaying into the trending tracker
+struct HashtagUsage {
+    std::string tag;
+    std::string university;  // Author's university, empty if unknown
+    double used_at = 0.0;    // Seconds since the Unix epoch
+};
+
 class HashtagRepository {
 public:
     explicit HashtagRepository(std::shared_ptr<db::Database> database);
@@ -20,6 +28,8 @@ public:
     std::optional<Hashtag> findByTag(const std::string& tag);
     std::vector<Hashtag> findTrending(int limit = 10);
     std::vector<Hashtag> searchTags(const std::string& query, int limit = 20);
+    std::vector<Hashtag> findAllUsage(); // id, tag and usage_count only
+    std::vector<HashtagUsage> findRecentUsage(int max_age_seconds); // Oldest first
     bool update(const Hashtag& hashtag);
     bool deleteById(int id);
 
@@ -2,6 +2,7 @@
 #define SOHBET_REPOSITORIES_MESSAGE_REPOSITORY_H
 
 #include "db/database.h"
+#include "db/async_client.h"
 #include "models/message.h"
 #include <vector>
 #include <memory>
@@ -18,6 +19,10 @@ public:
     std::optional<Message> createMessage(int conversation_id, int sender_id, 
                                          const std::string& content, 
                                          const std::string& media_url = "");
+
+    // Insert many messages with one multi-row INSERT; returns the new ids
+    // in order, or empty on failure
+    std::vector<int> createMessagesBatch(const std::vector<Message>& messages);
     
     // Get a message by ID
     std::optional<Message> getById(int id);
@@ -40,6 +45,17 @@ public:
     // Delete a message
     bool deleteMessage(int message_id);
 
+    // Send as one pipelined batch for db::AsyncClient: one round trip and one
+    // transaction. Results are [0] the conversation's user1_id/user2_id,
+    // [1] the new message, with no row unless the sender is a participant,
+    // and [2] the last_message_at bump.
+    static std::vector<db::AsyncQuery> sendMessageBatch(int conversation_id, int sender_id,
+                                                        const std::string& content,
+                                                        const std::string& media_url = "");
+
+    // Message from a row with the columns getById selects, in the same order
+    static std::optional<Message> messageFromResult(const db::QueryResult& result, size_t row = 0);
+
 private:
     std::shared_ptr<db::Database> database_;
 };
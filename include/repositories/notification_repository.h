@@ -24,6 +24,15 @@ public:
                                                     std::optional<int> related_session_id = std::nullopt,
                                                     const std::string& action_url = "");
 
+    // Insert many notifications in one multi-row INSERT; returns them with
+    // id and created_at set, in input order (empty on failure)
+    std::vector<Notification> createNotificationsBatch(const std::vector<Notification>& notifications);
+
+    // Insert the same notification for every user in user_ids with one
+    // INSERT ... SELECT over unnest (group announcements)
+    std::vector<Notification> fanOutNotification(const std::vector<int>& user_ids,
+                                                 const Notification& notification);
+
     // Get a notification by ID
     std::optional<Notification> getById(int id);
 
@@ -48,6 +57,9 @@ public:
     // Delete all notifications for a user
     bool deleteAllForUser(int user_id);
 
+    // Recompute users.unread_notification_count where it drifted
+    int repairUnreadCounts();
+
 private:
     std::shared_ptr<db::Database> database_;
 };
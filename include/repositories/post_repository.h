@@ -2,13 +2,23 @@
 
 #include "models/post.h"
 #include "db/database.h"
+#include "utils/counter_cache.h"
+#include <functional>
 #include <memory>
 #include <optional>
+#include <shared_mutex>
 #include <vector>
 
 namespace sohbet {
 namespace repositories {
 
+// A full-text search hit: the post, its ts_rank score and a highlighted excerpt
+struct PostSearchResult {
+    Post post;
+    double rank = 0.0;
+    std::string headline;
+};
+
 class PostRepository {
 public:
     explicit PostRepository(std::shared_ptr<db::Database> database);
@@ -16,6 +26,7 @@ public:
     // CRUD operations
     std::optional<Post> create(Post& post);
     std::optional<Post> findById(int id);
+    std::vector<Post> findByIds(const std::vector<int>& ids);
     std::vector<Post> findByAuthor(int author_id, int limit = 50, int offset = 0);
     std::vector<Post> findFeedForUser(int user_id, int limit = 50, int offset = 0);
     std::vector<Post> findByGroupId(int group_id, int limit = 50, int offset = 0);
@@ -24,15 +35,42 @@ public:
     
     // Visibility check
     bool canUserViewPost(int post_id, int viewer_id);
+
+    // Full-text search over content_tsv, best match first, limited to posts
+    // the viewer may see (same rules as canUserViewPost). Pages continue
+    // after the previous page's last (rank, id); after_id <= 0 starts over.
+    std::vector<PostSearchResult> search(const std::string& query, int viewer_id, int limit,
+                                         double after_rank = 0.0, int after_id = 0);
     
-    // Reactions
-    bool addReaction(int post_id, int user_id, const std::string& reaction_type);
+    // Author of a user-authored post (nullopt for group posts or missing ids)
+    std::optional<int> findUserAuthorId(int post_id);
+
+    // Reactions; inserted, if given, is set to whether a new row was added
+    bool addReaction(int post_id, int user_id, const std::string& reaction_type, bool* inserted = nullptr);
     bool removeReaction(int post_id, int user_id, const std::string& reaction_type);
     int getReactionCount(int post_id, const std::string& reaction_type = "");
 
+    // posts.reaction_count is written behind: reactions only record a delta
+    // in memory, and this applies all pending deltas with one UPDATE
+    size_t flushReactionCounts();
+
+    // Recompute reaction_count where it drifted; returns posts corrected.
+    // Holds off reaction writes while it runs so the recount is exact.
+    int repairReactionCounts();
+
+    // Answer friends-only visibility from memory (the server's social graph)
+    // instead of querying friendships; unset falls back to the query
+    void setFriendCheck(std::function<bool(int, int)> check);
+
 private:
     std::shared_ptr<db::Database> database_;
+    utils::CounterCache reaction_counts_;
+    // Shared by a reaction write and its delta, exclusive for a repair, so
+    // a repair never sees a row whose delta is still to be recorded
+    std::shared_mutex reaction_write_gate_;
+    bool applyReactionDeltas(const utils::CounterCache::Deltas& deltas);
     bool areFriends(int user1_id, int user2_id);
+    std::function<bool(int, int)> friend_check_;
 };
 
 } // namespace repositories
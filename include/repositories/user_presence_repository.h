@@ -33,6 +33,12 @@ public:
     // Set user as offline
     bool setOffline(int user_id);
 
+    // Every stored row (startup load of the in-memory presence table)
+    std::vector<UserPresence> findAll();
+
+    // Write many users' presence in one upsert; user_ids must be distinct
+    bool upsertBatch(const std::vector<UserPresence>& presences);
+
 private:
     std::shared_ptr<db::Database> database_;
 };
@@ -2,12 +2,33 @@
 
 #include "db/database.h"
 #include "models/user.h"
+#include "utils/sharded_cache.h"
+#include <chrono>
 #include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace sohbet {
 namespace repositories {
 
+/**
+ * A full-text search hit: the user and their ts_rank score
+ */
+struct UserSearchResult {
+    User user;
+    double rank = 0.0;
+};
+
+/**
+ * Username with its accepted friend count, used to rank autocomplete
+ */
+struct UsernamePopularity {
+    int id = 0;
+    std::string username;
+    int friend_count = 0;
+};
+
 /**
  * Repository for User data operations
  */
@@ -16,8 +37,12 @@ public:
     /**
      * Constructor
      * @param database Database instance
+     * @param cache_capacity Profiles kept in memory for findById/findByIds/findByUsername
+     * @param cache_ttl How long a cached profile is trusted; bounds staleness
+     *        for changes made elsewhere (another server, another repository)
      */
-    explicit UserRepository(std::shared_ptr<db::Database> database);
+    explicit UserRepository(std::shared_ptr<db::Database> database, size_t cache_capacity = 20000,
+                            std::chrono::milliseconds cache_ttl = std::chrono::seconds(30));
     
     /**
      * Run database migrations to create the users table
@@ -34,7 +59,7 @@ public:
     std::optional<User> create(User& user, const std::string& password);
     
     /**
-     * Find a user by username
+     * Find a user by username (cached)
      * @param username Username to search for
      * @return User object if found, nullopt otherwise
      */
@@ -48,11 +73,18 @@ public:
     std::optional<User> findByEmail(const std::string& email);
     
     /**
-     * Find a user by ID
+     * Find a user by ID (cached)
      * @param id User ID to search for
      * @return User object if found, nullopt otherwise
      */
     std::optional<User> findById(int id);
+
+    /**
+     * Find several users by ID; only those not cached are queried, with one query
+     * @param ids User IDs to search for
+     * @return Users found, in no particular order (missing IDs are skipped)
+     */
+    std::vector<User> findByIds(const std::vector<int>& ids);
     
     /**
      * Check if username exists
@@ -75,12 +107,29 @@ public:
      * @return Vector of User objects
      */
     std::vector<User> findAll(int limit = 50, int offset = 0);
+
+    /**
+     * Full-text search over username, name and email (search_tsv), best match first
+     * @param query User-typed search text (websearch syntax)
+     * @param limit Maximum number of users to return
+     * @param after_rank Rank of the previous page's last hit
+     * @param after_id Id of the previous page's last hit; <= 0 for the first page
+     * @return Matching users with their ts_rank score
+     */
+    std::vector<UserSearchResult> search(const std::string& query, int limit,
+                                         double after_rank = 0.0, int after_id = 0);
     
     /**
      * Count total number of users
      * @return Total count of users in database
      */
     int countAll();
+
+    /**
+     * Every username with its accepted friend count (autocomplete index load)
+     * @return One row per user
+     */
+    std::vector<UsernamePopularity> findAllUsernamePopularity();
     
     /**
      * Update an existing user's profile
@@ -97,8 +146,24 @@ public:
      */
     bool updatePassword(int userId, const std::string& newPassword);
 
+    /**
+     * Drop a user's cached profile after changing their row outside this
+     * repository (role, email verification)
+     * @param id User ID
+     */
+    void invalidate(int id);
+
 private:
     std::shared_ptr<db::Database> database_;
+
+    // Profiles by id, and the id behind each username (usernames never change)
+    utils::ShardedCache<int, User> users_;
+    utils::ShardedCache<std::string, int> username_ids_;
+
+    // Inside a db::UnitOfWork the caches are bypassed entirely
+    bool inUnitOfWork() const;
+    std::optional<User> loadById(int id);
+    std::optional<User> loadByUsername(const std::string& username);
     
     /**
      * Helper method to build User object from database row
@@ -6,6 +6,7 @@
 #include <memory>
 #include <optional>
 #include <vector>
+#include <unordered_map>
 
 namespace sohbet {
 namespace repositories {
@@ -80,6 +81,13 @@ public:
      */
     int getActiveUserCount(int channel_id);
 
+    /**
+     * @brief Get active user counts for several channels in one query
+     * @param channel_ids Voice channel IDs
+     * @return channel_id -> active users
+     */
+    std::unordered_map<int, int> getActiveUserCounts(const std::vector<int>& channel_ids);
+
     /**
      * @brief Get list of active user IDs in a channel
      * @param channel_id Voice channel ID
@@ -102,12 +110,41 @@ public:
      */
     int endAllUserSessions(int user_id);
 
+    /**
+     * @brief End open sessions for many disconnected users in one statement
+     * @param user_ids Disconnected users
+     * @param ended_at Disconnect time per user (unix seconds); sessions opened
+     *        after it belong to a reconnect and stay open
+     * @return Number of sessions ended, or -1 on failure
+     */
+    int endUserSessionsBatch(const std::vector<int>& user_ids, const std::vector<int>& ended_at);
+
+    /**
+     * @brief All open sessions grouped by channel (used to rebuild room state at startup)
+     * @return channel_id -> user IDs with an open session
+     */
+    std::unordered_map<int, std::vector<int>> getAllActiveUsers();
+
     /**
      * @brief Find voice channels that have been empty for more than the specified duration
      * @param inactivity_minutes Number of minutes of inactivity to consider
      * @return Vector of channel IDs that are empty and inactive
      */
     std::vector<int> findEmptyInactiveChannels(int inactivity_minutes = 30);
+
+    /**
+     * @brief Delete several channels in one statement, skipping any that
+     *        have an open session again
+     * @param channel_ids Candidate channel IDs
+     * @return IDs of the channels actually deleted
+     */
+    std::vector<int> deleteEmptyChannels(const std::vector<int>& channel_ids);
+
+    /**
+     * @brief Recompute active_user_count from open sessions where it drifted
+     * @return Number of channels corrected
+     */
+    int repairActiveUserCounts();
 };
 
 } // namespace repositories
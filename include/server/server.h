@@ -6,6 +6,9 @@
 #include "db/database.h"
 
 
+#include "db/async_client.h"
+
+
 #include "repositories/user_repository.h"
 
 
@@ -78,12 +81,45 @@
 #include "services/study_buddy_matching_service.h"
 
 
+#include "services/notification_dispatcher.h"
+
+
+#include "services/presence_tracker.h"
+
+
+#include "services/chat_ingest_queue.h"
+
+
 #include "server/websocket_server.h"
 
 
 #include "voice/voice_service.h"
 
 
+#include "voice/voice_room_registry.h"
+
+
+#include "utils/batch_loader.h"
+
+
+#include "utils/timer_wheel.h"
+
+
+#include "utils/lru_cache.h"
+
+
+#include "utils/prefix_index.h"
+
+
+#include "utils/trending_tracker.h"
+
+
+#include "utils/social_graph.h"
+
+
+#include "utils/http_parser.h"
+
+
 #include <memory>
 
 
@@ -165,7 +201,13 @@ struct HttpRequest {
     std::string body;
 
 
-    std::map<std::string, std::string> headers;
+    // Case-insensitive; names and values are views into buffer
+    utils::HttpHeaderTable headers;
+
+
+    // Raw request bytes the header views point into (shared, so copies of
+    // the request stay valid)
+    std::shared_ptr<const std::string> buffer;
 
 
     
@@ -396,19 +438,81 @@ private:
     std::shared_ptr<WebSocketServer> websocket_server_;
 
 
+    // Batched, coalesced notification writes with WebSocket push
+    std::unique_ptr<services::NotificationDispatcher> notification_dispatcher_;
+
+
+    // Who is online, fed by WebSocket connects/disconnects/activity and
+    // written to user_presence in periodic batches
+    std::unique_ptr<services::PresenceTracker> presence_tracker_;
+
+
+    // Pipelined, non-blocking queries on connections of their own; null when
+    // they could not be opened, and handlers fall back to Statement
+    std::unique_ptr<db::AsyncClient> async_db_;
+
+
+    // WebSocket chat messages: fanned out on arrival, stored by group commit
+    std::unique_ptr<services::ChatIngestQueue> chat_ingest_queue_;
+
+
+    // WebSocket upgrades arrive on the HTTP port (WS_PORT == PORT)
+    bool shared_websocket_port_ = false;
+
+
     std::atomic<bool> running_;
 
 
     int server_socket_;
 
-    // Voice channel cleanup thread
-    std::thread voice_cleanup_thread_;
-    std::atomic<bool> cleanup_running_;
+    // Live voice room membership (sharded; replaces the global participants map)
+    VoiceRoomRegistry voice_rooms_;
+
+
+    // Empty voice channel expiry: channel_id -> armed timer, and channels
+    // whose timer fired but are not yet deleted
+    std::mutex voice_expiry_mutex_;
+    std::unordered_map<int, utils::TimerWheel::TimerId> voice_channel_expiry_;
+    std::vector<int> expired_voice_channels_;
+
+
+    // Serialized /api/search responses for hot queries; short TTL instead of
+    // invalidation, so new posts show up within seconds
+    utils::LruCache<std::string, std::string> search_cache_{1024, std::chrono::seconds(30), "search"};
+
+
+    // Autocomplete: hashtags ranked by usage_count, usernames by accepted
+    // friend count; loaded at startup and updated on writes
+    utils::PrefixIndex hashtag_index_;
+
+    utils::PrefixIndex username_index_;
+
+
+    // Decayed hashtag use from public posts, per window and university
+    utils::TrendingTracker trending_hashtags_{{
+        {"1h", std::chrono::hours(1)},
+        {"24h", std::chrono::hours(24)},
+        {"7d", std::chrono::hours(24 * 7)},
+    }};
+
 
+    // Accepted friendships; loaded at startup, updated on accept/delete and
+    // compacted in the background
+    utils::SocialGraph social_graph_;
 
-    // Voice channel state tracking: channel_id -> set of user_ids
-    mutable std::mutex voice_channels_mutex_;
-    std::map<int, std::set<int>> voice_channel_participants_;
+
+    // Slow full-table jobs (counter repair, voice channel sweep) on their own
+    // thread so they never hold up the flushes below
+    utils::TimerWheel maintenance_;
+
+    // Read replica health checks, which reconnect synchronously, on a
+    // thread of their own too
+    utils::TimerWheel replica_monitor_;
+
+    // Periodic and deferred background jobs (declared last: stopped first);
+    // 250 ms ticks for the notification flush, 2048 slots keep one
+    // revolution at ~8.5 minutes
+    utils::TimerWheel scheduler_{std::chrono::milliseconds(250), 2048};
 
 
     
@@ -420,9 +524,35 @@ private:
 
     void handleClient(int client_socket);
 
-    HttpRequest parseHttpRequest(const std::string& raw_request);
+    // Dispatch to a handler; route receives the matched route template
+    // (a string literal, e.g. "/api/posts/:id") for metric labels
+    HttpResponse routeRequest(const HttpRequest& request, const char*& route);
+
+    void scheduleBackgroundJobs();
+
+    void flushVoiceSessionEnds();
+
+    void armVoiceChannelExpiry(int channel_id);
+
+    void cancelVoiceChannelExpiry(int channel_id);
+
+    void reapExpiredVoiceChannels();
+
+    void sweepInactiveVoiceChannels();
+
+    void repairCounters();
+
+    void loadAutocompleteIndexes();
+
+    void loadTrendingHashtags();
 
-    void runVoiceChannelCleanup();
+    void deliverNotifications(const std::vector<Notification>& notifications);
+
+    void loadPresence();
+
+    void loadSocialGraph();
+
+    void broadcastPresence(const UserPresence& presence, const std::string& type);
 
     std::string formatHttpResponse(const HttpResponse& response, const HttpRequest& request);
 
@@ -432,6 +562,8 @@ private:
 
     HttpResponse handleStatus(const HttpRequest& request);
 
+    HttpResponse handleMetrics(const HttpRequest& request);
+
 
     HttpResponse handleGetUsers(const HttpRequest& request);
 
@@ -487,6 +619,9 @@ private:
     HttpResponse handleGetFriends(const HttpRequest& request);
 
 
+    HttpResponse handleGetFriendSuggestions(const HttpRequest& request);
+
+
     
 
 
@@ -526,6 +661,15 @@ private:
     HttpResponse handleGetComments(const HttpRequest& request);
 
 
+    // GET /api/posts/:id/comments?view=tree; with a parent, that comment's
+    // replies in the same shape
+    HttpResponse handleGetCommentThreads(const HttpRequest& request, int post_id, const Comment* parent = nullptr);
+
+
+    // GET /api/comments/:id/replies
+    HttpResponse handleGetCommentReplies(const HttpRequest& request);
+
+
     HttpResponse handleReplyToComment(const HttpRequest& request);
 
 
@@ -576,6 +720,20 @@ private:
     HttpResponse handleGetPostsByHashtag(const HttpRequest& request);
 
 
+    // Search handlers
+
+    HttpResponse handleSearch(const HttpRequest& request);
+
+    HttpResponse handleAutocompleteUsers(const HttpRequest& request);
+
+
+    // Presence handlers
+
+    HttpResponse handleGetUserPresence(const HttpRequest& request);
+
+    HttpResponse handleGetPresence(const HttpRequest& request);
+
+
     // Announcement handlers
 
     HttpResponse handleCreateAnnouncement(const HttpRequest& request);
@@ -648,6 +806,12 @@ private:
     HttpResponse handleGetConversations(const HttpRequest& request);
 
 
+    HttpResponse handleGetInbox(const HttpRequest& request);
+
+
+    HttpResponse handleMarkConversationRead(const HttpRequest& request);
+
+
     HttpResponse handleGetOrCreateConversation(const HttpRequest& request);
 
 
@@ -702,6 +866,13 @@ private:
     void handleChatMessage(int user_id, const WebSocketMessage& message);
 
 
+    // sequence is set for messages from chat_ingest_queue_, which have no id yet
+    void sendChatMessage(const Message& message, int user1_id, int user2_id, uint64_t sequence = 0);
+
+
+    void acknowledgeChatMessage(const services::QueuedMessage& queued, bool persisted);
+
+
     void handleTypingIndicator(int user_id, const WebSocketMessage& message);
 
 
@@ -725,6 +896,10 @@ private:
 
     void handleVoiceVideoToggle(int user_id, const WebSocketMessage& message);
 
+    void handleUserConnect(int user_id);
+
+    void handlePresenceUpdate(int user_id, const WebSocketMessage& message);
+
     void handleUserDisconnect(int user_id);
 
 
@@ -740,9 +915,6 @@ private:
     HttpResponse createErrorResponse(int status_code, const std::string& message);
 
 
-    std::string extractJsonField(const std::string& json, const std::string& field);
-
-
     bool validateUserRegistration(const std::string& username, const std::string& email, const std::string& password, std::string& error);
 
 
@@ -756,6 +928,14 @@ private:
     int extractIdFromPath(const std::string& path, const std::string& prefix);
 
 
+    // URL-decoded value of a query string parameter ("" if absent)
+    static std::string getQueryParam(const std::string& path, const std::string& name);
+
+
+    // Per-request loader resolving user ids to profiles in batches
+    utils::BatchLoader<int, std::optional<User>> makeUserLoader();
+
+
 };
 
 
@@ -8,8 +8,12 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <vector>
 
 namespace sohbet {
+
+namespace utils { class Counter; }
+
 namespace server {
 
 /**
@@ -37,10 +41,15 @@ public:
 
     bool sendMessage(const std::string& message);
 
+    // Refuse further sends; waits for one in progress. Called before the
+    // socket is closed, since senders may still hold this connection
+    void markClosed();
+
 private:
     int socket_fd_;
     int user_id_;
     bool authenticated_;
+    bool closed_ = false;   // Guarded by send_mutex_
     std::mutex send_mutex_; // Protects concurrent sends on the same socket
 };
 
@@ -51,6 +60,8 @@ class WebSocketServer {
 public:
     using MessageHandler = std::function<void(int user_id, const WebSocketMessage& message)>;
     using DisconnectHandler = std::function<void(int user_id)>;
+    using ConnectHandler = std::function<void(int user_id)>;
+    using ActivityHandler = std::function<void(int user_id)>;
 
     /**
      * Constructor
@@ -69,10 +80,26 @@ public:
      */
     bool start();
     
+    /**
+     * Start in shared-port mode without a listener of its own
+     * Connections are handed over by the HTTP server via adoptConnection()
+     */
+    void startShared();
+
     /**
      * Stop the WebSocket server
      */
     void stop();
+
+    /**
+     * Take over a socket accepted by the HTTP server for an Upgrade request
+     * Completes the handshake using the already-read request and serves the
+     * connection on the calling thread until the client disconnects.
+     * @param client_socket Accepted client socket (closed by this call)
+     * @param request Raw HTTP upgrade request headers
+     * @param buffered Bytes received after the request headers, if any
+     */
+    void adoptConnection(int client_socket, const std::string& request, const std::string& buffered);
     
     /**
      * Register a message handler for specific message types
@@ -87,6 +114,19 @@ public:
      */
     void registerDisconnectHandler(DisconnectHandler handler);
 
+    /**
+     * Register a handler called when an authenticated socket opens
+     * Called once per socket; a user with two tabs connects twice.
+     * @param handler Handler function called with user_id
+     */
+    void registerConnectHandler(ConnectHandler handler);
+
+    /**
+     * Register a handler called for every message a user sends
+     * @param handler Handler function called with user_id
+     */
+    void registerActivityHandler(ActivityHandler handler);
+
     /**
      * Send message to a specific user
      * @param user_id Target user ID
@@ -101,6 +141,12 @@ public:
      * @param message Message to send
      */
     void sendToUsers(const std::set<int>& user_ids, const WebSocketMessage& message);
+
+    /**
+     * Send a batch of messages, grouped by recipient, in one fan-out
+     * @param messages_by_user User ID -> messages for that user, in order
+     */
+    void sendToUsers(const std::map<int, std::vector<WebSocketMessage>>& messages_by_user);
     
     /**
      * Broadcast message to all connected users
@@ -134,14 +180,22 @@ private:
     
     // Message handlers
     mutable std::mutex handlers_mutex_;
-    std::map<std::string, MessageHandler> handlers_;
+    struct RegisteredHandler {
+        MessageHandler handler;
+        utils::Counter* received;   // sohbet_websocket_received_messages_total{type}
+    };
+    std::map<std::string, RegisteredHandler> handlers_;
     DisconnectHandler disconnect_handler_;
+    ConnectHandler connect_handler_;
+    ActivityHandler activity_handler_;
 
     // Server methods
     bool initializeSocket();
     void acceptConnections();
     void handleClient(int client_socket);
+    void serveConnection(int client_socket, const std::string& request, const std::string& buffered);
     bool performWebSocketHandshake(int client_socket, std::string& request);
+    bool completeHandshake(int client_socket, const std::string& request);
     int authenticateConnection(const std::string& request);
     WebSocketMessage parseMessage(const std::string& raw_message);
     std::string formatMessage(const WebSocketMessage& message);
@@ -150,6 +204,9 @@ private:
     std::string decodeFrame(const std::string& frame);
     std::string encodeFrame(const std::string& message);
     
+    // Connections of a user; caller holds connections_mutex_
+    std::vector<std::shared_ptr<WebSocketConnection>> connectionsOf(int user_id) const;
+
     // Connection cleanup
     void removeConnection(int socket_fd);
 };
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "models/message.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sohbet {
+namespace services {
+
+/**
+ * A chat message accepted by ChatIngestQueue
+ *
+ * message.id is 0 until the message is stored. recipients and client_ref are
+ * carried through untouched for the acknowledgement.
+ */
+struct QueuedMessage {
+    uint64_t sequence = 0;          // Server order of acceptance
+    Message message;
+    std::vector<int> recipients;    // Who the message was fanned out to
+    std::string client_ref;         // Sender's correlation token, echoed back
+};
+
+/**
+ * Group commit for chat messages
+ *
+ * enqueue() assigns the next sequence number and returns at once, so the
+ * caller can fan the message out before it is stored. A writer thread then
+ * persists everything queued in one transaction: a multi-row INSERT plus a
+ * last_message_at update that touches each conversation once, however many
+ * messages it got.
+ * The writer waits up to linger after the first message so a burst shares a
+ * commit; messages arriving while a commit runs go into the next one.
+ *
+ * Once a batch commits, ack is called for each message in sequence order
+ * with its stored id. When a batch fails, its messages are stored one at a
+ * time so one bad row only fails itself; the ones that still fail are
+ * retried, oldest first, and after max_attempts acknowledged as not
+ * persisted.
+ *
+ * Sequence numbers start at the wall-clock time in microseconds, so they
+ * keep increasing across restarts as long as the server accepts fewer than
+ * a million messages a second on average.
+ */
+class ChatIngestQueue {
+public:
+    // Store messages and bump last_message_at of the conversations they belong
+    // to (each listed once) in one transaction; returns the new ids in the
+    // order of messages, or empty on failure
+    using PersistFunction = std::function<std::vector<int>(const std::vector<Message>& messages,
+                                                           const std::vector<int>& conversation_ids)>;
+    using AckFunction = std::function<void(const QueuedMessage& queued, bool persisted)>;
+
+    /**
+     * @param persist The group commit
+     * @param ack Called once per message after its batch commits or is given up
+     * @param linger How long the writer waits for more messages before committing
+     * @param max_batch Messages per commit
+     * @param max_attempts Commits tried before a message is dropped
+     */
+    ChatIngestQueue(PersistFunction persist, AckFunction ack,
+                    std::chrono::milliseconds linger = std::chrono::milliseconds(2),
+                    size_t max_batch = 500, size_t max_attempts = 3);
+    ~ChatIngestQueue();
+
+    ChatIngestQueue(const ChatIngestQueue&) = delete;
+    ChatIngestQueue& operator=(const ChatIngestQueue&) = delete;
+
+    /**
+     * Start the writer thread; without it, messages are stored only by flush()
+     */
+    void start();
+
+    /**
+     * Stop the writer thread and store what is still queued
+     */
+    void stop();
+
+    /**
+     * Accept a message (message.id and sequence are assigned here)
+     * @return The queued message with its sequence number
+     */
+    QueuedMessage enqueue(Message message, std::vector<int> recipients = {}, std::string client_ref = "");
+
+    /**
+     * Commit up to max_batch queued messages now
+     * @return Number of messages stored (with a failed batch, those stored
+     *         one at a time)
+     */
+    size_t flush();
+
+    /**
+     * Messages accepted but not yet stored or dropped
+     */
+    size_t pending() const;
+
+private:
+    struct Entry {
+        QueuedMessage queued;
+        size_t attempts = 0;
+    };
+
+    void run();
+
+    PersistFunction persist_;
+    AckFunction ack_;
+    std::chrono::milliseconds linger_;
+    size_t max_batch_;
+    size_t max_attempts_;
+
+    std::atomic<uint64_t> next_sequence_;
+
+    mutable std::mutex mutex_;        // Guards queue_ and stopping_
+    std::mutex flush_mutex_;          // Serializes commits, so acks stay in order
+    std::condition_variable wake_;
+    std::deque<Entry> queue_;
+    bool stopping_ = false;
+    std::thread writer_;
+};
+
+} // namespace services
+} // namespace sohbet
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "models/notification.h"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <set>
+
+namespace sohbet {
+namespace services {
+
+/**
+ * One notification for one recipient
+ *
+ * Requests with the same recipient and coalesce_key that arrive within the
+ * coalescing window become a single notification. With more than one
+ * distinct actor (related_user_id), its message is coalesced_message with
+ * "{count}" replaced by the number of actors, e.g.
+ * "{count} people reacted to your post".
+ */
+struct NotificationRequest {
+    Notification notification;
+    std::string coalesce_key;       // Empty: never coalesced
+    std::string coalesced_message;
+};
+
+/**
+ * Batches notification writes and pushes stored notifications to clients
+ *
+ * notify() and notifyAll() only queue. flush(), run periodically, writes
+ * everything that is ready in multi-row INSERTs (persist) or, for
+ * fan-outs such as group announcements, one INSERT ... SELECT per chunk of
+ * recipients (fan_out), then hands the stored rows, with ids, to deliver
+ * (the WebSocket push). Coalesced entries become ready once their window
+ * has passed; everything else is ready on the next flush.
+ *
+ * When a multi-row insert fails, its rows are written one at a time so one
+ * bad row cannot hold back the rest. Rows (and fan-out chunks) that still
+ * fail are retried with exponential backoff and dropped, with an error
+ * log, after max_attempts. The storage and delivery steps are injected,
+ * so the dispatcher knows nothing about SQL or sockets.
+ */
+class NotificationDispatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+    // Store rows; returns them with ids set, or empty on failure
+    using PersistFunction = std::function<std::vector<Notification>(const std::vector<Notification>& notifications)>;
+    // Store one notification for many recipients; same contract
+    using FanOutFunction = std::function<std::vector<Notification>(const std::vector<int>& user_ids,
+                                                                   const Notification& notification)>;
+    using DeliverFunction = std::function<void(const std::vector<Notification>& notifications)>;
+
+    /**
+     * @param persist Multi-row insert for individual notifications
+     * @param fan_out Single-statement insert of one notification for many users
+     * @param deliver Push to online recipients
+     * @param coalesce_window How long a coalescable notification waits for more actors
+     * @param max_batch Rows per persist call
+     * @param max_attempts Writes of one row or fan-out chunk before it is dropped
+     * @param retry_delay Wait before the first retry; doubles with each attempt
+     */
+    NotificationDispatcher(PersistFunction persist, FanOutFunction fan_out, DeliverFunction deliver,
+                           std::chrono::milliseconds coalesce_window = std::chrono::seconds(2),
+                           size_t max_batch = 500, int max_attempts = 8,
+                           std::chrono::milliseconds retry_delay = std::chrono::milliseconds(500));
+
+    NotificationDispatcher(const NotificationDispatcher&) = delete;
+    NotificationDispatcher& operator=(const NotificationDispatcher&) = delete;
+
+    /**
+     * Queue a notification for one recipient
+     */
+    void notify(NotificationRequest request);
+
+    /**
+     * Queue the same notification for many recipients (user_id is ignored)
+     */
+    void notifyAll(std::vector<int> user_ids, Notification notification);
+
+    /**
+     * Write and deliver everything that is ready
+     * @param force Also take coalesced entries whose window is still open (shutdown)
+     * @return Number of notifications stored
+     */
+    size_t flush(bool force = false);
+
+    /**
+     * Queued notifications not yet stored (fan-outs count every recipient)
+     */
+    size_t pending() const;
+
+private:
+    struct Coalesced {
+        NotificationRequest request;
+        std::set<int> actors;
+        Clock::time_point first_seen;
+    };
+
+    struct Queued {
+        Notification notification;
+        int attempts = 0;               // Failed writes so far
+        Clock::time_point retry_at{};   // Not written again before this
+    };
+
+    struct FanOut {
+        std::vector<int> user_ids;
+        Notification notification;
+        int attempts = 0;
+        Clock::time_point retry_at{};
+    };
+
+    static Notification finish(Coalesced& entry);
+
+    // Count a failed write; false once the item has used up its attempts
+    bool scheduleRetry(int& attempts, Clock::time_point& retry_at, Clock::time_point now) const;
+
+    PersistFunction persist_;
+    FanOutFunction fan_out_;
+    DeliverFunction deliver_;
+    std::chrono::milliseconds coalesce_window_;
+    size_t max_batch_;
+    int max_attempts_;
+    std::chrono::milliseconds retry_delay_;
+
+    mutable std::mutex mutex_;        // Guards the queues below
+    std::mutex flush_mutex_;          // Serializes flushes
+    std::unordered_map<std::string, Coalesced> coalescing_;  // "<user_id>|<key>"
+    std::vector<Queued> ready_;
+    std::vector<FanOut> fan_outs_;
+};
+
+} // namespace services
+} // namespace sohbet
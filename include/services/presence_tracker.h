@@ -0,0 +1,126 @@
+#pragma once
+
+#include "models/user_presence.h"
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sohbet {
+namespace services {
+
+/**
+ * Authoritative in-memory presence table with write-behind persistence
+ *
+ * The WebSocket server reports connects, disconnects and activity; a user is
+ * online while at least one of their sockets is open. The status a user
+ * picked (online, away or busy) and their custom status survive reconnects;
+ * while they have no sockets their visible status is "offline".
+ *
+ * Nothing here touches the database. Changed users are marked dirty and
+ * flush(), run periodically, hands their current rows to persist in batches
+ * (one upsert per batch), so a burst of heartbeats from one user becomes a
+ * single row write. A failed batch stays dirty and is retried.
+ */
+class PresenceTracker {
+public:
+    // Upsert rows; returns false on failure
+    using PersistFunction = std::function<bool(const std::vector<UserPresence>& rows)>;
+
+    /**
+     * @param persist Batched upsert into user_presence
+     * @param max_batch Rows per persist call
+     */
+    explicit PresenceTracker(PersistFunction persist, size_t max_batch = 1000);
+
+    PresenceTracker(const PresenceTracker&) = delete;
+    PresenceTracker& operator=(const PresenceTracker&) = delete;
+
+    /**
+     * Seed from the stored table at startup
+     * No one is connected yet, so rows stored as online are loaded as
+     * offline and marked dirty to correct the table on the next flush.
+     */
+    void load(const std::vector<UserPresence>& rows);
+
+    /**
+     * A socket for user_id opened
+     * @return true if the user was offline and is now online
+     */
+    bool connect(int user_id, std::time_t now = std::time(nullptr));
+
+    /**
+     * A socket for user_id closed
+     * @return true if it was the user's last socket and they are now offline
+     */
+    bool disconnect(int user_id, std::time_t now = std::time(nullptr));
+
+    /**
+     * Activity from a connected user: advances last_seen
+     */
+    void touch(int user_id, std::time_t now = std::time(nullptr));
+
+    /**
+     * Set the chosen status ("online", "away" or "busy") and custom status
+     * @return The user's presence if it changed while they are connected,
+     *         i.e. something friends should be told about
+     */
+    std::optional<UserPresence> setStatus(int user_id, const std::string& status,
+                                          const std::string& custom_status,
+                                          std::time_t now = std::time(nullptr));
+
+    /**
+     * Presence for one user; users never seen are offline with last_seen 0
+     */
+    UserPresence get(int user_id) const;
+
+    /**
+     * Presence for several users, in the given order
+     */
+    std::vector<UserPresence> getByUserIds(const std::vector<int>& user_ids) const;
+
+    /**
+     * Everyone with an open socket, most recently updated first
+     */
+    std::vector<UserPresence> getOnlineUsers() const;
+
+    /**
+     * Write all changed users
+     * @return Number of rows written
+     */
+    size_t flush();
+
+    /**
+     * Users changed since the last successful flush
+     */
+    size_t dirty() const;
+
+    static bool isValidStatus(const std::string& status);
+
+private:
+    struct Entry {
+        int id = 0;
+        int connections = 0;
+        std::string status = "online";   // Chosen status, shown while connected
+        std::string custom_status;
+        std::time_t last_seen = 0;
+        std::time_t updated_at = 0;
+    };
+
+    static UserPresence toPresence(int user_id, const Entry& entry);
+
+    PersistFunction persist_;
+    size_t max_batch_;
+
+    mutable std::mutex mutex_;        // Guards entries_ and dirty_
+    std::mutex flush_mutex_;          // Serializes flushes
+    std::unordered_map<int, Entry> entries_;
+    std::unordered_set<int> dirty_;
+};
+
+} // namespace services
+} // namespace sohbet
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Per-request batching and memoizing loader (DataLoader pattern)
+ *
+ * List handlers used to call a repository once per row to fetch an
+ * aggregate (member count, viewer role, author profile). A BatchLoader
+ * collects the keys first and fetches them with one query:
+ *
+ *   utils::BatchLoader<int, int> member_counts(
+ *       [&](const std::vector<int>& ids) { return repo->getMemberCounts(ids); }, 0);
+ *   for (const auto& group : groups) member_counts.prime(group.getId().value());
+ *   ...
+ *   int count = member_counts.load(group_id); // first load runs one batch
+ *
+ * Results are memoized for the loader's lifetime, so keep one loader per
+ * request; it is not thread-safe and does not outlive the handler.
+ * Keys the batch function does not return resolve to the fallback value.
+ */
+template <typename K, typename V>
+class BatchLoader {
+public:
+    using BatchFunction = std::function<std::unordered_map<K, V>(const std::vector<K>&)>;
+
+    /**
+     * @param batch_fn Fetches values for a set of distinct keys in one call
+     * @param fallback Value for keys the batch function does not return
+     */
+    explicit BatchLoader(BatchFunction batch_fn, V fallback = V())
+        : batch_fn_(std::move(batch_fn)), fallback_(std::move(fallback)) {}
+
+    /**
+     * Queue a key for the next batch (no-op if already loaded or queued)
+     */
+    void prime(const K& key) {
+        if (cache_.count(key) == 0 && queued_.insert(key).second) {
+            pending_.push_back(key);
+        }
+    }
+
+    /**
+     * Get the value for a key, running the pending batch if needed
+     */
+    const V& load(const K& key) {
+        auto it = cache_.find(key);
+        if (it != cache_.end()) {
+            return it->second;
+        }
+        prime(key);
+        dispatch();
+        return cache_.find(key)->second;
+    }
+
+    /**
+     * Fetch all queued keys now with a single batch call
+     */
+    void dispatch() {
+        if (pending_.empty()) {
+            return;
+        }
+        std::vector<K> keys;
+        keys.swap(pending_);
+        queued_.clear();
+
+        std::unordered_map<K, V> results = batch_fn_(keys);
+        ++batches_;
+        for (const K& key : keys) {
+            auto found = results.find(key);
+            if (found != results.end()) {
+                cache_.emplace(key, std::move(found->second));
+            } else {
+                cache_.emplace(key, fallback_);
+            }
+        }
+    }
+
+    /**
+     * Number of batch calls issued so far
+     */
+    size_t batchCount() const { return batches_; }
+
+private:
+    BatchFunction batch_fn_;
+    V fallback_;
+    std::vector<K> pending_;
+    std::unordered_set<K> queued_;
+    std::unordered_map<K, V> cache_;
+    size_t batches_ = 0;
+};
+
+} // namespace utils
+} // namespace sohbet
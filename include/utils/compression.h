@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * HTTP content codings the server can produce
+ * New codings (e.g. br) slot in here and in negotiateEncoding()
+ */
+enum class ContentEncoding {
+    Identity,
+    Gzip,
+    Deflate
+};
+
+/**
+ * Token used in the Content-Encoding header ("" for identity)
+ */
+const char* contentEncodingName(ContentEncoding encoding);
+
+/**
+ * Pick the best coding from an Accept-Encoding header value
+ * Honours q-values (q=0 forbids a coding) and "*"; prefers gzip over
+ * deflate when both are equally acceptable.
+ * @param accept_encoding Raw header value (may be empty)
+ * @return Chosen coding, Identity when nothing suitable is accepted
+ */
+ContentEncoding negotiateEncoding(std::string_view accept_encoding);
+
+/**
+ * Whether a response of this Content-Type benefits from compression
+ * Text and JSON-like types do; images, video, archives and other already
+ * compressed media do not and are sent as-is.
+ */
+bool isCompressibleContentType(std::string_view content_type);
+
+/**
+ * Response body compressor backed by reusable zlib streams
+ *
+ * Setting up a deflate stream allocates ~256 KB of window and hash tables.
+ * Streams are kept in a small pool and reset between responses instead of
+ * being created and destroyed per request, so connection threads borrow
+ * an already-initialized stream for the duration of one compress() call.
+ */
+class ResponseCompressor {
+public:
+    /**
+     * Process-wide instance used by the HTTP server
+     */
+    static ResponseCompressor& getInstance();
+
+    /**
+     * @param level zlib compression level (1-9); 6 is zlib's default
+     * @param max_pooled_streams Idle streams kept per coding
+     */
+    explicit ResponseCompressor(int level = 6, size_t max_pooled_streams = 16);
+    ~ResponseCompressor();
+
+    ResponseCompressor(const ResponseCompressor&) = delete;
+    ResponseCompressor& operator=(const ResponseCompressor&) = delete;
+
+    /**
+     * Compress a complete body
+     * @param input Uncompressed body
+     * @param encoding Gzip or Deflate (zlib format, as HTTP "deflate" means)
+     * @param output Replaced with the compressed bytes on success
+     * @return false for Identity or on zlib failure (output untouched)
+     */
+    bool compress(std::string_view input, ContentEncoding encoding, std::string& output);
+
+    /**
+     * Number of idle streams currently pooled (for tests)
+     */
+    size_t pooledStreams() const;
+
+private:
+    struct Stream;
+
+    std::unique_ptr<Stream> acquire(ContentEncoding encoding);
+    void release(std::unique_ptr<Stream> stream);
+
+    int level_;
+    size_t max_pooled_streams_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Stream>> gzip_pool_;
+    std::vector<std::unique_ptr<Stream>> deflate_pool_;
+};
+
+} // namespace utils
+} // namespace sohbet
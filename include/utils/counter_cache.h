@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Write-behind cache for hot counter increments
+ *
+ * Instead of one UPDATE per event, callers record deltas here and a
+ * periodic flush() hands the accumulated per-key deltas to a single
+ * batched write. A viral post receiving hundreds of reactions per second
+ * then costs one UPDATE per flush interval instead of hundreds.
+ *
+ * Readers add pending(key) to the stored value so counts stay exact
+ * between flushes within this process. If the write fails, the deltas are
+ * merged back and retried on the next flush.
+ */
+class CounterCache {
+public:
+    using Deltas = std::unordered_map<int, int64_t>;
+    using FlushFunction = std::function<bool(const Deltas& deltas)>;
+
+    /**
+     * @param name Label used in metrics (e.g. "post_reactions")
+     * @param flush_fn Applies a batch of deltas to storage, true on success
+     */
+    CounterCache(std::string name, FlushFunction flush_fn);
+
+    CounterCache(const CounterCache&) = delete;
+    CounterCache& operator=(const CounterCache&) = delete;
+
+    /**
+     * Record a change for a key (coalesced with earlier changes)
+     */
+    void add(int key, int64_t delta);
+
+    /**
+     * Not-yet-flushed delta for a key (0 if none)
+     */
+    int64_t pending(int key) const;
+
+    /**
+     * Number of keys with unflushed deltas
+     */
+    size_t pendingKeys() const;
+
+    /**
+     * Write all pending deltas with one call to the flush function
+     * Concurrent flushes are serialized; add() is never blocked by a write.
+     * @return Number of keys written (0 if nothing pending or on failure)
+     */
+    size_t flush();
+
+private:
+    std::string name_;
+    FlushFunction flush_fn_;
+
+    mutable std::mutex mutex_;        // Guards pending_ and in_flight_
+    std::mutex flush_mutex_;          // Serializes flushes
+    Deltas pending_;
+    Deltas in_flight_;                // Being written; still counted by pending()
+};
+
+} // namespace utils
+} // namespace sohbet
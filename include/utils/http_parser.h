@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * One request header; both views point into the buffer that was parsed
+ */
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * Flat header table with case-insensitive lookup
+ *
+ * The first INLINE_CAPACITY headers live in the object itself, so a typical
+ * request allocates nothing; more spill into a vector. Lookups are a linear
+ * scan, which beats a map for the dozen or so headers a browser sends.
+ */
+class HttpHeaderTable {
+public:
+    static const size_t INLINE_CAPACITY = 16;
+
+    void add(std::string_view name, std::string_view value);
+    void clear();
+
+    /**
+     * First value for name, compared case-insensitively
+     */
+    std::optional<std::string_view> get(std::string_view name) const;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const HttpHeader& operator[](size_t index) const;
+
+    /**
+     * Re-point every view after the underlying buffer moved
+     */
+    void rebase(const char* old_base, const char* new_base);
+
+    static bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+private:
+    std::array<HttpHeader, INLINE_CAPACITY> inline_{};
+    std::vector<HttpHeader> overflow_;
+    size_t size_ = 0;
+};
+
+enum class HttpParseStatus {
+    Complete,
+    Incomplete,   // Need more bytes
+    Invalid
+};
+
+/**
+ * Request line and headers of an HTTP/1.x request
+ */
+struct HttpRequestHead {
+    std::string_view method;
+    std::string_view target;
+    int minor_version = 1;
+    HttpHeaderTable headers;
+    size_t length = 0;   // Bytes up to and including the blank line
+
+    /**
+     * Body framing from Transfer-Encoding
+     * @param chunked Set when the codings end in "chunked"
+     * @return false if Transfer-Encoding is present but its last coding is
+     *         not chunked, or chunked appears before the end; RFC 9112 §6.3
+     *         requires a 400 and closing the connection
+     */
+    bool transferEncoding(bool& chunked) const;
+
+    /**
+     * Content-Length, 0 when absent
+     * @return false if it is malformed or repeated with different values
+     */
+    bool contentLength(size_t& length) const;
+
+    void rebase(const char* old_base, const char* new_base);
+};
+
+/**
+ * Parse a request head from the start of data without copying
+ *
+ * Views in head point into data, which must outlive them. Call again with
+ * more bytes after Incomplete; previous_size (how much was seen last time)
+ * lets the call skip rescanning for the end of the head.
+ *
+ * Accepts CRLF or bare LF line endings; rejects obsolete header folding,
+ * control characters and malformed tokens.
+ */
+HttpParseStatus parseHttpRequestHead(std::string_view data, HttpRequestHead& head, size_t previous_size = 0);
+
+/**
+ * Incremental decoder for Transfer-Encoding: chunked bodies
+ *
+ * Feed bytes as they arrive; decoded data is appended to the output.
+ * Chunk extensions and trailers are skipped; one line of either longer
+ * than 4 KiB makes the body Invalid.
+ */
+class HttpChunkedDecoder {
+public:
+    /**
+     * @param input Next bytes of the encoded body
+     * @param output Decoded bytes are appended here
+     * @return Complete after the last chunk and trailers; remaining() then
+     *         counts unconsumed input bytes (the next request, if pipelined)
+     */
+    HttpParseStatus feed(std::string_view input, std::string& output);
+
+    size_t remaining() const { return remaining_; }
+
+private:
+    enum class State { Size, Extension, SizeLf, Data, DataCr, DataLf, Trailer, TrailerCr, TrailerLine, Done };
+
+    State state_ = State::Size;
+    size_t chunk_size_ = 0;
+    size_t size_digits_ = 0;
+    size_t line_length_ = 0;    // Bytes so far of the extension or trailer line
+    size_t remaining_ = 0;
+};
+
+} // namespace utils
+} // namespace sohbet
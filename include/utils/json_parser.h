@@ -0,0 +1,168 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+namespace sohbet {
+namespace utils {
+
+enum class JsonType : uint8_t {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object
+};
+
+class JsonDocument;
+
+/**
+ * Read-only handle to a value inside a parsed JsonDocument
+ *
+ * Handles are cheap to copy. Looking up a key or index that does not exist
+ * yields a "missing" handle whose getters all return std::nullopt, so
+ * lookups can be chained without checks: body["author"]["id"].getInt().
+ */
+class JsonValue {
+public:
+    JsonValue() = default;
+
+    bool exists() const { return doc_ != nullptr; }
+    JsonType type() const;
+
+    bool isNull() const { return exists() && type() == JsonType::Null; }
+    bool isBool() const { return exists() && type() == JsonType::Bool; }
+    bool isNumber() const { return exists() && type() == JsonType::Number; }
+    bool isString() const { return exists() && type() == JsonType::String; }
+    bool isArray() const { return exists() && type() == JsonType::Array; }
+    bool isObject() const { return exists() && type() == JsonType::Object; }
+
+    /**
+     * String value with escape sequences decoded
+     * @return nullopt if missing or not a string
+     */
+    std::optional<std::string> getString() const;
+
+    /**
+     * Integer value
+     * Accepts integral numbers and strings holding an integer ("42"), since
+     * clients send ids both ways.
+     * @return nullopt if missing, not an integer, or out of range
+     */
+    std::optional<int64_t> getInt() const;
+
+    std::optional<double> getDouble() const;
+
+    /**
+     * Boolean value; also accepts the strings "true" and "false"
+     */
+    std::optional<bool> getBool() const;
+
+    /**
+     * Object member lookup (first match wins for duplicate keys)
+     */
+    JsonValue operator[](std::string_view key) const;
+
+    /**
+     * Array element lookup
+     */
+    JsonValue at(size_t index) const;
+
+    /**
+     * Number of array elements or object members (0 for scalars)
+     */
+    size_t size() const;
+
+    /**
+     * Source text of the value, e.g. to store a nested array as JSON
+     */
+    std::string_view raw() const;
+
+    /**
+     * Visit array elements in order
+     */
+    template <typename Fn>
+    void forEach(Fn fn) const;
+
+private:
+    friend class JsonDocument;
+    JsonValue(const JsonDocument* doc, uint32_t index) : doc_(doc), index_(index) {}
+
+    const JsonDocument* doc_ = nullptr;
+    uint32_t index_ = 0;
+};
+
+/**
+ * Single-pass JSON parser producing a flat, read-only index
+ *
+ * The input is validated once (RFC 8259, nesting limited to MAX_DEPTH) and
+ * recorded as a flat node array pointing into the source text. Strings are
+ * decoded and numbers converted only when a getter asks for them.
+ *
+ * The document refers to the parsed text without copying it, so the text
+ * must outlive the document (request.body does for a handler).
+ */
+class JsonDocument {
+public:
+    static constexpr int MAX_DEPTH = 64;
+
+    /**
+     * Parse a JSON text
+     * @return Document; check isValid() before use
+     */
+    static JsonDocument parse(std::string_view text);
+
+    bool isValid() const { return error_.empty(); }
+
+    /**
+     * Human readable parse error (empty when valid)
+     */
+    const std::string& getError() const { return error_; }
+
+    JsonValue root() const;
+
+    // Shorthands for the root object, which is what request bodies are
+    JsonValue operator[](std::string_view key) const { return root()[key]; }
+    std::optional<std::string> getString(std::string_view key) const { return root()[key].getString(); }
+    std::optional<int64_t> getInt(std::string_view key) const { return root()[key].getInt(); }
+    std::optional<double> getDouble(std::string_view key) const { return root()[key].getDouble(); }
+    std::optional<bool> getBool(std::string_view key) const { return root()[key].getBool(); }
+    bool has(std::string_view key) const { return root()[key].exists(); }
+
+private:
+    friend class JsonValue;
+    friend class JsonParser;
+
+    struct Node {
+        JsonType type;
+        bool escaped;     // string contains escape sequences
+        uint32_t end;     // index one past the last node of this subtree
+        uint32_t count;   // array elements / object members
+        uint32_t offset;  // source span: string contents, literal or container text
+        uint32_t length;
+    };
+
+    std::string_view text_;
+    std::vector<Node> nodes_;
+    std::string error_;
+};
+
+template <typename Fn>
+void JsonValue::forEach(Fn fn) const {
+    if (!isArray()) {
+        return;
+    }
+    const auto& nodes = doc_->nodes_;
+    uint32_t child = index_ + 1;
+    for (uint32_t i = 0; i < nodes[index_].count; ++i) {
+        fn(JsonValue(doc_, child));
+        child = nodes[child].end;
+    }
+}
+
+} // namespace utils
+} // namespace sohbet
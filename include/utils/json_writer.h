@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <type_traits>
+#include <cstdint>
+#include <ctime>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Streaming JSON writer
+ *
+ * Appends tokens directly into a string buffer, inserting commas and
+ * escaping strings as it goes. The default constructor borrows a buffer
+ * from a per-thread pool that keeps its capacity between uses, so building
+ * a response does not allocate once the buffer has warmed up. Writers may
+ * be nested (e.g. a handler writer calling a model's toJson()); each level
+ * gets its own pooled buffer. Writers must be destroyed in reverse order of
+ * construction, which scoped locals guarantee.
+ *
+ * Numbers are formatted with std::to_chars and are never locale dependent.
+ */
+class JsonWriter {
+public:
+    /**
+     * Write into a pooled per-thread buffer (read back with str())
+     */
+    JsonWriter();
+
+    /**
+     * Append to a caller-owned string
+     * @param out Destination buffer (existing content is kept)
+     */
+    explicit JsonWriter(std::string& out);
+
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    /**
+     * Write an object key; the next call must write its value
+     */
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view str);
+    JsonWriter& value(const char* str) { return value(std::string_view(str)); }
+    JsonWriter& value(const std::string& str) { return value(std::string_view(str)); }
+    JsonWriter& value(bool b);
+    JsonWriter& value(double number);
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value &&
+                                                  !std::is_same<T, bool>::value, int>::type = 0>
+    JsonWriter& value(T number) {
+        if (std::is_signed<T>::value) {
+            writeInt(static_cast<int64_t>(number));
+        } else {
+            writeUInt(static_cast<uint64_t>(number));
+        }
+        return *this;
+    }
+
+    JsonWriter& null();
+
+    /**
+     * Write a UTC time as an ISO 8601 string ("2025-01-31T12:00:00Z")
+     */
+    JsonWriter& timestamp(std::time_t time);
+
+    /**
+     * Write an already serialized JSON value verbatim
+     */
+    JsonWriter& raw(std::string_view json);
+
+    // Key/value shorthands
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    // Empty optionals are written as null
+    template <typename T>
+    JsonWriter& field(std::string_view name, const std::optional<T>& v) {
+        key(name);
+        return v.has_value() ? value(*v) : null();
+    }
+
+    JsonWriter& nullField(std::string_view name) { key(name); return null(); }
+    JsonWriter& rawField(std::string_view name, std::string_view json) { key(name); return raw(json); }
+    JsonWriter& timestampField(std::string_view name, std::time_t time) { key(name); return timestamp(time); }
+
+    /**
+     * Serialized output so far
+     */
+    const std::string& buffer() const { return *out_; }
+    std::string str() const { return *out_; }
+
+    /**
+     * Append the JSON-escaped form of a string (without surrounding quotes)
+     */
+    static void escape(std::string_view input, std::string& out);
+    static std::string escape(std::string_view input);
+
+private:
+    void separate();
+    void writeInt(int64_t number);
+    void writeUInt(uint64_t number);
+
+    static constexpr int MAX_DEPTH = 64;
+
+    std::string* out_;
+    bool pooled_;
+    int depth_ = 0;
+    uint64_t has_items_ = 0; // bit n set once the container at depth n has an element
+    bool after_key_ = false;
+};
+
+} // namespace utils
+} // namespace sohbet
@@ -39,7 +39,6 @@ private:
 
     std::string getCurrentTimestamp() const;
     std::string levelToString(LogLevel level) const;
-    std::string escapeJson(const std::string& str) const;
 
     LogLevel min_level_;
     std::mutex mutex_;
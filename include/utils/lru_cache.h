@@ -0,0 +1,158 @@
+#pragma once
+
+#include "utils/metrics.h"
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Thread-safe LRU cache with an optional time-to-live
+ *
+ * Holds at most `capacity` entries; inserting past that evicts the least
+ * recently used one. With a non-zero TTL, entries older than the TTL are
+ * treated as misses and dropped on lookup, which bounds staleness for
+ * caches that are not invalidated on write (e.g. search results).
+ *
+ * Lookups are reported through CacheLookupMetrics when a metrics name is
+ * given, so hit ratios show up on /metrics.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LruCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param capacity Maximum number of entries (at least 1)
+     * @param ttl Entry lifetime; zero means entries never expire
+     * @param metrics_name Cache label for hit/miss metrics; empty disables them
+     */
+    explicit LruCache(size_t capacity,
+                      std::chrono::milliseconds ttl = std::chrono::milliseconds(0),
+                      std::string metrics_name = "")
+        : capacity_(capacity == 0 ? 1 : capacity), ttl_(ttl), lookup_metrics_(metrics_name) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    /**
+     * Get a value and mark it most recently used
+     */
+    std::optional<V> get(const K& key) {
+        std::optional<V> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(key);
+            if (it != index_.end()) {
+                if (expired(*it->second)) {
+                    order_.erase(it->second);
+                    index_.erase(it);
+                } else {
+                    order_.splice(order_.begin(), order_, it->second);
+                    result = it->second->value;
+                }
+            }
+        }
+        lookup_metrics_.record(result.has_value());
+        return result;
+    }
+
+    /**
+     * Insert or replace a value
+     */
+    void put(const K& key, V value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto expires = ttl_.count() > 0 ? Clock::now() + ttl_ : Clock::time_point::max();
+
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->value = std::move(value);
+            it->second->expires = expires;
+            order_.splice(order_.begin(), order_, it->second);
+            return;
+        }
+
+        order_.push_front(Entry{key, std::move(value), expires});
+        index_[key] = order_.begin();
+        if (index_.size() > capacity_) {
+            index_.erase(order_.back().key);
+            order_.pop_back();
+        }
+    }
+
+    /**
+     * Modify a cached value in place, if present, without counting a lookup
+     * or changing its recency
+     * @return true if the key was present
+     */
+    bool update(const K& key, const std::function<void(V&)>& modify) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end() || expired(*it->second)) {
+            return false;
+        }
+        modify(it->second->value);
+        return true;
+    }
+
+    /**
+     * Remove a key
+     * @return true if it was present
+     */
+    bool erase(const K& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        order_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    /**
+     * Remove all entries
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_.clear();
+        order_.clear();
+    }
+
+    /**
+     * Number of entries, including expired ones not yet looked up
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+private:
+    struct Entry {
+        K key;
+        V value;
+        Clock::time_point expires;
+    };
+
+    bool expired(const Entry& entry) const {
+        return ttl_.count() > 0 && Clock::now() >= entry.expires;
+    }
+
+    size_t capacity_;
+    std::chrono::milliseconds ttl_;
+    CacheLookupMetrics lookup_metrics_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> order_;  // Most recently used first
+    std::unordered_map<K, typename std::list<Entry>::iterator, Hash> index_;
+};
+
+} // namespace utils
+} // namespace sohbet
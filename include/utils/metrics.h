@@ -0,0 +1,186 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Monotonically increasing counter (Prometheus "counter")
+ * Recording is a single relaxed atomic add.
+ */
+class Counter {
+public:
+    void inc(uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * Value that can go up and down (Prometheus "gauge")
+ */
+class Gauge {
+public:
+    void inc(int64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    void dec(int64_t amount = 1) { value_.fetch_sub(amount, std::memory_order_relaxed); }
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * Lock-free latency histogram with HDR-style log-linear buckets
+ *
+ * Values are recorded in microseconds into buckets that are linear within
+ * each power of two (8 sub-buckets, ~12.5% relative precision). Recording is
+ * three relaxed atomic adds and no allocation. Buckets are folded into the
+ * fixed Prometheus `le` boundaries (in seconds) only when rendered.
+ */
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 40; // ~12.7 days in microseconds
+    static constexpr int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    /**
+     * Record a value
+     * @param micros Observed duration in microseconds
+     */
+    void observeMicros(uint64_t micros) {
+        buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        sum_micros_.fetch_add(micros, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void observe(std::chrono::steady_clock::duration elapsed) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        observeMicros(micros > 0 ? static_cast<uint64_t>(micros) : 0);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sumMicros() const { return sum_micros_.load(std::memory_order_relaxed); }
+    uint64_t bucketCount(int index) const { return buckets_[index].load(std::memory_order_relaxed); }
+
+    /**
+     * Estimate a quantile from the recorded distribution
+     * @param q Quantile in [0, 1]
+     * @return Upper bound of the bucket containing the quantile, in microseconds
+     */
+    uint64_t quantileMicros(double q) const;
+
+    static int bucketIndex(uint64_t micros);
+
+    // Largest value (inclusive) that falls into the given bucket
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> sum_micros_{0};
+    std::atomic<uint64_t> count_{0};
+};
+
+/**
+ * Records the lifetime of the scope into a histogram
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram_.observe(std::chrono::steady_clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Process-wide metrics registry exposed in Prometheus text format
+ *
+ * Lookups take a shared lock and return references that stay valid for the
+ * lifetime of the process, so hot paths with fixed labels should resolve
+ * their metric once and keep the reference.
+ */
+class MetricsRegistry {
+public:
+    using Labels = std::initializer_list<std::pair<const char*, std::string>>;
+
+    static MetricsRegistry& getInstance();
+
+    Counter& counter(const std::string& name, const std::string& help, Labels labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, Labels labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help, Labels labels = {});
+
+    /**
+     * Render every registered metric in Prometheus text exposition format (0.0.4)
+     */
+    std::string renderPrometheus() const;
+
+    /**
+     * Format a label set as `key="value",...` with Prometheus escaping
+     */
+    static std::string formatLabels(Labels labels);
+
+private:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    template <typename T>
+    struct Family {
+        std::string help;
+        std::map<std::string, std::unique_ptr<T>> series; // labels -> metric
+    };
+
+    template <typename T>
+    T& getOrCreate(std::map<std::string, Family<T>>& families,
+                   const std::string& name, const std::string& help, Labels labels);
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, Family<Counter>> counters_;
+    std::map<std::string, Family<Gauge>> gauges_;
+    std::map<std::string, Family<Histogram>> histograms_;
+};
+
+/**
+ * Hit/miss counters of one cache, for hit-rate reporting
+ *
+ * Resolved once when the cache is built, so a lookup is a single increment.
+ */
+class CacheLookupMetrics {
+public:
+    /**
+     * @param cache Cache name (e.g. "user_profile"); empty records nothing
+     */
+    explicit CacheLookupMetrics(const std::string& cache);
+
+    void record(bool hit) {
+        if (hit_ != nullptr) {
+            (hit ? hit_ : miss_)->inc();
+        }
+    }
+
+private:
+    Counter* hit_ = nullptr;
+    Counter* miss_ = nullptr;
+};
+
+} // namespace utils
+} // namespace sohbet
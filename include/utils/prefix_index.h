@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * In-memory autocomplete index (radix trie with per-node top-K)
+ *
+ * Each entry is an id, its text (hashtag, username) and a popularity
+ * score. Text is matched case-insensitively (ASCII) by prefix. Every trie
+ * node stores the best K entries of its subtree, so a lookup walks the
+ * prefix and returns a precomputed list without visiting the subtree:
+ *
+ *   utils::PrefixIndex tags;
+ *   tags.upsert(7, "algorithms", 120);
+ *   tags.upsert(9, "algebra", 45);
+ *   tags.complete("alg", 5); // algorithms, algebra
+ *
+ * Updates refresh the top-K lists along a single root-to-leaf path.
+ * Reads share a lock; writes are exclusive.
+ */
+class PrefixIndex {
+public:
+    struct Match {
+        int id;
+        std::string text;
+        int64_t score;
+    };
+
+    /**
+     * @param top_k Results kept per node (upper bound for complete()'s limit)
+     */
+    explicit PrefixIndex(size_t top_k = 10);
+
+    PrefixIndex(const PrefixIndex&) = delete;
+    PrefixIndex& operator=(const PrefixIndex&) = delete;
+
+    /**
+     * Replace the whole index (startup load); computes every node's
+     * top-K once instead of once per insert
+     */
+    void rebuild(const std::vector<Match>& entries);
+
+    /**
+     * Insert an entry or replace its text and score
+     */
+    void upsert(int id, const std::string& text, int64_t score);
+
+    /**
+     * Adjust an entry's score
+     * @return false if the id is not indexed
+     */
+    bool addScore(int id, int64_t delta);
+
+    /**
+     * Remove an entry
+     * @return false if the id is not indexed
+     */
+    bool remove(int id);
+
+    /**
+     * Highest-scoring entries whose text starts with prefix (ties by text)
+     * @param limit Capped at top_k
+     */
+    std::vector<Match> complete(const std::string& prefix, size_t limit) const;
+
+    /**
+     * Number of indexed entries
+     */
+    size_t size() const;
+
+private:
+    struct Entry {
+        int id;
+        std::string text;
+        std::string key;    // Lowercased text
+        int64_t score;
+        bool live;
+    };
+
+    struct Node {
+        std::string label;               // Edge label from the parent
+        std::vector<uint32_t> children;  // Sorted by first label byte
+        int32_t entry = -1;              // Entry ending exactly here
+        std::vector<uint32_t> top;       // Best entries in this subtree
+    };
+
+    static std::string normalize(const std::string& text);
+    bool better(uint32_t a, uint32_t b) const;
+    int32_t findChild(uint32_t node, char c) const;
+    void addChild(uint32_t parent, uint32_t child);
+    std::vector<uint32_t> insertPath(const std::string& key);
+    std::vector<uint32_t> findPath(const std::string& key) const;
+    void refresh(const std::vector<uint32_t>& path);
+    void refreshSubtree(uint32_t node);
+    void detach(uint32_t entry_index);
+
+    size_t top_k_;
+    std::vector<Node> nodes_;
+    std::vector<Entry> entries_;
+    std::unordered_map<int, uint32_t> by_id_;
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "utils/lru_cache.h"
+#include "utils/metrics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Read-through cache for hot, widely shared rows (e.g. user profiles)
+ *
+ * Keys are spread over independent LruCache shards, each with its own lock,
+ * so concurrent handlers rarely contend. Capacity and TTL apply per shard
+ * (capacity is split evenly).
+ *
+ * getOrLoad() is single-flight: when many threads miss on the same key at
+ * once, one of them runs the loader and the rest wait for its result, so
+ * an expired popular entry costs one query rather than one per request.
+ * invalidate() during a load keeps that load's result out of the cache.
+ * Loads that find nothing (nullopt) are not cached.
+ *
+ * Lookups are reported through CacheLookupMetrics; waiters that joined
+ * another thread's load also count sohbet_cache_coalesced_loads_total.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ShardedCache {
+public:
+    using Loader = std::function<std::optional<V>(const K&)>;
+
+    /**
+     * @param capacity Maximum number of entries across all shards
+     * @param ttl Entry lifetime; zero means entries never expire
+     * @param metrics_name Cache label for hit/miss metrics; empty disables them
+     * @param shards Number of independently locked shards (at least 1)
+     */
+    ShardedCache(size_t capacity, std::chrono::milliseconds ttl, std::string metrics_name = "",
+                 size_t shards = 16)
+        : lookup_metrics_(metrics_name) {
+        if (!metrics_name.empty()) {
+            coalesced_loads_ = &MetricsRegistry::getInstance().counter(
+                "sohbet_cache_coalesced_loads_total", "Cache misses that waited for a load already running",
+                {{"cache", metrics_name}});
+        }
+        if (shards == 0) shards = 1;
+        size_t per_shard = (capacity + shards - 1) / shards;
+        for (size_t i = 0; i < shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>(per_shard, ttl));
+        }
+    }
+
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    /**
+     * Cached value, without loading on a miss
+     */
+    std::optional<V> get(const K& key) {
+        std::optional<V> value = shardFor(key).entries.get(key);
+        record(value.has_value());
+        return value;
+    }
+
+    /**
+     * Cached value, or the loader's result (cached if found)
+     * Exceptions from the loader reach every thread waiting on it.
+     */
+    std::optional<V> getOrLoad(const K& key, const Loader& load) {
+        Shard& shard = shardFor(key);
+        if (auto cached = shard.entries.get(key)) {
+            record(true);
+            return cached;
+        }
+
+        std::shared_ptr<Flight> flight;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.in_flight.find(key);
+            if (it != shard.in_flight.end()) {
+                flight = it->second;
+            } else {
+                // A load may have finished since the first check
+                if (auto cached = shard.entries.get(key)) {
+                    record(true);
+                    return cached;
+                }
+                flight = std::make_shared<Flight>();
+                flight->result = flight->promise.get_future().share();
+                shard.in_flight.emplace(key, flight);
+                leader = true;
+            }
+        }
+
+        record(false);
+        if (!leader) {
+            if (coalesced_loads_ != nullptr) {
+                coalesced_loads_->inc();
+            }
+            return flight->result.get();
+        }
+
+        std::optional<V> value;
+        try {
+            value = load(key);
+        } catch (...) {
+            finish(shard, key, flight, std::nullopt);
+            flight->promise.set_exception(std::current_exception());
+            throw;
+        }
+        finish(shard, key, flight, value);
+        flight->promise.set_value(value);
+        return value;
+    }
+
+    /**
+     * Insert or replace a value
+     */
+    void put(const K& key, V value) {
+        shardFor(key).entries.put(key, std::move(value));
+    }
+
+    /**
+     * Token for fill(), taken before reading values outside getOrLoad()
+     */
+    uint64_t stamp() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Cache a value read outside getOrLoad() (e.g. by a batch query) with
+     * the same guard a load gets: skipped if anything was invalidated since
+     * stamp was taken, or if a load of the key is running
+     */
+    void fill(const K& key, V value, uint64_t stamp) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (generation_.load(std::memory_order_acquire) != stamp) return;
+        if (shard.in_flight.count(key) != 0) return;
+        shard.entries.put(key, std::move(value));
+    }
+
+    /**
+     * Drop a key, including the result of a load running right now
+     */
+    void invalidate(const K& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+        shard.entries.erase(key);
+        auto it = shard.in_flight.find(key);
+        if (it != shard.in_flight.end()) {
+            it->second->invalidated = true;
+        }
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            generation_.fetch_add(1, std::memory_order_acq_rel);
+            shard->entries.clear();
+            for (auto& flight : shard->in_flight) {
+                flight.second->invalidated = true;
+            }
+        }
+    }
+
+    /**
+     * Number of entries, including expired ones not yet looked up
+     */
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : shards_) {
+            total += shard->entries.size();
+        }
+        return total;
+    }
+
+private:
+    struct Flight {
+        std::promise<std::optional<V>> promise;
+        std::shared_future<std::optional<V>> result;
+        bool invalidated = false;   // Guarded by the shard mutex
+    };
+
+    struct Shard {
+        Shard(size_t capacity, std::chrono::milliseconds ttl) : entries(capacity, ttl) {}
+
+        LruCache<K, V, Hash> entries;
+        std::mutex mutex;           // Guards in_flight
+        std::unordered_map<K, std::shared_ptr<Flight>, Hash> in_flight;
+    };
+
+    Shard& shardFor(const K& key) {
+        return *shards_[Hash{}(key) % shards_.size()];
+    }
+
+    void finish(Shard& shard, const K& key, const std::shared_ptr<Flight>& flight, const std::optional<V>& value) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (value.has_value() && !flight->invalidated) {
+            shard.entries.put(key, *value);
+        }
+        shard.in_flight.erase(key);
+    }
+
+    void record(bool hit) {
+        lookup_metrics_.record(hit);
+    }
+
+    CacheLookupMetrics lookup_metrics_;
+    Counter* coalesced_loads_ = nullptr;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<uint64_t> generation_{0};   // Bumped by every invalidation
+};
+
+} // namespace utils
+} // namespace sohbet
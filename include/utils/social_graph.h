@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * In-memory graph of accepted friendships
+ *
+ * Stored in compressed sparse row form: every user's friends are one sorted
+ * run of a single neighbors array, so a user's friend list is a contiguous
+ * slice, areFriends() is a hash lookup plus a binary search (O(log d)) and
+ * mutual friends are a merge of two sorted runs.
+ *
+ * Changes since the last compaction live in a small per-user delta (added
+ * and removed friends) that reads merge in. compact() folds the delta into
+ * new arrays; it runs periodically and whenever the delta grows past
+ * max_delta friendships.
+ *
+ *   utils::SocialGraph graph;
+ *   graph.rebuild(friendship_repository->findAcceptedPairs());
+ *   graph.addFriendship(3, 9);
+ *   graph.areFriends(9, 3);          // true
+ *   graph.suggest(3, 10);            // friends of friends by mutual count
+ *
+ * Reads share a lock; writes are exclusive.
+ */
+class SocialGraph {
+public:
+    struct Suggestion {
+        int user_id;
+        int mutual_count;
+    };
+
+    /**
+     * @param max_delta Pending changes that trigger a compaction on write
+     */
+    explicit SocialGraph(size_t max_delta = 4096);
+
+    SocialGraph(const SocialGraph&) = delete;
+    SocialGraph& operator=(const SocialGraph&) = delete;
+
+    /**
+     * Replace the whole graph (startup load); pairs are undirected and may
+     * repeat
+     */
+    void rebuild(const std::vector<std::pair<int, int>>& friendships);
+
+    void addFriendship(int user1_id, int user2_id);
+    void removeFriendship(int user1_id, int user2_id);
+
+    bool areFriends(int user1_id, int user2_id) const;
+
+    /**
+     * Friend ids, ascending
+     */
+    std::vector<int> friendsOf(int user_id) const;
+
+    size_t friendCount(int user_id) const;
+
+    int mutualFriendCount(int user1_id, int user2_id) const;
+
+    /**
+     * Friends of friends who are not friends yet, most mutual friends first
+     * (ties by id)
+     */
+    std::vector<Suggestion> suggest(int user_id, size_t limit) const;
+
+    /**
+     * suggest() for many users at once, spread over worker threads (batch
+     * jobs); threads = 0 uses the hardware concurrency
+     */
+    std::unordered_map<int, std::vector<Suggestion>> suggestAll(const std::vector<int>& user_ids, size_t limit,
+                                                                size_t threads = 0) const;
+
+    /**
+     * Fold pending changes into the compressed arrays
+     */
+    void compact();
+
+    size_t userCount() const;
+    size_t friendshipCount() const;
+    size_t pendingChanges() const;
+
+private:
+    // [begin, end) of a sorted friend list
+    using Range = std::pair<const int*, const int*>;
+
+    void rebuildLocked(std::vector<std::pair<int, int>> edges);
+    void compactLocked();
+    Range baseRow(int user_id) const;
+    bool inBase(int user1_id, int user2_id) const;
+    // Friend list with the delta applied; copies into scratch only if needed
+    Range row(int user_id, std::vector<int>& scratch) const;
+    std::vector<Suggestion> suggestLocked(int user_id, size_t limit) const;
+
+    size_t max_delta_;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<int, uint32_t> vertex_;  // User id -> row
+    std::vector<uint32_t> offsets_;             // Row i is neighbors_[offsets_[i], offsets_[i + 1])
+    std::vector<int> neighbors_;
+    size_t base_edges_ = 0;
+
+    // Changes since the last compaction, recorded for both endpoints
+    std::unordered_map<int, std::set<int>> added_;
+    std::unordered_map<int, std::set<int>> removed_;
+    size_t added_edges_ = 0;
+    size_t removed_edges_ = 0;
+};
+
+} // namespace utils
+} // namespace sohbet
@@ -1,67 +1,70 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <set>
 #include <vector>
-#include <regex>
 
 namespace sohbet {
 namespace utils {
 
+/**
+ * Hashtag, mention or URL found in post text
+ *
+ * Views point into the scanned text, which must outlive the token.
+ */
+struct TextToken {
+    enum class Kind { Hashtag, Mention, Url };
+
+    Kind kind;
+    std::string_view value;  // Tag or username without the sigil; the URL itself
+    size_t offset;           // Byte offset of the whole match (sigil included)
+    size_t length;           // Byte length of the whole match
+};
+
+/**
+ * Single-pass UTF-8 scanner for post text
+ *
+ * - Hashtags: '#' followed by letters, digits, '_' or combining marks in
+ *   any of the common scripts (so #Üniversite and #ağbilimi are whole tags)
+ * - Mentions: '@' followed by [A-Za-z0-9_], the username alphabet
+ * - URLs: http:// or https:// up to whitespace, quotes or angle brackets,
+ *   without trailing punctuation
+ *
+ * A '#' or '@' only starts a token at a word boundary, so "C#", e-mail
+ * addresses and URL fragments are not picked up. Invalid UTF-8 bytes are
+ * treated as separators.
+ */
 class TextParser {
 public:
-    // Extract hashtags from text (e.g., #study #programming)
-    static std::set<std::string> extractHashtags(const std::string& text) {
-        std::set<std::string> hashtags;
-        // Match hashtags: # followed by alphanumeric characters and underscores
-        std::regex hashtag_regex(R"(#([a-zA-Z0-9_]+))");
-        std::sregex_iterator iter(text.begin(), text.end(), hashtag_regex);
-        std::sregex_iterator end;
-
-        while (iter != end) {
-            std::string tag = (*iter)[1].str();
-            // Convert to lowercase for consistency
-            std::transform(tag.begin(), tag.end(), tag.begin(), ::tolower);
-            hashtags.insert(tag);
-            ++iter;
-        }
+    /**
+     * All hashtags, mentions and URLs in order of appearance
+     */
+    static std::vector<TextToken> tokenize(std::string_view text);
 
-        return hashtags;
-    }
+    // Extract hashtags from text (e.g., #study #programming), lowercased
+    static std::set<std::string> extractHashtags(const std::string& text);
 
     // Extract user mentions from text (e.g., @username)
-    static std::set<std::string> extractMentions(const std::string& text) {
-        std::set<std::string> mentions;
-        // Match mentions: @ followed by alphanumeric characters and underscores
-        std::regex mention_regex(R"(@([a-zA-Z0-9_]+))");
-        std::sregex_iterator iter(text.begin(), text.end(), mention_regex);
-        std::sregex_iterator end;
-
-        while (iter != end) {
-            std::string username = (*iter)[1].str();
-            mentions.insert(username);
-            ++iter;
-        }
-
-        return mentions;
-    }
-
-    // Make text clickable by wrapping hashtags and mentions in HTML
-    static std::string makeClickable(const std::string& text) {
-        std::string result = text;
+    static std::set<std::string> extractMentions(const std::string& text);
 
-        // Replace hashtags with links
-        std::regex hashtag_regex(R"(#([a-zA-Z0-9_]+))");
-        result = std::regex_replace(result, hashtag_regex,
-            "<a href=\"/hashtags/$1\" class=\"hashtag\">#$1</a>");
+    // Make text clickable by wrapping hashtags, mentions and URLs in HTML
+    static std::string makeClickable(const std::string& text);
 
-        // Replace mentions with links
-        std::regex mention_regex(R"(@([a-zA-Z0-9_]+))");
-        result = std::regex_replace(result, mention_regex,
-            "<a href=\"/users/$1\" class=\"mention\">@$1</a>");
+    /**
+     * Lowercase UTF-8 text using simple Unicode case mapping
+     * Covers Latin (including Turkish İ/Ğ/Ş), Greek and Cyrillic; İ maps
+     * to plain i. Other code points and invalid bytes are copied as is.
+     */
+    static std::string toLower(std::string_view text);
 
-        return result;
-    }
+private:
+    static uint32_t decode(std::string_view text, size_t pos, size_t& length);
+    static void encode(uint32_t code_point, std::string& out);
+    static bool isTagCodePoint(uint32_t code_point);
+    static uint32_t lowerCodePoint(uint32_t code_point);
 };
 
 } // namespace utils
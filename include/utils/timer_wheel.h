@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Hashed timer wheel for deferred and periodic server jobs
+ *
+ * Timers hash into one of `slots` buckets by expiry tick; each tick only
+ * visits the current bucket, so scheduling and cancelling are O(1) no
+ * matter how many timers are armed. Delays longer than one revolution
+ * carry a round counter.
+ *
+ *   utils::TimerWheel scheduler;
+ *   scheduler.scheduleEvery(std::chrono::seconds(1), [&] { flush(); });
+ *   auto id = scheduler.schedule(std::chrono::minutes(30), [&] { expire(channel); });
+ *   scheduler.cancel(id); // e.g. someone rejoined
+ *   scheduler.start();
+ *
+ * Callbacks run on the wheel's single thread, outside its lock (they may
+ * schedule or cancel timers). A slow callback delays later timers, so
+ * jobs should hand heavy work off or batch it.
+ */
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    /**
+     * @param tick Timer resolution; delays are rounded up to whole ticks
+     * @param slots Buckets per revolution (slots * tick = one revolution)
+     */
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::seconds(1), size_t slots = 512);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * Run a callback once after a delay
+     * @return Id usable with cancel()
+     */
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+
+    /**
+     * Run a callback every interval until cancelled
+     */
+    TimerId scheduleEvery(std::chrono::milliseconds interval, Callback callback);
+
+    /**
+     * Cancel a timer
+     * @return false if it already fired (one-shot) or was never armed
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * Number of armed timers
+     */
+    size_t pending() const;
+
+    /**
+     * Advance the wheel by one tick and run due callbacks
+     * Called by the wheel thread; tests drive it directly without start().
+     * @return Number of callbacks run
+     */
+    size_t tick();
+
+    /**
+     * Start the background thread ticking in real time
+     */
+    void start();
+
+    /**
+     * Stop the background thread (armed timers are kept, not run)
+     */
+    void stop();
+
+private:
+    struct Timer {
+        Callback callback;
+        uint64_t interval_ticks;  // 0 for one-shot timers
+        uint64_t rounds;          // Revolutions left before it is due
+    };
+
+    uint64_t toTicks(std::chrono::milliseconds delay) const;
+    TimerId arm(uint64_t ticks, uint64_t interval_ticks, Callback callback);
+    void place(TimerId id, Timer& timer, uint64_t ticks);
+    void run();
+
+    std::chrono::milliseconds tick_;
+    std::vector<std::vector<TimerId>> slots_;
+    size_t current_ = 0;
+    TimerId next_id_ = 1;
+    std::unordered_map<TimerId, Timer> timers_;
+    mutable std::mutex mutex_;
+
+    std::thread thread_;
+    std::mutex run_mutex_;
+    std::condition_variable run_cv_;
+    bool running_ = false;
+};
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+/**
+ * Streaming trending-hashtag tracker with exponentially decayed scores
+ *
+ * Every use of a tag adds 1 to its score, and scores decay as
+ * e^(-age / time_constant), so a window with a 1h time constant ranks tags
+ * by how much they were used in roughly the last hour. Several windows
+ * (e.g. 1h / 24h / 7d) are fed from the same events.
+ *
+ * Memory is bounded regardless of how many distinct tags appear: counts
+ * live in a count-min sketch (conservative update, never under-counts)
+ * and each scope keeps only its top_k candidates in a min-heap. A tag
+ * enters the heap once its sketch estimate beats the weakest candidate.
+ *
+ * Decay uses forward decay: an event at time t is stored with weight
+ * e^((t - landmark) / tau), which never changes afterwards, so decaying a
+ * score is a single multiply at read time. The landmark moves forward
+ * (rescaling every cell once) before the weights can overflow.
+ *
+ * Scopes partition the ranking (per university); record() always feeds
+ * the global scope "" as well.
+ */
+class TrendingTracker {
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Window {
+        std::string name;                   // e.g. "24h"
+        std::chrono::seconds time_constant; // Decay time constant (tau)
+    };
+
+    struct Entry {
+        std::string tag;
+        double score; // Decayed use count as of the query time
+    };
+
+    /**
+     * @param windows Decay windows, looked up by name in top()
+     * @param top_k Candidates kept per window and scope
+     * @param sketch_width Counters per sketch row (error ~ total / width)
+     * @param sketch_depth Sketch rows, at most 16 (failure probability ~ e^-depth)
+     */
+    explicit TrendingTracker(std::vector<Window> windows,
+                             size_t top_k = 100,
+                             size_t sketch_width = 4096,
+                             size_t sketch_depth = 4);
+
+    TrendingTracker(const TrendingTracker&) = delete;
+    TrendingTracker& operator=(const TrendingTracker&) = delete;
+
+    /**
+     * Record one use of a tag in the global scope and, if non-empty, scope
+     */
+    void record(const std::string& tag, const std::string& scope = "",
+                Clock::time_point at = Clock::now());
+
+    /**
+     * Whether a window with this name exists
+     */
+    bool hasWindow(const std::string& window) const;
+
+    /**
+     * Highest-scoring tags in a window and scope, best first
+     * Tags whose decayed score has fallen below min_score are left out.
+     */
+    std::vector<Entry> top(const std::string& window, const std::string& scope, size_t limit,
+                           Clock::time_point now = Clock::now(), double min_score = 0.01) const;
+
+private:
+    // Min-heap of candidates keyed by tag, with positions for in-place updates
+    struct Heap {
+        std::vector<std::pair<double, std::string>> items;
+        std::unordered_map<std::string, size_t> positions;
+    };
+
+    struct WindowState {
+        Window spec;
+        double tau;       // Seconds
+        double landmark;  // Seconds since epoch
+        std::vector<double> cells;
+        std::unordered_map<std::string, Heap> heaps; // By scope
+    };
+
+    double addToSketch(WindowState& window, const std::string& key, double weight);
+    void offer(Heap& heap, const std::string& tag, double estimate);
+    void rescale(WindowState& window, double now);
+    static void siftDown(Heap& heap, size_t index);
+    static void siftUp(Heap& heap, size_t index);
+    static void swapItems(Heap& heap, size_t a, size_t b);
+    static double seconds(Clock::time_point at);
+
+    size_t top_k_;
+    size_t width_;
+    size_t depth_;
+    std::vector<WindowState> windows_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,141 @@
+#ifndef VOICE_ROOM_REGISTRY_H
+#define VOICE_ROOM_REGISTRY_H
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace sohbet {
+
+/**
+ * @brief In-memory state of live voice rooms (channel_id -> participants)
+ *
+ * Rooms are spread over independently locked shards so signalling traffic
+ * in one room never waits on another. Each room's participant set is an
+ * immutable snapshot: writers publish a new set, readers take a shared_ptr
+ * under the shard lock and iterate it without holding any lock.
+ *
+ * A reverse user -> rooms index makes disconnect cleanup proportional to
+ * the rooms a user is in rather than to all rooms.
+ *
+ * Session ends caused by disconnects are queued here and written to
+ * voice_sessions in batches (see takePendingSessionEnds()).
+ */
+class VoiceRoomRegistry {
+public:
+    using Participants = std::set<int>;
+    using Snapshot = std::shared_ptr<const Participants>;
+
+    /**
+     * @brief Result of a membership change
+     */
+    struct Change {
+        bool changed = false;   // false if the user was already in / not in the room
+        Snapshot participants;  // Room members after the change (never null)
+    };
+
+    /**
+     * @brief A disconnect whose voice_sessions rows still need closing
+     */
+    struct SessionEnd {
+        int user_id;
+        std::time_t ended_at;
+    };
+
+    explicit VoiceRoomRegistry(size_t shard_count = 16);
+
+    VoiceRoomRegistry(const VoiceRoomRegistry&) = delete;
+    VoiceRoomRegistry& operator=(const VoiceRoomRegistry&) = delete;
+
+    /**
+     * @brief Add a user to a room
+     */
+    Change join(int channel_id, int user_id);
+
+    /**
+     * @brief Add users known from the database (e.g. open sessions at startup)
+     * @return Number of users that were not already in the room
+     */
+    size_t merge(int channel_id, const std::vector<int>& user_ids);
+
+    /**
+     * @brief Remove a user from a room; empty rooms are dropped
+     */
+    Change leave(int channel_id, int user_id);
+
+    /**
+     * @brief Remove a user from every room they are in and queue the
+     * matching voice_sessions update
+     * @return (channel_id, remaining participants) for each room left
+     */
+    std::vector<std::pair<int, Snapshot>> leaveAll(int user_id);
+
+    /**
+     * @brief Drop a room and its index entries (channel deleted)
+     */
+    void removeRoom(int channel_id);
+
+    /**
+     * @brief Current participants of a room (empty set if unknown)
+     */
+    Snapshot participants(int channel_id) const;
+
+    /**
+     * @brief Whether both users are in the room (signalling check)
+     */
+    bool containsBoth(int channel_id, int user_a, int user_b) const;
+
+    /**
+     * @brief Rooms a user is currently in
+     */
+    std::vector<int> roomsOf(int user_id) const;
+
+    /**
+     * @brief Number of non-empty rooms
+     */
+    size_t roomCount() const;
+
+    /**
+     * @brief Take all queued disconnects, clearing the queue
+     */
+    std::vector<SessionEnd> takePendingSessionEnds();
+
+    /**
+     * @brief Put back disconnects whose batched write failed
+     */
+    void requeueSessionEnds(const std::vector<SessionEnd>& ends);
+
+private:
+    struct RoomShard {
+        mutable std::mutex mutex;
+        std::unordered_map<int, Snapshot> rooms;
+    };
+
+    struct UserShard {
+        mutable std::mutex mutex;
+        std::unordered_map<int, std::unordered_set<int>> rooms_by_user;
+    };
+
+    RoomShard& roomShard(int channel_id) const;
+    UserShard& userShard(int user_id) const;
+
+    // Lock order: room shard, then user shard
+    std::unique_ptr<RoomShard[]> room_shards_;
+    std::unique_ptr<UserShard[]> user_shards_;
+    size_t shard_count_;
+
+    std::mutex pending_mutex_;
+    std::vector<SessionEnd> pending_session_ends_;
+
+    static const Snapshot empty_;
+};
+
+} // namespace sohbet
+
+#endif // VOICE_ROOM_REGISTRY_H
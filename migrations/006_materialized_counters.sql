@@ -0,0 +1,100 @@
+-- Migration: Materialized counters
+-- Date: November 20, 2025
+-- Description: Stores member, reaction, active voice user and unread
+--              notification counts on the owning row instead of running
+--              COUNT(*) on every read.
+--
+-- group_members, voice_sessions and notifications keep their counters in
+-- the same transaction via triggers. post_reactions has no trigger: the
+-- server coalesces reaction deltas in memory and applies them in batches
+-- (see PostRepository::flushReactionCounts). Drift from either path is
+-- corrected by the periodic repair job, which also backfills existing rows.
+
+-- =============================================================================
+-- 1. COUNTER COLUMNS
+-- =============================================================================
+
+ALTER TABLE groups ADD COLUMN IF NOT EXISTS member_count INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE posts ADD COLUMN IF NOT EXISTS reaction_count INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE voice_channels ADD COLUMN IF NOT EXISTS active_user_count INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE users ADD COLUMN IF NOT EXISTS unread_notification_count INTEGER NOT NULL DEFAULT 0;
+
+-- =============================================================================
+-- 2. GROUP MEMBER COUNT
+-- =============================================================================
+
+CREATE OR REPLACE FUNCTION group_member_count_trigger() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP = 'INSERT' THEN
+        UPDATE groups SET member_count = member_count + 1 WHERE id = NEW.group_id;
+    ELSIF TG_OP = 'DELETE' THEN
+        UPDATE groups SET member_count = member_count - 1 WHERE id = OLD.group_id;
+    END IF;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS group_member_count_update ON group_members;
+CREATE TRIGGER group_member_count_update
+    AFTER INSERT OR DELETE ON group_members
+    FOR EACH ROW
+    EXECUTE FUNCTION group_member_count_trigger();
+
+-- =============================================================================
+-- 3. ACTIVE VOICE USERS (open sessions: left_at IS NULL)
+-- =============================================================================
+
+CREATE OR REPLACE FUNCTION voice_active_user_count_trigger() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP IN ('UPDATE', 'DELETE') AND OLD.left_at IS NULL THEN
+        UPDATE voice_channels SET active_user_count = active_user_count - 1 WHERE id = OLD.channel_id;
+    END IF;
+    IF TG_OP IN ('INSERT', 'UPDATE') AND NEW.left_at IS NULL THEN
+        UPDATE voice_channels SET active_user_count = active_user_count + 1 WHERE id = NEW.channel_id;
+    END IF;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS voice_active_user_count_update ON voice_sessions;
+CREATE TRIGGER voice_active_user_count_update
+    AFTER INSERT OR UPDATE OF left_at, channel_id OR DELETE ON voice_sessions
+    FOR EACH ROW
+    EXECUTE FUNCTION voice_active_user_count_trigger();
+
+-- =============================================================================
+-- 4. UNREAD NOTIFICATIONS
+-- =============================================================================
+
+CREATE OR REPLACE FUNCTION unread_notification_count_trigger() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP IN ('UPDATE', 'DELETE') AND OLD.is_read IS NOT TRUE THEN
+        UPDATE users SET unread_notification_count = unread_notification_count - 1 WHERE id = OLD.user_id;
+    END IF;
+    IF TG_OP IN ('INSERT', 'UPDATE') AND NEW.is_read IS NOT TRUE THEN
+        UPDATE users SET unread_notification_count = unread_notification_count + 1 WHERE id = NEW.user_id;
+    END IF;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS unread_notification_count_update ON notifications;
+CREATE TRIGGER unread_notification_count_update
+    AFTER INSERT OR UPDATE OF is_read, user_id OR DELETE ON notifications
+    FOR EACH ROW
+    EXECUTE FUNCTION unread_notification_count_trigger();
+
+-- Counter updates on users must not recompute the search vector; limit that
+-- trigger (created in 004) to the columns it actually indexes
+DROP TRIGGER IF EXISTS users_search_update ON users;
+CREATE TRIGGER users_search_update
+    BEFORE INSERT OR UPDATE OF username, name, email ON users
+    FOR EACH ROW
+    EXECUTE FUNCTION users_search_trigger();
+
+-- Likewise reaction_count flushes on posts: only content feeds content_tsv
+DROP TRIGGER IF EXISTS posts_search_update ON posts;
+CREATE TRIGGER posts_search_update
+    BEFORE INSERT OR UPDATE OF content ON posts
+    FOR EACH ROW
+    EXECUTE FUNCTION posts_search_trigger();
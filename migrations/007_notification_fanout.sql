@@ -0,0 +1,35 @@
+-- Migration: Statement-level unread counter for notification inserts
+-- Date: November 27, 2025
+-- Description: Group announcements insert one notification per member in a
+--              single INSERT ... SELECT. The row-level trigger from 006 would
+--              run one UPDATE users per inserted row; inserts now update each
+--              recipient once per statement from the transition table.
+--              UPDATE and DELETE keep the row-level trigger.
+
+DROP TRIGGER IF EXISTS unread_notification_count_update ON notifications;
+CREATE TRIGGER unread_notification_count_update
+    AFTER UPDATE OF is_read, user_id OR DELETE ON notifications
+    FOR EACH ROW
+    EXECUTE FUNCTION unread_notification_count_trigger();
+
+CREATE OR REPLACE FUNCTION unread_notification_count_insert_trigger() RETURNS trigger AS $$
+BEGIN
+    UPDATE users u
+    SET unread_notification_count = u.unread_notification_count + added.count
+    FROM (
+        SELECT user_id, COUNT(*)::int AS count
+        FROM inserted_notifications
+        WHERE is_read IS NOT TRUE
+        GROUP BY user_id
+    ) added
+    WHERE u.id = added.user_id;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS unread_notification_count_insert ON notifications;
+CREATE TRIGGER unread_notification_count_insert
+    AFTER INSERT ON notifications
+    REFERENCING NEW TABLE AS inserted_notifications
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION unread_notification_count_insert_trigger();
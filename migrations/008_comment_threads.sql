@@ -0,0 +1,17 @@
+-- Migration: Indexes for threaded comment loading
+-- Date: December 4, 2025
+-- Description: CommentRepository::findThreads pages a post's top-level
+--              comments by (created_at, id) and loads each comment's first
+--              replies in the same order, in one recursive query. Both steps
+--              read these indexes in order instead of sorting every thread.
+--              The replies index also covers parent_id lookups (reply
+--              counts, cascading deletes), so it replaces idx_comments_parent.
+
+CREATE INDEX IF NOT EXISTS idx_comments_post_threads
+    ON comments (post_id, created_at, id)
+    WHERE parent_id IS NULL;
+
+CREATE INDEX IF NOT EXISTS idx_comments_parent_created
+    ON comments (parent_id, created_at, id);
+
+DROP INDEX IF EXISTS idx_comments_parent;
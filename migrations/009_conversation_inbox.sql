@@ -0,0 +1,186 @@
+-- Migration: Per-user conversation inbox
+-- Date: December 8, 2025
+-- Description: One row per (user, conversation) holding what the inbox
+--              shows: the other participant, a preview of the last message
+--              and the user's unread count. The inbox page is then a single
+--              index range scan on (user_id, last_message_at) instead of an
+--              OR over both participant columns plus a message and unread
+--              query per conversation.
+--
+-- Rows are kept current by triggers in the writing transaction: creating a
+-- conversation adds both participants' rows, and message inserts, read_at
+-- updates and deletes adjust previews and unread counts once per statement
+-- (group-committed chat batches and mark-all-read are single statements).
+-- Drift is corrected by the periodic repair job, which also fills in
+-- previews and unread counts for the rows backfilled below.
+
+-- =============================================================================
+-- 1. INBOX TABLE
+-- =============================================================================
+
+CREATE TABLE IF NOT EXISTS conversation_inbox (
+    user_id BIGINT NOT NULL,
+    conversation_id BIGINT NOT NULL,
+    other_user_id BIGINT NOT NULL,
+    last_message_id BIGINT,
+    last_message_sender_id BIGINT,
+    last_message_preview TEXT,
+    last_message_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    unread_count INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY (user_id, conversation_id),
+    FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE,
+    FOREIGN KEY (other_user_id) REFERENCES users(id) ON DELETE CASCADE,
+    FOREIGN KEY (conversation_id) REFERENCES conversations(id) ON DELETE CASCADE
+);
+
+CREATE INDEX IF NOT EXISTS idx_conversation_inbox_recent
+    ON conversation_inbox (user_id, last_message_at DESC, conversation_id DESC);
+
+-- Latest message and unread messages of a conversation (triggers, repair)
+CREATE INDEX IF NOT EXISTS idx_messages_conversation_latest
+    ON messages (conversation_id, id DESC);
+CREATE INDEX IF NOT EXISTS idx_messages_conversation_unread
+    ON messages (conversation_id, sender_id)
+    WHERE read_at IS NULL;
+
+INSERT INTO conversation_inbox (user_id, conversation_id, other_user_id, last_message_at)
+SELECT user1_id, id, user2_id, COALESCE(last_message_at, created_at, CURRENT_TIMESTAMP) FROM conversations
+UNION ALL
+SELECT user2_id, id, user1_id, COALESCE(last_message_at, created_at, CURRENT_TIMESTAMP) FROM conversations
+ON CONFLICT (user_id, conversation_id) DO NOTHING;
+
+-- =============================================================================
+-- 2. NEW CONVERSATIONS
+-- =============================================================================
+
+CREATE OR REPLACE FUNCTION conversation_inbox_create_trigger() RETURNS trigger AS $$
+BEGIN
+    INSERT INTO conversation_inbox (user_id, conversation_id, other_user_id, last_message_at)
+    VALUES (NEW.user1_id, NEW.id, NEW.user2_id, COALESCE(NEW.last_message_at, CURRENT_TIMESTAMP)),
+           (NEW.user2_id, NEW.id, NEW.user1_id, COALESCE(NEW.last_message_at, CURRENT_TIMESTAMP))
+    ON CONFLICT (user_id, conversation_id) DO NOTHING;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS conversation_inbox_create ON conversations;
+CREATE TRIGGER conversation_inbox_create
+    AFTER INSERT ON conversations
+    FOR EACH ROW
+    EXECUTE FUNCTION conversation_inbox_create_trigger();
+
+-- =============================================================================
+-- 3. SENT MESSAGES: preview for both participants, unread for the recipient
+-- =============================================================================
+
+CREATE OR REPLACE FUNCTION conversation_inbox_message_insert_trigger() RETURNS trigger AS $$
+BEGIN
+    UPDATE conversation_inbox i
+    SET last_message_id = latest.id,
+        last_message_sender_id = latest.sender_id,
+        last_message_preview = LEFT(latest.content, 140),
+        last_message_at = latest.created_at
+    FROM (
+        SELECT DISTINCT ON (conversation_id) conversation_id, id, sender_id, content, created_at
+        FROM inserted_messages
+        ORDER BY conversation_id, id DESC
+    ) latest
+    WHERE i.conversation_id = latest.conversation_id
+      AND (i.last_message_id IS NULL OR i.last_message_id < latest.id);
+
+    UPDATE conversation_inbox i
+    SET unread_count = i.unread_count + added.count
+    FROM (
+        SELECT conversation_id, sender_id, COUNT(*)::int AS count
+        FROM inserted_messages
+        WHERE read_at IS NULL
+        GROUP BY conversation_id, sender_id
+    ) added
+    WHERE i.conversation_id = added.conversation_id
+      AND i.user_id <> added.sender_id;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS conversation_inbox_message_insert ON messages;
+CREATE TRIGGER conversation_inbox_message_insert
+    AFTER INSERT ON messages
+    REFERENCING NEW TABLE AS inserted_messages
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION conversation_inbox_message_insert_trigger();
+
+-- =============================================================================
+-- 4. READ MESSAGES
+-- =============================================================================
+
+-- Transition tables rule out an UPDATE OF column list; updates that leave
+-- read_at alone contribute nothing to the join
+CREATE OR REPLACE FUNCTION conversation_inbox_message_read_trigger() RETURNS trigger AS $$
+BEGIN
+    UPDATE conversation_inbox i
+    SET unread_count = GREATEST(i.unread_count + changed.delta, 0)
+    FROM (
+        SELECT n.conversation_id, n.sender_id,
+               SUM(CASE WHEN o.read_at IS NULL AND n.read_at IS NOT NULL THEN -1
+                        WHEN o.read_at IS NOT NULL AND n.read_at IS NULL THEN 1
+                        ELSE 0 END)::int AS delta
+        FROM old_messages o
+        JOIN new_messages n ON n.id = o.id
+        WHERE (o.read_at IS NULL) <> (n.read_at IS NULL)
+        GROUP BY n.conversation_id, n.sender_id
+    ) changed
+    WHERE i.conversation_id = changed.conversation_id
+      AND i.user_id <> changed.sender_id;
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS conversation_inbox_message_read ON messages;
+CREATE TRIGGER conversation_inbox_message_read
+    AFTER UPDATE ON messages
+    REFERENCING OLD TABLE AS old_messages NEW TABLE AS new_messages
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION conversation_inbox_message_read_trigger();
+
+-- =============================================================================
+-- 5. DELETED MESSAGES: unread counts, and the preview if it was the last one
+-- =============================================================================
+
+CREATE OR REPLACE FUNCTION conversation_inbox_message_delete_trigger() RETURNS trigger AS $$
+BEGIN
+    UPDATE conversation_inbox i
+    SET unread_count = GREATEST(i.unread_count - removed.count, 0)
+    FROM (
+        SELECT conversation_id, sender_id, COUNT(*)::int AS count
+        FROM deleted_messages
+        WHERE read_at IS NULL
+        GROUP BY conversation_id, sender_id
+    ) removed
+    WHERE i.conversation_id = removed.conversation_id
+      AND i.user_id <> removed.sender_id;
+
+    UPDATE conversation_inbox i
+    SET last_message_id = latest.id,
+        last_message_sender_id = latest.sender_id,
+        last_message_preview = LEFT(latest.content, 140)
+    FROM conversation_inbox target
+    LEFT JOIN LATERAL (
+        SELECT m.id, m.sender_id, m.content
+        FROM messages m
+        WHERE m.conversation_id = target.conversation_id
+        ORDER BY m.id DESC
+        LIMIT 1
+    ) latest ON true
+    WHERE i.user_id = target.user_id
+      AND i.conversation_id = target.conversation_id
+      AND target.last_message_id IN (SELECT id FROM deleted_messages);
+    RETURN NULL;
+END
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS conversation_inbox_message_delete ON messages;
+CREATE TRIGGER conversation_inbox_message_delete
+    AFTER DELETE ON messages
+    REFERENCING OLD TABLE AS deleted_messages
+    FOR EACH STATEMENT
+    EXECUTE FUNCTION conversation_inbox_message_delete_trigger();
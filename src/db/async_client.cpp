@@ -0,0 +1,622 @@
+#include "db/async_client.h"
+#include "db/database.h"
+#include "utils/logger.h"
+#include "utils/metrics.h"
+#include <libpq-fe.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+
+namespace sohbet {
+namespace db {
+
+// A broken connection is reopened at most this often
+static const std::chrono::seconds RECONNECT_INTERVAL(1);
+// A connection handshake that takes longer than this is abandoned
+static const std::chrono::seconds CONNECT_TIMEOUT(10);
+
+// Milliseconds until when, for a poll() timeout (at least 0)
+static int millisecondsUntil(std::chrono::steady_clock::time_point when) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        when - std::chrono::steady_clock::now()).count();
+    return remaining > 0 ? static_cast<int>(remaining) + 1 : 0;
+}
+
+struct AsyncClient::Batch {
+    std::vector<AsyncQuery> queries;
+    std::vector<QueryResult> results;
+    Callback done;
+    std::chrono::steady_clock::time_point submitted;
+};
+
+static utils::Histogram& batchHistogram() {
+    static utils::Histogram& histogram = utils::MetricsRegistry::getInstance().histogram(
+        "sohbet_db_async_batch_duration_seconds", "Time from submit to results for pipelined query batches");
+    return histogram;
+}
+
+static utils::Counter& queryCounter(const char* outcome) {
+    return utils::MetricsRegistry::getInstance().counter(
+        "sohbet_db_async_queries_total", "Pipelined queries by outcome", {{"outcome", outcome}});
+}
+
+// libpq messages end in a newline
+static std::string errorText(const char* message) {
+    std::string text = message ? message : "";
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.pop_back();
+    }
+    return text.empty() ? "Unknown database error" : text;
+}
+
+// ===================
+// AsyncQuery class
+// ===================
+
+AsyncQuery::AsyncQuery(const std::string& sql)
+    : sql_(toPostgresPlaceholders(sql)) {
+}
+
+AsyncQuery& AsyncQuery::bindInt(int value) {
+    params_.emplace_back(std::to_string(value));
+    return *this;
+}
+
+AsyncQuery& AsyncQuery::bindInt64(long long value) {
+    params_.emplace_back(std::to_string(value));
+    return *this;
+}
+
+AsyncQuery& AsyncQuery::bindDouble(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    params_.emplace_back(buffer);
+    return *this;
+}
+
+AsyncQuery& AsyncQuery::bindText(const std::string& value) {
+    params_.emplace_back(value);
+    return *this;
+}
+
+AsyncQuery& AsyncQuery::bindNull() {
+    params_.emplace_back(std::nullopt);
+    return *this;
+}
+
+AsyncQuery& AsyncQuery::bindIntArray(const std::vector<int>& values) {
+    std::string literal = "{";
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) literal += ',';
+        literal += std::to_string(values[i]);
+    }
+    literal += '}';
+    return bindText(literal);
+}
+
+// ===================
+// QueryResult class
+// ===================
+
+size_t QueryResult::rowCount() const {
+    return result_ ? static_cast<size_t>(PQntuples(result_.get())) : 0;
+}
+
+size_t QueryResult::columnCount() const {
+    return result_ ? static_cast<size_t>(PQnfields(result_.get())) : 0;
+}
+
+size_t QueryResult::affectedRows() const {
+    if (!result_) return 0;
+    const char* count = PQcmdTuples(result_.get());
+    return count && *count ? static_cast<size_t>(std::strtoull(count, nullptr, 10)) : 0;
+}
+
+bool QueryResult::isNull(size_t row, int column) const {
+    if (row >= rowCount() || column < 0 || static_cast<size_t>(column) >= columnCount()) {
+        return true;
+    }
+    return PQgetisnull(result_.get(), static_cast<int>(row), column) == 1;
+}
+
+int QueryResult::getInt(size_t row, int column) const {
+    if (isNull(row, column)) return 0;
+    return std::atoi(PQgetvalue(result_.get(), static_cast<int>(row), column));
+}
+
+long long QueryResult::getInt64(size_t row, int column) const {
+    if (isNull(row, column)) return 0;
+    return std::strtoll(PQgetvalue(result_.get(), static_cast<int>(row), column), nullptr, 10);
+}
+
+double QueryResult::getDouble(size_t row, int column) const {
+    if (isNull(row, column)) return 0.0;
+    return std::strtod(PQgetvalue(result_.get(), static_cast<int>(row), column), nullptr);
+}
+
+std::string QueryResult::getText(size_t row, int column) const {
+    if (isNull(row, column)) return "";
+    return std::string(PQgetvalue(result_.get(), static_cast<int>(row), column),
+                       PQgetlength(result_.get(), static_cast<int>(row), column));
+}
+
+// ===================
+// AsyncClient class
+// ===================
+
+AsyncClient::AsyncClient(const std::string& connection_string, size_t connections, size_t max_depth)
+    : connection_string_(connection_string),
+      max_depth_(std::max<size_t>(1, max_depth)),
+      connections_(std::max<size_t>(1, connections)) {
+}
+
+AsyncClient::~AsyncClient() {
+    stop();
+}
+
+void AsyncClient::startConnect(Connection& connection) {
+    connection.conn = PQconnectStart(connection_string_.c_str());
+    if (connection.conn == nullptr || PQstatus(connection.conn) == CONNECTION_BAD) {
+        connectFailed(connection, connection.conn ? errorText(PQerrorMessage(connection.conn)) : "Out of memory");
+        return;
+    }
+    // Per libpq, the first PQconnectPoll() waits for the socket to be writable
+    connection.connecting = true;
+    connection.connect_events = POLLOUT;
+    connection.connect_deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+}
+
+void AsyncClient::continueConnect(Connection& connection) {
+    switch (PQconnectPoll(connection.conn)) {
+        case PGRES_POLLING_READING:
+            connection.connect_events = POLLIN;
+            return;
+        case PGRES_POLLING_WRITING:
+            connection.connect_events = POLLOUT;
+            return;
+        case PGRES_POLLING_OK:
+            if (PQsetnonblocking(connection.conn, 1) == 0 && PQenterPipelineMode(connection.conn) == 1) {
+                connection.connecting = false;
+                connection.connect_events = 0;
+                if (running_) {
+                    LOG_INFO("Async database connection restored");
+                }
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    connectFailed(connection, errorText(PQerrorMessage(connection.conn)));
+}
+
+void AsyncClient::connectFailed(Connection& connection, const std::string& error) {
+    LOG_WARN("Async database connection failed: " + error);
+    if (connection.conn) {
+        PQfinish(connection.conn);
+        connection.conn = nullptr;
+    }
+    connection.connecting = false;
+    connection.connect_events = 0;
+    connection.retry_at = std::chrono::steady_clock::now() + RECONNECT_INTERVAL;
+}
+
+bool AsyncClient::start() {
+    if (running_) {
+        return true;
+    }
+    if (pipe(wake_fds_) != 0) {
+        std::cerr << "Failed to create async database wake pipe" << std::endl;
+        return false;
+    }
+    for (int fd : wake_fds_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    // The first handshakes are waited for here, so start() can report
+    // whether the database is reachable at all
+    for (auto& connection : connections_) {
+        startConnect(connection);
+    }
+    auto deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+    std::vector<pollfd> fds;
+    std::vector<Connection*> waiting;
+    while (true) {
+        fds.clear();
+        waiting.clear();
+        for (auto& connection : connections_) {
+            if (connection.connecting) {
+                fds.push_back(pollfd{PQsocket(connection.conn), connection.connect_events, 0});
+                waiting.push_back(&connection);
+            }
+        }
+        if (waiting.empty()) {
+            break;
+        }
+        int ready = poll(fds.data(), fds.size(), millisecondsUntil(deadline));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            for (Connection* connection : waiting) {
+                connectFailed(*connection, ready == 0 ? "Connection timed out" : "poll() failed");
+            }
+            break;
+        }
+        for (size_t i = 0; i < waiting.size(); ++i) {
+            if (fds[i].revents != 0) {
+                continueConnect(*waiting[i]);
+            }
+        }
+    }
+
+    size_t opened = 0;
+    for (const auto& connection : connections_) {
+        if (connection.conn) {
+            ++opened;
+        }
+    }
+    if (opened == 0) {
+        close(wake_fds_[0]);
+        close(wake_fds_[1]);
+        wake_fds_[0] = wake_fds_[1] = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&AsyncClient::run, this);
+    return true;
+}
+
+void AsyncClient::stop() {
+    {
+        // Under mutex_ so that submit() never queues after the final drain
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    std::deque<std::shared_ptr<Batch>> leftover;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        leftover.swap(queue_);
+    }
+    for (const auto& batch : leftover) {
+        fail(batch, "Async database client stopped");
+    }
+
+    close(wake_fds_[0]);
+    close(wake_fds_[1]);
+    wake_fds_[0] = wake_fds_[1] = -1;
+}
+
+void AsyncClient::submit(std::vector<AsyncQuery> queries, Callback done) {
+    auto batch = std::make_shared<Batch>();
+    batch->results.resize(queries.size());
+    batch->queries = std::move(queries);
+    batch->done = std::move(done);
+    batch->submitted = std::chrono::steady_clock::now();
+
+    if (batch->queries.empty()) {
+        complete(batch);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            queue_.push_back(batch);
+            batch = nullptr;
+        }
+    }
+    if (batch) {
+        fail(batch, "Async database client is not running");
+        return;
+    }
+    wake();
+}
+
+std::future<std::vector<QueryResult>> AsyncClient::execute(std::vector<AsyncQuery> batch) {
+    auto promise = std::make_shared<std::promise<std::vector<QueryResult>>>();
+    auto future = promise->get_future();
+    submit(std::move(batch), [promise](std::vector<QueryResult> results) {
+        promise->set_value(std::move(results));
+    });
+    return future;
+}
+
+std::future<QueryResult> AsyncClient::query(AsyncQuery query) {
+    auto promise = std::make_shared<std::promise<QueryResult>>();
+    auto future = promise->get_future();
+    std::vector<AsyncQuery> batch;
+    batch.push_back(std::move(query));
+    submit(std::move(batch), [promise](std::vector<QueryResult> results) {
+        promise->set_value(results.empty() ? QueryResult() : std::move(results.front()));
+    });
+    return future;
+}
+
+size_t AsyncClient::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + in_flight_;
+}
+
+void AsyncClient::wake() {
+    if (wake_fds_[1] < 0) {
+        return;
+    }
+    char byte = 1;
+    ssize_t written = write(wake_fds_[1], &byte, 1);
+    (void)written;  // A full pipe already guarantees a wakeup
+}
+
+void AsyncClient::complete(const std::shared_ptr<Batch>& batch) {
+    batchHistogram().observe(std::chrono::steady_clock::now() - batch->submitted);
+    size_t failed = 0;
+    for (const auto& result : batch->results) {
+        if (!result.ok()) ++failed;
+    }
+    if (failed > 0) {
+        queryCounter("error").inc(failed);
+    }
+    if (batch->results.size() > failed) {
+        queryCounter("ok").inc(batch->results.size() - failed);
+    }
+
+    if (!batch->done) {
+        return;
+    }
+    try {
+        batch->done(std::move(batch->results));
+    } catch (const std::exception& e) {
+        std::cerr << "Async query callback threw: " << e.what() << std::endl;
+    }
+}
+
+void AsyncClient::fail(const std::shared_ptr<Batch>& batch, const std::string& error) {
+    for (auto& result : batch->results) {
+        result.result_.reset();
+        result.error_ = error;
+    }
+    complete(batch);
+}
+
+void AsyncClient::reset(Connection& connection, const std::string& error) {
+    LOG_WARN("Async database connection lost: " + error);
+    std::deque<std::shared_ptr<Batch>> lost;
+    lost.swap(connection.in_flight);
+    in_flight_ -= lost.size();
+    connection.queued_queries = 0;
+    connection.result_index = 0;
+    connection.has_result = false;
+    connection.want_write = false;
+    if (connection.conn) {
+        PQfinish(connection.conn);
+        connection.conn = nullptr;
+    }
+    connection.retry_at = std::chrono::steady_clock::now() + RECONNECT_INTERVAL;
+
+    // A batch that was sent may or may not have committed
+    for (const auto& batch : lost) {
+        fail(batch, "Connection lost: " + error);
+    }
+}
+
+void AsyncClient::dispatch() {
+    while (true) {
+        std::shared_ptr<Batch> batch;
+        Connection* target = nullptr;
+        std::deque<std::shared_ptr<Batch>> unavailable;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) {
+                return;
+            }
+            bool any_open = false;
+            for (auto& connection : connections_) {
+                if (!connection.conn) continue;
+                any_open = true;   // A handshake under way may still succeed
+                if (connection.connecting) continue;
+                if (connection.queued_queries < max_depth_ &&
+                    (!target || connection.queued_queries < target->queued_queries)) {
+                    target = &connection;
+                }
+            }
+            if (!any_open) {
+                unavailable.swap(queue_);
+            } else if (target) {
+                batch = queue_.front();
+                queue_.pop_front();
+            }
+        }
+
+        // Fail fast while the database is unreachable rather than piling up
+        for (const auto& failed : unavailable) {
+            fail(failed, "Database unavailable");
+        }
+        if (!batch) {
+            return;  // Every connection is at max_depth or connecting; wait
+        }
+        if (!send(*target, batch)) {
+            reset(*target, errorText(PQerrorMessage(target->conn)));
+        }
+    }
+}
+
+bool AsyncClient::send(Connection& connection, const std::shared_ptr<Batch>& batch) {
+    connection.in_flight.push_back(batch);
+    connection.queued_queries += batch->queries.size();
+    ++in_flight_;
+
+    std::vector<const char*> values;
+    for (const auto& query : batch->queries) {
+        values.clear();
+        for (const auto& param : query.params()) {
+            values.push_back(param.has_value() ? param->c_str() : nullptr);
+        }
+        if (!PQsendQueryParams(connection.conn, query.sql().c_str(), static_cast<int>(values.size()),
+                               nullptr, values.data(), nullptr, nullptr, 0)) {
+            return false;
+        }
+    }
+    // The sync ends the batch's implicit transaction
+    if (!PQpipelineSync(connection.conn)) {
+        return false;
+    }
+
+    int flushed = PQflush(connection.conn);
+    if (flushed < 0) {
+        return false;
+    }
+    connection.want_write = flushed == 1;
+    return true;
+}
+
+bool AsyncClient::readResults(Connection& connection) {
+    // In pipeline mode each query yields its result then a null, and each
+    // sync yields PGRES_PIPELINE_SYNC
+    while (!connection.in_flight.empty() && !PQisBusy(connection.conn)) {
+        PGresult* raw = PQgetResult(connection.conn);
+        const std::shared_ptr<Batch>& batch = connection.in_flight.front();
+
+        if (raw == nullptr) {
+            if (!connection.has_result) {
+                break;
+            }
+            connection.has_result = false;
+            ++connection.result_index;
+            continue;
+        }
+
+        ExecStatusType status = PQresultStatus(raw);
+        if (status == PGRES_PIPELINE_SYNC) {
+            PQclear(raw);
+            std::shared_ptr<Batch> finished = batch;
+            connection.in_flight.pop_front();
+            connection.queued_queries -= finished->queries.size();
+            connection.result_index = 0;
+            connection.has_result = false;
+            --in_flight_;
+            complete(finished);
+            continue;
+        }
+
+        if (connection.result_index < batch->results.size()) {
+            QueryResult& result = batch->results[connection.result_index];
+            result.result_.reset(raw, PQclear);
+            if (status == PGRES_PIPELINE_ABORTED) {
+                result.error_ = "Not run: an earlier query in the batch failed";
+            } else if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
+                result.error_ = errorText(PQresultErrorMessage(raw));
+            }
+        } else {
+            PQclear(raw);
+        }
+        connection.has_result = true;
+    }
+    return PQstatus(connection.conn) == CONNECTION_OK;
+}
+
+void AsyncClient::run() {
+    std::vector<pollfd> fds;
+    while (running_) {
+        dispatch();
+
+        int timeout = -1;
+        auto waitUntil = [&timeout](std::chrono::steady_clock::time_point when) {
+            int ms = millisecondsUntil(when);
+            timeout = timeout < 0 ? ms : std::min(timeout, ms);
+        };
+        fds.clear();
+        fds.push_back(pollfd{wake_fds_[0], POLLIN, 0});
+        for (auto& connection : connections_) {
+            if (!connection.conn && std::chrono::steady_clock::now() >= connection.retry_at) {
+                startConnect(connection);
+            }
+            pollfd entry{-1, 0, 0};  // Negative fds are ignored by poll()
+            if (connection.connecting) {
+                entry.fd = PQsocket(connection.conn);
+                entry.events = connection.connect_events;
+                waitUntil(connection.connect_deadline);
+            } else if (connection.conn) {
+                entry.fd = PQsocket(connection.conn);
+                entry.events = POLLIN | (connection.want_write ? POLLOUT : 0);
+            } else {
+                waitUntil(connection.retry_at);
+            }
+            fds.push_back(entry);
+        }
+
+        if (poll(fds.data(), fds.size(), timeout) < 0) {
+            if (errno != EINTR) {
+                std::cerr << "Async database poll failed" << std::endl;
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wake_fds_[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+
+        for (size_t i = 0; i < connections_.size(); ++i) {
+            Connection& connection = connections_[i];
+            short revents = fds[i + 1].revents;
+
+            if (connection.connecting) {
+                if (revents != 0) {
+                    continueConnect(connection);
+                } else if (std::chrono::steady_clock::now() >= connection.connect_deadline) {
+                    connectFailed(connection, "Connection timed out");
+                }
+                continue;
+            }
+            if (!connection.conn) {
+                continue;   // Reconnected at the top of the next pass
+            }
+            if (revents & POLLOUT) {
+                int flushed = PQflush(connection.conn);
+                if (flushed < 0) {
+                    reset(connection, errorText(PQerrorMessage(connection.conn)));
+                    continue;
+                }
+                connection.want_write = flushed == 1;
+            }
+            if (revents & (POLLIN | POLLERR | POLLHUP)) {
+                if (!PQconsumeInput(connection.conn) || !readResults(connection)) {
+                    reset(connection, errorText(PQerrorMessage(connection.conn)));
+                }
+            }
+        }
+    }
+
+    for (auto& connection : connections_) {
+        std::deque<std::shared_ptr<Batch>> lost;
+        lost.swap(connection.in_flight);
+        in_flight_ -= lost.size();
+        connection.queued_queries = 0;
+        connection.connecting = false;
+        if (connection.conn) {
+            PQfinish(connection.conn);
+            connection.conn = nullptr;
+        }
+        for (const auto& batch : lost) {
+            fail(batch, "Async database client stopped");
+        }
+    }
+}
+
+} // namespace db
+} // namespace sohbet
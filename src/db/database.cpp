@@ -1,12 +1,169 @@
 #include "db/database.h"
+#include "utils/metrics.h"
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <unordered_map>
 
 namespace sohbet {
 namespace db {
 
-Database::Database(const std::string& connection_string)
+// Collapse whitespace so the same parameterized query always maps to one label
+static std::string fingerprintQuery(const std::string& sql) {
+    const size_t MAX_FINGERPRINT_LENGTH = 160;
+    std::string fingerprint;
+    fingerprint.reserve(std::min(sql.size(), MAX_FINGERPRINT_LENGTH));
+    bool pending_space = false;
+    for (char c : sql) {
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            pending_space = !fingerprint.empty();
+            continue;
+        }
+        if (pending_space) {
+            fingerprint += ' ';
+            pending_space = false;
+        }
+        fingerprint += c;
+        if (fingerprint.size() >= MAX_FINGERPRINT_LENGTH) break;
+    }
+    return fingerprint;
+}
+
+// Metric series of one SQL text, resolved on first use
+struct StatementMetrics {
+    std::string fingerprint;
+    utils::Histogram* duration = nullptr;
+    utils::Counter* errors = nullptr;   // Only registered once the query fails
+};
+
+// This thread's series by SQL text, so a statement fingerprints its SQL and
+// consults the (locked) registry only the first time a thread runs it.
+// SQL assembled at runtime can mint new texts, so the table starts over
+// once it reaches MAX_CACHED_STATEMENTS.
+static StatementMetrics& statementMetrics(const std::string& sql) {
+    const size_t MAX_CACHED_STATEMENTS = 1024;
+    thread_local std::unordered_map<std::string, StatementMetrics> resolved;
+
+    auto it = resolved.find(sql);
+    if (it != resolved.end()) return it->second;
+    if (resolved.size() >= MAX_CACHED_STATEMENTS) resolved.clear();
+
+    StatementMetrics& entry = resolved[sql];
+    entry.fingerprint = fingerprintQuery(sql);
+    entry.duration = &utils::MetricsRegistry::getInstance().histogram(
+        "sohbet_db_query_duration_seconds", "Statement execution time by query fingerprint",
+        {{"query", entry.fingerprint}});
+    return entry;
+}
+
+// Standalone statements by where they ran, resolved once
+static utils::Counter& routedStatements(bool on_replica) {
+    static utils::Counter& primary = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_db_routed_statements_total", "Standalone statements by the connection they ran on",
+        {{"target", "primary"}});
+    static utils::Counter& replica = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_db_routed_statements_total", "Standalone statements by the connection they ran on",
+        {{"target", "replica"}});
+    return on_replica ? replica : primary;
+}
+
+std::string toPostgresPlaceholders(const std::string& sql) {
+    std::string pg_sql;
+    pg_sql.reserve(sql.size() + 16);
+    int param_num = 1;
+    for (char c : sql) {
+        if (c == '?') {
+            pg_sql += '$';
+            pg_sql += std::to_string(param_num++);
+        } else {
+            pg_sql += c;
+        }
+    }
+    return pg_sql;
+}
+
+// ===================
+// Read routing
+// ===================
+
+struct Database::Replica {
+    size_t index = 0;
+    std::string connection_string;
+    std::unique_ptr<pqxx::connection> conn;
+    std::recursive_mutex mutex;   // One transaction at a time, as Database::mutex_
+    std::atomic<bool> healthy{false};
+    std::atomic<long long> lag_ms{-1};
+};
+
+static thread_local int session_user = 0;
+
+SessionScope::SessionScope(int user_id) : previous_(session_user) {
+    session_user = user_id > 0 ? user_id : 0;
+}
+
+SessionScope::~SessionScope() {
+    session_user = previous_;
+}
+
+int SessionScope::currentUser() {
+    return session_user;
+}
+
+bool isReadOnlyQuery(const std::string& sql) {
+    // Scan words outside literals, quoted identifiers and comments
+    std::string word;
+    bool first = true;
+    size_t i = 0;
+    while (i < sql.size()) {
+        char c = sql[i];
+        if (c == '\'' || c == '"') {
+            size_t close = sql.find(c, i + 1);
+            i = close == std::string::npos ? sql.size() : close + 1;   // '' escapes rescan as a new literal
+            continue;
+        }
+        if (c == '-' && i + 1 < sql.size() && sql[i + 1] == '-') {
+            size_t eol = sql.find('\n', i);
+            i = eol == std::string::npos ? sql.size() : eol + 1;
+            continue;
+        }
+        if (c == '/' && i + 1 < sql.size() && sql[i + 1] == '*') {
+            size_t close = sql.find("*/", i + 2);
+            i = close == std::string::npos ? sql.size() : close + 2;
+            continue;
+        }
+        if (!std::isalpha(static_cast<unsigned char>(c)) && c != '_') {
+            ++i;
+            continue;
+        }
+
+        word.clear();
+        while (i < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '_')) {
+            word += static_cast<char>(std::toupper(static_cast<unsigned char>(sql[i])));
+            ++i;
+        }
+        if (first) {
+            if (word != "SELECT" && word != "WITH") return false;
+            first = false;
+            continue;
+        }
+        // Writes (also in CTEs), SELECT INTO, row locks (FOR UPDATE/SHARE)
+        // and sequence or advisory-lock calls all need the primary
+        if (word == "INSERT" || word == "UPDATE" || word == "DELETE" || word == "MERGE" ||
+            word == "INTO" || word == "SHARE" || word == "LOCK" ||
+            word == "NEXTVAL" || word == "SETVAL" || word.compare(0, 11, "PG_ADVISORY") == 0) {
+            return false;
+        }
+    }
+    return !first;
+}
+
+Database::Database(const std::string& connection_string,
+                   const std::vector<std::string>& replica_connection_strings)
     : conn_(nullptr), connection_string_(connection_string), last_insert_id_(0) {
     try {
         conn_ = std::make_unique<pqxx::connection>(connection_string);
@@ -18,6 +175,15 @@ Database::Database(const std::string& connection_string)
         conn_ = nullptr;
         throw std::runtime_error("Failed to connect to database: " + std::string(e.what()));
     }
+
+    // Replicas are optional: one that is down starts out of rotation
+    for (const auto& replica_connection_string : replica_connection_strings) {
+        auto replica = std::make_unique<Replica>();
+        replica->index = replicas_.size();
+        replica->connection_string = replica_connection_string;
+        replicas_.push_back(std::move(replica));
+    }
+    checkReplicas();
 }
 
 Database::~Database() {
@@ -28,7 +194,9 @@ Database::Database(Database&& other) noexcept
     : conn_(std::move(other.conn_)),
       connection_string_(std::move(other.connection_string_)),
       last_error_(std::move(other.last_error_)),
-      last_insert_id_(other.last_insert_id_) {
+      last_insert_id_(other.last_insert_id_),
+      replicas_(std::move(other.replicas_)),
+      max_replica_lag_(other.max_replica_lag_) {
 }
 
 Database& Database::operator=(Database&& other) noexcept {
@@ -38,6 +206,8 @@ Database& Database::operator=(Database&& other) noexcept {
         connection_string_ = std::move(other.connection_string_);
         last_error_ = std::move(other.last_error_);
         last_insert_id_ = other.last_insert_id_;
+        replicas_ = std::move(other.replicas_);
+        max_replica_lag_ = other.max_replica_lag_;
     }
     return *this;
 }
@@ -48,10 +218,30 @@ bool Database::execute(const std::string& sql) {
         return false;
     }
 
+    UnitOfWork* unit = UnitOfWork::current(*this);
+    if (unit != nullptr) {
+        if (!unit->isActive()) {
+            last_error_ = "Unit of work is not active";
+            return false;
+        }
+        try {
+            unit->txn_->exec(sql);
+            recordWrite();
+            return true;
+        } catch (const std::exception& e) {
+            unit->markFailed();
+            last_error_ = e.what();
+            std::cerr << "SQL error: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
     try {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         pqxx::work txn(*conn_);
         txn.exec(sql);
         txn.commit();
+        recordWrite();
         return true;
     } catch (const std::exception& e) {
         last_error_ = e.what();
@@ -83,36 +273,388 @@ void Database::close() {
         }
         conn_ = nullptr;
     }
+    replicas_.clear();
+}
+
+void Database::setMaxReplicaLag(std::chrono::milliseconds max_lag) {
+    max_replica_lag_ = max_lag;
+}
+
+void Database::checkReplicas() {
+    auto& metrics = utils::MetricsRegistry::getInstance();
+
+    // Where the primary's WAL stands now: a replica that has replayed up to
+    // here is current, however long ago the last commit was
+    std::string primary_lsn;
+    if (!replicas_.empty() && conn_ && conn_->is_open()) {
+        try {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            pqxx::nontransaction txn(*conn_);
+            pqxx::result result = txn.exec("SELECT pg_current_wal_lsn()::text");
+            if (!result.empty() && !result[0][0].is_null()) {
+                primary_lsn = result[0][0].as<std::string>();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Primary WAL position unavailable: " << e.what() << std::endl;
+        }
+    }
+
+    for (auto& replica : replicas_) {
+        long long lag_ms = -1;
+        {
+            std::lock_guard<std::recursive_mutex> lock(replica->mutex);
+            try {
+                if (!replica->conn || !replica->conn->is_open()) {
+                    replica->conn = std::make_unique<pqxx::connection>(replica->connection_string);
+                }
+                // A primary has no lag at all, and a standby whose WAL receiver is
+                // not streaming is cut off however current its replay looks.
+                // Otherwise it is current once replay reaches the primary's
+                // position; when that is unknown, once it has replayed all it
+                // received and heard from the primary within the lag budget.
+                // Short of that it lags by the age of its last replayed commit
+                pqxx::nontransaction txn(*replica->conn);
+                std::string primary_position = primary_lsn.empty() ? "NULL" : txn.quote(primary_lsn);
+                std::string budget_seconds = std::to_string(max_replica_lag_.count() / 1000.0);
+                pqxx::result result = txn.exec(
+                    "SELECT CASE WHEN NOT pg_is_in_recovery() THEN 0 "
+                    "WHEN receiver.last_msg_receipt_time IS NULL THEN -1 "
+                    "WHEN pg_last_wal_replay_lsn() >= " + primary_position + "::pg_lsn THEN 0 "
+                    "WHEN " + primary_position + " IS NULL "
+                    "AND pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() "
+                    "AND receiver.last_msg_receipt_time > now() - make_interval(secs => " + budget_seconds + ") "
+                    "THEN 0 "
+                    "ELSE (EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000)::bigint END "
+                    "FROM (SELECT max(last_msg_receipt_time) AS last_msg_receipt_time "
+                    "FROM pg_stat_wal_receiver WHERE status = 'streaming') receiver");
+                // NULL: nothing replayed since the replica started
+                lag_ms = result.empty() || result[0][0].is_null() ? 0 : result[0][0].as<long long>();
+            } catch (const std::exception& e) {
+                if (replica->healthy) {
+                    std::cerr << "Read replica " << replica->index << " unreachable: " << e.what() << std::endl;
+                }
+                replica->conn = nullptr;
+            }
+        }
+
+        bool healthy = lag_ms >= 0 && lag_ms <= max_replica_lag_.count();
+        if (replica->healthy.exchange(healthy) != healthy) {
+            std::cerr << "Read replica " << replica->index << (healthy ? " in rotation" : " out of rotation")
+                      << " (lag " << lag_ms << " ms)" << std::endl;
+        }
+        replica->lag_ms = lag_ms;
+
+        std::string label = std::to_string(replica->index);
+        metrics.gauge("sohbet_db_replica_lag_ms", "Replay lag of each read replica; -1 when unreachable or not streaming",
+                      {{"replica", label}}).set(lag_ms);
+        metrics.gauge("sohbet_db_replica_healthy", "1 while a read replica takes reads",
+                      {{"replica", label}}).set(healthy ? 1 : 0);
+    }
+
+    std::lock_guard<std::mutex> lock(recent_writes_mutex_);
+    pruneRecentWrites(std::chrono::steady_clock::now());
+}
+
+std::vector<ReplicaStatus> Database::replicaStatus() const {
+    std::vector<ReplicaStatus> status;
+    status.reserve(replicas_.size());
+    for (const auto& replica : replicas_) {
+        status.push_back(ReplicaStatus{replica->index, replica->healthy, replica->lag_ms});
+    }
+    return status;
+}
+
+Database::Replica* Database::acquireReplica(std::unique_lock<std::recursive_mutex>& lock) {
+    // Round-robin, preferring an idle replica over queueing behind a busy one
+    size_t count = replicas_.size();
+    size_t start = next_replica_.fetch_add(1, std::memory_order_relaxed);
+    Replica* busy = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        Replica* replica = replicas_[(start + i) % count].get();
+        if (!replica->healthy) {
+            continue;
+        }
+        std::unique_lock<std::recursive_mutex> attempt(replica->mutex, std::try_to_lock);
+        if (attempt.owns_lock() && replica->conn) {
+            lock = std::move(attempt);
+            return replica;
+        }
+        if (busy == nullptr) {
+            busy = replica;
+        }
+    }
+    if (busy == nullptr) {
+        return nullptr;
+    }
+    lock = std::unique_lock<std::recursive_mutex>(busy->mutex);
+    if (busy->conn && busy->healthy) {
+        return busy;
+    }
+    lock.unlock();
+    return nullptr;
+}
+
+bool Database::readsNeedPrimary() {
+    int user_id = SessionScope::currentUser();
+    if (user_id == 0) {
+        return false;
+    }
+    // Twice the lag allowed for replicas in rotation, since lag is only
+    // re-measured every few seconds
+    std::lock_guard<std::mutex> lock(recent_writes_mutex_);
+    auto it = recent_writes_.find(user_id);
+    return it != recent_writes_.end() &&
+           std::chrono::steady_clock::now() - it->second < 2 * max_replica_lag_;
+}
+
+void Database::recordWrite() {
+    recordWriteBy(SessionScope::currentUser());
+}
+
+void Database::recordWriteBy(int user_id) {
+    if (user_id <= 0 || replicas_.empty()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(recent_writes_mutex_);
+    recent_writes_[user_id] = now;
+    // Also swept here, so the map stays bounded without checkReplicas()
+    if (now - recent_writes_pruned_ >= max_replica_lag_) {
+        pruneRecentWrites(now);
+    }
+}
+
+void Database::pruneRecentWrites(std::chrono::steady_clock::time_point now) {
+    // Writes older than the read-your-writes window no longer pin anyone
+    auto cutoff = now - 2 * max_replica_lag_;
+    for (auto it = recent_writes_.begin(); it != recent_writes_.end();) {
+        it = it->second < cutoff ? recent_writes_.erase(it) : std::next(it);
+    }
+    recent_writes_pruned_ = now;
+}
+
+// ===================
+// UnitOfWork class
+// ===================
+
+// Open scopes on this thread, innermost last
+static thread_local std::vector<UnitOfWork*> active_units;
+
+static utils::Counter& transactionCounter(const char* outcome) {
+    return utils::MetricsRegistry::getInstance().counter(
+        "sohbet_db_unit_of_work_total", "Unit-of-work scopes by outcome", {{"outcome", outcome}});
+}
+
+UnitOfWork::UnitOfWork(Database& db)
+    : db_(db), parent_(current(db)), txn_(nullptr), finished_(false), failed_(false) {
+    active_units.push_back(this);
+    if (!db_.isOpen()) {
+        return;
+    }
+
+    try {
+        if (parent_ == nullptr) {
+            lock_ = std::unique_lock<std::recursive_mutex>(db_.mutex_);
+            work_ = std::make_unique<pqxx::work>(*db_.getHandle());
+            txn_ = work_.get();
+        } else if (parent_->isActive()) {
+            savepoint_ = std::make_unique<pqxx::subtransaction>(*parent_->txn_);
+            txn_ = savepoint_.get();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to begin unit of work: " << e.what() << std::endl;
+        db_.last_error_ = e.what();
+        work_.reset();
+        savepoint_.reset();
+        txn_ = nullptr;
+    }
+    if (txn_ == nullptr) {
+        failed_ = true;
+        if (lock_.owns_lock()) {
+            lock_.unlock();
+        }
+        if (parent_ != nullptr) {
+            parent_->markFailed();
+        }
+    }
+}
+
+UnitOfWork::~UnitOfWork() {
+    if (!finished_) {
+        rollback();
+    }
+    finish();
+}
+
+UnitOfWork* UnitOfWork::current(const Database& db) {
+    for (auto it = active_units.rbegin(); it != active_units.rend(); ++it) {
+        if (&(*it)->db_ == &db) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+void UnitOfWork::finish() {
+    finished_ = true;
+    // Statements after commit()/rollback() go to the enclosing scope again
+    auto it = std::find(active_units.begin(), active_units.end(), this);
+    if (it != active_units.end()) {
+        active_units.erase(it);
+    }
+}
+
+bool UnitOfWork::commit() {
+    if (finished_) {
+        return !failed_;
+    }
+    if (failed_ || txn_ == nullptr) {
+        rollback();
+        return false;
+    }
+
+    try {
+        if (savepoint_) {
+            savepoint_->commit();   // RELEASE SAVEPOINT
+        } else {
+            work_->commit();
+            transactionCounter("commit").inc();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Unit of work commit failed: " << e.what() << std::endl;
+        db_.last_error_ = e.what();
+        failed_ = true;
+        if (parent_ != nullptr) {
+            parent_->markFailed();
+        } else {
+            transactionCounter("rollback").inc();
+        }
+    }
+    finish();
+    txn_ = nullptr;
+    if (lock_.owns_lock()) {
+        lock_.unlock();
+    }
+    return !failed_;
+}
+
+void UnitOfWork::rollback() {
+    if (finished_) {
+        return;
+    }
+    failed_ = true;
+    try {
+        if (savepoint_) {
+            savepoint_->abort();    // ROLLBACK TO SAVEPOINT; the parent carries on
+        } else if (work_) {
+            work_->abort();
+            transactionCounter("rollback").inc();
+        }
+    } catch (...) {
+        // The transaction is gone either way
+        if (parent_ != nullptr) {
+            parent_->markFailed();
+        }
+    }
+    finish();
+    txn_ = nullptr;
+    if (lock_.owns_lock()) {
+        lock_.unlock();
+    }
 }
 
 // ===================
 // Statement class
 // ===================
 
-Statement::Statement(Database& db, const std::string& sql)
-    : db_(db), sql_(sql), current_row_(0), executed_(false), done_(false) {
+Statement::Statement(Database& db, const std::string& sql, Routing routing)
+    : db_(db), unit_(nullptr), replica_(nullptr), txn_(nullptr), writes_(true), sql_(sql),
+      current_row_(0), executed_(false), done_(false) {
     if (!db_.isOpen()) {
-        work_ = nullptr;
         return;
     }
 
+    // Classifying the SQL only matters when there is somewhere else to send it
+    if (!db_.replicas_.empty()) {
+        writes_ = routing != Routing::ReadOnly && !isReadOnlyQuery(sql_);
+    }
+
+    // Inside a unit of work: run in its transaction and leave committing to it
+    unit_ = UnitOfWork::current(db_);
+    if (unit_ != nullptr) {
+        if (unit_->isActive()) {
+            txn_ = unit_->txn_;
+        }
+        return;
+    }
+
+    if (!writes_ && routing != Routing::Primary && !db_.readsNeedPrimary()) {
+        beginOnReplica();
+    }
+    if (txn_ == nullptr) {
+        beginOnPrimary();
+    }
+    if (!db_.replicas_.empty()) {
+        routedStatements(replica_ != nullptr).inc();
+    }
+}
+
+void Statement::beginOnReplica() {
+    Database::Replica* replica = db_.acquireReplica(lock_);
+    if (replica == nullptr) {
+        return;
+    }
     try {
+        work_ = std::make_unique<pqxx::read_transaction>(*replica->conn);
+        txn_ = work_.get();
+        replica_ = replica;
+    } catch (const std::exception& e) {
+        // Also reached when this thread already has a transaction open on
+        // that replica; the primary serves the read instead
+        if (!replica->conn->is_open()) {
+            replica->healthy = false;
+        }
+        work_ = nullptr;
+        lock_.unlock();
+    }
+}
+
+void Statement::beginOnPrimary() {
+    try {
+        lock_ = std::unique_lock<std::recursive_mutex>(db_.mutex_);
         work_ = std::make_unique<pqxx::work>(*db_.getHandle());
+        txn_ = work_.get();
     } catch (const std::exception& e) {
         std::cerr << "Failed to create transaction: " << e.what() << std::endl;
         work_ = nullptr;
+        if (lock_.owns_lock()) {
+            lock_.unlock();
+        }
     }
 }
 
+bool Statement::retryOnPrimary() {
+    // Out of rotation until checkReplicas() reconnects it
+    replica_->healthy = false;
+    try {
+        work_->abort();
+    } catch (...) {
+        // The connection is gone either way
+    }
+    work_ = nullptr;
+    txn_ = nullptr;
+    replica_->conn = nullptr;
+    replica_ = nullptr;
+    lock_.unlock();
+
+    beginOnPrimary();
+    return txn_ != nullptr;
+}
+
 Statement::~Statement() {
-    if (work_) {
+    if (work_ && !done_) {
         try {
-            // Commit the transaction if it's still active
-            if (!executed_ || !done_) {
-                work_->abort();
-            } else {
-                work_->commit();
-            }
+            work_->abort();
         } catch (...) {
             // Ignore errors during cleanup
         }
@@ -120,7 +662,7 @@ Statement::~Statement() {
 }
 
 bool Statement::bindInt(int index, int value) {
-    if (!work_) return false;
+    if (!txn_) return false;
     // Resize params vector if needed
     if (static_cast<size_t>(index) > params_.size()) {
         params_.resize(index);
@@ -132,18 +674,21 @@ bool Statement::bindInt(int index, int value) {
 }
 
 bool Statement::bindDouble(int index, double value) {
-    if (!work_) return false;
+    if (!txn_) return false;
     if (static_cast<size_t>(index) > params_.size()) {
         params_.resize(index);
         is_null_.resize(index, false);
     }
-    params_[index - 1] = std::to_string(value);
+    // std::to_string keeps only 6 decimals; send the full round-trip value
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    params_[index - 1] = buffer;
     is_null_[index - 1] = false;
     return true;
 }
 
 bool Statement::bindText(int index, const std::string& value) {
-    if (!work_) return false;
+    if (!txn_) return false;
     if (static_cast<size_t>(index) > params_.size()) {
         params_.resize(index);
         is_null_.resize(index, false);
@@ -154,7 +699,7 @@ bool Statement::bindText(int index, const std::string& value) {
 }
 
 bool Statement::bindNull(int index) {
-    if (!work_) return false;
+    if (!txn_) return false;
     if (static_cast<size_t>(index) > params_.size()) {
         params_.resize(index);
         is_null_.resize(index, false);
@@ -165,19 +710,22 @@ bool Statement::bindNull(int index) {
     return true;
 }
 
+bool Statement::bindIntArray(int index, const std::vector<int>& values) {
+    std::string literal = "{";
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) literal += ',';
+        literal += std::to_string(values[i]);
+    }
+    literal += '}';
+    return bindText(index, literal);
+}
+
 int Statement::step() {
-    if (!work_) return SQLITE_ERROR;
+    if (!txn_) return SQLITE_ERROR;
 
     try {
         if (!executed_) {
-            // Replace ? placeholders with $1, $2, etc. for PostgreSQL
-            std::string pg_sql = sql_;
-            int param_num = 1;
-            size_t pos = 0;
-            while ((pos = pg_sql.find('?', pos)) != std::string::npos) {
-                pg_sql.replace(pos, 1, "$" + std::to_string(param_num++));
-                pos += std::to_string(param_num - 1).length() + 1;
-            }
+            std::string pg_sql = toPostgresPlaceholders(sql_);
 
             // Build parameter list with proper NULL handling
             pqxx::params pq_params;
@@ -190,7 +738,29 @@ int Statement::step() {
             }
 
             // Execute with parameters
-            result_ = work_->exec_params(pg_sql, pq_params);
+            auto started = std::chrono::steady_clock::now();
+            try {
+                try {
+                    result_ = txn_->exec_params(pg_sql, pq_params);
+                } catch (const pqxx::broken_connection&) {
+                    // The replica went away mid-read; the primary has the same data
+                    if (replica_ == nullptr || !retryOnPrimary()) throw;
+                    result_ = txn_->exec_params(pg_sql, pq_params);
+                }
+            } catch (...) {
+                StatementMetrics& series = statementMetrics(sql_);
+                if (series.errors == nullptr) {
+                    series.errors = &utils::MetricsRegistry::getInstance().counter(
+                        "sohbet_db_query_errors_total", "Failed statements by query fingerprint",
+                        {{"query", series.fingerprint}});
+                }
+                series.errors->inc();
+                throw;
+            }
+            statementMetrics(sql_).duration->observe(std::chrono::steady_clock::now() - started);
+            if (writes_) {
+                db_.recordWrite();
+            }
 
             // Check if this was an INSERT and try to get the last inserted ID
             if (pg_sql.find("INSERT") != std::string::npos ||
@@ -214,7 +784,11 @@ int Statement::step() {
             return SQLITE_ROW;
         } else {
             if (!done_) {
-                work_->commit();
+                // Joined statements are committed by their unit of work
+                if (work_) {
+                    work_->commit();
+                    lock_.unlock();
+                }
                 done_ = true;
             }
             return SQLITE_DONE;
@@ -222,12 +796,16 @@ int Statement::step() {
     } catch (const std::exception& e) {
         std::cerr << "Statement execution error: " << e.what() << std::endl;
         db_.last_error_ = e.what();
+        if (unit_ != nullptr) {
+            // PostgreSQL refuses further statements in this transaction
+            unit_->markFailed();
+        }
         return SQLITE_ERROR;
     }
 }
 
 bool Statement::reset() {
-    if (!work_) return false;
+    if (!txn_) return false;
     current_row_ = 0;
     executed_ = false;
     done_ = false;
@@ -1,5 +1,5 @@
 #include "models/announcement.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -8,68 +8,49 @@ Announcement::Announcement(int group_id, int author_id, const std::string& title
 }
 
 std::string Announcement::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
-
-    if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
-    }
-
-    oss << "\"group_id\":" << group_id_ << ","
-        << "\"author_id\":" << author_id_ << ","
-        << "\"title\":\"";
-
-    // Escape quotes in title
-    for (char c : title_) {
-        if (c == '"') oss << "\\\"";
-        else if (c == '\\') oss << "\\\\";
-        else if (c == '\n') oss << "\\n";
-        else if (c == '\r') oss << "\\r";
-        else if (c == '\t') oss << "\\t";
-        else oss << c;
-    }
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
 
-    oss << "\",\"content\":\"";
+void Announcement::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
 
-    // Escape quotes in content
-    for (char c : content_) {
-        if (c == '"') oss << "\\\"";
-        else if (c == '\\') oss << "\\\\";
-        else if (c == '\n') oss << "\\n";
-        else if (c == '\r') oss << "\\r";
-        else if (c == '\t') oss << "\\t";
-        else oss << c;
+    if (id_.has_value()) {
+        writer.field("id", id_.value());
     }
 
-    oss << "\","
-        << "\"is_pinned\":" << (is_pinned_ ? "true" : "false");
+    writer.field("group_id", group_id_)
+          .field("author_id", author_id_)
+          .field("title", title_)
+          .field("content", content_)
+          .field("is_pinned", is_pinned_);
 
     if (created_at_.has_value()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
 
     if (updated_at_.has_value()) {
-        oss << ",\"updated_at\":\"" << updated_at_.value() << "\"";
+        writer.field("updated_at", updated_at_.value());
     }
 
     // Include author information if available
     if (author_username_.has_value() || author_name_.has_value()) {
-        oss << ",\"author\":{";
-        oss << "\"id\":" << author_id_;
+        writer.key("author").beginObject();
+        writer.field("id", author_id_);
 
         if (author_username_.has_value()) {
-            oss << ",\"username\":\"" << author_username_.value() << "\"";
+            writer.field("username", author_username_.value());
         }
 
         if (author_name_.has_value()) {
-            oss << ",\"name\":\"" << author_name_.value() << "\"";
+            writer.field("name", author_name_.value());
         }
 
-        oss << "}";
+        writer.endObject();
     }
 
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 Announcement Announcement::fromJson(const std::string& json) {
@@ -1,5 +1,5 @@
 #include "models/comment.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -8,46 +8,34 @@ Comment::Comment(int post_id, int author_id, const std::string& content)
 }
 
 std::string Comment::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
-    
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Comment::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writeJsonFields(writer);
+    writer.endObject();
+}
+
+void Comment::writeJsonFields(utils::JsonWriter& writer) const {
     if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
-    }
-    
-    oss << "\"post_id\":" << post_id_ << ",";
-    
-    if (parent_id_.has_value()) {
-        oss << "\"parent_id\":" << parent_id_.value() << ",";
-    } else {
-        oss << "\"parent_id\":null,";
-    }
-    
-    oss << "\"author_id\":" << author_id_ << ","
-        << "\"content\":\"";
-    
-    // Escape quotes in content
-    for (char c : content_) {
-        if (c == '"') oss << "\\\"";
-        else if (c == '\\') oss << "\\\\";
-        else if (c == '\n') oss << "\\n";
-        else if (c == '\r') oss << "\\r";
-        else if (c == '\t') oss << "\\t";
-        else oss << c;
+        writer.field("id", id_.value());
     }
     
-    oss << "\"";
+    writer.field("post_id", post_id_)
+          .field("parent_id", parent_id_)
+          .field("author_id", author_id_)
+          .field("content", content_);
     
     if (created_at_.has_value()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
     
     if (updated_at_.has_value()) {
-        oss << ",\"updated_at\":\"" << updated_at_.value() << "\"";
+        writer.field("updated_at", updated_at_.value());
     }
-    
-    oss << "}";
-    return oss.str();
 }
 
 Comment Comment::fromJson(const std::string& json) {
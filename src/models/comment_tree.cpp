@@ -0,0 +1,97 @@
+#include "models/comment_tree.h"
+#include "utils/json_writer.h"
+#include <unordered_map>
+
+namespace sohbet {
+
+std::string CommentTree::Node::cursor() const {
+    return std::to_string(created_at_us) + ":" + std::to_string(comment.getId().value_or(0));
+}
+
+CommentTree CommentTree::build(std::vector<Node> rows) {
+    const uint32_t none = static_cast<uint32_t>(-1);
+
+    std::unordered_map<int, uint32_t> position;
+    position.reserve(rows.size());
+    for (uint32_t i = 0; i < rows.size(); ++i) {
+        position[rows[i].comment.getId().value_or(0)] = i;
+    }
+
+    // Replies grouped by parent in one array, keeping the input order
+    std::vector<uint32_t> parent(rows.size(), none);
+    std::vector<uint32_t> offsets(rows.size() + 1, 0);
+    std::vector<uint32_t> roots;
+    for (uint32_t i = 0; i < rows.size(); ++i) {
+        const auto& parent_id = rows[i].comment.getParentId();
+        if (rows[i].depth == 0) {
+            roots.push_back(i);
+            continue;
+        }
+        if (!parent_id.has_value()) {
+            continue;
+        }
+        auto it = position.find(parent_id.value());
+        if (it != position.end()) {
+            parent[i] = it->second;
+            ++offsets[it->second + 1];
+        }
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+    std::vector<uint32_t> replies(offsets.back());
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (uint32_t i = 0; i < rows.size(); ++i) {
+        if (parent[i] != none) {
+            replies[next[parent[i]]++] = i;
+        }
+    }
+
+    // Breadth-first layout: appending each node's replies as it is reached
+    // keeps every sibling run contiguous
+    std::vector<uint32_t> order(roots);
+    order.reserve(rows.size());
+    CommentTree tree;
+    tree.nodes_.reserve(rows.size());
+    tree.thread_count_ = roots.size();
+    for (size_t k = 0; k < order.size(); ++k) {
+        uint32_t source = order[k];
+        Node node = std::move(rows[source]);
+        node.first_reply = static_cast<uint32_t>(order.size());
+        node.loaded_replies = offsets[source + 1] - offsets[source];
+        order.insert(order.end(), replies.begin() + offsets[source], replies.begin() + offsets[source + 1]);
+        tree.nodes_.push_back(std::move(node));
+    }
+
+    return tree;
+}
+
+std::string CommentTree::toJson() const {
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void CommentTree::writeJson(utils::JsonWriter& writer) const {
+    writer.beginArray();
+    for (uint32_t i = 0; i < thread_count_; ++i) {
+        writeNode(writer, i);
+    }
+    writer.endArray();
+}
+
+void CommentTree::writeNode(utils::JsonWriter& writer, uint32_t index) const {
+    const Node& node = nodes_[index];
+    writer.beginObject();
+    node.comment.writeJsonFields(writer);
+    writer.field("reply_count", node.reply_count);
+    writer.field("cursor", node.cursor());
+    writer.key("replies").beginArray();
+    for (uint32_t i = 0; i < node.loaded_replies; ++i) {
+        writeNode(writer, node.first_reply + i);
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+} // namespace sohbet
@@ -1,5 +1,5 @@
 #include "models/conversation.h"
-#include <sstream>
+#include "utils/json_writer.h"
 #include <regex>
 #include <algorithm>
 
@@ -17,22 +17,48 @@ Conversation::Conversation(int id, int user1_id, int user2_id,
 }
 
 std::string Conversation::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":" << id << ",";
-    oss << "\"user1_id\":" << user1_id << ",";
-    oss << "\"user2_id\":" << user2_id << ",";
-    
-    // Convert time_t to ISO 8601 string
-    char time_buf[30];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&created_at));
-    oss << "\"created_at\":\"" << time_buf << "\",";
-    
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&last_message_at));
-    oss << "\"last_message_at\":\"" << time_buf << "\"";
-    
-    oss << "}";
-    return oss.str();
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
+
+void Conversation::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("id", id);
+    writer.field("user1_id", user1_id);
+    writer.field("user2_id", user2_id);
+    writer.timestampField("created_at", created_at);
+    writer.timestampField("last_message_at", last_message_at);
+    writer.endObject();
+}
+
+std::string InboxEntry::to_json() const {
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
+
+void InboxEntry::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("conversation_id", conversation_id);
+    writer.key("other_user").beginObject();
+    writer.field("id", other_user_id);
+    writer.field("username", other_username);
+    writer.field("name", other_name);
+    writer.field("avatar_url", other_avatar_url);
+    writer.endObject();
+    if (last_message_id > 0) {
+        writer.key("last_message").beginObject();
+        writer.field("id", last_message_id);
+        writer.field("sender_id", last_message_sender_id);
+        writer.field("preview", last_message_preview);
+        writer.endObject();
+    } else {
+        writer.nullField("last_message");
+    }
+    writer.timestampField("last_message_at", last_message_at);
+    writer.field("unread_count", unread_count);
+    writer.endObject();
 }
 
 Conversation Conversation::from_json(const std::string& json) {
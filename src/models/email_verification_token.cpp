@@ -1,4 +1,5 @@
 #include "models/email_verification_token.h"
+#include "utils/json_writer.h"
 #include <sstream>
 #include <random>
 #include <iomanip>
@@ -35,32 +36,31 @@ std::time_t EmailVerificationToken::getDefaultExpiration() {
 }
 
 std::string EmailVerificationToken::toJson() const {
-    std::stringstream ss;
-    ss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void EmailVerificationToken::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
     
     if (id_.has_value()) {
-        ss << "\"id\":" << id_.value() << ",";
+        writer.field("id", id_.value());
     }
     
-    ss << "\"user_id\":" << user_id_ << ","
-       << "\"token\":\"" << token_ << "\",";
-    
-    // Convert time_t to ISO 8601 string
-    char expires_buf[32];
-    std::tm* expires_tm = std::gmtime(&expires_at_);
-    std::strftime(expires_buf, sizeof(expires_buf), "%Y-%m-%dT%H:%M:%SZ", expires_tm);
-    ss << "\"expires_at\":\"" << expires_buf << "\"";
+    writer.field("user_id", user_id_)
+          .field("token", token_)
+          .timestampField("expires_at", expires_at_);
     
     if (created_at_.has_value()) {
-        ss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
     
     if (verified_at_.has_value()) {
-        ss << ",\"verified_at\":\"" << verified_at_.value() << "\"";
+        writer.field("verified_at", verified_at_.value());
     }
     
-    ss << "}";
-    return ss.str();
+    writer.endObject();
 }
 
 } // namespace sohbet
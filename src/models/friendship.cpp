@@ -1,5 +1,5 @@
 #include "models/friendship.h"
-#include <sstream>
+#include "utils/json_writer.h"
 #include <stdexcept>
 
 namespace sohbet {
@@ -9,27 +9,31 @@ Friendship::Friendship(int requester_id, int addressee_id)
 }
 
 std::string Friendship::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Friendship::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
     
     if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
+        writer.field("id", id_.value());
     }
     
-    oss << "\"requester_id\":" << requester_id_ << ","
-        << "\"addressee_id\":" << addressee_id_ << ","
-        << "\"status\":\"" << status_ << "\"";
+    writer.field("requester_id", requester_id_)
+          .field("addressee_id", addressee_id_)
+          .field("status", status_);
     
     if (created_at_.has_value()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
     
     if (updated_at_.has_value()) {
-        oss << ",\"updated_at\":\"" << updated_at_.value() << "\"";
+        writer.field("updated_at", updated_at_.value());
     }
     
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 Friendship Friendship::fromJson(const std::string& json) {
@@ -1,5 +1,5 @@
 #include "models/group.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -7,25 +7,33 @@ Group::Group(const std::string& name, int creator_id)
     : name_(name), creator_id_(creator_id) {}
 
 std::string Group::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Group::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writeJsonFields(writer);
+    writer.endObject();
+}
+
+void Group::writeJsonFields(utils::JsonWriter& writer) const {
     if (id_) {
-        oss << "\"id\":" << *id_ << ",";
+        writer.field("id", *id_);
     }
-    oss << "\"name\":\"" << name_ << "\",";
+    writer.field("name", name_);
     if (description_) {
-        oss << "\"description\":\"" << *description_ << "\",";
+        writer.field("description", *description_);
     }
-    oss << "\"creator_id\":" << creator_id_ << ",";
-    oss << "\"privacy\":\"" << privacy_ << "\"";
+    writer.field("creator_id", creator_id_);
+    writer.field("privacy", privacy_);
     if (created_at_) {
-        oss << ",\"created_at\":\"" << *created_at_ << "\"";
+        writer.field("created_at", *created_at_);
     }
     if (updated_at_) {
-        oss << ",\"updated_at\":\"" << *updated_at_ << "\"";
+        writer.field("updated_at", *updated_at_);
     }
-    oss << "}";
-    return oss.str();
 }
 
 Group Group::fromJson(const std::string& json) {
@@ -1,5 +1,5 @@
 #include "models/hashtag.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -8,26 +8,30 @@ Hashtag::Hashtag(const std::string& tag)
 }
 
 std::string Hashtag::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Hashtag::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
 
     if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
+        writer.field("id", id_.value());
     }
 
-    oss << "\"tag\":\"" << tag_ << "\","
-        << "\"usage_count\":" << usage_count_;
+    writer.field("tag", tag_)
+          .field("usage_count", usage_count_);
 
     if (created_at_.has_value()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
 
     if (last_used_at_.has_value()) {
-        oss << ",\"last_used_at\":\"" << last_used_at_.value() << "\"";
+        writer.field("last_used_at", last_used_at_.value());
     }
 
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 Hashtag Hashtag::fromJson(const std::string& json) {
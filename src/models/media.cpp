@@ -1,5 +1,5 @@
 #include "models/media.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -7,39 +7,43 @@ Media::Media(int user_id, const std::string& media_type, const std::string& stor
     : user_id_(user_id), media_type_(media_type), storage_key_(storage_key) {}
 
 std::string Media::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Media::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
     
     if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
+        writer.field("id", id_.value());
     }
     
-    oss << "\"user_id\":" << user_id_ << ",";
-    oss << "\"media_type\":\"" << media_type_ << "\",";
-    oss << "\"storage_key\":\"" << storage_key_ << "\"";
+    writer.field("user_id", user_id_);
+    writer.field("media_type", media_type_);
+    writer.field("storage_key", storage_key_);
     
     if (file_name_.has_value() && !file_name_.value().empty()) {
-        oss << ",\"file_name\":\"" << file_name_.value() << "\"";
+        writer.field("file_name", file_name_.value());
     }
     
     if (file_size_.has_value()) {
-        oss << ",\"file_size\":" << file_size_.value();
+        writer.field("file_size", file_size_.value());
     }
     
     if (mime_type_.has_value() && !mime_type_.value().empty()) {
-        oss << ",\"mime_type\":\"" << mime_type_.value() << "\"";
+        writer.field("mime_type", mime_type_.value());
     }
     
     if (url_.has_value() && !url_.value().empty()) {
-        oss << ",\"url\":\"" << url_.value() << "\"";
+        writer.field("url", url_.value());
     }
     
     if (created_at_.has_value() && !created_at_.value().empty()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
     
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 } // namespace sohbet
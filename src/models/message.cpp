@@ -1,5 +1,5 @@
 #include "models/message.h"
-#include <sstream>
+#include "utils/json_writer.h"
 #include <regex>
 #include <algorithm>
 
@@ -21,42 +21,38 @@ Message::Message(int id, int conversation_id, int sender_id, const std::string&
 }
 
 std::string Message::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":" << id << ",";
-    oss << "\"conversation_id\":" << conversation_id << ",";
-    oss << "\"sender_id\":" << sender_id << ",";
-    oss << "\"content\":\"" << content << "\",";
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
+
+void Message::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("id", id);
+    writer.field("conversation_id", conversation_id);
+    writer.field("sender_id", sender_id);
+    writer.field("content", content);
     
     if (!media_url.empty()) {
-        oss << "\"media_url\":\"" << media_url << "\",";
+        writer.field("media_url", media_url);
     } else {
-        oss << "\"media_url\":null,";
+        writer.nullField("media_url");
     }
     
-    // Convert time_t to ISO 8601 string
     if (!is_read_at_null) {
-        char time_buf[30];
-        std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&read_at));
-        oss << "\"read_at\":\"" << time_buf << "\",";
+        writer.timestampField("read_at", read_at);
     } else {
-        oss << "\"read_at\":null,";
+        writer.nullField("read_at");
     }
     
     if (!is_delivered_at_null) {
-        char time_buf[30];
-        std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&delivered_at));
-        oss << "\"delivered_at\":\"" << time_buf << "\",";
+        writer.timestampField("delivered_at", delivered_at);
     } else {
-        oss << "\"delivered_at\":null,";
+        writer.nullField("delivered_at");
     }
     
-    char time_buf[30];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&created_at));
-    oss << "\"created_at\":\"" << time_buf << "\"";
-    
-    oss << "}";
-    return oss.str();
+    writer.timestampField("created_at", created_at);
+    writer.endObject();
 }
 
 Message Message::from_json(const std::string& json) {
@@ -1,5 +1,5 @@
 #include "models/notification.h"
-#include <sstream>
+#include "utils/json_writer.h"
 #include <regex>
 
 namespace sohbet {
@@ -31,65 +31,40 @@ Notification::Notification(int id, int user_id, const std::string& type,
 }
 
 std::string Notification::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":" << id << ",";
-    oss << "\"user_id\":" << user_id << ",";
-    oss << "\"type\":\"" << type << "\",";
-    oss << "\"title\":\"" << title << "\",";
-    oss << "\"message\":\"" << message << "\",";
-
-    if (related_user_id.has_value()) {
-        oss << "\"related_user_id\":" << related_user_id.value() << ",";
-    } else {
-        oss << "\"related_user_id\":null,";
-    }
-
-    if (related_post_id.has_value()) {
-        oss << "\"related_post_id\":" << related_post_id.value() << ",";
-    } else {
-        oss << "\"related_post_id\":null,";
-    }
-
-    if (related_comment_id.has_value()) {
-        oss << "\"related_comment_id\":" << related_comment_id.value() << ",";
-    } else {
-        oss << "\"related_comment_id\":null,";
-    }
-
-    if (related_group_id.has_value()) {
-        oss << "\"related_group_id\":" << related_group_id.value() << ",";
-    } else {
-        oss << "\"related_group_id\":null,";
-    }
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
 
-    if (related_session_id.has_value()) {
-        oss << "\"related_session_id\":" << related_session_id.value() << ",";
-    } else {
-        oss << "\"related_session_id\":null,";
-    }
+void Notification::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("id", id);
+    writer.field("user_id", user_id);
+    writer.field("type", type);
+    writer.field("title", title);
+    writer.field("message", message);
+    writer.field("related_user_id", related_user_id);
+    writer.field("related_post_id", related_post_id);
+    writer.field("related_comment_id", related_comment_id);
+    writer.field("related_group_id", related_group_id);
+    writer.field("related_session_id", related_session_id);
 
     if (!action_url.empty()) {
-        oss << "\"action_url\":\"" << action_url << "\",";
+        writer.field("action_url", action_url);
     } else {
-        oss << "\"action_url\":null,";
+        writer.nullField("action_url");
     }
 
-    oss << "\"is_read\":" << (is_read ? "true" : "false") << ",";
-
-    char time_buf[30];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&created_at));
-    oss << "\"created_at\":\"" << time_buf << "\",";
+    writer.field("is_read", is_read);
+    writer.timestampField("created_at", created_at);
 
     if (!is_read_at_null) {
-        std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&read_at));
-        oss << "\"read_at\":\"" << time_buf << "\"";
+        writer.timestampField("read_at", read_at);
     } else {
-        oss << "\"read_at\":null";
+        writer.nullField("read_at");
     }
 
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 Notification Notification::from_json(const std::string& json) {
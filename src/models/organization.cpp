@@ -1,5 +1,5 @@
 #include "models/organization.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -7,34 +7,38 @@ Organization::Organization(const std::string& name, const std::string& type)
     : name_(name), type_(type) {}
 
 std::string Organization::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Organization::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
     if (id_) {
-        oss << "\"id\":" << *id_ << ",";
+        writer.field("id", *id_);
     }
-    oss << "\"name\":\"" << name_ << "\",";
-    oss << "\"type\":\"" << type_ << "\",";
-    oss << "\"category\":\"" << type_ << "\"";  // Frontend expects 'category'
+    writer.field("name", name_);
+    writer.field("type", type_);
+    writer.field("category", type_);  // Frontend expects 'category'
     if (description_) {
-        oss << ",\"description\":\"" << *description_ << "\"";
+        writer.field("description", *description_);
     }
     if (email_) {
-        oss << ",\"email\":\"" << *email_ << "\"";
+        writer.field("email", *email_);
     }
     if (website_) {
-        oss << ",\"website\":\"" << *website_ << "\"";
+        writer.field("website", *website_);
     }
     if (logo_url_) {
-        oss << ",\"logo_url\":\"" << *logo_url_ << "\"";
+        writer.field("logo_url", *logo_url_);
     }
     if (created_at_) {
-        oss << ",\"created_at\":\"" << *created_at_ << "\"";
+        writer.field("created_at", *created_at_);
     }
     if (updated_at_) {
-        oss << ",\"updated_at\":\"" << *updated_at_ << "\"";
+        writer.field("updated_at", *updated_at_);
     }
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 Organization Organization::fromJson(const std::string& json) {
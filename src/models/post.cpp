@@ -1,5 +1,5 @@
 #include "models/post.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -8,68 +8,61 @@ Post::Post(int author_id, const std::string& content)
 }
 
 std::string Post::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
 
-    if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
-    }
+void Post::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
 
-    oss << "\"author_id\":" << author_id_ << ","
-        << "\"author_type\":\"" << author_type_ << "\","
-        << "\"content\":\"";
-
-    // Escape quotes in content
-    for (char c : content_) {
-        if (c == '"') oss << "\\\"";
-        else if (c == '\\') oss << "\\\\";
-        else if (c == '\n') oss << "\\n";
-        else if (c == '\r') oss << "\\r";
-        else if (c == '\t') oss << "\\t";
-        else oss << c;
+    if (id_.has_value()) {
+        writer.field("id", id_.value());
     }
 
-    oss << "\","
-        << "\"visibility\":\"" << visibility_ << "\"";
+    writer.field("author_id", author_id_)
+          .field("author_type", author_type_)
+          .field("content", content_)
+          .field("visibility", visibility_);
 
+    // media_urls is stored as a serialized JSON array
     if (media_urls_.has_value()) {
-        oss << ",\"media_urls\":" << media_urls_.value();
+        writer.rawField("media_urls", media_urls_.value());
     }
 
     if (group_id_.has_value()) {
-        oss << ",\"group_id\":" << group_id_.value();
+        writer.field("group_id", group_id_.value());
     }
 
     if (created_at_.has_value()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
 
     if (updated_at_.has_value()) {
-        oss << ",\"updated_at\":\"" << updated_at_.value() << "\"";
+        writer.field("updated_at", updated_at_.value());
     }
 
     // Include author information if available
     if (author_username_.has_value() || author_name_.has_value() || author_avatar_url_.has_value()) {
-        oss << ",\"author\":{";
-        oss << "\"id\":" << author_id_;
+        writer.key("author").beginObject();
+        writer.field("id", author_id_);
 
         if (author_username_.has_value()) {
-            oss << ",\"username\":\"" << author_username_.value() << "\"";
+            writer.field("username", author_username_.value());
         }
 
         if (author_name_.has_value()) {
-            oss << ",\"name\":\"" << author_name_.value() << "\"";
+            writer.field("name", author_name_.value());
         }
 
         if (author_avatar_url_.has_value()) {
-            oss << ",\"avatar_url\":\"" << author_avatar_url_.value() << "\"";
+            writer.field("avatar_url", author_avatar_url_.value());
         }
 
-        oss << "}";
+        writer.endObject();
     }
 
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 Post Post::fromJson(const std::string& json) {
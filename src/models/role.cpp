@@ -1,5 +1,5 @@
 #include "models/role.h"
-#include <sstream>
+#include "utils/json_writer.h"
 
 namespace sohbet {
 
@@ -7,25 +7,29 @@ Role::Role(const std::string& name, const std::string& description)
     : name_(name), description_(description) {}
 
 std::string Role::toJson() const {
-    std::ostringstream json;
-    json << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void Role::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
     
     if (id_.has_value()) {
-        json << "\"id\":" << id_.value() << ",";
+        writer.field("id", id_.value());
     }
     
-    json << "\"name\":\"" << name_ << "\"";
+    writer.field("name", name_);
     
     if (!description_.empty()) {
-        json << ",\"description\":\"" << description_ << "\"";
+        writer.field("description", description_);
     }
     
     if (created_at_.has_value()) {
-        json << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
     
-    json << "}";
-    return json.str();
+    writer.endObject();
 }
 
 // Simplified fromJson - in production, use a proper JSON library
@@ -1,5 +1,5 @@
 #include "models/study_session.h"
-#include <sstream>
+#include "utils/json_writer.h"
 #include <regex>
 
 namespace sohbet {
@@ -30,51 +30,34 @@ StudySession::StudySession(int id, int group_id, const std::string& title,
 }
 
 std::string StudySession::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":" << id << ",";
-    oss << "\"group_id\":" << group_id << ",";
-    oss << "\"title\":\"" << title << "\",";
-    oss << "\"description\":\"" << description << "\",";
-    oss << "\"location\":\"" << location << "\",";
-
-    if (voice_channel_id.has_value()) {
-        oss << "\"voice_channel_id\":" << voice_channel_id.value() << ",";
-    } else {
-        oss << "\"voice_channel_id\":null,";
-    }
-
-    char time_buf[30];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&start_time));
-    oss << "\"start_time\":\"" << time_buf << "\",";
-
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&end_time));
-    oss << "\"end_time\":\"" << time_buf << "\",";
-
-    oss << "\"created_by\":" << created_by << ",";
-
-    if (max_participants.has_value()) {
-        oss << "\"max_participants\":" << max_participants.value() << ",";
-    } else {
-        oss << "\"max_participants\":null,";
-    }
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
 
-    oss << "\"is_recurring\":" << (is_recurring ? "true" : "false") << ",";
+void StudySession::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("id", id);
+    writer.field("group_id", group_id);
+    writer.field("title", title);
+    writer.field("description", description);
+    writer.field("location", location);
+    writer.field("voice_channel_id", voice_channel_id);
+    writer.timestampField("start_time", start_time);
+    writer.timestampField("end_time", end_time);
+    writer.field("created_by", created_by);
+    writer.field("max_participants", max_participants);
+    writer.field("is_recurring", is_recurring);
 
     if (!recurrence_pattern.empty()) {
-        oss << "\"recurrence_pattern\":\"" << recurrence_pattern << "\",";
+        writer.field("recurrence_pattern", recurrence_pattern);
     } else {
-        oss << "\"recurrence_pattern\":null,";
+        writer.nullField("recurrence_pattern");
     }
 
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&created_at));
-    oss << "\"created_at\":\"" << time_buf << "\",";
-
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&updated_at));
-    oss << "\"updated_at\":\"" << time_buf << "\"";
-
-    oss << "}";
-    return oss.str();
+    writer.timestampField("created_at", created_at);
+    writer.timestampField("updated_at", updated_at);
+    writer.endObject();
 }
 
 StudySession StudySession::from_json(const std::string& json) {
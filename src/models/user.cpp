@@ -1,6 +1,6 @@
 #include "models/user.h"
+#include "utils/json_writer.h"
 #include <regex>
-#include <sstream>
 #include <algorithm>
 
 namespace sohbet {
@@ -11,79 +11,80 @@ User::User(const std::string& username, const std::string& email)
 
 // Serialize to JSON (excludes password hash)
 std::string User::toJson() const {
-    std::ostringstream oss;
-    oss << "{";
+    utils::JsonWriter writer;
+    writeJson(writer);
+    return writer.str();
+}
+
+void User::writeJson(utils::JsonWriter& writer) const {
+    writer.beginObject();
 
     if (id_.has_value()) {
-        oss << "\"id\":" << id_.value() << ",";
+        writer.field("id", id_.value());
     }
 
-    oss << "\"username\":\"" << username_ << "\",";
-    oss << "\"email\":\"" << email_ << "\"";
+    writer.field("username", username_);
+    writer.field("email", email_);
 
     if (name_.has_value() && !name_.value().empty()) {
-        oss << ",\"name\":\"" << name_.value() << "\"";
+        writer.field("name", name_.value());
     }
 
     if (position_.has_value() && !position_.value().empty()) {
-        oss << ",\"position\":\"" << position_.value() << "\"";
+        writer.field("position", position_.value());
     }
 
     if (phone_number_.has_value() && !phone_number_.value().empty()) {
-        oss << ",\"phone_number\":\"" << phone_number_.value() << "\"";
+        writer.field("phone_number", phone_number_.value());
     }
 
     if (university_.has_value() && !university_.value().empty()) {
-        oss << ",\"university\":\"" << university_.value() << "\"";
+        writer.field("university", university_.value());
     }
 
     if (department_.has_value() && !department_.value().empty()) {
-        oss << ",\"department\":\"" << department_.value() << "\"";
+        writer.field("department", department_.value());
     }
 
     if (enrollment_year_.has_value()) {
-        oss << ",\"enrollment_year\":" << enrollment_year_.value();
+        writer.field("enrollment_year", enrollment_year_.value());
     }
 
     if (created_at_.has_value() && !created_at_.value().empty()) {
-        oss << ",\"created_at\":\"" << created_at_.value() << "\"";
+        writer.field("created_at", created_at_.value());
     }
 
     if (warnings_.has_value()) {
-        oss << ",\"warnings\":" << warnings_.value();
+        writer.field("warnings", warnings_.value());
     }
 
     if (primary_language_.has_value() && !primary_language_.value().empty()) {
-        oss << ",\"primary_language\":\"" << primary_language_.value() << "\"";
+        writer.field("primary_language", primary_language_.value());
     }
 
     if (!additional_languages_.empty()) {
-        oss << ",\"additional_languages\":[";
-        for (size_t i = 0; i < additional_languages_.size(); ++i) {
-            oss << "\"" << additional_languages_[i] << "\"";
-            if (i < additional_languages_.size() - 1) {
-                oss << ",";
-            }
+        writer.key("additional_languages").beginArray();
+        for (const auto& language : additional_languages_) {
+            writer.value(language);
         }
-        oss << "]";
+        writer.endArray();
     }
 
     if (role_.has_value() && !role_.value().empty()) {
-        oss << ",\"role\":\"" << role_.value() << "\"";
+        writer.field("role", role_.value());
     }
 
     if (avatar_url_.has_value() && !avatar_url_.value().empty()) {
-        oss << ",\"avatar_url\":\"" << avatar_url_.value() << "\"";
+        writer.field("avatar_url", avatar_url_.value());
     }
 
     if (banner_url_.has_value() && !banner_url_.value().empty()) {
-        oss << ",\"banner_url\":\"" << banner_url_.value() << "\"";
+        writer.field("banner_url", banner_url_.value());
     }
 
-    oss << ",\"email_verified\":" << (email_verified_ ? "true" : "false");
+    writer.field("email_verified", email_verified_);
 
-    oss << "}";
-    return oss.str();
+    writer.endObject();
 }
 
 // Deserialize from JSON (basic prototype parser)
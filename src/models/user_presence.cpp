@@ -1,5 +1,5 @@
 #include "models/user_presence.h"
-#include <sstream>
+#include "utils/json_writer.h"
 #include <regex>
 
 namespace sohbet {
@@ -17,27 +17,30 @@ UserPresence::UserPresence(int id, int user_id, const std::string& status,
 }
 
 std::string UserPresence::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":" << id << ",";
-    oss << "\"user_id\":" << user_id << ",";
-    oss << "\"status\":\"" << status << "\",";
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
+
+void UserPresence::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("id", id);
+    writer.field("user_id", user_id);
+    writer.field("status", status);
 
     if (!custom_status.empty()) {
-        oss << "\"custom_status\":\"" << custom_status << "\",";
+        writer.field("custom_status", custom_status);
     } else {
-        oss << "\"custom_status\":null,";
+        writer.nullField("custom_status");
     }
 
-    char time_buf[30];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&last_seen));
-    oss << "\"last_seen\":\"" << time_buf << "\",";
-
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&updated_at));
-    oss << "\"updated_at\":\"" << time_buf << "\"";
-
-    oss << "}";
-    return oss.str();
+    if (last_seen > 0) {
+        writer.timestampField("last_seen", last_seen);
+    } else {
+        writer.nullField("last_seen");  // Never connected
+    }
+    writer.timestampField("updated_at", updated_at);
+    writer.endObject();
 }
 
 UserPresence UserPresence::from_json(const std::string& json) {
@@ -1,6 +1,6 @@
 #include "models/voice_channel.h"
+#include "utils/json_writer.h"
 #include <ctime>
-#include <sstream>
 #include <regex>
 #include <iomanip>
 
@@ -13,31 +13,31 @@ VoiceChannel::VoiceChannel()
 }
 
 std::string VoiceChannel::to_json() const {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"id\":" << id << ",";
-    oss << "\"name\":\"" << name << "\",";
-    oss << "\"channel_type\":\"" << channel_type << "\",";
+    utils::JsonWriter writer;
+    write_json(writer);
+    return writer.str();
+}
+
+void VoiceChannel::write_json(utils::JsonWriter& writer) const {
+    writer.beginObject();
+    writer.field("id", id);
+    writer.field("name", name);
+    writer.field("channel_type", channel_type);
     
     if (group_id > 0) {
-        oss << "\"group_id\":" << group_id << ",";
+        writer.field("group_id", group_id);
     } else {
-        oss << "\"group_id\":null,";
+        writer.nullField("group_id");
     }
     
     if (organization_id > 0) {
-        oss << "\"organization_id\":" << organization_id << ",";
+        writer.field("organization_id", organization_id);
     } else {
-        oss << "\"organization_id\":null,";
+        writer.nullField("organization_id");
     }
 
-    // Convert time_t to ISO 8601 string
-    char time_buf[30];
-    std::strftime(time_buf, sizeof(time_buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&created_at));
-    oss << "\"created_at\":\"" << time_buf << "\"";
-    
-    oss << "}";
-    return oss.str();
+    writer.timestampField("created_at", created_at);
+    writer.endObject();
 }
 
 VoiceChannel VoiceChannel::from_json(const std::string& json) {
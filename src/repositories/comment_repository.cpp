@@ -4,8 +4,8 @@
 namespace sohbet {
 namespace repositories {
 
-CommentRepository::CommentRepository(std::shared_ptr<db::Database> database)
-    : database_(database) {}
+CommentRepository::CommentRepository(std::shared_ptr<db::Database> database, size_t thread_cache_capacity)
+    : database_(database), thread_cache_(thread_cache_capacity, std::chrono::seconds(30), "comment_threads") {}
 
 std::optional<Comment> CommentRepository::create(Comment& comment) {
     if (!database_ || !database_->isOpen()) return std::nullopt;
@@ -35,6 +35,7 @@ std::optional<Comment> CommentRepository::create(Comment& comment) {
         comment.setId(stmt.getInt(0));
         // Call step() again to commit the transaction
         stmt.step();
+        thread_cache_.erase(comment.getPostId());
         return comment;
     }
 
@@ -144,6 +145,112 @@ std::vector<Comment> CommentRepository::findReplies(int parent_comment_id, int l
     return comments;
 }
 
+std::shared_ptr<const CommentTree> CommentRepository::findThreads(int post_id, const CommentTreeQuery& query,
+                                                                 long long after_at_us, int after_id) {
+    bool cacheable = after_id <= 0 && query == CommentTreeQuery{};
+    if (cacheable) {
+        if (auto cached = thread_cache_.get(post_id)) {
+            return *cached;
+        }
+    }
+
+    auto tree = loadThreads(post_id, 0, query, after_at_us, after_id);
+    if (cacheable && tree) {
+        thread_cache_.put(post_id, tree);
+    }
+    return tree;
+}
+
+std::shared_ptr<const CommentTree> CommentRepository::findReplyThreads(const Comment& parent,
+                                                                      const CommentTreeQuery& query,
+                                                                      long long after_at_us, int after_id) {
+    if (!parent.getId().has_value()) return nullptr;
+    return loadThreads(parent.getPostId(), parent.getId().value(), query, after_at_us, after_id);
+}
+
+std::shared_ptr<const CommentTree> CommentRepository::loadThreads(int post_id, int parent_id,
+                                                                  const CommentTreeQuery& query,
+                                                                  long long after_at_us, int after_id) {
+    if (!database_ || !database_->isOpen()) return nullptr;
+
+    // The page's threads (top-level comments, or one comment's replies when
+    // expanding it), then replies level by level, each comment's capped by
+    // the LATERAL limit. The outer LIMIT stops the recursion once the page
+    // is big enough; levels are produced in order, so it cuts the deepest.
+    // reply_count is not stored anywhere: it is counted for each returned
+    // comment, a short range scan of idx_comments_parent_created.
+    const std::string anchor = parent_id > 0 ? "parent_id = ?" : "parent_id IS NULL";
+    const std::string sql = R"(
+        WITH RECURSIVE tree AS (
+            SELECT * FROM (
+                SELECT id, post_id, parent_id, author_id, content, created_at, updated_at, 0 AS depth
+                FROM comments
+                WHERE post_id = ? AND )" + anchor + R"(
+                  AND (? <= 0 OR (created_at, id) > (TIMESTAMP 'epoch' + ?::bigint * INTERVAL '1 microsecond', ?))
+                ORDER BY created_at, id
+                LIMIT ?
+            ) threads
+            UNION ALL
+            SELECT r.id, r.post_id, r.parent_id, r.author_id, r.content, r.created_at, r.updated_at, t.depth + 1
+            FROM tree t
+            CROSS JOIN LATERAL (
+                SELECT c.id, c.post_id, c.parent_id, c.author_id, c.content, c.created_at, c.updated_at
+                FROM comments c
+                WHERE c.parent_id = t.id
+                ORDER BY c.created_at, c.id
+                LIMIT ?
+            ) r
+            WHERE t.depth < ?
+        )
+        SELECT t.id, t.post_id, t.parent_id, t.author_id, t.content, t.created_at, t.updated_at, t.depth,
+               (SELECT COUNT(*) FROM comments c WHERE c.parent_id = t.id) AS reply_count,
+               (EXTRACT(EPOCH FROM t.created_at) * 1000000)::bigint
+        FROM (SELECT * FROM tree LIMIT ?) t
+        ORDER BY t.depth, t.created_at, t.id
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return nullptr;
+
+    int index = 1;
+    stmt.bindInt(index++, post_id);
+    if (parent_id > 0) {
+        stmt.bindInt(index++, parent_id);
+    }
+    stmt.bindInt(index++, after_id);
+    stmt.bindText(index++, std::to_string(after_at_us));
+    stmt.bindInt(index++, after_id);
+    stmt.bindInt(index++, query.threads);
+    stmt.bindInt(index++, query.replies_per_comment);
+    stmt.bindInt(index++, query.max_depth);
+    stmt.bindInt(index++, query.max_comments);
+
+    std::vector<CommentTree::Node> rows;
+    int result;
+    while ((result = stmt.step()) == SQLITE_ROW) {
+        CommentTree::Node node;
+        node.comment.setId(stmt.getInt(0));
+        node.comment.setPostId(stmt.getInt(1));
+        if (!stmt.isNull(2)) {
+            node.comment.setParentId(stmt.getInt(2));
+        }
+        node.comment.setAuthorId(stmt.getInt(3));
+        node.comment.setContent(stmt.getText(4));
+        node.comment.setCreatedAt(stmt.getText(5));
+        node.comment.setUpdatedAt(stmt.getText(6));
+        node.depth = stmt.getInt(7);
+        node.reply_count = stmt.getInt(8);
+        node.created_at_us = stmt.getInt64(9);
+        rows.push_back(std::move(node));
+    }
+    if (result != SQLITE_DONE) {
+        std::cerr << "Failed to load comment threads for post " << post_id << std::endl;
+        return nullptr;
+    }
+
+    return std::make_shared<const CommentTree>(CommentTree::build(std::move(rows)));
+}
+
 bool CommentRepository::update(const Comment& comment) {
     if (!database_ || !database_->isOpen()) return false;
     if (!comment.getId().has_value()) return false;
@@ -160,18 +267,29 @@ bool CommentRepository::update(const Comment& comment) {
     stmt.bindText(1, comment.getContent());
     stmt.bindInt(2, comment.getId().value());
 
-    return stmt.step() == SQLITE_DONE;
+    if (stmt.step() != SQLITE_DONE) return false;
+    thread_cache_.erase(comment.getPostId());
+    return true;
 }
 
 bool CommentRepository::deleteById(int id) {
     if (!database_ || !database_->isOpen()) return false;
 
-    const std::string sql = "DELETE FROM comments WHERE id = ?";
+    // post_id identifies the cached threads the deleted subtree was part of
+    const std::string sql = "DELETE FROM comments WHERE id = ? RETURNING post_id";
     db::Statement stmt(*database_, sql);
     if (!stmt.isValid()) return false;
 
     stmt.bindInt(1, id);
-    return stmt.step() == SQLITE_DONE;
+    int result = stmt.step();
+    if (result == SQLITE_ROW) {
+        int post_id = stmt.getInt(0);
+        // Call step() again to commit the transaction
+        if (stmt.step() != SQLITE_DONE) return false;
+        thread_cache_.erase(post_id);
+        return true;
+    }
+    return result == SQLITE_DONE;
 }
 
 int CommentRepository::getCommentCount(int post_id) {
@@ -5,8 +5,8 @@
 namespace sohbet {
 namespace repositories {
 
-ConversationRepository::ConversationRepository(std::shared_ptr<db::Database> database)
-    : database_(database) {
+ConversationRepository::ConversationRepository(std::shared_ptr<db::Database> database, size_t cache_capacity)
+    : database_(database), cache_(cache_capacity, std::chrono::milliseconds(0), "conversations") {
 }
 
 std::optional<Conversation> ConversationRepository::findOrCreateConversation(int user1_id, int user2_id) {
@@ -17,12 +17,18 @@ std::optional<Conversation> ConversationRepository::findOrCreateConversation(int
     
     // Try to find existing conversation
     auto existing = findConversation(user1_id, user2_id);
-    if (existing) {
-        return existing;
+    if (!existing) {
+        // Create new conversation
+        Conversation created = createConversation(user1_id, user2_id);
+        if (created.id <= 0) {
+            return created;
+        }
+        existing = created;
     }
     
-    // Create new conversation
-    return createConversation(user1_id, user2_id);
+    // Chat sends usually follow, so have them hit the cache
+    cache_.put(existing->id, *existing);
+    return existing;
 }
 
 std::optional<Conversation> ConversationRepository::findConversation(int user1_id, int user2_id) {
@@ -80,6 +86,10 @@ Conversation ConversationRepository::createConversation(int user1_id, int user2_
 }
 
 std::optional<Conversation> ConversationRepository::getById(int id) {
+    if (auto cached = cache_.get(id)) {
+        return cached;
+    }
+
     std::string query = "SELECT id, user1_id, user2_id, "
                        "EXTRACT(EPOCH FROM created_at)::bigint as created_at, "
                        "EXTRACT(EPOCH FROM last_message_at)::bigint as last_message_at "
@@ -99,6 +109,7 @@ std::optional<Conversation> ConversationRepository::getById(int id) {
         conv.user2_id = stmt.getInt(2);
         conv.created_at = stmt.getInt64(3);
         conv.last_message_at = stmt.getInt64(4);
+        cache_.put(conv.id, conv);
         return conv;
     }
     
@@ -108,21 +119,23 @@ std::optional<Conversation> ConversationRepository::getById(int id) {
 std::vector<Conversation> ConversationRepository::getUserConversations(int user_id) {
     std::vector<Conversation> conversations;
     
-    std::string query = "SELECT id, user1_id, user2_id, "
-                       "EXTRACT(EPOCH FROM created_at)::bigint as created_at, "
-                       "EXTRACT(EPOCH FROM last_message_at)::bigint as last_message_at "
-                       "FROM conversations "
-                       "WHERE user1_id = ? OR user2_id = ? "
-                       "ORDER BY last_message_at DESC";
+    // The inbox's (user_id, last_message_at) index instead of an OR over
+    // both participant columns
+    std::string query = "SELECT c.id, c.user1_id, c.user2_id, "
+                       "EXTRACT(EPOCH FROM c.created_at)::bigint as created_at, "
+                       "EXTRACT(EPOCH FROM c.last_message_at)::bigint as last_message_at "
+                       "FROM conversation_inbox i "
+                       "JOIN conversations c ON c.id = i.conversation_id "
+                       "WHERE i.user_id = ? "
+                       "ORDER BY i.last_message_at DESC, i.conversation_id DESC";
     
-    db::Statement stmt(*database_, query);
+    db::Statement stmt(*database_, query, db::Routing::ReadOnly);
     if (!stmt.isValid()) {
         std::cerr << "Failed to prepare get user conversations query" << std::endl;
         return conversations;
     }
     
     stmt.bindInt(1, user_id);
-    stmt.bindInt(2, user_id);
     
     while (stmt.step() == SQLITE_ROW) {
         Conversation conv;
@@ -137,6 +150,94 @@ std::vector<Conversation> ConversationRepository::getUserConversations(int user_
     return conversations;
 }
 
+std::vector<InboxEntry> ConversationRepository::getInbox(int user_id, int limit, long long before_at_us,
+                                                         int before_conversation_id) {
+    std::vector<InboxEntry> entries;
+    if (!database_ || !database_->isOpen()) {
+        return entries;
+    }
+
+    std::string query = "SELECT i.conversation_id, i.other_user_id, u.username, u.name, u.avatar_url, "
+                       "i.last_message_id, i.last_message_sender_id, i.last_message_preview, "
+                       "EXTRACT(EPOCH FROM i.last_message_at)::bigint, i.unread_count, "
+                       "(EXTRACT(EPOCH FROM i.last_message_at) * 1000000)::bigint "
+                       "FROM conversation_inbox i "
+                       "JOIN users u ON u.id = i.other_user_id "
+                       "WHERE i.user_id = ? "
+                       "AND (? <= 0 OR (i.last_message_at, i.conversation_id) < "
+                       "(TIMESTAMP 'epoch' + ?::bigint * INTERVAL '1 microsecond', ?)) "
+                       "ORDER BY i.last_message_at DESC, i.conversation_id DESC "
+                       "LIMIT ?";
+
+    db::Statement stmt(*database_, query, db::Routing::ReadOnly);
+    if (!stmt.isValid()) {
+        std::cerr << "Failed to prepare inbox query" << std::endl;
+        return entries;
+    }
+
+    stmt.bindInt(1, user_id);
+    stmt.bindInt(2, before_conversation_id);
+    stmt.bindText(3, std::to_string(before_at_us));
+    stmt.bindInt(4, before_conversation_id);
+    stmt.bindInt(5, limit);
+
+    while (stmt.step() == SQLITE_ROW) {
+        InboxEntry entry;
+        entry.conversation_id = stmt.getInt(0);
+        entry.other_user_id = stmt.getInt(1);
+        entry.other_username = stmt.getText(2);
+        if (!stmt.isNull(3)) {
+            entry.other_name = stmt.getText(3);
+        }
+        if (!stmt.isNull(4)) {
+            entry.other_avatar_url = stmt.getText(4);
+        }
+        if (!stmt.isNull(5)) {
+            entry.last_message_id = stmt.getInt(5);
+            entry.last_message_sender_id = stmt.getInt(6);
+            entry.last_message_preview = stmt.getText(7);
+        }
+        entry.last_message_at = stmt.getInt64(8);
+        entry.unread_count = stmt.getInt(9);
+        entry.last_message_at_us = stmt.getInt64(10);
+        entries.push_back(std::move(entry));
+    }
+
+    return entries;
+}
+
+int ConversationRepository::repairInbox() {
+    if (!database_ || !database_->isOpen()) {
+        return 0;
+    }
+
+    std::string query = "UPDATE conversation_inbox i SET "
+                       "unread_count = actual.unread_count, "
+                       "last_message_id = actual.last_id, "
+                       "last_message_sender_id = actual.last_sender_id, "
+                       "last_message_preview = LEFT(actual.last_content, 140), "
+                       "last_message_at = COALESCE(actual.last_created_at, i.last_message_at) "
+                       "FROM (SELECT i2.user_id, i2.conversation_id, "
+                       "(SELECT COUNT(*)::int FROM messages m WHERE m.conversation_id = i2.conversation_id "
+                       "AND m.sender_id <> i2.user_id AND m.read_at IS NULL) AS unread_count, "
+                       "latest.id AS last_id, latest.sender_id AS last_sender_id, "
+                       "latest.content AS last_content, latest.created_at AS last_created_at "
+                       "FROM conversation_inbox i2 "
+                       "LEFT JOIN LATERAL (SELECT m.id, m.sender_id, m.content, m.created_at FROM messages m "
+                       "WHERE m.conversation_id = i2.conversation_id ORDER BY m.id DESC LIMIT 1) latest ON true"
+                       ") actual "
+                       "WHERE i.user_id = actual.user_id AND i.conversation_id = actual.conversation_id "
+                       "AND (i.unread_count <> actual.unread_count "
+                       "OR i.last_message_id IS DISTINCT FROM actual.last_id)";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid() || stmt.step() == SQLITE_ERROR) {
+        return 0;
+    }
+
+    return static_cast<int>(stmt.affectedRows());
+}
+
 bool ConversationRepository::updateLastMessageTime(int conversation_id) {
     std::string query = "UPDATE conversations SET last_message_at = CURRENT_TIMESTAMP "
                        "WHERE id = ?";
@@ -147,7 +248,35 @@ bool ConversationRepository::updateLastMessageTime(int conversation_id) {
     }
     
     stmt.bindInt(1, conversation_id);
-    return stmt.step() == SQLITE_DONE;
+    if (stmt.step() != SQLITE_DONE) {
+        return false;
+    }
+    touchCached(conversation_id);
+    return true;
+}
+
+bool ConversationRepository::updateLastMessageTimes(const std::vector<int>& conversation_ids) {
+    if (conversation_ids.empty()) {
+        return true;
+    }
+    if (!database_ || !database_->isOpen()) {
+        return false;
+    }
+
+    db::Statement stmt(*database_, "UPDATE conversations SET last_message_at = CURRENT_TIMESTAMP "
+                                   "WHERE id = ANY(?::int[])");
+    if (!stmt.isValid()) {
+        return false;
+    }
+
+    stmt.bindIntArray(1, conversation_ids);
+    if (stmt.step() != SQLITE_DONE) {
+        return false;
+    }
+    for (int conversation_id : conversation_ids) {
+        touchCached(conversation_id);
+    }
+    return true;
 }
 
 bool ConversationRepository::deleteConversation(int conversation_id) {
@@ -159,7 +288,18 @@ bool ConversationRepository::deleteConversation(int conversation_id) {
     }
     
     stmt.bindInt(1, conversation_id);
-    return stmt.step() == SQLITE_DONE;
+    if (stmt.step() != SQLITE_DONE) {
+        return false;
+    }
+    cache_.erase(conversation_id);
+    return true;
+}
+
+void ConversationRepository::touchCached(int conversation_id) {
+    std::time_t now = std::time(nullptr);
+    cache_.update(conversation_id, [now](Conversation& conversation) {
+        conversation.last_message_at = now;
+    });
 }
 
 } // namespace repositories
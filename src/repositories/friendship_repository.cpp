@@ -297,5 +297,50 @@ std::vector<User> FriendshipRepository::getFriendsForUser(int user_id) {
     return friends;
 }
 
+std::vector<int> FriendshipRepository::getFriendIds(int user_id) {
+    std::vector<int> friend_ids;
+    if (!database_ || !database_->isOpen()) return friend_ids;
+
+    const std::string sql = R"(
+        SELECT CASE WHEN requester_id = ? THEN addressee_id ELSE requester_id END
+        FROM friendships
+        WHERE (requester_id = ? OR addressee_id = ?)
+          AND status = 'accepted'
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return friend_ids;
+
+    stmt.bindInt(1, user_id);
+    stmt.bindInt(2, user_id);
+    stmt.bindInt(3, user_id);
+
+    while (stmt.step() == SQLITE_ROW) {
+        friend_ids.push_back(stmt.getInt(0));
+    }
+
+    return friend_ids;
+}
+
+std::vector<std::pair<int, int>> FriendshipRepository::findAcceptedPairs() {
+    std::vector<std::pair<int, int>> pairs;
+    if (!database_ || !database_->isOpen()) return pairs;
+
+    const std::string sql = R"(
+        SELECT requester_id, addressee_id
+        FROM friendships
+        WHERE status = 'accepted'
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return pairs;
+
+    while (stmt.step() == SQLITE_ROW) {
+        pairs.emplace_back(stmt.getInt(0), stmt.getInt(1));
+    }
+
+    return pairs;
+}
+
 } // namespace repositories
 } // namespace sohbet
@@ -16,6 +16,9 @@ std::optional<Group> GroupRepository::create(Group& group) {
         RETURNING id
     )";
 
+    // The group and its admin membership are written together (a savepoint
+    // when the caller already has a unit of work open)
+    db::UnitOfWork unit(*database_);
     db::Statement stmt(*database_, sql);
     if (!stmt.isValid()) return std::nullopt;
 
@@ -33,11 +36,12 @@ std::optional<Group> GroupRepository::create(Group& group) {
         int group_id = stmt.getInt(0);
         group.setId(group_id);
 
-        // Call step() again to commit the transaction
         stmt.step();
 
         // Automatically add creator as admin member
-        addMember(group_id, group.getCreatorId(), "admin");
+        if (!addMember(group_id, group.getCreatorId(), "admin") || !unit.commit()) {
+            return std::nullopt;
+        }
 
         return group;
     }
@@ -284,6 +288,26 @@ bool GroupRepository::isMember(int group_id, int user_id) {
     return false;
 }
 
+std::vector<int> GroupRepository::getMemberIds(int group_id) {
+    std::vector<int> member_ids;
+    if (!database_ || !database_->isOpen()) return member_ids;
+
+    const std::string sql = R"(
+        SELECT user_id FROM group_members WHERE group_id = ?
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return member_ids;
+
+    stmt.bindInt(1, group_id);
+
+    while (stmt.step() == SQLITE_ROW) {
+        member_ids.push_back(stmt.getInt(0));
+    }
+
+    return member_ids;
+}
+
 std::string GroupRepository::getMemberRole(int group_id, int user_id) {
     if (!database_ || !database_->isOpen()) return "";
 
@@ -307,8 +331,9 @@ std::string GroupRepository::getMemberRole(int group_id, int user_id) {
 int GroupRepository::getMemberCount(int group_id) {
     if (!database_ || !database_->isOpen()) return 0;
 
+    // Maintained by the group_member_count_update trigger
     const std::string sql = R"(
-        SELECT COUNT(*) FROM group_members WHERE group_id = ?
+        SELECT member_count FROM groups WHERE id = ?
     )";
 
     db::Statement stmt(*database_, sql);
@@ -323,6 +348,49 @@ int GroupRepository::getMemberCount(int group_id) {
     return 0;
 }
 
+std::unordered_map<int, int> GroupRepository::getMemberCounts(const std::vector<int>& group_ids) {
+    std::unordered_map<int, int> counts;
+    if (!database_ || !database_->isOpen() || group_ids.empty()) return counts;
+
+    const std::string sql = R"(
+        SELECT id, member_count FROM groups
+        WHERE id = ANY(?::int[])
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return counts;
+
+    stmt.bindIntArray(1, group_ids);
+
+    while (stmt.step() == SQLITE_ROW) {
+        counts[stmt.getInt(0)] = stmt.getInt(1);
+    }
+
+    return counts;
+}
+
+std::unordered_map<int, std::string> GroupRepository::getMemberRoles(const std::vector<int>& group_ids, int user_id) {
+    std::unordered_map<int, std::string> roles;
+    if (!database_ || !database_->isOpen() || group_ids.empty()) return roles;
+
+    const std::string sql = R"(
+        SELECT group_id, role FROM group_members
+        WHERE group_id = ANY(?::int[]) AND user_id = ?
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return roles;
+
+    stmt.bindIntArray(1, group_ids);
+    stmt.bindInt(2, user_id);
+
+    while (stmt.step() == SQLITE_ROW) {
+        roles[stmt.getInt(0)] = stmt.getText(1);
+    }
+
+    return roles;
+}
+
 bool GroupRepository::canUserManage(int group_id, int user_id) {
     if (!database_ || !database_->isOpen()) return false;
 
@@ -347,5 +415,25 @@ bool GroupRepository::canUserManage(int group_id, int user_id) {
     return false;
 }
 
+int GroupRepository::repairMemberCounts() {
+    if (!database_ || !database_->isOpen()) return 0;
+
+    const std::string sql = R"(
+        UPDATE groups g SET member_count = actual.count
+        FROM (
+            SELECT g2.id, COUNT(gm.id)::int AS count
+            FROM groups g2
+            LEFT JOIN group_members gm ON gm.group_id = g2.id
+            GROUP BY g2.id
+        ) actual
+        WHERE g.id = actual.id AND g.member_count <> actual.count
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid() || stmt.step() == SQLITE_ERROR) return 0;
+
+    return static_cast<int>(stmt.affectedRows());
+}
+
 } // namespace repositories
 } // namespace sohbet
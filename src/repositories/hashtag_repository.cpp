@@ -97,7 +97,7 @@ std::vector<Hashtag> HashtagRepository::findTrending(int limit) {
         LIMIT ?
     )";
 
-    db::Statement stmt(*database_, sql);
+    db::Statement stmt(*database_, sql, db::Routing::ReadOnly);
     if (!stmt.isValid()) return hashtags;
 
     stmt.bindInt(1, limit);
@@ -213,6 +213,58 @@ bool HashtagRepository::unlinkFromPost(int hashtag_id, int post_id) {
     return stmt.step() == SQLITE_DONE;
 }
 
+std::vector<Hashtag> HashtagRepository::findAllUsage() {
+    std::vector<Hashtag> hashtags;
+    if (!database_ || !database_->isOpen()) return hashtags;
+
+    db::Statement stmt(*database_, "SELECT id, tag, usage_count FROM hashtags");
+    if (!stmt.isValid()) return hashtags;
+
+    while (stmt.step() == SQLITE_ROW) {
+        Hashtag hashtag;
+        hashtag.setId(stmt.getInt(0));
+        hashtag.setTag(stmt.getText(1));
+        hashtag.setUsageCount(stmt.getInt(2));
+        hashtags.push_back(hashtag);
+    }
+
+    return hashtags;
+}
+
+std::vector<HashtagUsage> HashtagRepository::findRecentUsage(int max_age_seconds) {
+    std::vector<HashtagUsage> usages;
+    if (!database_ || !database_->isOpen()) return usages;
+
+    // created_at is a local TIMESTAMP; the timestamptz cast reads it in the
+    // session time zone so the epoch matches the server clock
+    const std::string sql = R"(
+        SELECT h.tag, COALESCE(u.university, ''),
+               EXTRACT(EPOCH FROM ph.created_at::timestamptz)::float8
+        FROM post_hashtags ph
+        JOIN hashtags h ON h.id = ph.hashtag_id
+        JOIN posts p ON p.id = ph.post_id
+        LEFT JOIN users u ON p.author_type = 'user' AND u.id = p.author_id
+        WHERE p.visibility = 'public'
+          AND ph.created_at >= NOW() - make_interval(secs => ?)
+        ORDER BY ph.created_at
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return usages;
+
+    stmt.bindInt(1, max_age_seconds);
+
+    while (stmt.step() == SQLITE_ROW) {
+        HashtagUsage usage;
+        usage.tag = stmt.getText(0);
+        usage.university = stmt.getText(1);
+        usage.used_at = stmt.getDouble(2);
+        usages.push_back(std::move(usage));
+    }
+
+    return usages;
+}
+
 std::vector<Hashtag> HashtagRepository::findByPostId(int post_id) {
     std::vector<Hashtag> hashtags;
     if (!database_ || !database_->isOpen()) return hashtags;
@@ -251,10 +303,19 @@ std::vector<Hashtag> HashtagRepository::findOrCreateTags(const std::set<std::str
         if (existing.has_value()) {
             result.push_back(existing.value());
         } else {
+            // A concurrent insert of the same tag fails only this savepoint,
+            // not the caller's transaction; then the tag is read back
+            db::UnitOfWork savepoint(*database_);
             Hashtag new_hashtag(tag);
             auto created = create(new_hashtag);
-            if (created.has_value()) {
+            if (created.has_value() && savepoint.commit()) {
                 result.push_back(created.value());
+            } else {
+                savepoint.rollback();
+                auto winner = findByTag(tag);
+                if (winner.has_value()) {
+                    result.push_back(winner.value());
+                }
             }
         }
     }
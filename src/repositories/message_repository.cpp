@@ -41,6 +41,116 @@ std::optional<Message> MessageRepository::createMessage(int conversation_id, int
     return std::nullopt;
 }
 
+std::vector<int> MessageRepository::createMessagesBatch(const std::vector<Message>& messages) {
+    std::vector<int> ids;
+    if (messages.empty() || !database_ || !database_->isOpen()) {
+        return ids;
+    }
+
+    // RETURNING order is not guaranteed, so each row's id is drawn up front
+    // (in batch order) next to its position, and rows are matched back by it
+    std::string query =
+        "WITH batch AS ("
+        " SELECT ord, nextval(pg_get_serial_sequence('messages', 'id')) AS id,"
+        " conversation_id, sender_id, content, media_url"
+        " FROM (SELECT * FROM (VALUES ";
+    for (size_t i = 0; i < messages.size(); ++i) {
+        query += (i == 0 ? "" : ", ");
+        query += "(" + std::to_string(i) + ", ?::bigint, ?::bigint, ?::text, ?::text)";
+    }
+    query += ") AS input (ord, conversation_id, sender_id, content, media_url) ORDER BY ord) sorted"
+             "), inserted AS ("
+             " INSERT INTO messages (id, conversation_id, sender_id, content, media_url)"
+             " SELECT id, conversation_id, sender_id, content, media_url FROM batch"
+             " RETURNING id"
+             ") SELECT batch.ord, inserted.id FROM inserted JOIN batch ON batch.id = inserted.id";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid()) {
+        std::cerr << "Failed to prepare batch message insert" << std::endl;
+        return ids;
+    }
+
+    int index = 1;
+    for (const auto& message : messages) {
+        stmt.bindInt(index++, message.conversation_id);
+        stmt.bindInt(index++, message.sender_id);
+        stmt.bindText(index++, message.content);
+        message.media_url.empty() ? stmt.bindNull(index++) : stmt.bindText(index++, message.media_url);
+    }
+
+    ids.assign(messages.size(), 0);
+    size_t returned = 0;
+    int result;
+    while ((result = stmt.step()) == SQLITE_ROW) {
+        int ord = stmt.getInt(0);
+        if (ord >= 0 && static_cast<size_t>(ord) < ids.size() && ids[ord] == 0) {
+            ids[ord] = stmt.getInt(1);
+            ++returned;
+        }
+    }
+
+    if (result != SQLITE_DONE || returned != messages.size()) {
+        std::cerr << "Failed to create message batch" << std::endl;
+        ids.clear();
+    }
+    return ids;
+}
+
+std::vector<db::AsyncQuery> MessageRepository::sendMessageBatch(int conversation_id, int sender_id,
+                                                                const std::string& content,
+                                                                const std::string& media_url) {
+    std::vector<db::AsyncQuery> batch;
+    batch.push_back(db::AsyncQuery("SELECT user1_id, user2_id FROM conversations WHERE id = ?")
+                        .bindInt(conversation_id));
+
+    // The participant check is part of the insert, so it needs no round trip of its own
+    db::AsyncQuery insert(
+        "INSERT INTO messages (conversation_id, sender_id, content, media_url) "
+        "SELECT id, ?::int, ?::text, ?::text FROM conversations "
+        "WHERE id = ? AND (user1_id = ? OR user2_id = ?) "
+        "RETURNING id, conversation_id, sender_id, content, media_url, "
+        "EXTRACT(EPOCH FROM read_at)::bigint, "
+        "EXTRACT(EPOCH FROM delivered_at)::bigint, "
+        "EXTRACT(EPOCH FROM created_at)::bigint");
+    insert.bindInt(sender_id).bindText(content);
+    if (media_url.empty()) {
+        insert.bindNull();
+    } else {
+        insert.bindText(media_url);
+    }
+    insert.bindInt(conversation_id).bindInt(sender_id).bindInt(sender_id);
+    batch.push_back(std::move(insert));
+
+    batch.push_back(db::AsyncQuery("UPDATE conversations SET last_message_at = CURRENT_TIMESTAMP "
+                                   "WHERE id = ? AND (user1_id = ? OR user2_id = ?)")
+                        .bindInt(conversation_id).bindInt(sender_id).bindInt(sender_id));
+    return batch;
+}
+
+std::optional<Message> MessageRepository::messageFromResult(const db::QueryResult& result, size_t row) {
+    if (!result.ok() || row >= result.rowCount()) {
+        return std::nullopt;
+    }
+
+    Message msg;
+    msg.id = result.getInt(row, 0);
+    msg.conversation_id = result.getInt(row, 1);
+    msg.sender_id = result.getInt(row, 2);
+    msg.content = result.getText(row, 3);
+    msg.media_url = result.getText(row, 4);
+    msg.is_read_at_null = result.isNull(row, 5);
+    if (!msg.is_read_at_null) {
+        msg.read_at = result.getInt64(row, 5);
+    }
+    msg.is_delivered_at_null = result.isNull(row, 6);
+    if (!msg.is_delivered_at_null) {
+        msg.delivered_at = result.getInt64(row, 6);
+    }
+    msg.created_at = result.getInt64(row, 7);
+    return msg;
+}
+
 std::optional<Message> MessageRepository::getById(int id) {
     std::string query = "SELECT id, conversation_id, sender_id, content, media_url, "
                        "EXTRACT(EPOCH FROM read_at)::bigint as read_at, "
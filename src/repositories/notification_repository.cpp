@@ -53,6 +53,132 @@ std::optional<Notification> NotificationRepository::createNotification(
     return std::nullopt;
 }
 
+static void bindOptionalInt(db::Statement& stmt, int index, const std::optional<int>& value) {
+    value.has_value() ? stmt.bindInt(index, value.value()) : stmt.bindNull(index);
+}
+
+std::vector<Notification> NotificationRepository::createNotificationsBatch(
+    const std::vector<Notification>& notifications) {
+    std::vector<Notification> created;
+    if (notifications.empty() || !database_ || !database_->isOpen()) {
+        return created;
+    }
+
+    // RETURNING order is not guaranteed, so each row's id is drawn up front
+    // (in batch order) next to its position, and rows are matched back by it
+    const std::string columns = "user_id, type, title, message, "
+                                "related_user_id, related_post_id, related_comment_id, "
+                                "related_group_id, related_session_id, action_url";
+    std::string query =
+        "WITH batch AS ("
+        " SELECT ord, nextval(pg_get_serial_sequence('notifications', 'id')) AS id, " + columns +
+        " FROM (SELECT * FROM (VALUES ";
+    for (size_t i = 0; i < notifications.size(); ++i) {
+        query += (i == 0 ? "" : ", ");
+        query += "(" + std::to_string(i) + ", ?::bigint, ?::text, ?::text, ?::text, "
+                 "?::bigint, ?::bigint, ?::bigint, ?::bigint, ?::bigint, ?::text)";
+    }
+    query += ") AS input (ord, " + columns + ") ORDER BY ord) sorted"
+             "), inserted AS ("
+             " INSERT INTO notifications (id, " + columns + ")"
+             " SELECT id, " + columns + " FROM batch"
+             " RETURNING id, EXTRACT(EPOCH FROM created_at)::bigint AS created_at"
+             ") SELECT batch.ord, inserted.id, inserted.created_at"
+             " FROM inserted JOIN batch ON batch.id = inserted.id";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid()) {
+        std::cerr << "Failed to prepare batch notification insert" << std::endl;
+        return created;
+    }
+
+    int index = 1;
+    for (const auto& notif : notifications) {
+        stmt.bindInt(index++, notif.user_id);
+        stmt.bindText(index++, notif.type);
+        stmt.bindText(index++, notif.title);
+        stmt.bindText(index++, notif.message);
+        bindOptionalInt(stmt, index++, notif.related_user_id);
+        bindOptionalInt(stmt, index++, notif.related_post_id);
+        bindOptionalInt(stmt, index++, notif.related_comment_id);
+        bindOptionalInt(stmt, index++, notif.related_group_id);
+        bindOptionalInt(stmt, index++, notif.related_session_id);
+        notif.action_url.empty() ? stmt.bindNull(index++) : stmt.bindText(index++, notif.action_url);
+    }
+
+    created = notifications;
+    std::vector<bool> matched(notifications.size(), false);
+    size_t returned = 0;
+    int result;
+    while ((result = stmt.step()) == SQLITE_ROW) {
+        int ord = stmt.getInt(0);
+        if (ord < 0 || static_cast<size_t>(ord) >= created.size() || matched[ord]) {
+            continue;
+        }
+        Notification& notif = created[ord];
+        notif.id = stmt.getInt(1);
+        notif.created_at = stmt.getInt64(2);
+        notif.is_read = false;
+        matched[ord] = true;
+        ++returned;
+    }
+
+    if (result != SQLITE_DONE || returned != notifications.size()) {
+        std::cerr << "Failed to create notification batch" << std::endl;
+        created.clear();
+    }
+    return created;
+}
+
+std::vector<Notification> NotificationRepository::fanOutNotification(const std::vector<int>& user_ids,
+                                                                      const Notification& notification) {
+    std::vector<Notification> created;
+    if (user_ids.empty() || !database_ || !database_->isOpen()) {
+        return created;
+    }
+
+    std::string query = "INSERT INTO notifications (user_id, type, title, message, "
+                       "related_user_id, related_post_id, related_comment_id, "
+                       "related_group_id, related_session_id, action_url) "
+                       "SELECT recipient, ?, ?, ?, ?, ?, ?, ?, ?, ? "
+                       "FROM unnest(?::int[]) AS recipient "
+                       "RETURNING id, user_id, EXTRACT(EPOCH FROM created_at)::bigint";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid()) {
+        std::cerr << "Failed to prepare notification fan-out" << std::endl;
+        return created;
+    }
+
+    stmt.bindText(1, notification.type);
+    stmt.bindText(2, notification.title);
+    stmt.bindText(3, notification.message);
+    bindOptionalInt(stmt, 4, notification.related_user_id);
+    bindOptionalInt(stmt, 5, notification.related_post_id);
+    bindOptionalInt(stmt, 6, notification.related_comment_id);
+    bindOptionalInt(stmt, 7, notification.related_group_id);
+    bindOptionalInt(stmt, 8, notification.related_session_id);
+    notification.action_url.empty() ? stmt.bindNull(9) : stmt.bindText(9, notification.action_url);
+    stmt.bindIntArray(10, user_ids);
+
+    created.reserve(user_ids.size());
+    int rc;
+    while ((rc = stmt.step()) == SQLITE_ROW) {
+        Notification notif = notification;
+        notif.id = stmt.getInt(0);
+        notif.user_id = stmt.getInt(1);
+        notif.created_at = stmt.getInt64(2);
+        notif.is_read = false;
+        created.push_back(std::move(notif));
+    }
+
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Failed to fan out notification" << std::endl;
+        created.clear();
+    }
+    return created;
+}
+
 std::optional<Notification> NotificationRepository::getById(int id) {
     std::string query = "SELECT id, user_id, type, title, message, "
                        "related_user_id, related_post_id, related_comment_id, "
@@ -164,7 +290,7 @@ std::vector<Notification> NotificationRepository::getUnreadNotifications(int use
                        "EXTRACT(EPOCH FROM created_at)::bigint as created_at, "
                        "EXTRACT(EPOCH FROM read_at)::bigint as read_at "
                        "FROM notifications "
-                       "WHERE user_id = ? AND is_read = 0 "
+                       "WHERE user_id = ? AND is_read = FALSE "
                        "ORDER BY created_at DESC "
                        "LIMIT ?";
 
@@ -209,7 +335,8 @@ std::vector<Notification> NotificationRepository::getUnreadNotifications(int use
 }
 
 int NotificationRepository::getUnreadCount(int user_id) {
-    std::string query = "SELECT COUNT(*) FROM notifications WHERE user_id = ? AND is_read = 0";
+    // Maintained by the unread_notification_count_update trigger
+    std::string query = "SELECT unread_notification_count FROM users WHERE id = ?";
 
     db::Statement stmt(*database_, query);
     if (!stmt.isValid()) {
@@ -226,7 +353,7 @@ int NotificationRepository::getUnreadCount(int user_id) {
 }
 
 bool NotificationRepository::markAsRead(int notification_id) {
-    std::string query = "UPDATE notifications SET is_read = 1, read_at = CURRENT_TIMESTAMP "
+    std::string query = "UPDATE notifications SET is_read = TRUE, read_at = CURRENT_TIMESTAMP "
                        "WHERE id = ?";
 
     db::Statement stmt(*database_, query);
@@ -240,8 +367,8 @@ bool NotificationRepository::markAsRead(int notification_id) {
 }
 
 bool NotificationRepository::markAllAsRead(int user_id) {
-    std::string query = "UPDATE notifications SET is_read = 1, read_at = CURRENT_TIMESTAMP "
-                       "WHERE user_id = ? AND is_read = 0";
+    std::string query = "UPDATE notifications SET is_read = TRUE, read_at = CURRENT_TIMESTAMP "
+                       "WHERE user_id = ? AND is_read = FALSE";
 
     db::Statement stmt(*database_, query);
     if (!stmt.isValid()) {
@@ -279,5 +406,20 @@ bool NotificationRepository::deleteAllForUser(int user_id) {
     return stmt.step() == SQLITE_DONE;
 }
 
+int NotificationRepository::repairUnreadCounts() {
+    std::string query = "UPDATE users u SET unread_notification_count = actual.count "
+                       "FROM (SELECT u2.id, COUNT(n.id)::int AS count FROM users u2 "
+                       "LEFT JOIN notifications n ON n.user_id = u2.id AND n.is_read IS NOT TRUE "
+                       "GROUP BY u2.id) actual "
+                       "WHERE u.id = actual.id AND u.unread_notification_count <> actual.count";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid() || stmt.step() == SQLITE_ERROR) {
+        return 0;
+    }
+
+    return static_cast<int>(stmt.affectedRows());
+}
+
 } // namespace repositories
 } // namespace sohbet
@@ -5,7 +5,10 @@ namespace sohbet {
 namespace repositories {
 
 PostRepository::PostRepository(std::shared_ptr<db::Database> database)
-    : database_(database) {}
+    : database_(database),
+      reaction_counts_("post_reactions", [this](const utils::CounterCache::Deltas& deltas) {
+          return applyReactionDeltas(deltas);
+      }) {}
 
 std::optional<Post> PostRepository::create(Post& post) {
     if (!database_ || !database_->isOpen()) return std::nullopt;
@@ -48,6 +51,26 @@ std::optional<Post> PostRepository::create(Post& post) {
     return std::nullopt;
 }
 
+// Columns: id, author_id, author_type, content, media_urls, visibility,
+//          group_id, created_at, updated_at
+static Post postFromRow(db::Statement& stmt) {
+    Post post;
+    post.setId(stmt.getInt(0));
+    post.setAuthorId(stmt.getInt(1));
+    post.setAuthorType(stmt.getText(2));
+    post.setContent(stmt.getText(3));
+    if (!stmt.isNull(4)) {
+        post.setMediaUrls(stmt.getText(4));
+    }
+    post.setVisibility(stmt.getText(5));
+    if (!stmt.isNull(6)) {
+        post.setGroupId(stmt.getInt(6));
+    }
+    post.setCreatedAt(stmt.getText(7));
+    post.setUpdatedAt(stmt.getText(8));
+    return post;
+}
+
 std::optional<Post> PostRepository::findById(int id) {
     if (!database_ || !database_->isOpen()) return std::nullopt;
 
@@ -63,26 +86,34 @@ std::optional<Post> PostRepository::findById(int id) {
     stmt.bindInt(1, id);
 
     if (stmt.step() == SQLITE_ROW) {
-        Post post;
-        post.setId(stmt.getInt(0));
-        post.setAuthorId(stmt.getInt(1));
-        post.setAuthorType(stmt.getText(2));
-        post.setContent(stmt.getText(3));
-        if (!stmt.isNull(4)) {
-            post.setMediaUrls(stmt.getText(4));
-        }
-        post.setVisibility(stmt.getText(5));
-        if (!stmt.isNull(6)) {
-            post.setGroupId(stmt.getInt(6));
-        }
-        post.setCreatedAt(stmt.getText(7));
-        post.setUpdatedAt(stmt.getText(8));
-        return post;
+        return postFromRow(stmt);
     }
 
     return std::nullopt;
 }
 
+std::vector<Post> PostRepository::findByIds(const std::vector<int>& ids) {
+    std::vector<Post> posts;
+    if (!database_ || !database_->isOpen() || ids.empty()) return posts;
+
+    const std::string sql = R"(
+        SELECT id, author_id, author_type, content, media_urls, visibility,
+               group_id, created_at, updated_at
+        FROM posts WHERE id = ANY(?::int[])
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return posts;
+
+    stmt.bindIntArray(1, ids);
+
+    while (stmt.step() == SQLITE_ROW) {
+        posts.push_back(postFromRow(stmt));
+    }
+
+    return posts;
+}
+
 std::vector<Post> PostRepository::findByAuthor(int author_id, int limit, int offset) {
     std::vector<Post> posts;
     if (!database_ || !database_->isOpen()) return posts;
@@ -160,7 +191,7 @@ std::vector<Post> PostRepository::findFeedForUser(int user_id, int limit, int of
         LIMIT ? OFFSET ?
     )";
 
-    db::Statement stmt(*database_, sql);
+    db::Statement stmt(*database_, sql, db::Routing::ReadOnly);
     if (!stmt.isValid()) return posts;
 
     stmt.bindInt(1, user_id);
@@ -316,7 +347,88 @@ bool PostRepository::canUserViewPost(int post_id, int viewer_id) {
     return false;
 }
 
+std::vector<PostSearchResult> PostRepository::search(const std::string& query, int viewer_id, int limit,
+                                                     double after_rank, int after_id) {
+    std::vector<PostSearchResult> results;
+    if (!database_ || !database_->isOpen() || query.empty()) return results;
+
+    // The GIN index on content_tsv answers the @@ match; ts_headline is the
+    // expensive part, so it only runs for the rows on this page. Content is
+    // HTML-escaped first so <mark> is the only markup in the excerpt.
+    std::string sql = R"(
+        WITH q AS (SELECT websearch_to_tsquery('english', ?) AS query)
+        SELECT hits.id, hits.author_id, hits.author_type, hits.content, hits.media_urls,
+               hits.visibility, hits.group_id, hits.created_at, hits.updated_at,
+               u.username, u.name, u.avatar_url, hits.rank,
+               ts_headline('english',
+                           replace(replace(replace(hits.content, '&', '&amp;'), '<', '&lt;'), '>', '&gt;'),
+                           q.query,
+                           'StartSel=<mark>, StopSel=</mark>, MaxFragments=2, MaxWords=20, MinWords=5')
+        FROM (
+            SELECT p.id, p.author_id, p.author_type, p.content, p.media_urls, p.visibility,
+                   p.group_id, p.created_at, p.updated_at,
+                   ts_rank(p.content_tsv, q.query) AS rank
+            FROM posts p, q
+            WHERE p.content_tsv @@ q.query
+              AND (
+                  p.visibility = 'public' OR
+                  p.author_id = ? OR
+                  (p.visibility = 'friends' AND EXISTS (
+                      SELECT 1 FROM friendships f
+                      WHERE f.status = 'accepted'
+                        AND ((f.requester_id = p.author_id AND f.addressee_id = ?) OR
+                             (f.addressee_id = p.author_id AND f.requester_id = ?))
+                  ))
+              )
+        ) hits
+        CROSS JOIN q
+        LEFT JOIN users u ON u.id = hits.author_id
+    )";
+    if (after_id > 0) {
+        sql += " WHERE (hits.rank, hits.id) < (?::real, ?)";
+    }
+    sql += " ORDER BY hits.rank DESC, hits.id DESC LIMIT ?";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return results;
+
+    int index = 1;
+    stmt.bindText(index++, query);
+    stmt.bindInt(index++, viewer_id);
+    stmt.bindInt(index++, viewer_id);
+    stmt.bindInt(index++, viewer_id);
+    if (after_id > 0) {
+        stmt.bindDouble(index++, after_rank);
+        stmt.bindInt(index++, after_id);
+    }
+    stmt.bindInt(index++, limit);
+
+    while (stmt.step() == SQLITE_ROW) {
+        PostSearchResult result;
+        result.post = postFromRow(stmt);
+        if (!stmt.isNull(9)) {
+            result.post.setAuthorUsername(stmt.getText(9));
+        }
+        if (!stmt.isNull(10)) {
+            result.post.setAuthorName(stmt.getText(10));
+        }
+        if (!stmt.isNull(11)) {
+            result.post.setAuthorAvatarUrl(stmt.getText(11));
+        }
+        result.rank = stmt.getDouble(12);
+        result.headline = stmt.getText(13);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+void PostRepository::setFriendCheck(std::function<bool(int, int)> check) {
+    friend_check_ = std::move(check);
+}
+
 bool PostRepository::areFriends(int user1_id, int user2_id) {
+    if (friend_check_) return friend_check_(user1_id, user2_id);
     if (!database_ || !database_->isOpen()) return false;
 
     const std::string sql = R"(
@@ -341,14 +453,30 @@ bool PostRepository::areFriends(int user1_id, int user2_id) {
     return false;
 }
 
-bool PostRepository::addReaction(int post_id, int user_id, const std::string& reaction_type) {
+std::optional<int> PostRepository::findUserAuthorId(int post_id) {
+    if (!database_ || !database_->isOpen()) return std::nullopt;
+
+    db::Statement stmt(*database_, "SELECT author_id FROM posts WHERE id = ? AND author_type = 'user'");
+    if (!stmt.isValid()) return std::nullopt;
+
+    stmt.bindInt(1, post_id);
+    if (stmt.step() == SQLITE_ROW) {
+        return stmt.getInt(0);
+    }
+    return std::nullopt;
+}
+
+bool PostRepository::addReaction(int post_id, int user_id, const std::string& reaction_type, bool* inserted) {
     if (!database_ || !database_->isOpen()) return false;
 
+    // Re-reacting is a no-op, so only a new row moves the counter
     const std::string sql = R"(
-        INSERT OR REPLACE INTO post_reactions (post_id, user_id, reaction_type)
+        INSERT INTO post_reactions (post_id, user_id, reaction_type)
         VALUES (?, ?, ?)
+        ON CONFLICT (post_id, user_id, reaction_type) DO NOTHING
     )";
 
+    std::shared_lock<std::shared_mutex> gate(reaction_write_gate_);
     db::Statement stmt(*database_, sql);
     if (!stmt.isValid()) return false;
 
@@ -356,7 +484,12 @@ bool PostRepository::addReaction(int post_id, int user_id, const std::string& re
     stmt.bindInt(2, user_id);
     stmt.bindText(3, reaction_type);
 
-    return stmt.step() == SQLITE_DONE;
+    if (stmt.step() != SQLITE_DONE) return false;
+    reaction_counts_.add(post_id, static_cast<int64_t>(stmt.affectedRows()));
+    if (inserted) {
+        *inserted = stmt.affectedRows() > 0;
+    }
+    return true;
 }
 
 bool PostRepository::removeReaction(int post_id, int user_id, const std::string& reaction_type) {
@@ -367,6 +500,7 @@ bool PostRepository::removeReaction(int post_id, int user_id, const std::string&
         WHERE post_id = ? AND user_id = ? AND reaction_type = ?
     )";
 
+    std::shared_lock<std::shared_mutex> gate(reaction_write_gate_);
     db::Statement stmt(*database_, sql);
     if (!stmt.isValid()) return false;
 
@@ -374,32 +508,105 @@ bool PostRepository::removeReaction(int post_id, int user_id, const std::string&
     stmt.bindInt(2, user_id);
     stmt.bindText(3, reaction_type);
 
-    return stmt.step() == SQLITE_DONE;
+    if (stmt.step() != SQLITE_DONE) return false;
+    reaction_counts_.add(post_id, -static_cast<int64_t>(stmt.affectedRows()));
+    return true;
 }
 
 int PostRepository::getReactionCount(int post_id, const std::string& reaction_type) {
     if (!database_ || !database_->isOpen()) return 0;
 
-    std::string sql = "SELECT COUNT(*) FROM post_reactions WHERE post_id = ?";
-    
+    // Per-type counts are rare; only the total is materialized
     if (!reaction_type.empty()) {
-        sql += " AND reaction_type = ?";
+        const std::string sql = "SELECT COUNT(*) FROM post_reactions WHERE post_id = ? AND reaction_type = ?";
+
+        db::Statement stmt(*database_, sql);
+        if (!stmt.isValid()) return 0;
+
+        stmt.bindInt(1, post_id);
+        stmt.bindText(2, reaction_type);
+
+        if (stmt.step() == SQLITE_ROW) {
+            return stmt.getInt(0);
+        }
+        return 0;
     }
 
+    const std::string sql = "SELECT reaction_count FROM posts WHERE id = ?";
+
     db::Statement stmt(*database_, sql);
     if (!stmt.isValid()) return 0;
 
     stmt.bindInt(1, post_id);
-    if (!reaction_type.empty()) {
-        stmt.bindText(2, reaction_type);
-    }
 
     if (stmt.step() == SQLITE_ROW) {
-        return stmt.getInt(0);
+        return static_cast<int>(stmt.getInt(0) + reaction_counts_.pending(post_id));
     }
 
     return 0;
 }
 
+size_t PostRepository::flushReactionCounts() {
+    return reaction_counts_.flush();
+}
+
+bool PostRepository::applyReactionDeltas(const utils::CounterCache::Deltas& deltas) {
+    if (!database_ || !database_->isOpen()) return false;
+
+    std::vector<int> post_ids;
+    std::vector<int> amounts;
+    post_ids.reserve(deltas.size());
+    amounts.reserve(deltas.size());
+    for (const auto& entry : deltas) {
+        post_ids.push_back(entry.first);
+        amounts.push_back(static_cast<int>(entry.second));
+    }
+
+    const std::string sql = R"(
+        UPDATE posts p SET reaction_count = GREATEST(p.reaction_count + d.delta, 0)
+        FROM unnest(?::int[], ?::int[]) AS d(id, delta)
+        WHERE p.id = d.id
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return false;
+
+    stmt.bindIntArray(1, post_ids);
+    stmt.bindIntArray(2, amounts);
+
+    return stmt.step() == SQLITE_DONE;
+}
+
+int PostRepository::repairReactionCounts() {
+    if (!database_ || !database_->isOpen()) return 0;
+
+    // With reaction writes held off, every committed reaction's delta is
+    // recorded, so after the flush nothing is pending and the recount below
+    // already includes every row. If the flush failed, the deltas are still
+    // pending and the recount would count them twice: skip this pass.
+    std::unique_lock<std::shared_mutex> gate(reaction_write_gate_);
+    flushReactionCounts();
+    if (reaction_counts_.pendingKeys() > 0) {
+        std::cerr << "Reaction count flush failed; skipping repair" << std::endl;
+        return 0;
+    }
+
+    const std::string sql = R"(
+        UPDATE posts p SET reaction_count = actual.count
+        FROM (
+            SELECT p2.id, COUNT(pr.id)::int AS count
+            FROM posts p2
+            LEFT JOIN post_reactions pr ON pr.post_id = p2.id
+            GROUP BY p2.id
+        ) actual
+        WHERE p.id = actual.id AND p.reaction_count <> actual.count
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid() || stmt.step() == SQLITE_ERROR) return 0;
+
+    return static_cast<int>(stmt.affectedRows());
+}
+
 } // namespace repositories
 } // namespace sohbet
@@ -112,7 +112,7 @@ std::vector<StudyPreferences> StudyPreferencesRepository::findAllActive() {
         FROM study_preferences WHERE is_active = 1
     )";
 
-    db::Statement stmt(*database_, sql);
+    db::Statement stmt(*database_, sql, db::Routing::ReadOnly);
     if (!stmt.isValid()) return result;
 
     while (stmt.step() == SQLITE_ROW) {
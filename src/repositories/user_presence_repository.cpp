@@ -181,5 +181,84 @@ bool UserPresenceRepository::setOffline(int user_id) {
     return stmt.step() == SQLITE_DONE;
 }
 
+std::vector<UserPresence> UserPresenceRepository::findAll() {
+    std::vector<UserPresence> presences;
+    if (!database_ || !database_->isOpen()) {
+        return presences;
+    }
+
+    std::string query = "SELECT id, user_id, status, custom_status, "
+                       "EXTRACT(EPOCH FROM last_seen)::bigint as last_seen, "
+                       "EXTRACT(EPOCH FROM updated_at)::bigint as updated_at "
+                       "FROM user_presence";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid()) {
+        return presences;
+    }
+
+    while (stmt.step() == SQLITE_ROW) {
+        UserPresence presence;
+        presence.id = stmt.getInt(0);
+        presence.user_id = stmt.getInt(1);
+        presence.status = stmt.getText(2);
+
+        if (!stmt.isNull(3)) {
+            presence.custom_status = stmt.getText(3);
+        }
+
+        presence.last_seen = stmt.isNull(4) ? 0 : stmt.getInt64(4);
+        presence.updated_at = stmt.isNull(5) ? 0 : stmt.getInt64(5);
+
+        presences.push_back(presence);
+    }
+
+    return presences;
+}
+
+bool UserPresenceRepository::upsertBatch(const std::vector<UserPresence>& presences) {
+    if (presences.empty()) {
+        return true;
+    }
+    if (!database_ || !database_->isOpen()) {
+        return false;
+    }
+
+    // Timestamps are epoch seconds; 'epoch' + interval matches the
+    // EXTRACT(EPOCH FROM ...) used to read them back
+    std::string query = "INSERT INTO user_presence (user_id, status, custom_status, last_seen, updated_at) VALUES ";
+    for (size_t i = 0; i < presences.size(); ++i) {
+        query += (i == 0 ? "" : ", ");
+        query += "(?, ?, ?, TIMESTAMP 'epoch' + ?::bigint * INTERVAL '1 second', "
+                 "TIMESTAMP 'epoch' + ?::bigint * INTERVAL '1 second')";
+    }
+    query += " ON CONFLICT(user_id) DO UPDATE SET "
+             "status = excluded.status, "
+             "custom_status = excluded.custom_status, "
+             "last_seen = excluded.last_seen, "
+             "updated_at = excluded.updated_at";
+
+    db::Statement stmt(*database_, query);
+    if (!stmt.isValid()) {
+        std::cerr << "Failed to prepare batch presence upsert" << std::endl;
+        return false;
+    }
+
+    int index = 1;
+    for (const auto& presence : presences) {
+        stmt.bindInt(index++, presence.user_id);
+        stmt.bindText(index++, presence.status);
+        presence.custom_status.empty() ? stmt.bindNull(index++) : stmt.bindText(index++, presence.custom_status);
+        stmt.bindText(index++, std::to_string(static_cast<long long>(presence.last_seen)));
+        stmt.bindText(index++, std::to_string(static_cast<long long>(presence.updated_at)));
+    }
+
+    if (stmt.step() != SQLITE_DONE) {
+        std::cerr << "Failed to upsert presence batch" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 } // namespace repositories
 } // namespace sohbet
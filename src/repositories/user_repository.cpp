@@ -2,12 +2,16 @@
 #include "utils/hash.h"
 #include <sstream>
 #include <iostream>
+#include <unordered_set>
 
 namespace sohbet {
 namespace repositories {
 
-UserRepository::UserRepository(std::shared_ptr<db::Database> database)
-    : database_(database) {}
+UserRepository::UserRepository(std::shared_ptr<db::Database> database, size_t cache_capacity,
+                               std::chrono::milliseconds cache_ttl)
+    : database_(database),
+      users_(cache_capacity, cache_ttl, "users"),
+      username_ids_(cache_capacity, cache_ttl, "usernames") {}
 
 // Run migrations (create users table)
 bool UserRepository::migrate() {
@@ -93,18 +97,42 @@ std::optional<User> UserRepository::create(User& user, const std::string& passwo
 std::optional<User> UserRepository::findByUsername(const std::string& username) {
     if (!database_ || !database_->isOpen()) return std::nullopt;
 
+    if (inUnitOfWork()) return loadByUsername(username);
+
+    std::optional<User> loaded;
+    auto id = username_ids_.getOrLoad(username, [this, &loaded](const std::string& name) -> std::optional<int> {
+        loaded = loadByUsername(name);
+        if (!loaded.has_value()) return std::nullopt;
+        return loaded->getId();
+    });
+    if (!id.has_value()) return std::nullopt;
+    if (loaded.has_value()) return loaded;
+
+    auto user = findById(*id);
+    if (!user.has_value() || user->getUsername() != username) {
+        // Gone or renamed since the id was cached
+        username_ids_.invalidate(username);
+        return std::nullopt;
+    }
+    return user;
+}
+
+// Find user by email
+std::optional<User> UserRepository::findByEmail(const std::string& email) {
+    if (!database_ || !database_->isOpen()) return std::nullopt;
+
     const std::string sql = R"(
         SELECT id, username, email, password_hash, name, position, phone_number,
-               university, department, enrollment_year, warnings, 
+               university, department, enrollment_year, warnings,
                primary_language, additional_languages, role, avatar_url, banner_url, created_at,
                COALESCE(email_verified, 0) as email_verified
-        FROM users WHERE username = ?
+        FROM users WHERE email = ?
     )";
 
     db::Statement stmt(*database_, sql);
     if (!stmt.isValid()) return std::nullopt;
 
-    stmt.bindText(1, username);
+    stmt.bindText(1, email);
     if (stmt.step() == SQLITE_ROW) {
         return userFromStatement(stmt);
     }
@@ -112,22 +140,35 @@ std::optional<User> UserRepository::findByUsername(const std::string& username)
     return std::nullopt;
 }
 
-// Find user by email
-std::optional<User> UserRepository::findByEmail(const std::string& email) {
+// Find user by ID
+std::optional<User> UserRepository::findById(int id) {
     if (!database_ || !database_->isOpen()) return std::nullopt;
+    if (inUnitOfWork()) return loadById(id);
+    return users_.getOrLoad(id, [this](int key) { return loadById(key); });
+}
 
+bool UserRepository::inUnitOfWork() const {
+    // The unit's thread holds the connection until it commits: joining a
+    // load led by another thread would wait on it forever, and leading one
+    // could cache rows that are then rolled back
+    return db::UnitOfWork::current(*database_) != nullptr;
+}
+
+std::optional<User> UserRepository::loadByUsername(const std::string& username) {
     const std::string sql = R"(
         SELECT id, username, email, password_hash, name, position, phone_number,
                university, department, enrollment_year, warnings,
                primary_language, additional_languages, role, avatar_url, banner_url, created_at,
                COALESCE(email_verified, 0) as email_verified
-        FROM users WHERE email = ?
+        FROM users WHERE username = ?
     )";
 
-    db::Statement stmt(*database_, sql);
+    // Cache fills read the primary: a lagging replica would otherwise put a
+    // row back that an invalidation just removed, for the whole TTL
+    db::Statement stmt(*database_, sql, db::Routing::Primary);
     if (!stmt.isValid()) return std::nullopt;
 
-    stmt.bindText(1, email);
+    stmt.bindText(1, username);
     if (stmt.step() == SQLITE_ROW) {
         return userFromStatement(stmt);
     }
@@ -135,18 +176,17 @@ std::optional<User> UserRepository::findByEmail(const std::string& email) {
     return std::nullopt;
 }
 
-// Find user by ID
-std::optional<User> UserRepository::findById(int id) {
-    if (!database_ || !database_->isOpen()) return std::nullopt;
-
+std::optional<User> UserRepository::loadById(int id) {
     const std::string sql = R"(
         SELECT id, username, email, password_hash, name, position, phone_number,
                university, department, enrollment_year, warnings,
-               primary_language, additional_languages, role, avatar_url, banner_url, created_at
+               primary_language, additional_languages, role, avatar_url, banner_url, created_at,
+               COALESCE(email_verified, 0) as email_verified
         FROM users WHERE id = ?
     )";
 
-    db::Statement stmt(*database_, sql);
+    // Primary for the same reason as loadByUsername
+    db::Statement stmt(*database_, sql, db::Routing::Primary);
     if (!stmt.isValid()) return std::nullopt;
 
     stmt.bindInt(1, id);
@@ -157,6 +197,91 @@ std::optional<User> UserRepository::findById(int id) {
     return std::nullopt;
 }
 
+std::vector<User> UserRepository::findByIds(const std::vector<int>& ids) {
+    std::vector<User> users;
+    if (!database_ || !database_->isOpen() || ids.empty()) return users;
+
+    const bool cached_reads = !inUnitOfWork();
+    const uint64_t stamp = users_.stamp();
+    std::vector<int> missing;
+    std::unordered_set<int> seen;
+    for (int id : ids) {
+        if (!seen.insert(id).second) continue;
+        if (!cached_reads) {
+            missing.push_back(id);
+        } else if (auto cached = users_.get(id)) {
+            users.push_back(std::move(*cached));
+        } else {
+            missing.push_back(id);
+        }
+    }
+    if (missing.empty()) return users;
+
+    const std::string sql = R"(
+        SELECT id, username, email, password_hash, name, position, phone_number,
+               university, department, enrollment_year, warnings,
+               primary_language, additional_languages, role, avatar_url, banner_url, created_at,
+               COALESCE(email_verified, 0) as email_verified
+        FROM users WHERE id = ANY(?::int[])
+    )";
+
+    db::Statement stmt(*database_, sql, db::Routing::Primary);
+    if (!stmt.isValid()) return users;
+
+    stmt.bindIntArray(1, missing);
+    while (stmt.step() == SQLITE_ROW) {
+        User user = userFromStatement(stmt);
+        if (cached_reads) {
+            users_.fill(user.getId().value(), user, stamp);
+        }
+        users.push_back(std::move(user));
+    }
+
+    return users;
+}
+
+std::vector<UserSearchResult> UserRepository::search(const std::string& query, int limit,
+                                                     double after_rank, int after_id) {
+    std::vector<UserSearchResult> results;
+    if (!database_ || !database_->isOpen() || query.empty()) return results;
+
+    std::string sql = R"(
+        SELECT * FROM (
+            SELECT u.id, u.username, u.email, u.password_hash, u.name, u.position, u.phone_number,
+                   u.university, u.department, u.enrollment_year, u.warnings,
+                   u.primary_language, u.additional_languages, u.role, u.avatar_url, u.banner_url,
+                   u.created_at, COALESCE(u.email_verified, 0) AS email_verified,
+                   ts_rank(u.search_tsv, q.query) AS rank
+            FROM users u, websearch_to_tsquery('english', ?) q(query)
+            WHERE u.search_tsv @@ q.query
+        ) hits
+    )";
+    if (after_id > 0) {
+        sql += " WHERE (hits.rank, hits.id) < (?::real, ?)";
+    }
+    sql += " ORDER BY hits.rank DESC, hits.id DESC LIMIT ?";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return results;
+
+    int index = 1;
+    stmt.bindText(index++, query);
+    if (after_id > 0) {
+        stmt.bindDouble(index++, after_rank);
+        stmt.bindInt(index++, after_id);
+    }
+    stmt.bindInt(index++, limit);
+
+    while (stmt.step() == SQLITE_ROW) {
+        UserSearchResult result;
+        result.user = userFromStatement(stmt);
+        result.rank = stmt.getDouble(18);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
 // Check if username exists
 bool UserRepository::usernameExists(const std::string& username) {
     return findByUsername(username).has_value();
@@ -211,6 +336,39 @@ int UserRepository::countAll() {
     return 0;
 }
 
+std::vector<UsernamePopularity> UserRepository::findAllUsernamePopularity() {
+    std::vector<UsernamePopularity> users;
+    if (!database_ || !database_->isOpen()) return users;
+
+    // Each accepted friendship counts once for both sides
+    const std::string sql = R"(
+        SELECT u.id, u.username, COALESCE(f.friend_count, 0)
+        FROM users u
+        LEFT JOIN (
+            SELECT user_id, COUNT(*) AS friend_count
+            FROM (
+                SELECT requester_id AS user_id FROM friendships WHERE status = 'accepted'
+                UNION ALL
+                SELECT addressee_id FROM friendships WHERE status = 'accepted'
+            ) sides
+            GROUP BY user_id
+        ) f ON f.user_id = u.id
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return users;
+
+    while (stmt.step() == SQLITE_ROW) {
+        UsernamePopularity row;
+        row.id = stmt.getInt(0);
+        row.username = stmt.getText(1);
+        row.friend_count = stmt.getInt(2);
+        users.push_back(std::move(row));
+    }
+
+    return users;
+}
+
 // Update user profile
 bool UserRepository::update(const User& user) {
     if (!database_ || !database_->isOpen()) return false;
@@ -239,7 +397,10 @@ bool UserRepository::update(const User& user) {
     stmt.bindText(7, user.getPrimaryLanguage().value_or(""));
     stmt.bindInt(8, user.getId().value());
 
-    return stmt.step() == SQLITE_DONE;
+    if (stmt.step() != SQLITE_DONE) return false;
+
+    invalidate(user.getId().value());
+    return true;
 }
 
 // Update user password
@@ -262,6 +423,7 @@ bool UserRepository::updatePassword(int userId, const std::string& newPassword)
     if (stmt.step() != SQLITE_DONE) {
         return false;
     }
+    invalidate(userId);
 
     // Verify that exactly one row was updated
     size_t changes = stmt.affectedRows();
@@ -276,6 +438,10 @@ bool UserRepository::updatePassword(int userId, const std::string& newPassword)
     return true;
 }
 
+void UserRepository::invalidate(int id) {
+    users_.invalidate(id);
+}
+
 // Build User object from a DB row
 User UserRepository::userFromStatement(db::Statement& stmt) {
     User user;
@@ -258,9 +258,9 @@ bool VoiceChannelRepository::endSession(int session_id) {
 int VoiceChannelRepository::getActiveUserCount(int channel_id) {
     if (!database_ || !database_->isOpen()) return 0;
 
+    // Maintained by the voice_active_user_count_update trigger
     const std::string sql = R"(
-        SELECT COUNT(*) FROM voice_sessions
-        WHERE channel_id = ? AND left_at IS NULL
+        SELECT active_user_count FROM voice_channels WHERE id = ?
     )";
 
     db::Statement stmt(*database_, sql);
@@ -275,6 +275,27 @@ int VoiceChannelRepository::getActiveUserCount(int channel_id) {
     return 0;
 }
 
+std::unordered_map<int, int> VoiceChannelRepository::getActiveUserCounts(const std::vector<int>& channel_ids) {
+    std::unordered_map<int, int> counts;
+    if (!database_ || !database_->isOpen() || channel_ids.empty()) return counts;
+
+    const std::string sql = R"(
+        SELECT id, active_user_count FROM voice_channels
+        WHERE id = ANY(?::int[])
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return counts;
+
+    stmt.bindIntArray(1, channel_ids);
+
+    while (stmt.step() == SQLITE_ROW) {
+        counts[stmt.getInt(0)] = stmt.getInt(1);
+    }
+
+    return counts;
+}
+
 std::vector<int> VoiceChannelRepository::getActiveUsers(int channel_id) {
     std::vector<int> user_ids;
     if (!database_ || !database_->isOpen()) return user_ids;
@@ -342,6 +363,53 @@ int VoiceChannelRepository::endAllUserSessions(int user_id) {
     return 0;
 }
 
+int VoiceChannelRepository::endUserSessionsBatch(const std::vector<int>& user_ids,
+                                                 const std::vector<int>& ended_at) {
+    if (!database_ || !database_->isOpen()) return -1;
+    if (user_ids.empty() || user_ids.size() != ended_at.size()) return 0;
+
+    const std::string sql = R"(
+        UPDATE voice_sessions vs
+        SET left_at = CURRENT_TIMESTAMP
+        FROM unnest(?::int[], ?::int[]) AS d(user_id, ended_at)
+        WHERE vs.user_id = d.user_id
+          AND vs.left_at IS NULL
+          AND vs.joined_at <= to_timestamp(d.ended_at)
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return -1;
+
+    stmt.bindIntArray(1, user_ids);
+    stmt.bindIntArray(2, ended_at);
+
+    if (stmt.step() == SQLITE_DONE) {
+        return static_cast<int>(stmt.affectedRows());
+    }
+
+    return -1;
+}
+
+std::unordered_map<int, std::vector<int>> VoiceChannelRepository::getAllActiveUsers() {
+    std::unordered_map<int, std::vector<int>> users_by_channel;
+    if (!database_ || !database_->isOpen()) return users_by_channel;
+
+    const std::string sql = R"(
+        SELECT channel_id, user_id FROM voice_sessions
+        WHERE left_at IS NULL
+        ORDER BY joined_at ASC
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return users_by_channel;
+
+    while (stmt.step() == SQLITE_ROW) {
+        users_by_channel[stmt.getInt(0)].push_back(stmt.getInt(1));
+    }
+
+    return users_by_channel;
+}
+
 std::vector<int> VoiceChannelRepository::findEmptyInactiveChannels(int inactivity_minutes) {
     std::vector<int> channel_ids;
     if (!database_ || !database_->isOpen()) return channel_ids;
@@ -378,5 +446,49 @@ std::vector<int> VoiceChannelRepository::findEmptyInactiveChannels(int inactivit
     return channel_ids;
 }
 
+std::vector<int> VoiceChannelRepository::deleteEmptyChannels(const std::vector<int>& channel_ids) {
+    std::vector<int> deleted;
+    if (!database_ || !database_->isOpen() || channel_ids.empty()) return deleted;
+
+    // active_user_count is kept by trigger, so a rejoin that raced the
+    // expiry keeps the channel alive
+    const std::string sql = R"(
+        DELETE FROM voice_channels
+        WHERE id = ANY(?::int[]) AND active_user_count = 0
+        RETURNING id
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid()) return deleted;
+
+    stmt.bindIntArray(1, channel_ids);
+
+    while (stmt.step() == SQLITE_ROW) {
+        deleted.push_back(stmt.getInt(0));
+    }
+
+    return deleted;
+}
+
+int VoiceChannelRepository::repairActiveUserCounts() {
+    if (!database_ || !database_->isOpen()) return 0;
+
+    const std::string sql = R"(
+        UPDATE voice_channels vc SET active_user_count = actual.count
+        FROM (
+            SELECT c.id, COUNT(vs.id)::int AS count
+            FROM voice_channels c
+            LEFT JOIN voice_sessions vs ON vs.channel_id = c.id AND vs.left_at IS NULL
+            GROUP BY c.id
+        ) actual
+        WHERE vc.id = actual.id AND vc.active_user_count <> actual.count
+    )";
+
+    db::Statement stmt(*database_, sql);
+    if (!stmt.isValid() || stmt.step() == SQLITE_ERROR) return 0;
+
+    return static_cast<int>(stmt.affectedRows());
+}
+
 } // namespace repositories
 } // namespace sohbet
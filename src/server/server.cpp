@@ -12,66 +12,67 @@
 #include "utils/multipart_parser.h"
 #include "utils/text_parser.h"
 #include "utils/logger.h"
+#include "utils/json_writer.h"
+#include "utils/json_parser.h"
+#include "utils/metrics.h"
+#include "utils/compression.h"
+#include "utils/batch_loader.h"
 #include <iostream>
 #include <fstream>
 #include <regex>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <cctype>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <signal.h>
 #include <chrono>
+#include <algorithm>
+#include <unordered_map>
 
 namespace sohbet {
 namespace server {
 
-// Helper function to escape JSON strings
-static std::string escapeJsonString(const std::string& input) {
-    std::ostringstream output;
-    for (char c : input) {
-        switch (c) {
-            case '"':  output << "\\\""; break;
-            case '\\': output << "\\\\"; break;
-            case '\b': output << "\\b"; break;
-            case '\f': output << "\\f"; break;
-            case '\n': output << "\\n"; break;
-            case '\r': output << "\\r"; break;
-            case '\t': output << "\\t"; break;
-            default:
-                // Escape control characters
-                if (c < 0x20) {
-                    output << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                } else {
-                    output << c;
-                }
-                break;
-        }
-    }
-    return output.str();
-}
+// A voice channel is deleted once it has been empty this long
+static const std::chrono::minutes VOICE_CHANNEL_IDLE_TIMEOUT(30);
 
 AcademicSocialServer::AcademicSocialServer(int port, const std::string& connection_string)
     : port_(port), connection_string_(connection_string), running_(false), server_socket_(-1) {
 }
 
 bool AcademicSocialServer::initialize() {
-    database_ = std::make_shared<db::Database>(connection_string_);
+    database_ = std::make_shared<db::Database>(connection_string_, config::get_database_replica_urls());
     if (!database_->isOpen()) {
         std::cerr << "Failed to open database with connection string" << std::endl;
         return false;
     }
+    database_->setMaxReplicaLag(std::chrono::milliseconds(config::get_replica_max_lag_ms()));
+    if (database_->replicaCount() > 0) {
+        std::cout << "[CONFIG] Read replicas: " << database_->replicaCount() << std::endl;
+    }
+
+    async_db_ = std::make_unique<db::AsyncClient>(connection_string_, config::get_db_async_connections());
+    if (!async_db_->start()) {
+        LOG_WARN("Async database client unavailable; chat sends use blocking statements");
+        async_db_.reset();
+    }
 
-    user_repository_ = std::make_shared<repositories::UserRepository>(database_);
+    user_repository_ = std::make_shared<repositories::UserRepository>(
+        database_, config::get_user_cache_size(), std::chrono::seconds(config::get_user_cache_ttl_seconds()));
     media_repository_ = std::make_shared<repositories::MediaRepository>(database_);
     friendship_repository_ = std::make_shared<repositories::FriendshipRepository>(database_);
     post_repository_ = std::make_shared<repositories::PostRepository>(database_);
+    post_repository_->setFriendCheck([this](int user1_id, int user2_id) {
+        return social_graph_.areFriends(user1_id, user2_id);
+    });
     comment_repository_ = std::make_shared<repositories::CommentRepository>(database_);
     group_repository_ = std::make_shared<repositories::GroupRepository>(database_);
     organization_repository_ = std::make_shared<repositories::OrganizationRepository>(database_);
     role_repository_ = std::make_shared<repositories::RoleRepository>(database_);
-    conversation_repository_ = std::make_shared<repositories::ConversationRepository>(database_);
+    conversation_repository_ = std::make_shared<repositories::ConversationRepository>(
+        database_, config::get_conversation_cache_size());
     message_repository_ = std::make_shared<repositories::MessageRepository>(database_);
     voice_channel_repository_ = std::make_shared<repositories::VoiceChannelRepository>(database_);
     notification_repository_ = std::make_shared<repositories::NotificationRepository>(database_);
@@ -109,6 +110,42 @@ bool AcademicSocialServer::initialize() {
     websocket_server_ = std::make_shared<WebSocketServer>(ws_port);
     setupWebSocketHandlers();
 
+    notification_dispatcher_ = std::make_unique<services::NotificationDispatcher>(
+        [this](const std::vector<Notification>& notifications) {
+            return notification_repository_->createNotificationsBatch(notifications);
+        },
+        [this](const std::vector<int>& user_ids, const Notification& notification) {
+            return notification_repository_->fanOutNotification(user_ids, notification);
+        },
+        [this](const std::vector<Notification>& notifications) {
+            deliverNotifications(notifications);
+        });
+
+    presence_tracker_ = std::make_unique<services::PresenceTracker>(
+        [this](const std::vector<UserPresence>& rows) {
+            return user_presence_repository_->upsertBatch(rows);
+        });
+
+    chat_ingest_queue_ = std::make_unique<services::ChatIngestQueue>(
+        [this](const std::vector<Message>& messages, const std::vector<int>& conversation_ids) {
+            db::UnitOfWork unit(*database_);
+            std::vector<int> ids = message_repository_->createMessagesBatch(messages);
+            if (ids.empty() || !conversation_repository_->updateLastMessageTimes(conversation_ids) ||
+                !unit.commit()) {
+                return std::vector<int>();
+            }
+            // The batch ran outside any sender's SessionScope
+            for (const auto& message : messages) {
+                database_->recordWriteBy(message.sender_id);
+            }
+            return ids;
+        },
+        [this](const services::QueuedMessage& queued, bool persisted) {
+            acknowledgeChatMessage(queued, persisted);
+        },
+        std::chrono::milliseconds(config::get_chat_commit_linger_ms()));
+    chat_ingest_queue_->start();
+
     if (!user_repository_->migrate()) {
         std::cerr << "Failed to run database migrations" << std::endl;
         return false;
@@ -163,10 +200,87 @@ bool AcademicSocialServer::initialize() {
         }
     }
 
+    // Run materialized counters migration if needed
+    const std::string counters_migration_path = "migrations/006_materialized_counters.sql";
+    std::ifstream counters_migration_file(counters_migration_path);
+    if (counters_migration_file.is_open()) {
+        std::stringstream buffer;
+        buffer << counters_migration_file.rdbuf();
+        std::string migration_sql = buffer.str();
+        counters_migration_file.close();
+
+        if (!database_->execute(migration_sql)) {
+            std::cerr << "Warning: Materialized counters migration failed (may already be applied)" << std::endl;
+        } else {
+            std::cout << "Materialized counters migration applied successfully" << std::endl;
+        }
+    }
+
+    // Run notification fan-out migration if needed (after 006, whose trigger it replaces)
+    const std::string fanout_migration_path = "migrations/007_notification_fanout.sql";
+    std::ifstream fanout_migration_file(fanout_migration_path);
+    if (fanout_migration_file.is_open()) {
+        std::stringstream buffer;
+        buffer << fanout_migration_file.rdbuf();
+        std::string migration_sql = buffer.str();
+        fanout_migration_file.close();
+
+        if (!database_->execute(migration_sql)) {
+            std::cerr << "Warning: Notification fan-out migration failed (may already be applied)" << std::endl;
+        } else {
+            std::cout << "Notification fan-out migration applied successfully" << std::endl;
+        }
+    }
+
+    // Run comment thread index migration if needed
+    const std::string comment_threads_migration_path = "migrations/008_comment_threads.sql";
+    std::ifstream comment_threads_migration_file(comment_threads_migration_path);
+    if (comment_threads_migration_file.is_open()) {
+        std::stringstream buffer;
+        buffer << comment_threads_migration_file.rdbuf();
+        std::string migration_sql = buffer.str();
+        comment_threads_migration_file.close();
+
+        if (!database_->execute(migration_sql)) {
+            std::cerr << "Warning: Comment threads migration failed (may already be applied)" << std::endl;
+        } else {
+            std::cout << "Comment threads migration applied successfully" << std::endl;
+        }
+    }
+
+    // Run conversation inbox migration if needed
+    const std::string inbox_migration_path = "migrations/009_conversation_inbox.sql";
+    std::ifstream inbox_migration_file(inbox_migration_path);
+    if (inbox_migration_file.is_open()) {
+        std::stringstream buffer;
+        buffer << inbox_migration_file.rdbuf();
+        std::string migration_sql = buffer.str();
+        inbox_migration_file.close();
+
+        if (!database_->execute(migration_sql)) {
+            std::cerr << "Warning: Conversation inbox migration failed (may already be applied)" << std::endl;
+        } else {
+            std::cout << "Conversation inbox migration applied successfully" << std::endl;
+        }
+    }
+
+    // Backfill counter columns and correct any drift from a previous run
+    repairCounters();
+
+    // Rebuild live voice rooms from sessions left open by a previous run
+    for (const auto& [channel_id, user_ids] : voice_channel_repository_->getAllActiveUsers()) {
+        voice_rooms_.merge(channel_id, user_ids);
+    }
+
     // Ensure demo users exist for demo/testing purposes
     ensureDemoUserExists();
     ensureSecondDemoUserExists();
 
+    loadAutocompleteIndexes();
+    loadTrendingHashtags();
+    loadPresence();
+    loadSocialGraph();
+
     std::cout << "Server initialized successfully" << std::endl;
     return true;
 }
@@ -181,8 +295,8 @@ bool AcademicSocialServer::start() {
         return false;
     }
 
-    // Start WebSocket server only if on a different port
-    // When on the same port, WebSocket connections would need to be handled via HTTP upgrade
+    // Start a separate WebSocket listener only if on a different port.
+    // On a shared port, handleClient hands Upgrade requests to the WebSocket server.
     int ws_port = config::get_websocket_port();
     if (ws_port != port_) {
         std::cout << "[WebSocket] Starting on separate port: " << ws_port << std::endl;
@@ -192,13 +306,15 @@ bool AcademicSocialServer::start() {
         }
     } else {
         std::cout << "[WebSocket] Shared port mode detected (port " << port_ << ")" << std::endl;
-        std::cout << "[WebSocket] ⚠️  WebSocket functionality temporarily disabled in shared port mode" << std::endl;
-        std::cout << "[WebSocket] TODO: Implement WebSocket upgrade handling in HTTP server" << std::endl;
+        websocket_server_->startShared();
+        shared_websocket_port_ = true;
     }
 
-    // Start voice channel cleanup task
-    cleanup_running_ = true;
-    voice_cleanup_thread_ = std::thread(&AcademicSocialServer::runVoiceChannelCleanup, this);
+    // Start background jobs (voice reaper, batched flushes, counter repair)
+    scheduleBackgroundJobs();
+    scheduler_.start();
+    maintenance_.start();
+    replica_monitor_.start();
 
     running_ = true;
     std::cout << "🌐 HTTP Server listening on http://0.0.0.0:" << port_ << std::endl;
@@ -238,10 +354,25 @@ bool AcademicSocialServer::start() {
 void AcademicSocialServer::stop() {
     running_ = false;
 
-    // Stop voice channel cleanup task
-    cleanup_running_ = false;
-    if (voice_cleanup_thread_.joinable()) {
-        voice_cleanup_thread_.join();
+    // Stop background jobs, then write out what they had batched
+    replica_monitor_.stop();
+    maintenance_.stop();
+    scheduler_.stop();
+    flushVoiceSessionEnds();
+    if (post_repository_) {
+        post_repository_->flushReactionCounts();
+    }
+    if (notification_dispatcher_) {
+        notification_dispatcher_->flush(true);
+    }
+    if (presence_tracker_) {
+        presence_tracker_->flush();
+    }
+    if (chat_ingest_queue_) {
+        chat_ingest_queue_->stop();
+    }
+    if (async_db_) {
+        async_db_->stop();
     }
 
     // Stop WebSocket server
@@ -295,127 +426,166 @@ bool AcademicSocialServer::initializeSocket() {
     return true;
 }
 
+// Case-insensitive "Upgrade: websocket" check
+static bool isWebSocketUpgrade(const HttpRequest& request) {
+    if (request.method != "GET") {
+        return false;
+    }
+    auto upgrade = request.headers.get("Upgrade");
+    if (!upgrade.has_value()) {
+        return false;
+    }
+    std::string value(upgrade.value());
+    for (char& c : value) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return value.find("websocket") != std::string::npos;
+}
+
+// Reply to a request that could not be read or parsed, then close
+static void sendErrorAndClose(int client_socket, int status_code, const char* reason, const std::string& message) {
+    std::string body = "{\"error\":\"" + message + "\"}";
+    std::string response = "HTTP/1.1 " + std::to_string(status_code) + " " + reason + "\r\n"
+                           "Content-Type: application/json\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+    send(client_socket, response.data(), response.size(), 0);
+    close(client_socket);
+}
+
 void AcademicSocialServer::handleClient(int client_socket) {
-    const int INITIAL_BUFFER_SIZE = 8192;
+    const size_t INITIAL_BUFFER_SIZE = 8192;
+    const size_t MAX_HEADER_SIZE = 64 * 1024;
     const size_t MAX_REQUEST_SIZE = 10 * 1024 * 1024; // 10MB max request size
-    std::vector<char> buffer(INITIAL_BUFFER_SIZE);
-    std::string raw_request;
-    
+
     // Set socket timeout to prevent indefinite blocking
     struct timeval timeout;
     timeout.tv_sec = 30;  // 30 second timeout
     timeout.tv_usec = 0;
     setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    
-    // Read request data
-    ssize_t total_bytes = 0;
-    ssize_t bytes_read;
-    bool headers_found = false;
-    size_t headers_end = 0;
-    
-    while ((bytes_read = recv(client_socket, buffer.data() + total_bytes, 
-                               buffer.size() - total_bytes, 0)) > 0) {
-        total_bytes += bytes_read;
-        
-        // Only search for headers if we haven't found them yet
-        if (!headers_found) {
-            // Use string_view-like approach to avoid creating new strings
-            const char* data_ptr = buffer.data();
-            for (size_t i = 0; i + 3 < static_cast<size_t>(total_bytes); ++i) {
-                if (data_ptr[i] == '\r' && data_ptr[i+1] == '\n' && 
-                    data_ptr[i+2] == '\r' && data_ptr[i+3] == '\n') {
-                    headers_end = i;
-                    headers_found = true;
-                    break;
-                }
-            }
+
+    // The request is read into one buffer; the parsed head (method, target,
+    // headers) is string_views into it rather than copies
+    auto buffer = std::make_shared<std::string>(INITIAL_BUFFER_SIZE, '\0');
+    size_t received = 0;
+    utils::HttpRequestHead head;
+
+    while (true) {
+        if (received == buffer->size()) {
+            const char* old_base = buffer->data();
+            buffer->resize(buffer->size() * 2);
+            head.rebase(old_base, buffer->data());
         }
-        
-        if (headers_found) {
-            // Parse headers to get Content-Length
-            std::string headers_section(buffer.data(), headers_end);
-            std::istringstream header_stream(headers_section);
-            std::string line;
-            size_t content_length = 0;
-            bool has_content_length = false;
-            
-            while (std::getline(header_stream, line)) {
-                if (line.find("Content-Length:") == 0) {
-                    std::string length_str = line.substr(15);
-                    // Trim whitespace
-                    length_str.erase(0, length_str.find_first_not_of(" \t\r\n"));
-                    length_str.erase(length_str.find_last_not_of(" \t\r\n") + 1);
-                    
-                    try {
-                        content_length = std::stoull(length_str);
-                        has_content_length = true;
-                    } catch (const std::exception&) {
-                        // Invalid Content-Length, close connection
-                        close(client_socket);
-                        return;
-                    }
-                    break;
-                }
-            }
-            
-            if (has_content_length) {
-                size_t expected_total = headers_end + 4 + content_length; // +4 for \r\n\r\n
-                
-                // Enforce maximum request size
-                if (expected_total > MAX_REQUEST_SIZE) {
-                    // Send 413 Payload Too Large
-                    std::string error_response = 
-                        "HTTP/1.1 413 Payload Too Large\r\n"
-                        "Content-Type: application/json\r\n"
-                        "Content-Length: 38\r\n"
-                        "Connection: close\r\n\r\n"
-                        "{\"error\":\"Request too large (max 10MB)\"}";
-                    send(client_socket, error_response.c_str(), error_response.length(), 0);
-                    close(client_socket);
-                    return;
-                }
-                
-                // Resize buffer if needed
-                if (expected_total > buffer.size()) {
-                    buffer.resize(expected_total);
-                }
-                
-           // Keep reading until we have all the data
-          while (total_bytes < static_cast<ssize_t>(expected_total)) {
-            bytes_read = recv(client_socket, buffer.data() + total_bytes,
-                     expected_total - total_bytes, 0);
-        if (bytes_read < 0) {
-            std::cerr << "recv() error: " << strerror(errno) << std::endl;
-        break;
+        ssize_t bytes_read = recv(client_socket, &(*buffer)[received], buffer->size() - received, 0);
+        if (bytes_read <= 0) {
+            close(client_socket);
+            return;
+        }
+        size_t previous = received;
+        received += static_cast<size_t>(bytes_read);
+
+        auto status = utils::parseHttpRequestHead(std::string_view(buffer->data(), received), head, previous);
+        if (status == utils::HttpParseStatus::Complete) {
+            break;
+        }
+        if (status == utils::HttpParseStatus::Invalid) {
+            sendErrorAndClose(client_socket, 400, "Bad Request", "Malformed request");
+            return;
+        }
+        if (received >= MAX_HEADER_SIZE) {
+            sendErrorAndClose(client_socket, 431, "Request Header Fields Too Large", "Request headers too large");
+            return;
         }
-        if (bytes_read == 0) break; // EOF
-            total_bytes += bytes_read;
+    }
+
+    // Body: chunked transfer coding or Content-Length; neither means none.
+    // Any other Transfer-Encoding cannot be framed, and falling back to
+    // Content-Length would let a proxy and this server disagree on where
+    // the request ends
+    bool chunked = false;
+    if (!head.transferEncoding(chunked)) {
+        sendErrorAndClose(client_socket, 400, "Bad Request", "Unsupported Transfer-Encoding");
+        return;
+    }
+    std::string body;
+    size_t extra_start = head.length;
+    if (chunked) {
+        // The size limit counts bytes on the wire, not decoded ones: chunk
+        // framing, extensions and trailers decode to nothing
+        utils::HttpChunkedDecoder decoder;
+        std::string_view input(buffer->data() + head.length, received - head.length);
+        std::vector<char> chunk_buffer(INITIAL_BUFFER_SIZE);
+        size_t wire_bytes = received;
+        while (true) {
+            auto status = decoder.feed(input, body);
+            if (status == utils::HttpParseStatus::Complete) {
+                break;
+            }
+            if (status == utils::HttpParseStatus::Invalid) {
+                sendErrorAndClose(client_socket, 400, "Bad Request", "Malformed chunked body");
+                return;
+            }
+            if (wire_bytes > MAX_REQUEST_SIZE) {
+                sendErrorAndClose(client_socket, 413, "Payload Too Large", "Request too large (max 10MB)");
+                return;
+            }
+            ssize_t bytes_read = recv(client_socket, chunk_buffer.data(), chunk_buffer.size(), 0);
+            if (bytes_read <= 0) {
+                close(client_socket);
+                return;
             }
+            wire_bytes += static_cast<size_t>(bytes_read);
+            input = std::string_view(chunk_buffer.data(), static_cast<size_t>(bytes_read));
         }
-            
-            break; // We have the full request
+        extra_start = received;
+    } else {
+        size_t content_length = 0;
+        if (!head.contentLength(content_length)) {
+            sendErrorAndClose(client_socket, 400, "Bad Request", "Invalid Content-Length");
+            return;
         }
-        
-        // Expand buffer if needed, but enforce max size
-        if (total_bytes >= static_cast<ssize_t>(buffer.size())) {
-            if (buffer.size() * 2 > MAX_REQUEST_SIZE) {
+        size_t expected_total = head.length + content_length;
+        if (expected_total > MAX_REQUEST_SIZE) {
+            sendErrorAndClose(client_socket, 413, "Payload Too Large", "Request too large (max 10MB)");
+            return;
+        }
+        if (expected_total > buffer->size()) {
+            const char* old_base = buffer->data();
+            buffer->resize(expected_total);
+            head.rebase(old_base, buffer->data());
+        }
+        while (received < expected_total) {
+            ssize_t bytes_read = recv(client_socket, &(*buffer)[received], expected_total - received, 0);
+            if (bytes_read <= 0) {
+                if (bytes_read < 0) {
+                    std::cerr << "recv() error: " << strerror(errno) << std::endl;
+                }
                 close(client_socket);
                 return;
             }
-            buffer.resize(buffer.size() * 2);
+            received += static_cast<size_t>(bytes_read);
         }
+        body.assign(buffer->data() + head.length, content_length);
+        extra_start = expected_total;
     }
-    
-    if (total_bytes <= 0) {
-        close(client_socket);
+
+    HttpRequest request(std::string(head.method), std::string(head.target), "");
+    request.body = std::move(body);
+    request.headers = head.headers;
+    request.buffer = buffer;
+
+    // On a shared port, hand WebSocket upgrades over on the same socket
+    if (shared_websocket_port_ && isWebSocketUpgrade(request)) {
+        // The 30s receive timeout is for HTTP requests; WebSocket clients idle
+        struct timeval no_timeout = {0, 0};
+        setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &no_timeout, sizeof(no_timeout));
+
+        // Bytes after the head are the client's first frames
+        websocket_server_->adoptConnection(client_socket, std::string(buffer->data(), head.length),
+                                           std::string(buffer->data() + extra_start, received - extra_start));
         return;
     }
-    
-    raw_request = std::string(buffer.data(), total_bytes);
-    
-    // Parse HTTP request
-    HttpRequest request = parseHttpRequest(raw_request);
-    
+
     // Handle request
     HttpResponse response = handleRequest(request);
 
@@ -430,64 +600,6 @@ void AcademicSocialServer::handleClient(int client_socket) {
     close(client_socket);
 }
 
-HttpRequest AcademicSocialServer::parseHttpRequest(const std::string& raw_request) {
-    size_t headers_end = raw_request.find("\r\n\r\n");
-    if (headers_end == std::string::npos) {
-        std::cerr << "  WARNING: No \\r\\n\\r\\n found!" << std::endl;
-    }
-    
-    std::istringstream stream(raw_request);
-    std::string line;
-    
-    // Parse request line (GET /path HTTP/1.1)
-    std::getline(stream, line);
-    std::istringstream request_line(line);
-    std::string method, path, version;
-    request_line >> method >> path >> version;
-
-    HttpRequest request(method, path, "");
-    
-    // Parse headers
-    bool headers_done = false;
-    int header_count = 0;
-    while (std::getline(stream, line)) {
-        if (line == "\r" || line.empty()) {
-            headers_done = true;
-            break;
-        }
-        
-        // Remove \r if present
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-
-        // Parse header (Name: Value)
-        size_t colon_pos = line.find(':');
-        if (colon_pos != std::string::npos) {
-            std::string header_name = line.substr(0, colon_pos);
-            std::string header_value = line.substr(colon_pos + 1);
-
-            // Trim whitespace from value
-            size_t start = header_value.find_first_not_of(" \t");
-            if (start != std::string::npos) {
-                header_value = header_value.substr(start);
-            }
-
-            request.headers[header_name] = header_value;
-        }
-    }
-    
-    // Read body if present
-    if (headers_done) {
-        std::string remaining;
-        while (std::getline(stream, line)) {
-            request.body += line + "\n";
-        }
-    }
-    
-    return request;
-}
-
 // Helper function to validate and sanitize Origin header
 static bool isValidOrigin(const std::string& origin) {
     // Validate that the origin matches a proper URL format
@@ -497,6 +609,31 @@ static bool isValidOrigin(const std::string& origin) {
     return std::regex_match(origin, origin_regex);
 }
 
+// Compression series are resolved once per thread, like the route series in
+// handleRequest, so a compressed response does no registry lookup
+static void recordCompression(utils::ContentEncoding encoding, size_t saved_bytes) {
+    struct CompressionMetrics {
+        utils::Counter* responses[3] = {nullptr, nullptr, nullptr};   // By ContentEncoding
+        utils::Counter* saved_bytes = nullptr;
+    };
+    thread_local CompressionMetrics series;
+
+    size_t index = static_cast<size_t>(encoding);
+    if (index >= 3) return;
+    auto& metrics = utils::MetricsRegistry::getInstance();
+    if (series.responses[index] == nullptr) {
+        series.responses[index] = &metrics.counter("sohbet_http_compressed_responses_total",
+                                                   "HTTP responses sent compressed",
+                                                   {{"encoding", utils::contentEncodingName(encoding)}});
+    }
+    if (series.saved_bytes == nullptr) {
+        series.saved_bytes = &metrics.counter("sohbet_http_compression_saved_bytes_total",
+                                              "Response bytes saved by compression");
+    }
+    series.responses[index]->inc();
+    series.saved_bytes->inc(saved_bytes);
+}
+
 std::string AcademicSocialServer::formatHttpResponse(const HttpResponse& response, const HttpRequest& request) {
     std::ostringstream oss;
     oss << "HTTP/1.1 " << response.status_code << " ";
@@ -515,14 +652,37 @@ std::string AcademicSocialServer::formatHttpResponse(const HttpResponse& respons
     
     oss << "\r\n";
     oss << "Content-Type: " << response.content_type << "\r\n";
-    oss << "Content-Length: " << response.body.length() << "\r\n";
+
+    // Negotiate compression for text-like bodies above the size threshold
+    const std::string* body = &response.body;
+    std::string compressed_body;
+    bool compressible = response.status_code != 204 && utils::isCompressibleContentType(response.content_type);
+    if (compressible && response.body.size() >= config::get_compression_min_bytes()) {
+        auto accept_encoding = request.headers.get("Accept-Encoding");
+        utils::ContentEncoding encoding = accept_encoding.has_value()
+            ? utils::negotiateEncoding(accept_encoding.value())
+            : utils::ContentEncoding::Identity;
+        if (utils::ResponseCompressor::getInstance().compress(response.body, encoding, compressed_body) &&
+            compressed_body.size() < response.body.size()) {
+            body = &compressed_body;
+            oss << "Content-Encoding: " << utils::contentEncodingName(encoding) << "\r\n";
+
+            recordCompression(encoding, response.body.size() - compressed_body.size());
+        }
+    }
+    if (compressible) {
+        // Caches must key on Accept-Encoding even when this reply went uncompressed
+        oss << "Vary: Accept-Encoding\r\n";
+    }
+
+    oss << "Content-Length: " << body->length() << "\r\n";
     
     // CORS headers - allow ALL origins by echoing the Origin header
     // Validate the origin to prevent header injection attacks
     std::string cors_origin = "*";
-    auto origin_it = request.headers.find("Origin");
-    if (origin_it != request.headers.end() && isValidOrigin(origin_it->second)) {
-        cors_origin = origin_it->second;
+    auto origin = request.headers.get("Origin");
+    if (origin.has_value() && isValidOrigin(std::string(origin.value()))) {
+        cors_origin = std::string(origin.value());
     }
     
     oss << "Access-Control-Allow-Origin: " << cors_origin << "\r\n";
@@ -536,14 +696,73 @@ std::string AcademicSocialServer::formatHttpResponse(const HttpResponse& respons
     
     oss << "Connection: close\r\n";
     oss << "\r\n";
-    oss << response.body;
+    oss << *body;
     
     return oss.str();
 }
 
+// Method label for metrics; anything else a client sends is "other"
+static const char* metricMethod(const std::string& method) {
+    static const char* const known[] = {"GET", "POST", "PUT", "DELETE", "OPTIONS"};
+    for (const char* name : known) {
+        if (method == name) return name;
+    }
+    return "other";
+}
+
 // -------------------- Request Handlers --------------------
-// Add this function right before handleGetPosts() (before line 420)
 HttpResponse AcademicSocialServer::handleRequest(const HttpRequest& request) {
+    auto started = std::chrono::steady_clock::now();
+    const char* route = "unmatched";
+    HttpResponse response = routeRequest(request, route);
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    // Methods and routes are string literals, so their addresses key this
+    // thread's resolved series and the registry is only consulted (locked,
+    // labels formatted) the first time a thread sees a route or status
+    struct RouteMetrics {
+        utils::Histogram* duration = nullptr;
+        std::vector<std::pair<int, utils::Counter*>> responses;
+    };
+    struct RouteKey {
+        const char* method;
+        const char* route;
+        bool operator==(const RouteKey& other) const { return method == other.method && route == other.route; }
+    };
+    struct RouteKeyHash {
+        size_t operator()(const RouteKey& key) const {
+            return std::hash<const void*>()(key.method) * 31 + std::hash<const void*>()(key.route);
+        }
+    };
+    thread_local std::unordered_map<RouteKey, RouteMetrics, RouteKeyHash> resolved;
+
+    const char* method = metricMethod(request.method);
+    RouteMetrics& series = resolved[RouteKey{method, route}];
+    auto& metrics = utils::MetricsRegistry::getInstance();
+    if (series.duration == nullptr) {
+        series.duration = &metrics.histogram("sohbet_http_request_duration_seconds", "HTTP request latency by route",
+                                             {{"method", method}, {"route", route}});
+    }
+    series.duration->observe(elapsed);
+
+    utils::Counter* responses = nullptr;
+    for (const auto& entry : series.responses) {
+        if (entry.first == response.status_code) {
+            responses = entry.second;
+            break;
+        }
+    }
+    if (responses == nullptr) {
+        responses = &metrics.counter("sohbet_http_responses_total", "HTTP responses by route and status",
+                                     {{"method", method}, {"route", route},
+                                      {"status", std::to_string(response.status_code)}});
+        series.responses.emplace_back(response.status_code, responses);
+    }
+    responses->inc();
+    return response;
+}
+
+HttpResponse AcademicSocialServer::routeRequest(const HttpRequest& request, const char*& route) {
     // Extract base path (without query string)
     std::string base_path = request.path;
     size_t query_pos = base_path.find('?');
@@ -553,183 +772,294 @@ HttpResponse AcademicSocialServer::handleRequest(const HttpRequest& request) {
     
     // Handle CORS preflight requests FIRST (before logging/processing body)
     if (request.method == "OPTIONS") {
+        route = "preflight";
         return HttpResponse(200, "text/plain", "");
     }
 
     // Status endpoint - no authentication required for health checks
     if (request.method == "GET" && base_path == "/api/status") {
+        route = "/api/status";
         return handleStatus(request);
     }
 
+    // Prometheus scrape endpoint - no authentication, like the health check
+    if (request.method == "GET" && base_path == "/metrics") {
+        route = "/metrics";
+        return handleMetrics(request);
+    }
+
     int author_id = getUserIdFromAuth(request);
+    // Lets the database keep this user's reads on the primary right after they write
+    db::SessionScope session(author_id);
 
     if (request.method == "GET" && base_path == "/api/users") {
+        route = "/api/users";
         return handleGetUsers(request);
     } else if (request.method == "GET" && base_path == "/api/users/demo") {
+        route = "/api/users/demo";
         return handleUsersDemo(request);
+    } else if (request.method == "GET" && base_path == "/api/users/autocomplete") {
+        route = "/api/users/autocomplete";
+        return handleAutocompleteUsers(request);
+    } else if (request.method == "GET" && base_path.find("/api/users/") == 0 && base_path.find("/presence") != std::string::npos) {
+        route = "/api/users/:id/presence";
+        return handleGetUserPresence(request);
     } else if (request.method == "GET" && base_path.find("/api/users/") == 0 && base_path.find("/friends") != std::string::npos) {
+        route = "/api/users/:id/friends";
         return handleGetFriends(request);
     } else if (request.method == "GET" && base_path.find("/api/users/") == 0 && base_path.find("/posts") != std::string::npos) {
+        route = "/api/users/:id/posts";
         return handleGetUserPosts(request);
     } else if (request.method == "GET" && base_path.find("/api/users/") == 0 && base_path.find("/media") != std::string::npos) {
+        route = "/api/users/:id/media";
         return handleGetUserMedia(request);
     } else if (request.method == "GET" && base_path.find("/api/users/") == 0 && base_path.find("/friends") == std::string::npos && base_path.find("/posts") == std::string::npos && base_path.find("/media") == std::string::npos) {
+        route = "/api/users/:id";
         return handleGetUserById(request);
     } else if (request.method == "POST" && base_path == "/api/users") {
+        route = "/api/users";
         return handleCreateUser(request);
     } else if (request.method == "PUT" && base_path.find("/api/users/") == 0) {
+        route = "/api/users/:id";
         return handleUpdateUser(request);
     } else if (request.method == "POST" && base_path == "/api/login") {
+        route = "/api/login";
         return handleLogin(request);
     } else if (request.method == "POST" && base_path == "/api/verify-email") {
+        route = "/api/verify-email";
         return handleVerifyEmail(request);
     } else if (request.method == "POST" && base_path == "/api/media/upload") {
+        route = "/api/media/upload";
         return handleUploadMedia(request);
     } else if (request.method == "GET" && base_path.find("/api/media/file/") == 0) {
+        route = "/api/media/file/:key";
         return handleGetMediaFile(request);
     }
     // Friendship routes
     else if (request.method == "POST" && base_path == "/api/friendships") {
+        route = "/api/friendships";
         return handleCreateFriendship(request);
     } else if (request.method == "GET" && base_path == "/api/friendships") {
+        route = "/api/friendships";
         return handleGetFriendships(request);
     } else if (request.method == "PUT" && base_path.find("/api/friendships/") == 0 && base_path.find("/accept") != std::string::npos) {
+        route = "/api/friendships/:id/accept";
         return handleAcceptFriendship(request);
     } else if (request.method == "PUT" && base_path.find("/api/friendships/") == 0 && base_path.find("/reject") != std::string::npos) {
+        route = "/api/friendships/:id/reject";
         return handleRejectFriendship(request);
     } else if (request.method == "DELETE" && base_path.find("/api/friendships/") == 0) {
+        route = "/api/friendships/:id";
         return handleDeleteFriendship(request);
+    } else if (request.method == "GET" && base_path == "/api/friends/suggestions") {
+        route = "/api/friends/suggestions";
+        return handleGetFriendSuggestions(request);
     }
     // Post routes
     else if (request.method == "POST" && base_path == "/api/posts") {
+        route = "/api/posts";
         return handleCreatePost(request);
     } else if (request.method == "GET" && base_path == "/api/posts") {
+        route = "/api/posts";
         return handleGetPosts(request);
     } else if (request.method == "PUT" && base_path.find("/api/posts/") == 0 && base_path.find("/react") == std::string::npos) {
+        route = "/api/posts/:id";
         return handleUpdatePost(request);
     } else if (request.method == "DELETE" && base_path.find("/api/posts/") == 0 && base_path.find("/react") == std::string::npos) {
+        route = "/api/posts/:id";
         return handleDeletePost(request);
     } else if (request.method == "POST" && base_path.find("/api/posts/") == 0 && base_path.find("/react") != std::string::npos) {
+        route = "/api/posts/:id/react";
         return handleAddReaction(request);
     } else if (request.method == "DELETE" && base_path.find("/api/posts/") == 0 && base_path.find("/react") != std::string::npos) {
+        route = "/api/posts/:id/react";
         return handleRemoveReaction(request);
     }
     // Comment routes
     else if (request.method == "POST" && base_path.find("/api/posts/") == 0 && base_path.find("/comments") != std::string::npos && base_path.find("/api/comments/") == std::string::npos) {
+        route = "/api/posts/:id/comments";
         return handleCreateComment(request);
     } else if (request.method == "GET" && base_path.find("/api/posts/") == 0 && base_path.find("/comments") != std::string::npos) {
+        route = "/api/posts/:id/comments";
         return handleGetComments(request);
+    } else if (request.method == "GET" && base_path.find("/api/comments/") == 0 && base_path.find("/replies") != std::string::npos) {
+        route = "/api/comments/:id/replies";
+        return handleGetCommentReplies(request);
     } else if (request.method == "POST" && base_path.find("/api/comments/") == 0 && base_path.find("/reply") != std::string::npos) {
+        route = "/api/comments/:id/reply";
         return handleReplyToComment(request);
     } else if (request.method == "PUT" && base_path.find("/api/comments/") == 0) {
+        route = "/api/comments/:id";
         return handleUpdateComment(request);
     } else if (request.method == "DELETE" && base_path.find("/api/comments/") == 0) {
+        route = "/api/comments/:id";
         return handleDeleteComment(request);
     }
     // Group routes
     else if (request.method == "POST" && base_path == "/api/groups") {
+        route = "/api/groups";
         return handleCreateGroup(request);
     } else if (request.method == "GET" && base_path == "/api/groups") {
+        route = "/api/groups";
         return handleGetGroups(request);
     } else if (request.method == "GET" && base_path.find("/api/groups/") == 0 && base_path.find("/members") == std::string::npos) {
+        route = "/api/groups/:id";
         return handleGetGroup(request);
     } else if (request.method == "PUT" && base_path.find("/api/groups/") == 0 && base_path.find("/members") == std::string::npos) {
+        route = "/api/groups/:id";
         return handleUpdateGroup(request);
     } else if (request.method == "DELETE" && base_path.find("/api/groups/") == 0 && base_path.find("/members") == std::string::npos) {
+        route = "/api/groups/:id";
         return handleDeleteGroup(request);
     } else if (request.method == "POST" && base_path.find("/api/groups/") == 0 && base_path.find("/members") != std::string::npos) {
+        route = "/api/groups/:id/members";
         return handleAddGroupMember(request);
     } else if (request.method == "DELETE" && base_path.find("/api/groups/") == 0 && base_path.find("/members/") != std::string::npos) {
+        route = "/api/groups/:id/members/:id";
         return handleRemoveGroupMember(request);
     } else if (request.method == "PUT" && base_path.find("/api/groups/") == 0 && base_path.find("/members/") != std::string::npos && base_path.find("/role") != std::string::npos) {
+        route = "/api/groups/:id/members/:id/role";
         return handleUpdateGroupMemberRole(request);
     }
     // Hashtag routes
     else if (request.method == "GET" && base_path == "/api/hashtags/trending") {
+        route = "/api/hashtags/trending";
         return handleGetTrendingHashtags(request);
     } else if (request.method == "GET" && base_path == "/api/hashtags/search") {
+        route = "/api/hashtags/search";
         return handleSearchHashtags(request);
     } else if (request.method == "GET" && base_path.find("/api/hashtags/") == 0 && base_path.find("/posts") != std::string::npos) {
+        route = "/api/hashtags/:tag/posts";
         return handleGetPostsByHashtag(request);
     }
+    // Search routes
+    else if (request.method == "GET" && base_path == "/api/search") {
+        route = "/api/search";
+        return handleSearch(request);
+    }
+    // Presence routes
+    else if (request.method == "GET" && base_path == "/api/presence") {
+        route = "/api/presence";
+        return handleGetPresence(request);
+    }
     // Announcement routes
     else if (request.method == "POST" && base_path.find("/api/groups/") == 0 && base_path.find("/announcements") != std::string::npos && base_path.find("/api/groups/") == 0) {
+        route = "/api/groups/:id/announcements";
         return handleCreateAnnouncement(request);
     } else if (request.method == "GET" && base_path.find("/api/groups/") == 0 && base_path.find("/announcements") != std::string::npos) {
+        route = "/api/groups/:id/announcements";
         return handleGetAnnouncements(request);
     } else if (request.method == "GET" && base_path.find("/api/announcements/") == 0) {
+        route = "/api/announcements/:id";
         return handleGetAnnouncement(request);
     } else if (request.method == "PUT" && base_path.find("/api/announcements/") == 0 && base_path.find("/pin") == std::string::npos) {
+        route = "/api/announcements/:id";
         return handleUpdateAnnouncement(request);
     } else if (request.method == "DELETE" && base_path.find("/api/announcements/") == 0) {
+        route = "/api/announcements/:id";
         return handleDeleteAnnouncement(request);
     } else if (request.method == "PUT" && base_path.find("/api/announcements/") == 0 && base_path.find("/pin") != std::string::npos) {
+        route = "/api/announcements/:id/pin";
         return handlePinAnnouncement(request);
     } else if (request.method == "PUT" && base_path.find("/api/announcements/") == 0 && base_path.find("/unpin") != std::string::npos) {
+        route = "/api/announcements/:id/unpin";
         return handleUnpinAnnouncement(request);
     }
     // Study Buddy routes
     else if (request.method == "GET" && base_path == "/api/study-buddies/preferences") {
+        route = "/api/study-buddies/preferences";
         return handleGetStudyPreferences(request);
     } else if (request.method == "POST" && base_path == "/api/study-buddies/preferences") {
+        route = "/api/study-buddies/preferences";
         return handleSetStudyPreferences(request);
     } else if (request.method == "GET" && base_path == "/api/study-buddies/matches") {
+        route = "/api/study-buddies/matches";
         return handleGetStudyBuddyMatches(request);
     } else if (request.method == "POST" && base_path == "/api/study-buddies/matches/refresh") {
+        route = "/api/study-buddies/matches/refresh";
         return handleRefreshStudyBuddyMatches(request);
     } else if (request.method == "PUT" && base_path.find("/api/study-buddies/matches/") == 0 && base_path.find("/accept") != std::string::npos) {
+        route = "/api/study-buddies/matches/:id/accept";
         return handleAcceptStudyBuddyMatch(request);
     } else if (request.method == "PUT" && base_path.find("/api/study-buddies/matches/") == 0 && base_path.find("/decline") != std::string::npos) {
+        route = "/api/study-buddies/matches/:id/decline";
         return handleDeclineStudyBuddyMatch(request);
     } else if (request.method == "GET" && base_path == "/api/study-buddies/connections") {
+        route = "/api/study-buddies/connections";
         return handleGetStudyBuddyConnections(request);
     }
     // Mention routes
     else if (request.method == "GET" && base_path.find("/api/users/") == 0 && base_path.find("/mentions") != std::string::npos) {
+        route = "/api/users/:id/mentions";
         return handleGetUserMentions(request);
     }
     // Organization routes
     else if (request.method == "POST" && base_path == "/api/organizations") {
+        route = "/api/organizations";
         return handleCreateOrganization(request);
     } else if (request.method == "GET" && base_path == "/api/organizations") {
+        route = "/api/organizations";
         return handleGetOrganizations(request);
     } else if (request.method == "GET" && base_path.find("/api/organizations/") == 0 && base_path.find("/accounts") == std::string::npos) {
+        route = "/api/organizations/:id";
         return handleGetOrganization(request);
     } else if (request.method == "PUT" && base_path.find("/api/organizations/") == 0 && base_path.find("/accounts") == std::string::npos) {
+        route = "/api/organizations/:id";
         return handleUpdateOrganization(request);
     } else if (request.method == "DELETE" && base_path.find("/api/organizations/") == 0 && base_path.find("/accounts") == std::string::npos) {
+        route = "/api/organizations/:id";
         return handleDeleteOrganization(request);
     } else if (request.method == "POST" && base_path.find("/api/organizations/") == 0 && base_path.find("/accounts") != std::string::npos) {
+        route = "/api/organizations/:id/accounts";
         return handleAddOrganizationAccount(request);
     } else if (request.method == "DELETE" && base_path.find("/api/organizations/") == 0 && base_path.find("/accounts/") != std::string::npos) {
+        route = "/api/organizations/:id/accounts/:id";
         return handleRemoveOrganizationAccount(request);
     }
     // Chat/Messaging routes
     else if (request.method == "GET" && base_path == "/api/conversations") {
+        route = "/api/conversations";
         return handleGetConversations(request);
+    } else if (request.method == "GET" && base_path == "/api/inbox") {
+        route = "/api/inbox";
+        return handleGetInbox(request);
+    } else if (request.method == "PUT" && base_path.find("/api/conversations/") == 0 && base_path.find("/read") != std::string::npos) {
+        route = "/api/conversations/:id/read";
+        return handleMarkConversationRead(request);
     } else if (request.method == "POST" && base_path == "/api/conversations") {
+        route = "/api/conversations";
         return handleGetOrCreateConversation(request);
     } else if (request.method == "GET" && base_path.find("/api/conversations/") == 0 && base_path.find("/messages") != std::string::npos) {
+        route = "/api/conversations/:id/messages";
         return handleGetMessages(request);
     } else if (request.method == "POST" && base_path.find("/api/conversations/") == 0 && base_path.find("/messages") != std::string::npos) {
+        route = "/api/conversations/:id/messages";
         return handleSendMessage(request);
     } else if (request.method == "PUT" && base_path.find("/api/messages/") == 0 && base_path.find("/read") != std::string::npos) {
+        route = "/api/messages/:id/read";
         return handleMarkMessageRead(request);
     }
     // Voice/Murmur routes
     else if (request.method == "POST" && base_path == "/api/voice/channels") {
+        route = "/api/voice/channels";
         return handleCreateVoiceChannel(request);
     } else if (request.method == "GET" && base_path == "/api/voice/channels") {
+        route = "/api/voice/channels";
         return handleGetVoiceChannels(request);
     } else if (request.method == "GET" && base_path.find("/api/voice/channels/") == 0 && base_path.find("/join") == std::string::npos && base_path.find("/leave") == std::string::npos) {
+        route = "/api/voice/channels/:id";
         return handleGetVoiceChannel(request);
     } else if (request.method == "POST" && base_path.find("/api/voice/channels/") == 0 && base_path.find("/join") != std::string::npos) {
+        route = "/api/voice/channels/:id/join";
         return handleJoinVoiceChannel(request);
     } else if (request.method == "DELETE" && base_path.find("/api/voice/channels/") == 0 && base_path.find("/leave") != std::string::npos) {
+        route = "/api/voice/channels/:id/leave";
         return handleLeaveVoiceChannel(request);
     } else if (request.method == "DELETE" && base_path.find("/api/voice/channels/") == 0 && base_path.find("/leave") == std::string::npos) {
+        route = "/api/voice/channels/:id";
         return handleDeleteVoiceChannel(request);
     } else {
+        route = "unmatched";
         return handleNotFound(request);
     }
 }
@@ -741,6 +1071,12 @@ HttpResponse AcademicSocialServer::handleStatus(const HttpRequest& request) {
     return createJsonResponse(200, response);
 }
 
+HttpResponse AcademicSocialServer::handleMetrics(const HttpRequest& request) {
+    (void)request;
+    return HttpResponse(200, "text/plain; version=0.0.4",
+                        utils::MetricsRegistry::getInstance().renderPrometheus());
+}
+
 HttpResponse AcademicSocialServer::handleGetUsers(const HttpRequest& request) {
     int limit = 50;
     int offset = 0;
@@ -766,22 +1102,20 @@ HttpResponse AcademicSocialServer::handleGetUsers(const HttpRequest& request) {
     std::vector<User> users = user_repository_->findAll(limit, offset);
     int total = user_repository_->countAll();
     
-    std::ostringstream oss;
-    oss << "{\"users\":[";
-    
-    for (size_t i = 0; i < users.size(); ++i) {
-        oss << users[i].toJson();
-        if (i < users.size() - 1) {
-            oss << ",";
-        }
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("users").beginArray();
+    for (const auto& user : users) {
+        user.writeJson(writer);
     }
+    writer.endArray();
+    writer.field("total", total);
+    writer.field("limit", limit);
+    writer.field("offset", offset);
+    writer.field("count", users.size());
+    writer.endObject();
     
-    oss << "],\"total\":" << total;
-    oss << ",\"limit\":" << limit;
-    oss << ",\"offset\":" << offset;
-    oss << ",\"count\":" << users.size() << "}";
-    
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleUsersDemo(const HttpRequest& request) {
@@ -823,9 +1157,14 @@ HttpResponse AcademicSocialServer::handleGetUserById(const HttpRequest& request)
 
 HttpResponse AcademicSocialServer::handleCreateUser(const HttpRequest& request) {
     try {
-        std::string username = extractJsonField(request.body, "username");
-        std::string email = extractJsonField(request.body, "email");
-        std::string password = extractJsonField(request.body, "password");
+        utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+        if (!body.isValid()) {
+            return createErrorResponse(400, body.getError());
+        }
+        
+        std::string username = body.getString("username").value_or("");
+        std::string email = body.getString("email").value_or("");
+        std::string password = body.getString("password").value_or("");
 
         std::string error;
         if (!validateUserRegistration(username, email, password, error)) {
@@ -840,28 +1179,31 @@ HttpResponse AcademicSocialServer::handleCreateUser(const HttpRequest& request)
         user.setEmail(email);
         user.setPasswordHash(utils::hash_password(password));
 
-        std::string university = extractJsonField(request.body, "university");
+        std::string university = body.getString("university").value_or("");
         if (!university.empty()) user.setUniversity(university);
 
-        std::string department = extractJsonField(request.body, "department");
+        std::string department = body.getString("department").value_or("");
         if (!department.empty()) user.setDepartment(department);
 
-        std::string year_str = extractJsonField(request.body, "enrollment_year");
-        if (!year_str.empty()) user.setEnrollmentYear(std::stoi(year_str));
+        auto enrollment_year = body["enrollment_year"];
+        if (enrollment_year.exists() && !enrollment_year.isNull()) {
+            auto year = enrollment_year.getInt();
+            if (!year.has_value()) return createErrorResponse(400, "enrollment_year must be an integer");
+            user.setEnrollmentYear(static_cast<int>(year.value()));
+        }
 
-        std::string primary_lang = extractJsonField(request.body, "primary_language");
+        std::string primary_lang = body.getString("primary_language").value_or("");
         if (!primary_lang.empty()) user.setPrimaryLanguage(primary_lang);
 
-        std::regex lang_regex("\"additional_languages\"\\s*:\\s*\\[(.*?)\\]");
-        std::smatch match;
-        if (std::regex_search(request.body, match, lang_regex)) {
-            std::string langs_str = match[1].str();
+        auto additional_languages = body["additional_languages"];
+        if (additional_languages.isArray()) {
             std::vector<std::string> langs;
-            std::regex item_regex("\"([^\"]*)\"");
-            for (auto iter = std::sregex_iterator(langs_str.begin(), langs_str.end(), item_regex);
-                 iter != std::sregex_iterator(); ++iter) {
-                langs.push_back((*iter)[1].str());
-            }
+            langs.reserve(additional_languages.size());
+            additional_languages.forEach([&langs](utils::JsonValue item) {
+                if (auto lang = item.getString()) {
+                    langs.push_back(std::move(lang.value()));
+                }
+            });
             user.setAdditionalLanguages(langs);
         }
 
@@ -872,6 +1214,7 @@ HttpResponse AcademicSocialServer::handleCreateUser(const HttpRequest& request)
 
         // Create email verification token and send verification email
         int user_id = created_user.value().getId().value();
+        username_index_.upsert(user_id, created_user->getUsername(), 0);
         auto token_opt = email_verification_token_repository_->createToken(user_id);
         if (token_opt.has_value()) {
             std::cout << "Email service not available in this build. Verification token created." << std::endl;
@@ -903,8 +1246,13 @@ HttpResponse AcademicSocialServer::handleCreateUser(const HttpRequest& request)
 
 HttpResponse AcademicSocialServer::handleLogin(const HttpRequest& request) {
     try {
-        std::string username = extractJsonField(request.body, "username");
-        std::string password = extractJsonField(request.body, "password");
+        utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+        if (!body.isValid()) {
+            return createErrorResponse(400, body.getError());
+        }
+        
+        std::string username = body.getString("username").value_or("");
+        std::string password = body.getString("password").value_or("");
 
         auto user_opt = user_repository_->findByUsername(username);
         if (!user_opt.has_value()) return createErrorResponse(401, "Invalid username or password");
@@ -919,9 +1267,13 @@ HttpResponse AcademicSocialServer::handleLogin(const HttpRequest& request) {
         int expiry_hours = config::get_jwt_expiry_hours();
         std::string token = security::generate_jwt_token(username, user.getId().value(), user_role, jwt_secret, expiry_hours);
 
-        std::ostringstream oss;
-        oss << "{ \"token\":\"" << token << "\", \"user\":" << user.toJson() << " }";
-        return createJsonResponse(200, oss.str());
+        utils::JsonWriter writer;
+        writer.beginObject();
+        writer.field("token", token);
+        writer.key("user");
+        user.writeJson(writer);
+        writer.endObject();
+        return createJsonResponse(200, writer.str());
     } catch (const std::exception& e) {
         std::cerr << "Login error: " << e.what() << std::endl;
         return createErrorResponse(500, "Internal server error");
@@ -933,7 +1285,12 @@ HttpResponse AcademicSocialServer::handleLogin(const HttpRequest& request) {
 
 HttpResponse AcademicSocialServer::handleVerifyEmail(const HttpRequest& request) {
     try {
-        std::string token = extractJsonField(request.body, "token");
+        utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+        if (!body.isValid()) {
+            return createErrorResponse(400, body.getError());
+        }
+        
+        std::string token = body.getString("token").value_or("");
 
         if (token.empty()) {
             return createErrorResponse(400, "Token is required");
@@ -943,6 +1300,11 @@ HttpResponse AcademicSocialServer::handleVerifyEmail(const HttpRequest& request)
         bool verified = email_verification_token_repository_->verifyToken(token);
 
         if (verified) {
+            // The cached profile still says unverified
+            auto verified_token = email_verification_token_repository_->findByToken(token);
+            if (verified_token.has_value()) {
+                user_repository_->invalidate(verified_token->getUserId());
+            }
             return createJsonResponse(200, "{\"message\":\"Email verified successfully\",\"verified\":true}");
         } else {
             // Token might be invalid, expired, or already used
@@ -987,27 +1349,36 @@ HttpResponse AcademicSocialServer::handleUpdateUser(const HttpRequest& request)
         
         User user = user_opt.value();
         
-        std::string name = extractJsonField(request.body, "name");
+        utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+        if (!body.isValid()) {
+            return createErrorResponse(400, body.getError());
+        }
+        
+        std::string name = body.getString("name").value_or("");
         if (!name.empty()) user.setName(name);
         
-        std::string position = extractJsonField(request.body, "position");
+        std::string position = body.getString("position").value_or("");
         if (!position.empty()) user.setPosition(position);
         
-        std::string phone_number = extractJsonField(request.body, "phone_number");
+        std::string phone_number = body.getString("phone_number").value_or("");
         if (!phone_number.empty()) user.setPhoneNumber(phone_number);
         
-        std::string university = extractJsonField(request.body, "university");
+        std::string university = body.getString("university").value_or("");
         if (!university.empty()) user.setUniversity(university);
         
-        std::string department = extractJsonField(request.body, "department");
+        std::string department = body.getString("department").value_or("");
         if (!department.empty()) user.setDepartment(department);
         
-        std::string enrollment_year_str = extractJsonField(request.body, "enrollment_year");
-        if (!enrollment_year_str.empty()) {
-            user.setEnrollmentYear(std::stoi(enrollment_year_str));
+        auto enrollment_year = body["enrollment_year"];
+        if (enrollment_year.exists() && !enrollment_year.isNull()) {
+            auto year = enrollment_year.getInt();
+            if (!year.has_value()) {
+                return createErrorResponse(400, "enrollment_year must be an integer");
+            }
+            user.setEnrollmentYear(static_cast<int>(year.value()));
         }
         
-        std::string primary_language = extractJsonField(request.body, "primary_language");
+        std::string primary_language = body.getString("primary_language").value_or("");
         if (!primary_language.empty()) user.setPrimaryLanguage(primary_language);
         
         if (!user_repository_->update(user)) {
@@ -1032,67 +1403,9 @@ HttpResponse AcademicSocialServer::createJsonResponse(int status, const std::str
 }
 
 HttpResponse AcademicSocialServer::createErrorResponse(int status, const std::string& message) {
-    return createJsonResponse(status, "{\"error\":\"" + message + "\"}");
-}
-
-std::string AcademicSocialServer::extractJsonField(const std::string& json, const std::string& field) {
-    // Try to find the field with double quotes
-    std::string search_key = "\"" + field + "\"";
-    size_t key_pos = json.find(search_key);
-
-    if (key_pos == std::string::npos) {
-        return "";
-    }
-    
-    // Find the colon after the field name
-    size_t colon_pos = json.find(':', key_pos);
-    if (colon_pos == std::string::npos) {
-        return "";
-    }
-    
-    // Skip whitespace after colon
-    size_t value_start = colon_pos + 1;
-    while (value_start < json.length() && (json[value_start] == ' ' || json[value_start] == '\t')) {
-        value_start++;
-    }
-    
-    if (value_start >= json.length()) {
-        return "";
-    }
-    
-    // Check if value is a string (starts with quote)
-    if (json[value_start] == '"') {
-        value_start++; // Skip opening quote
-        size_t value_end = value_start;
-        
-        // Find closing quote (handle escaped quotes)
-        while (value_end < json.length() && json[value_end] != '"') {
-            if (json[value_end] == '\\' && value_end + 1 < json.length()) {
-                value_end += 2; // Skip escaped character
-            } else {
-                value_end++;
-            }
-        }
-        
-        if (value_end >= json.length()) {
-            return "";
-        }
-
-        std::string result = json.substr(value_start, value_end - value_start);
-        return result;
-    }
-    
-    // Check if value is a number
-    if (std::isdigit(json[value_start]) || json[value_start] == '-') {
-        size_t value_end = value_start;
-        while (value_end < json.length() && std::isdigit(json[value_end])) {
-            value_end++;
-        }
-        std::string result = json.substr(value_start, value_end - value_start);
-        return result;
-    }
-
-    return "";
+    utils::JsonWriter writer;
+    writer.beginObject().field("error", message).endObject();
+    return createJsonResponse(status, writer.str());
 }
 
 bool AcademicSocialServer::validateUserRegistration(const std::string& username,
@@ -1150,6 +1463,7 @@ void AcademicSocialServer::ensureDemoUserExists() {
         if (stmt.step() != SQLITE_DONE) {
             std::cerr << "Warning: Failed to persist Professor role for demo user" << std::endl;
         } else {
+            user_repository_->invalidate(user_id);
             std::cout << "Demo user flagged as Professor for primary role" << std::endl;
         }
     };
@@ -1228,6 +1542,7 @@ void AcademicSocialServer::ensureSecondDemoUserExists() {
         if (stmt.step() != SQLITE_DONE) {
             std::cerr << "Warning: Failed to persist Professor role for second demo user" << std::endl;
         } else {
+            user_repository_->invalidate(user_id);
             std::cout << "Second demo user flagged as Professor for primary role" << std::endl;
         }
     };
@@ -1274,12 +1589,12 @@ void AcademicSocialServer::ensureSecondDemoUserExists() {
 
 HttpResponse AcademicSocialServer::handleUploadMedia(const HttpRequest& request) {
     // Check Content-Type for multipart/form-data
-    auto content_type_it = request.headers.find("Content-Type");
-    if (content_type_it == request.headers.end()) {
+    auto content_type_header = request.headers.get("Content-Type");
+    if (!content_type_header.has_value()) {
         return createErrorResponse(400, "Content-Type header is required");
     }
     
-    std::string content_type = content_type_it->second;
+    std::string content_type(content_type_header.value());
     if (content_type.find("multipart/form-data") == std::string::npos) {
         return createErrorResponse(400, "Content-Type must be multipart/form-data");
     }
@@ -1400,6 +1715,7 @@ HttpResponse AcademicSocialServer::handleGetMediaFile(const HttpRequest& request
     }
     
     // Convert binary data to string for response
+    // (image types are already compressed; formatHttpResponse leaves them as-is)
     std::string body(file_data->begin(), file_data->end());
     
     return HttpResponse(200, content_type, body);
@@ -1420,30 +1736,36 @@ HttpResponse AcademicSocialServer::handleGetUserMedia(const HttpRequest& request
     auto media_list = media_repository_->findByUser(user_id);
     
     // Build JSON array
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < media_list.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << media_list[i].toJson();
+    utils::JsonWriter writer;
+    writer.beginArray();
+    for (const auto& media : media_list) {
+        media.writeJson(writer);
     }
-    oss << "]";
+    writer.endArray();
     
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 // ==================== Helper Methods ====================
 
+utils::BatchLoader<int, std::optional<User>> AcademicSocialServer::makeUserLoader() {
+    return utils::BatchLoader<int, std::optional<User>>([this](const std::vector<int>& ids) {
+        std::unordered_map<int, std::optional<User>> users;
+        for (auto& user : user_repository_->findByIds(ids)) {
+            int id = user.getId().value();
+            users.emplace(id, std::move(user));
+        }
+        return users;
+    });
+}
+
 // COMPLETE getUserIdFromAuth function - Replace your entire function with this:
 
 int AcademicSocialServer::getUserIdFromAuth(const HttpRequest& request) {
     // Extract user ID from Authorization header (JWT token)
-    // Try different cases of Authorization header
-    auto it = request.headers.find("Authorization");
-    if (it == request.headers.end()) {
-        it = request.headers.find("authorization");
-    }
-    if (it != request.headers.end()) {
-        std::string auth_header = it->second;
+    auto authorization = request.headers.get("Authorization");
+    if (authorization.has_value()) {
+        std::string auth_header(authorization.value());
 
         if (auth_header.find("Bearer ") == 0) {
             std::string token = auth_header.substr(7);
@@ -1467,17 +1789,17 @@ int AcademicSocialServer::getUserIdFromAuth(const HttpRequest& request) {
     }
     
     // Fallback: check for X-User-ID header (for testing)
-    it = request.headers.find("X-User-ID");
-    if (it != request.headers.end()) {
+    auto user_id_header = request.headers.get("X-User-ID");
+    if (user_id_header.has_value()) {
         try {
-            return std::stoi(it->second);
+            return std::stoi(std::string(user_id_header.value()));
         } catch (...) {
             return -1;
         }
     }
 
     // Check for demo user in request body (for demo/testing purposes only)
-    std::string username = extractJsonField(request.body, "username");
+    std::string username = utils::JsonDocument::parse(request.body).getString("username").value_or("");
     if (username == "demo_student") {
         auto demo_user = user_repository_->findByUsername("demo_student");
         if (demo_user.has_value() && demo_user->getId().has_value()) {
@@ -1503,6 +1825,39 @@ int AcademicSocialServer::extractIdFromPath(const std::string& path, const std::
     }
 }
 
+std::string AcademicSocialServer::getQueryParam(const std::string& path, const std::string& name) {
+    size_t query_pos = path.find('?');
+    if (query_pos == std::string::npos) return "";
+
+    size_t pos = query_pos + 1;
+    while (pos < path.size()) {
+        size_t end = path.find('&', pos);
+        if (end == std::string::npos) end = path.size();
+
+        size_t eq = path.find('=', pos);
+        if (eq != std::string::npos && eq < end && path.compare(pos, eq - pos, name) == 0) {
+            std::string value;
+            value.reserve(end - eq - 1);
+            for (size_t i = eq + 1; i < end; ++i) {
+                char c = path[i];
+                if (c == '+') {
+                    value += ' ';
+                } else if (c == '%' && i + 2 < end &&
+                           std::isxdigit(static_cast<unsigned char>(path[i + 1])) &&
+                           std::isxdigit(static_cast<unsigned char>(path[i + 2]))) {
+                    value += static_cast<char>(std::stoi(path.substr(i + 1, 2), nullptr, 16));
+                    i += 2;
+                } else {
+                    value += c;
+                }
+            }
+            return value;
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
 // ==================== Friendship Handlers ====================
 
 HttpResponse AcademicSocialServer::handleCreateFriendship(const HttpRequest& request) {
@@ -1511,12 +1866,20 @@ HttpResponse AcademicSocialServer::handleCreateFriendship(const HttpRequest& req
         return createErrorResponse(401, "Unauthorized");
     }
     
-    std::string addressee_id_str = extractJsonField(request.body, "addressee_id");
-    if (addressee_id_str.empty()) {
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    if (!body.has("addressee_id")) {
         return createErrorResponse(400, "addressee_id is required");
     }
     
-    int addressee_id = std::stoi(addressee_id_str);
+    auto addressee_id_opt = body.getInt("addressee_id");
+    if (!addressee_id_opt.has_value()) {
+        return createErrorResponse(400, "addressee_id must be an integer");
+    }
+    int addressee_id = static_cast<int>(addressee_id_opt.value());
     
     // Check if friendship already exists
     auto existing = friendship_repository_->findBetweenUsers(requester_id, addressee_id);
@@ -1560,15 +1923,14 @@ HttpResponse AcademicSocialServer::handleGetFriendships(const HttpRequest& reque
         friendships = friendship_repository_->findByUserId(user_id, status);
     }
     
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < friendships.size(); ++i) {
-        oss << friendships[i].toJson();
-        if (i < friendships.size() - 1) oss << ",";
+    utils::JsonWriter writer;
+    writer.beginArray();
+    for (const auto& friendship : friendships) {
+        friendship.writeJson(writer);
     }
-    oss << "]";
+    writer.endArray();
     
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetFriends(const HttpRequest& request) {
@@ -1577,41 +1939,117 @@ HttpResponse AcademicSocialServer::handleGetFriends(const HttpRequest& request)
         return createErrorResponse(400, "Invalid user ID");
     }
     
-    std::vector<User> friends = friendship_repository_->getFriendsForUser(user_id);
+    // Ids from the social graph, profiles from the user cache
+    std::vector<User> friends = user_repository_->findByIds(social_graph_.friendsOf(user_id));
+    std::sort(friends.begin(), friends.end(), [](const User& a, const User& b) {
+        return a.getUsername() < b.getUsername();
+    });
     
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < friends.size(); ++i) {
-        oss << friends[i].toJson();
-        if (i < friends.size() - 1) oss << ",";
+    utils::JsonWriter writer;
+    writer.beginArray();
+    for (const auto& friend_user : friends) {
+        friend_user.writeJson(writer);
     }
-    oss << "]";
+    writer.endArray();
     
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
-HttpResponse AcademicSocialServer::handleAcceptFriendship(const HttpRequest& request) {
+HttpResponse AcademicSocialServer::handleGetFriendSuggestions(const HttpRequest& request) {
     int user_id = getUserIdFromAuth(request);
     if (user_id < 0) {
         return createErrorResponse(401, "Unauthorized");
     }
-    
-    int friendship_id = extractIdFromPath(request.path, "/api/friendships/");
-    if (friendship_id < 0) {
-        return createErrorResponse(400, "Invalid friendship ID");
-    }
-    
-    // Verify the user is the addressee
-    auto friendship = friendship_repository_->findById(friendship_id);
-    if (!friendship.has_value()) {
-        return createErrorResponse(404, "Friendship request not found");
+
+    int limit = 10;
+    std::string limit_str = getQueryParam(request.path, "limit");
+    if (!limit_str.empty()) {
+        try {
+            limit = std::stoi(limit_str);
+        } catch (...) {
+            return createErrorResponse(400, "Invalid limit");
+        }
+        limit = std::max(1, std::min(limit, 50));
     }
-    
-    if (friendship->getAddresseeId() != user_id) {
-        return createErrorResponse(403, "You can only accept requests sent to you");
+
+    // Friends of friends by mutual count, then re-ranked with a bonus for the
+    // same university and department; a wider pool leaves room for that
+    auto candidates = social_graph_.suggest(user_id, static_cast<size_t>(limit) * 4);
+    auto me = user_repository_->findById(user_id);
+
+    std::vector<int> candidate_ids;
+    std::unordered_map<int, int> mutual_counts;
+    for (const auto& candidate : candidates) {
+        candidate_ids.push_back(candidate.user_id);
+        mutual_counts[candidate.user_id] = candidate.mutual_count;
     }
-    
-    if (friendship_repository_->acceptRequest(friendship_id)) {
+
+    struct Ranked {
+        User user;
+        int mutual_count;
+        int score;
+    };
+    std::vector<Ranked> ranked;
+    for (auto& user : user_repository_->findByIds(candidate_ids)) {
+        int mutual_count = mutual_counts[user.getId().value_or(0)];
+        int score = mutual_count * 2;
+        if (me.has_value()) {
+            if (me->getUniversity().has_value() && user.getUniversity() == me->getUniversity()) score += 2;
+            if (me->getDepartment().has_value() && user.getDepartment() == me->getDepartment()) score += 1;
+        }
+        ranked.push_back({std::move(user), mutual_count, score});
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.mutual_count != b.mutual_count) return a.mutual_count > b.mutual_count;
+        return a.user.getId().value_or(0) < b.user.getId().value_or(0);
+    });
+    if (ranked.size() > static_cast<size_t>(limit)) {
+        ranked.resize(limit);
+    }
+
+    utils::JsonWriter writer;
+    writer.beginArray();
+    for (const auto& suggestion : ranked) {
+        writer.beginObject();
+        writer.key("user");
+        suggestion.user.writeJson(writer);
+        writer.field("mutual_count", suggestion.mutual_count);
+        writer.endObject();
+    }
+    writer.endArray();
+
+    return createJsonResponse(200, writer.str());
+}
+
+HttpResponse AcademicSocialServer::handleAcceptFriendship(const HttpRequest& request) {
+    int user_id = getUserIdFromAuth(request);
+    if (user_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
+    }
+    
+    int friendship_id = extractIdFromPath(request.path, "/api/friendships/");
+    if (friendship_id < 0) {
+        return createErrorResponse(400, "Invalid friendship ID");
+    }
+    
+    // Verify the user is the addressee
+    auto friendship = friendship_repository_->findById(friendship_id);
+    if (!friendship.has_value()) {
+        return createErrorResponse(404, "Friendship request not found");
+    }
+    
+    if (friendship->getAddresseeId() != user_id) {
+        return createErrorResponse(403, "You can only accept requests sent to you");
+    }
+    
+    bool was_accepted = friendship->getStatus() == "accepted";
+    if (friendship_repository_->acceptRequest(friendship_id)) {
+        if (!was_accepted) {
+            social_graph_.addFriendship(friendship->getRequesterId(), friendship->getAddresseeId());
+            username_index_.addScore(friendship->getRequesterId(), 1);
+            username_index_.addScore(friendship->getAddresseeId(), 1);
+        }
         auto updated = friendship_repository_->findById(friendship_id);
         return createJsonResponse(200, updated->toJson());
     }
@@ -1640,7 +2078,14 @@ HttpResponse AcademicSocialServer::handleRejectFriendship(const HttpRequest& req
         return createErrorResponse(403, "You can only reject requests sent to you");
     }
     
+    // Rejecting an accepted friendship ends it, as unfriending does
+    bool was_accepted = friendship->getStatus() == "accepted";
     if (friendship_repository_->rejectRequest(friendship_id)) {
+        if (was_accepted) {
+            social_graph_.removeFriendship(friendship->getRequesterId(), friendship->getAddresseeId());
+            username_index_.addScore(friendship->getRequesterId(), -1);
+            username_index_.addScore(friendship->getAddresseeId(), -1);
+        }
         auto updated = friendship_repository_->findById(friendship_id);
         return createJsonResponse(200, updated->toJson());
     }
@@ -1671,6 +2116,11 @@ HttpResponse AcademicSocialServer::handleDeleteFriendship(const HttpRequest& req
     }
     
     if (friendship_repository_->deleteById(friendship_id)) {
+        if (friendship->getStatus() == "accepted") {
+            social_graph_.removeFriendship(friendship->getRequesterId(), friendship->getAddresseeId());
+            username_index_.addScore(friendship->getRequesterId(), -1);
+            username_index_.addScore(friendship->getAddresseeId(), -1);
+        }
         return HttpResponse(204, "text/plain", "");
     }
     
@@ -1685,36 +2135,53 @@ HttpResponse AcademicSocialServer::handleCreatePost(const HttpRequest& request)
         return createErrorResponse(401, "Unauthorized");
     }
     
-    std::string content = extractJsonField(request.body, "content");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string content = body.getString("content").value_or("");
     if (content.empty()) {
         return createErrorResponse(400, "content is required");
     }
     
     Post post(author_id, content);
     
-    std::string visibility = extractJsonField(request.body, "visibility");
+    std::string visibility = body.getString("visibility").value_or("");
     if (!visibility.empty()) {
         post.setVisibility(visibility);
     }
     
-    std::string media_urls = extractJsonField(request.body, "media_urls");
-    if (!media_urls.empty()) {
-        post.setMediaUrls(media_urls);
+    // media_urls is stored as the JSON array text it was sent as
+    auto media_urls = body["media_urls"];
+    if (media_urls.isArray()) {
+        post.setMediaUrls(std::string(media_urls.raw()));
+    } else if (media_urls.exists() && !media_urls.isNull()) {
+        return createErrorResponse(400, "media_urls must be an array");
     }
     
-    std::string group_id_str = extractJsonField(request.body, "group_id");
-    if (!group_id_str.empty()) {
-        post.setGroupId(std::stoi(group_id_str));
+    auto group_id = body["group_id"];
+    if (group_id.exists() && !group_id.isNull()) {
+        auto group_id_opt = group_id.getInt();
+        if (!group_id_opt.has_value()) {
+            return createErrorResponse(400, "group_id must be an integer");
+        }
+        post.setGroupId(static_cast<int>(group_id_opt.value()));
     }
     
+    // Post, hashtags, links and mentions are written in one transaction;
+    // in-memory indexes and notifications follow only once it commits
+    db::UnitOfWork unit(*database_);
+
     auto created = post_repository_->create(post);
     if (created.has_value()) {
         int post_id = created->getId().value();
 
         // Extract and save hashtags
         auto hashtags = utils::TextParser::extractHashtags(content);
+        std::vector<Hashtag> hashtag_records;
         if (!hashtags.empty()) {
-            auto hashtag_records = hashtag_repository_->findOrCreateTags(hashtags);
+            hashtag_records = hashtag_repository_->findOrCreateTags(hashtags);
             std::vector<int> hashtag_ids;
             for (const auto& tag : hashtag_records) {
                 if (tag.getId().has_value()) {
@@ -1728,6 +2195,7 @@ HttpResponse AcademicSocialServer::handleCreatePost(const HttpRequest& request)
         auto author = user_repository_->findById(author_id);
 
         // Extract and save mentions
+        std::vector<services::NotificationRequest> mention_notifications;
         auto mentions = utils::TextParser::extractMentions(content);
         if (!mentions.empty() && author.has_value()) {
             std::set<int> mentioned_user_ids;
@@ -1739,24 +2207,43 @@ HttpResponse AcademicSocialServer::handleCreatePost(const HttpRequest& request)
 
                     // Create notification for mention (only if not mentioning self)
                     if (mentioned_id != author_id) {
-                        notification_repository_->createNotification(
-                            mentioned_id,
-                            "mention",
-                            "You were mentioned in a post",
-                            author->getUsername() + " mentioned you in a post",
-                            author_id,
-                            post_id,
-                            std::nullopt,  // comment_id
-                            std::nullopt,  // group_id
-                            std::nullopt,  // session_id
-                            "/posts/" + std::to_string(post_id)
-                        );
+                        services::NotificationRequest mention;
+                        mention.notification.user_id = mentioned_id;
+                        mention.notification.type = "mention";
+                        mention.notification.title = "You were mentioned in a post";
+                        mention.notification.message = author->getUsername() + " mentioned you in a post";
+                        mention.notification.related_user_id = author_id;
+                        mention.notification.related_post_id = post_id;
+                        mention.notification.action_url = "/posts/" + std::to_string(post_id);
+                        mention_notifications.push_back(std::move(mention));
                     }
                 }
             }
             mention_repository_->createMentions(post_id, mentioned_user_ids);
         }
 
+        if (!unit.commit()) {
+            return createErrorResponse(500, "Failed to create post");
+        }
+
+        for (const auto& tag : hashtag_records) {
+            if (tag.getId().has_value() && !hashtag_index_.addScore(tag.getId().value(), 1)) {
+                hashtag_index_.upsert(tag.getId().value(), tag.getTag(), tag.getUsageCount() + 1);
+            }
+        }
+
+        // Only public posts feed trending, so tags from private posts never surface
+        if (!hashtags.empty() && created->getVisibility() == "public") {
+            std::string university = author.has_value() ? author->getUniversity().value_or("") : "";
+            for (const auto& tag : hashtags) {
+                trending_hashtags_.record(tag, university);
+            }
+        }
+
+        for (auto& mention : mention_notifications) {
+            notification_dispatcher_->notify(std::move(mention));
+        }
+
         // Set author information
         if (author.has_value()) {
             created->setAuthorUsername(author->getUsername());
@@ -1796,15 +2283,17 @@ HttpResponse AcademicSocialServer::handleGetPosts(const HttpRequest& request) {
     
     std::vector<Post> posts = post_repository_->findFeedForUser(user_id, limit, offset);
 
-    std::ostringstream oss;
-    oss << "{\"posts\":[";
-    for (size_t i = 0; i < posts.size(); ++i) {
-        oss << posts[i].toJson();
-        if (i < posts.size() - 1) oss << ",";
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("posts").beginArray();
+    for (const auto& post : posts) {
+        post.writeJson(writer);
     }
-    oss << "],\"total\":" << posts.size() << "}";
+    writer.endArray();
+    writer.field("total", posts.size());
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetUserPosts(const HttpRequest& request) {
@@ -1830,15 +2319,14 @@ HttpResponse AcademicSocialServer::handleGetUserPosts(const HttpRequest& request
     
     std::vector<Post> posts = post_repository_->findByAuthor(user_id, limit, offset);
     
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < posts.size(); ++i) {
-        oss << posts[i].toJson();
-        if (i < posts.size() - 1) oss << ",";
+    utils::JsonWriter writer;
+    writer.beginArray();
+    for (const auto& post : posts) {
+        post.writeJson(writer);
     }
-    oss << "]";
+    writer.endArray();
     
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleUpdatePost(const HttpRequest& request) {
@@ -1862,12 +2350,17 @@ HttpResponse AcademicSocialServer::handleUpdatePost(const HttpRequest& request)
         return createErrorResponse(403, "You can only edit your own posts");
     }
     
-    std::string content = extractJsonField(request.body, "content");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string content = body.getString("content").value_or("");
     if (!content.empty()) {
         post->setContent(content);
     }
     
-    std::string visibility = extractJsonField(request.body, "visibility");
+    std::string visibility = body.getString("visibility").value_or("");
     if (!visibility.empty()) {
         post->setVisibility(visibility);
     }
@@ -1919,12 +2412,33 @@ HttpResponse AcademicSocialServer::handleAddReaction(const HttpRequest& request)
         return createErrorResponse(400, "Invalid post ID");
     }
     
-    std::string reaction_type = extractJsonField(request.body, "reaction_type");
+    // The body is optional here; an empty or unparsable body means the default reaction
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    std::string reaction_type = body.getString("reaction_type").value_or("");
     if (reaction_type.empty()) {
         reaction_type = "like"; // Default reaction type
     }
     
-    if (post_repository_->addReaction(post_id, user_id, reaction_type)) {
+    bool inserted = false;
+    if (post_repository_->addReaction(post_id, user_id, reaction_type, &inserted)) {
+        // Bursts of reactions on one post become one notification
+        auto post_author = inserted ? post_repository_->findUserAuthorId(post_id) : std::nullopt;
+        if (post_author.has_value() && post_author.value() != user_id) {
+            auto reactor = user_repository_->findById(user_id);
+            services::NotificationRequest reacted;
+            reacted.notification.user_id = post_author.value();
+            reacted.notification.type = "post_like";
+            reacted.notification.title = "New reaction";
+            reacted.notification.message = (reactor.has_value() ? reactor->getUsername() : std::string("Someone")) +
+                                           " reacted to your post";
+            reacted.notification.related_user_id = user_id;
+            reacted.notification.related_post_id = post_id;
+            reacted.notification.action_url = "/posts/" + std::to_string(post_id);
+            reacted.coalesce_key = "post_like:" + std::to_string(post_id);
+            reacted.coalesced_message = "{count} people reacted to your post";
+            notification_dispatcher_->notify(std::move(reacted));
+        }
+
         std::ostringstream oss;
         oss << "{\"success\":true,\"reaction_type\":\"" << reaction_type << "\"}";
         return createJsonResponse(200, oss.str());
@@ -1972,7 +2486,12 @@ HttpResponse AcademicSocialServer::handleCreateComment(const HttpRequest& reques
         return createErrorResponse(400, "Invalid post ID");
     }
     
-    std::string content = extractJsonField(request.body, "content");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string content = body.getString("content").value_or("");
     if (content.empty()) {
         return createErrorResponse(400, "content is required");
     }
@@ -1992,6 +2511,10 @@ HttpResponse AcademicSocialServer::handleGetComments(const HttpRequest& request)
     if (post_id < 0) {
         return createErrorResponse(400, "Invalid post ID");
     }
+
+    if (getQueryParam(request.path, "view") == "tree") {
+        return handleGetCommentThreads(request, post_id);
+    }
     
     // Parse pagination parameters
     int limit = 100;
@@ -2010,15 +2533,94 @@ HttpResponse AcademicSocialServer::handleGetComments(const HttpRequest& request)
     
     std::vector<Comment> comments = comment_repository_->findByPostId(post_id, limit, offset);
     
-    std::ostringstream oss;
-    oss << "[";
-    for (size_t i = 0; i < comments.size(); ++i) {
-        oss << comments[i].toJson();
-        if (i < comments.size() - 1) oss << ",";
+    utils::JsonWriter writer;
+    writer.beginArray();
+    for (const auto& comment : comments) {
+        comment.writeJson(writer);
     }
-    oss << "]";
+    writer.endArray();
     
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
+}
+
+// Keyset cursor format: "<sort timestamp in microseconds>:<id>" of the last
+// row on the previous page (inbox entries, comment threads)
+static bool parseKeysetCursor(const std::string& cursor, long long& at_us, int& id) {
+    size_t colon = cursor.find(':');
+    if (colon == std::string::npos) return false;
+    try {
+        size_t used = 0;
+        at_us = std::stoll(cursor.substr(0, colon), &used);
+        if (used != colon) return false;
+        id = std::stoi(cursor.substr(colon + 1), &used);
+        return used == cursor.size() - colon - 1 && id > 0;
+    } catch (...) {
+        return false;
+    }
+}
+
+HttpResponse AcademicSocialServer::handleGetCommentThreads(const HttpRequest& request, int post_id,
+                                                           const Comment* parent) {
+    // Each knob is bounded so one request cannot pull a whole busy post
+    struct Bound {
+        const char* name;
+        int* value;
+        int max;
+    };
+    repositories::CommentTreeQuery query;
+    for (const Bound& bound : {Bound{"limit", &query.threads, 50},
+                               Bound{"depth", &query.max_depth, 5},
+                               Bound{"replies", &query.replies_per_comment, 10}}) {
+        std::string param = getQueryParam(request.path, bound.name);
+        if (param.empty()) continue;
+        try {
+            *bound.value = std::max(0, std::min(std::stoi(param), bound.max));
+        } catch (...) {
+            return createErrorResponse(400, std::string("Invalid ") + bound.name);
+        }
+    }
+    query.threads = std::max(1, query.threads);
+
+    // Cursor: the last thread (or reply) on the previous page
+    long long after_at_us = 0;
+    int after_id = 0;
+    std::string cursor = getQueryParam(request.path, "cursor");
+    if (!cursor.empty() && !parseKeysetCursor(cursor, after_at_us, after_id)) {
+        return createErrorResponse(400, "Invalid cursor");
+    }
+
+    auto tree = parent ? comment_repository_->findReplyThreads(*parent, query, after_at_us, after_id)
+                       : comment_repository_->findThreads(post_id, query, after_at_us, after_id);
+    if (!tree) {
+        return createErrorResponse(500, "Failed to load comments");
+    }
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("threads");
+    tree->writeJson(writer);
+    if (tree->threadCount() == static_cast<size_t>(query.threads)) {
+        writer.field("next_cursor", tree->nodes()[tree->threadCount() - 1].cursor());
+    } else {
+        writer.nullField("next_cursor");
+    }
+    writer.endObject();
+
+    return createJsonResponse(200, writer.str());
+}
+
+HttpResponse AcademicSocialServer::handleGetCommentReplies(const HttpRequest& request) {
+    int comment_id = extractIdFromPath(request.path, "/api/comments/");
+    if (comment_id < 0) {
+        return createErrorResponse(400, "Invalid comment ID");
+    }
+
+    auto parent = comment_repository_->findById(comment_id);
+    if (!parent.has_value()) {
+        return createErrorResponse(404, "Comment not found");
+    }
+
+    return handleGetCommentThreads(request, parent->getPostId(), &parent.value());
 }
 
 HttpResponse AcademicSocialServer::handleReplyToComment(const HttpRequest& request) {
@@ -2038,7 +2640,12 @@ HttpResponse AcademicSocialServer::handleReplyToComment(const HttpRequest& reque
         return createErrorResponse(404, "Parent comment not found");
     }
     
-    std::string content = extractJsonField(request.body, "content");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string content = body.getString("content").value_or("");
     if (content.empty()) {
         return createErrorResponse(400, "content is required");
     }
@@ -2075,7 +2682,12 @@ HttpResponse AcademicSocialServer::handleUpdateComment(const HttpRequest& reques
         return createErrorResponse(403, "You can only edit your own comments");
     }
     
-    std::string content = extractJsonField(request.body, "content");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string content = body.getString("content").value_or("");
     if (!content.empty()) {
         comment->setContent(content);
     }
@@ -2128,9 +2740,14 @@ HttpResponse AcademicSocialServer::handleCreateGroup(const HttpRequest& request)
         return createErrorResponse(403, "Only professors and admins can create groups");
     }
     
-    std::string name = extractJsonField(request.body, "name");
-    std::string description = extractJsonField(request.body, "description");
-    std::string privacy = extractJsonField(request.body, "privacy");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string name = body.getString("name").value_or("");
+    std::string description = body.getString("description").value_or("");
+    std::string privacy = body.getString("privacy").value_or("");
     
     if (name.empty()) {
         return createErrorResponse(400, "Group name is required");
@@ -2175,34 +2792,39 @@ HttpResponse AcademicSocialServer::handleGetGroups(const HttpRequest& request) {
         groups = group_repository_->findAll();
     }
 
-    std::ostringstream oss;
-    oss << "{\"groups\":[";
-    for (size_t i = 0; i < groups.size(); ++i) {
-        if (i > 0) oss << ",";
-
-        // Get the base JSON and remove the closing brace
-        std::string base_json = groups[i].toJson();
-        base_json.pop_back(); // Remove '}'
-
-        oss << base_json;
-
-        // Add user_role and member_count fields
-        if (groups[i].getId().has_value()) {
-            int group_id = groups[i].getId().value();
-            std::string user_role = group_repository_->getMemberRole(group_id, user_id);
-            int member_count = group_repository_->getMemberCount(group_id);
+    // One GROUP BY query each for roles and counts instead of two per group
+    utils::BatchLoader<int, std::string> user_roles(
+        [this, user_id](const std::vector<int>& ids) { return group_repository_->getMemberRoles(ids, user_id); });
+    utils::BatchLoader<int, int> member_counts(
+        [this](const std::vector<int>& ids) { return group_repository_->getMemberCounts(ids); }, 0);
+    for (const auto& group : groups) {
+        if (group.getId().has_value()) {
+            user_roles.prime(group.getId().value());
+            member_counts.prime(group.getId().value());
+        }
+    }
 
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("groups").beginArray();
+    for (const auto& group : groups) {
+        writer.beginObject();
+        group.writeJsonFields(writer);
+        if (group.getId().has_value()) {
+            int group_id = group.getId().value();
+            const std::string& user_role = user_roles.load(group_id);
             if (!user_role.empty()) {
-                oss << ",\"user_role\":\"" << user_role << "\"";
+                writer.field("user_role", user_role);
             }
-            oss << ",\"member_count\":" << member_count;
+            writer.field("member_count", member_counts.load(group_id));
         }
-
-        oss << "}";
+        writer.endObject();
     }
-    oss << "],\"total\":" << groups.size() << "}";
+    writer.endArray();
+    writer.field("total", groups.size());
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetGroup(const HttpRequest& request) {
@@ -2245,9 +2867,14 @@ HttpResponse AcademicSocialServer::handleUpdateGroup(const HttpRequest& request)
         return createErrorResponse(403, "You don't have permission to update this group");
     }
     
-    std::string name = extractJsonField(request.body, "name");
-    std::string description = extractJsonField(request.body, "description");
-    std::string privacy = extractJsonField(request.body, "privacy");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string name = body.getString("name").value_or("");
+    std::string description = body.getString("description").value_or("");
+    std::string privacy = body.getString("privacy").value_or("");
     
     if (!name.empty()) {
         group->setName(name);
@@ -2310,14 +2937,22 @@ HttpResponse AcademicSocialServer::handleAddGroupMember(const HttpRequest& reque
         return createErrorResponse(404, "Group not found");
     }
     
-    std::string user_id_str = extractJsonField(request.body, "user_id");
-    std::string role = extractJsonField(request.body, "role");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string role = body.getString("role").value_or("");
     
-    if (user_id_str.empty()) {
+    if (!body.has("user_id")) {
         return createErrorResponse(400, "User ID is required");
     }
     
-    int member_user_id = std::stoi(user_id_str);
+    auto member_user_id_opt = body.getInt("user_id");
+    if (!member_user_id_opt.has_value()) {
+        return createErrorResponse(400, "user_id must be an integer");
+    }
+    int member_user_id = static_cast<int>(member_user_id_opt.value());
     if (role.empty()) {
         role = "member";
     }
@@ -2399,7 +3034,12 @@ HttpResponse AcademicSocialServer::handleUpdateGroupMemberRole(const HttpRequest
         return createErrorResponse(403, "You don't have permission to update member roles");
     }
     
-    std::string role = extractJsonField(request.body, "role");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string role = body.getString("role").value_or("");
     if (role.empty()) {
         return createErrorResponse(400, "Role is required");
     }
@@ -2423,11 +3063,16 @@ HttpResponse AcademicSocialServer::handleCreateOrganization(const HttpRequest& r
         return createErrorResponse(403, "Only admins can create organizations");
     }
     
-    std::string name = extractJsonField(request.body, "name");
-    std::string type = extractJsonField(request.body, "type");
-    std::string description = extractJsonField(request.body, "description");
-    std::string email = extractJsonField(request.body, "email");
-    std::string website = extractJsonField(request.body, "website");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string name = body.getString("name").value_or("");
+    std::string type = body.getString("type").value_or("");
+    std::string description = body.getString("description").value_or("");
+    std::string email = body.getString("email").value_or("");
+    std::string website = body.getString("website").value_or("");
     
     if (name.empty()) {
         return createErrorResponse(400, "Organization name is required");
@@ -2485,15 +3130,17 @@ HttpResponse AcademicSocialServer::handleGetOrganizations(const HttpRequest& req
     // In production, you'd want a separate count query
     int total = orgs.size();
 
-    std::ostringstream oss;
-    oss << "{\"organizations\":[";
-    for (size_t i = 0; i < orgs.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << orgs[i].toJson();
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("organizations").beginArray();
+    for (const auto& org : orgs) {
+        org.writeJson(writer);
     }
-    oss << "],\"total\":" << orgs.size() << "}";
+    writer.endArray();
+    writer.field("total", total);
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetOrganization(const HttpRequest& request) {
@@ -2536,11 +3183,16 @@ HttpResponse AcademicSocialServer::handleUpdateOrganization(const HttpRequest& r
         return createErrorResponse(403, "You don't have permission to update this organization");
     }
     
-    std::string name = extractJsonField(request.body, "name");
-    std::string type = extractJsonField(request.body, "type");
-    std::string description = extractJsonField(request.body, "description");
-    std::string email = extractJsonField(request.body, "email");
-    std::string website = extractJsonField(request.body, "website");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string name = body.getString("name").value_or("");
+    std::string type = body.getString("type").value_or("");
+    std::string description = body.getString("description").value_or("");
+    std::string email = body.getString("email").value_or("");
+    std::string website = body.getString("website").value_or("");
     
     if (!name.empty()) {
         org->setName(name);
@@ -2609,14 +3261,22 @@ HttpResponse AcademicSocialServer::handleAddOrganizationAccount(const HttpReques
         return createErrorResponse(404, "Organization not found");
     }
     
-    std::string account_user_id_str = extractJsonField(request.body, "user_id");
-    std::string role = extractJsonField(request.body, "role");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string role = body.getString("role").value_or("");
     
-    if (account_user_id_str.empty()) {
+    if (!body.has("user_id")) {
         return createErrorResponse(400, "User ID is required");
     }
     
-    int account_user_id = std::stoi(account_user_id_str);
+    auto account_user_id_opt = body.getInt("user_id");
+    if (!account_user_id_opt.has_value()) {
+        return createErrorResponse(400, "user_id must be an integer");
+    }
+    int account_user_id = static_cast<int>(account_user_id_opt.value());
     if (role.empty()) {
         role = "editor";
     }
@@ -2681,19 +3341,90 @@ HttpResponse AcademicSocialServer::handleGetConversations(const HttpRequest& req
     
     auto conversations = conversation_repository_->getUserConversations(user_id);
     
-    std::ostringstream oss;
-    oss << "{\"conversations\":[";
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("conversations").beginArray();
+    for (const auto& conversation : conversations) {
+        conversation.write_json(writer);
+    }
+    writer.endArray();
+    writer.field("count", conversations.size());
+    writer.endObject();
     
-    for (size_t i = 0; i < conversations.size(); ++i) {
-        oss << conversations[i].to_json();
-        if (i < conversations.size() - 1) {
-            oss << ",";
+    return createJsonResponse(200, writer.str());
+}
+
+HttpResponse AcademicSocialServer::handleGetInbox(const HttpRequest& request) {
+    int user_id = getUserIdFromAuth(request);
+    if (user_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
+    }
+
+    int limit = 30;
+    std::string limit_str = getQueryParam(request.path, "limit");
+    if (!limit_str.empty()) {
+        try {
+            limit = std::stoi(limit_str);
+        } catch (...) {
+            return createErrorResponse(400, "Invalid limit");
         }
+        limit = std::max(1, std::min(limit, 100));
     }
-    
-    oss << "],\"count\":" << conversations.size() << "}";
-    
-    return createJsonResponse(200, oss.str());
+
+    long long before_at_us = 0;
+    int before_id = 0;
+    std::string cursor = getQueryParam(request.path, "cursor");
+    if (!cursor.empty() && !parseKeysetCursor(cursor, before_at_us, before_id)) {
+        return createErrorResponse(400, "Invalid cursor");
+    }
+
+    auto entries = conversation_repository_->getInbox(user_id, limit, before_at_us, before_id);
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("conversations").beginArray();
+    for (const auto& entry : entries) {
+        entry.write_json(writer);
+    }
+    writer.endArray();
+    if (entries.size() == static_cast<size_t>(limit)) {
+        const auto& last = entries.back();
+        writer.field("next_cursor", std::to_string(last.last_message_at_us) + ":" +
+                                    std::to_string(last.conversation_id));
+    } else {
+        writer.nullField("next_cursor");
+    }
+    writer.endObject();
+
+    return createJsonResponse(200, writer.str());
+}
+
+HttpResponse AcademicSocialServer::handleMarkConversationRead(const HttpRequest& request) {
+    int user_id = getUserIdFromAuth(request);
+    if (user_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
+    }
+
+    int conversation_id = extractIdFromPath(request.path, "/api/conversations/");
+    if (conversation_id < 0) {
+        return createErrorResponse(400, "Invalid conversation ID");
+    }
+
+    auto conversation = conversation_repository_->getById(conversation_id);
+    if (!conversation.has_value()) {
+        return createErrorResponse(404, "Conversation not found");
+    }
+
+    if (conversation->user1_id != user_id && conversation->user2_id != user_id) {
+        return createErrorResponse(403, "You don't have access to this conversation");
+    }
+
+    // One statement; the inbox trigger zeroes the unread count with it
+    if (message_repository_->markAllAsRead(conversation_id, user_id)) {
+        return HttpResponse(204, "text/plain", "");
+    }
+
+    return createErrorResponse(500, "Failed to mark conversation as read");
 }
 
 HttpResponse AcademicSocialServer::handleGetOrCreateConversation(const HttpRequest& request) {
@@ -2702,17 +3433,20 @@ HttpResponse AcademicSocialServer::handleGetOrCreateConversation(const HttpReque
         return createErrorResponse(401, "Unauthorized");
     }
     
-    std::string other_user_id_str = extractJsonField(request.body, "user_id");
-    if (other_user_id_str.empty()) {
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    if (!body.has("user_id")) {
         return createErrorResponse(400, "Missing user_id field");
     }
     
-    int other_user_id;
-    try {
-        other_user_id = std::stoi(other_user_id_str);
-    } catch (const std::exception&) {
+    auto other_user_id_opt = body.getInt("user_id");
+    if (!other_user_id_opt.has_value()) {
         return createErrorResponse(400, "Invalid user_id");
     }
+    int other_user_id = static_cast<int>(other_user_id_opt.value());
     
     if (other_user_id == user_id) {
         return createErrorResponse(400, "Cannot create conversation with yourself");
@@ -2777,21 +3511,19 @@ HttpResponse AcademicSocialServer::handleGetMessages(const HttpRequest& request)
     
     auto messages = message_repository_->getConversationMessages(conversation_id, limit, offset);
     
-    std::ostringstream oss;
-    oss << "{\"messages\":[";
-    
-    for (size_t i = 0; i < messages.size(); ++i) {
-        oss << messages[i].to_json();
-        if (i < messages.size() - 1) {
-            oss << ",";
-        }
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("messages").beginArray();
+    for (const auto& msg : messages) {
+        msg.write_json(writer);
     }
+    writer.endArray();
+    writer.field("count", messages.size());
+    writer.field("limit", limit);
+    writer.field("offset", offset);
+    writer.endObject();
     
-    oss << "],\"count\":" << messages.size();
-    oss << ",\"limit\":" << limit;
-    oss << ",\"offset\":" << offset << "}";
-    
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleSendMessage(const HttpRequest& request) {
@@ -2805,6 +3537,38 @@ HttpResponse AcademicSocialServer::handleSendMessage(const HttpRequest& request)
         return createErrorResponse(400, "Invalid conversation ID");
     }
     
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string content = body.getString("content").value_or("");
+    if (content.empty()) {
+        return createErrorResponse(400, "Message content cannot be empty");
+    }
+    
+    std::string media_url = body.getString("media_url").value_or("");
+    
+    if (async_db_) {
+        // Lookup, guarded insert and timestamp bump in a single round trip
+        auto results = async_db_->execute(repositories::MessageRepository::sendMessageBatch(
+            conversation_id, user_id, content, media_url)).get();
+        if (!results[0].ok() || !results[1].ok() || !results[2].ok()) {
+            return createErrorResponse(500, "Failed to send message");
+        }
+        if (results[0].rowCount() == 0) {
+            return createErrorResponse(404, "Conversation not found");
+        }
+        auto message = repositories::MessageRepository::messageFromResult(results[1]);
+        if (!message.has_value()) {
+            return createErrorResponse(403, "You don't have access to this conversation");
+        }
+        conversation_repository_->touchCached(conversation_id);
+        // The async connection bypasses Statement's read-your-writes tracking
+        database_->recordWriteBy(user_id);
+        return createJsonResponse(201, message->to_json());
+    }
+    
     // Check if user is part of this conversation
     auto conversation = conversation_repository_->getById(conversation_id);
     if (!conversation.has_value()) {
@@ -2815,13 +3579,7 @@ HttpResponse AcademicSocialServer::handleSendMessage(const HttpRequest& request)
         return createErrorResponse(403, "You don't have access to this conversation");
     }
     
-    std::string content = extractJsonField(request.body, "content");
-    if (content.empty()) {
-        return createErrorResponse(400, "Message content cannot be empty");
-    }
-    
-    std::string media_url = extractJsonField(request.body, "media_url");
-    
+    db::UnitOfWork unit(*database_);
     auto message = message_repository_->createMessage(conversation_id, user_id, content, media_url);
     if (!message.has_value()) {
         return createErrorResponse(500, "Failed to send message");
@@ -2829,6 +3587,9 @@ HttpResponse AcademicSocialServer::handleSendMessage(const HttpRequest& request)
     
     // Update conversation's last_message_at timestamp
     conversation_repository_->updateLastMessageTime(conversation_id);
+    if (!unit.commit()) {
+        return createErrorResponse(500, "Failed to send message");
+    }
     
     return createJsonResponse(201, message->to_json());
 }
@@ -2920,7 +3681,23 @@ void AcademicSocialServer::setupWebSocketHandlers() {
             handleVoiceVideoToggle(user_id, message);
         });
 
-    // Register disconnect handler to cleanup voice sessions
+    websocket_server_->registerHandler("presence:update",
+        [this](int user_id, const WebSocketMessage& message) {
+            handlePresenceUpdate(user_id, message);
+        });
+
+    websocket_server_->registerConnectHandler(
+        [this](int user_id) {
+            handleUserConnect(user_id);
+        });
+
+    // Any message counts as activity for last_seen
+    websocket_server_->registerActivityHandler(
+        [this](int user_id) {
+            presence_tracker_->touch(user_id);
+        });
+
+    // Register disconnect handler to cleanup voice sessions and presence
     websocket_server_->registerDisconnectHandler(
         [this](int user_id) {
             handleUserDisconnect(user_id);
@@ -2929,29 +3706,18 @@ void AcademicSocialServer::setupWebSocketHandlers() {
 
 void AcademicSocialServer::handleChatMessage(int user_id, const WebSocketMessage& message) {
     // Parse payload to extract conversation_id and content
-    std::string payload = message.payload;
-    
-    // Extract conversation_id
-    std::regex conv_regex("\"conversation_id\"\\s*:\\s*(\\d+)");
-    std::smatch matches;
-    int conversation_id = 0;
-    if (std::regex_search(payload, matches, conv_regex)) {
-        conversation_id = std::stoi(matches[1].str());
-    }
-    
-    // Extract content
-    std::regex content_regex("\"content\"\\s*:\\s*\"([^\"]+)\"");
-    std::string content;
-    if (std::regex_search(payload, matches, content_regex)) {
-        content = matches[1].str();
-    }
+    utils::JsonDocument payload = utils::JsonDocument::parse(message.payload);
+    int conversation_id = static_cast<int>(payload.getInt("conversation_id").value_or(0));
+    std::string content = payload.getString("content").value_or("");
+    std::string client_ref = payload.getString("client_ref").value_or("");
     
     if (conversation_id <= 0 || content.empty()) {
         std::cerr << "Invalid chat message payload" << std::endl;
         return;
     }
     
-    // Verify user is part of this conversation
+    // Verify user is part of this conversation. This stays on the reader
+    // thread so one sender's messages are sequenced in the order they sent them.
     auto conversation_opt = conversation_repository_->getById(conversation_id);
     if (!conversation_opt.has_value()) {
         std::cerr << "Conversation not found: " << conversation_id << std::endl;
@@ -2964,45 +3730,68 @@ void AcademicSocialServer::handleChatMessage(int user_id, const WebSocketMessage
         return;
     }
     
-    // Create the message
-    auto new_message_opt = message_repository_->createMessage(conversation_id, user_id, content);
-    if (!new_message_opt.has_value()) {
-        std::cerr << "Failed to create message" << std::endl;
-        return;
-    }
-    
-    auto new_message = new_message_opt.value();
-    
-    // Update conversation's last_message_at
-    conversation_repository_->updateLastMessageTime(conversation_id);
-    
+    // Fan out now; the message is stored with the next group commit and
+    // acknowledged with its id from there
+    Message new_message;
+    new_message.conversation_id = conversation_id;
+    new_message.sender_id = user_id;
+    new_message.content = content;
+    auto queued = chat_ingest_queue_->enqueue(std::move(new_message),
+                                              {conversation.user1_id, conversation.user2_id}, client_ref);
+    sendChatMessage(queued.message, conversation.user1_id, conversation.user2_id, queued.sequence);
+}
+
+void AcademicSocialServer::sendChatMessage(const Message& message, int user1_id, int user2_id, uint64_t sequence) {
     // Prepare message to send to both users
-    std::ostringstream msg_json;
-    msg_json << "{\"id\":" << new_message.id
-             << ",\"conversation_id\":" << new_message.conversation_id
-             << ",\"sender_id\":" << new_message.sender_id
-             << ",\"content\":\"" << new_message.content << "\""
-             << ",\"created_at\":\"" << new_message.created_at << "\"}";
+    utils::JsonWriter writer;
+    writer.beginObject();
+    if (message.id > 0) {
+        writer.field("id", message.id);
+    } else {
+        writer.nullField("id");
+    }
+    if (sequence > 0) {
+        writer.field("seq", sequence);
+    }
+    writer.field("conversation_id", message.conversation_id);
+    writer.field("sender_id", message.sender_id);
+    writer.field("content", message.content);
+    writer.field("created_at", std::to_string(message.created_at));
+    writer.endObject();
     
-    WebSocketMessage ws_message("chat:message", msg_json.str());
+    WebSocketMessage ws_message("chat:message", writer.str());
     
     // Send to both participants
     std::set<int> participants;
-    participants.insert(conversation.user1_id);
-    participants.insert(conversation.user2_id);
+    participants.insert(user1_id);
+    participants.insert(user2_id);
+    websocket_server_->sendToUsers(participants, ws_message);
+}
+
+void AcademicSocialServer::acknowledgeChatMessage(const services::QueuedMessage& queued, bool persisted) {
+    // Everyone who saw the message learns its id, or that it was lost
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.field("seq", queued.sequence);
+    if (persisted) {
+        writer.field("id", queued.message.id);
+    }
+    writer.field("conversation_id", queued.message.conversation_id);
+    writer.field("sender_id", queued.message.sender_id);
+    if (!queued.client_ref.empty()) {
+        writer.field("client_ref", queued.client_ref);
+    }
+    writer.endObject();
+    
+    WebSocketMessage ws_message(persisted ? "chat:message:ack" : "chat:message:failed", writer.str());
+    std::set<int> participants(queued.recipients.begin(), queued.recipients.end());
     websocket_server_->sendToUsers(participants, ws_message);
 }
 
 void AcademicSocialServer::handleTypingIndicator(int user_id, const WebSocketMessage& message) {
     // Parse payload to extract conversation_id
-    std::string payload = message.payload;
-    
-    std::regex conv_regex("\"conversation_id\"\\s*:\\s*(\\d+)");
-    std::smatch matches;
-    int conversation_id = 0;
-    if (std::regex_search(payload, matches, conv_regex)) {
-        conversation_id = std::stoi(matches[1].str());
-    }
+    utils::JsonDocument payload = utils::JsonDocument::parse(message.payload);
+    int conversation_id = static_cast<int>(payload.getInt("conversation_id").value_or(0));
     
     if (conversation_id <= 0) {
         return;
@@ -3058,67 +3847,36 @@ void AcademicSocialServer::handleVoiceJoin(int user_id, const WebSocketMessage&
     }
     auto user = user_opt.value();
 
-    // Sync in-memory participants with database to handle server restarts and reconnections
-    // Get all active users from the database for this channel
-    std::vector<int> active_users_in_db = voice_channel_repository_->getActiveUsers(channel_id);
-
-    // Add user to voice channel participants and sync with database
-    int synced_users = 0;
-    {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-
-        // Ensure all users with active database sessions are in the in-memory map
-        for (int db_user_id : active_users_in_db) {
-            auto result = voice_channel_participants_[channel_id].insert(db_user_id);
-            if (result.second) {
-                synced_users++;
-                std::cout << "Synced user " << db_user_id << " from database to channel " << channel_id << std::endl;
-            }
-        }
-
-        // Add the newly joining user
-        voice_channel_participants_[channel_id].insert(user_id);
-    }
+    // Room state was rebuilt from voice_sessions at startup, so joining is
+    // purely in-memory; the HTTP join endpoint already recorded the session
+    VoiceRoomRegistry::Change joined = voice_rooms_.join(channel_id, user_id);
+    cancelVoiceChannelExpiry(channel_id);
 
     std::cout << "User " << user.getUsername() << " (id=" << user_id
-              << ") joined voice channel " << channel_id
-              << " (synced " << synced_users << " existing users from database)" << std::endl;
+              << ") joined voice channel " << channel_id << std::endl;
 
-    // FIX: Create TWO separate participant sets:
-    // 1. All participants (for logging)
-    // 2. Existing participants only (for broadcasting new user arrival)
-    std::set<int> all_participants;
+    // Existing participants only (for broadcasting new user arrival)
     std::set<int> existing_participants;
-
-    {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        auto it = voice_channel_participants_.find(channel_id);
-        if (it != voice_channel_participants_.end()) {
-            all_participants = it->second;
-
-            // Create set of existing participants (excluding the new user)
-            for (int participant_id : all_participants) {
-                if (participant_id != user_id) {
-                    existing_participants.insert(participant_id);
-                }
-            }
-
-            std::cout << "Room " << channel_id << " now has " << all_participants.size()
-                      << " user(s): ";
-            for (int p : all_participants) {
-                std::cout << p << " ";
-            }
-            std::cout << std::endl;
+    for (int participant_id : *joined.participants) {
+        if (participant_id != user_id) {
+            existing_participants.insert(participant_id);
         }
     }
 
+    std::cout << "Room " << channel_id << " now has " << joined.participants->size()
+              << " user(s): ";
+    for (int p : *joined.participants) {
+        std::cout << p << " ";
+    }
+    std::cout << std::endl;
+
     std::cout << "User " << user_id << " joined channel " << channel_id
               << ". Notifying " << existing_participants.size() << " existing participants" << std::endl;
 
     // Prepare join notification with user info
     std::string university_str = user.getUniversity().has_value() ? user.getUniversity().value() : "";
-    std::string escaped_username = escapeJsonString(user.getUsername());
-    std::string escaped_university = escapeJsonString(university_str);
+    std::string escaped_username = utils::JsonWriter::escape(user.getUsername());
+    std::string escaped_university = utils::JsonWriter::escape(university_str);
 
     std::ostringstream join_json;
     join_json << "{\"channel_id\":" << channel_id
@@ -3138,13 +3896,17 @@ void AcademicSocialServer::handleVoiceJoin(int user_id, const WebSocketMessage&
     std::ostringstream participants_json;
     participants_json << "{\"channel_id\":" << channel_id << ",\"participants\":[";
     bool first = true;
+    auto participants = makeUserLoader();
+    for (int participant_id : existing_participants) {
+        participants.prime(participant_id);
+    }
     for (int participant_id : existing_participants) {  // Use existing_participants here too
-        auto participant_opt = user_repository_->findById(participant_id);
+        const auto& participant_opt = participants.load(participant_id);
         if (participant_opt.has_value()) {
             auto participant = participant_opt.value();
             std::string participant_university = participant.getUniversity().has_value() ? participant.getUniversity().value() : "";
-            std::string escaped_participant_username = escapeJsonString(participant.getUsername());
-            std::string escaped_participant_university = escapeJsonString(participant_university);
+            std::string escaped_participant_username = utils::JsonWriter::escape(participant.getUsername());
+            std::string escaped_participant_university = utils::JsonWriter::escape(participant_university);
 
             if (!first) participants_json << ",";
             participants_json << "{\"user_id\":" << participant_id
@@ -3177,28 +3939,16 @@ void AcademicSocialServer::handleVoiceLeave(int user_id, const WebSocketMessage&
         return;
     }
 
-    // Remove user from channel and get remaining participants
-    std::set<int> remaining_participants;
-    {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        auto it = voice_channel_participants_.find(channel_id);
-        if (it != voice_channel_participants_.end()) {
-            it->second.erase(user_id);
-
-            // Get remaining participants AFTER removal
-            remaining_participants = it->second;
-
-            // Clean up empty channels
-            if (it->second.empty()) {
-                voice_channel_participants_.erase(it);
-            }
-        }
+    // Remove user from channel; empty rooms are dropped by the registry
+    VoiceRoomRegistry::Snapshot remaining_participants = voice_rooms_.leave(channel_id, user_id).participants;
+    if (remaining_participants->empty()) {
+        armVoiceChannelExpiry(channel_id);
     }
 
     std::cout << "User " << user_id << " left voice channel " << channel_id << std::endl;
-    std::cout << "Room " << channel_id << " now has " << remaining_participants.size()
+    std::cout << "Room " << channel_id << " now has " << remaining_participants->size()
               << " user(s): ";
-    for (int p : remaining_participants) {
+    for (int p : *remaining_participants) {
         std::cout << p << " ";
     }
     std::cout << std::endl;
@@ -3209,7 +3959,7 @@ void AcademicSocialServer::handleVoiceLeave(int user_id, const WebSocketMessage&
                << ",\"user_id\":" << user_id << "}";
 
     WebSocketMessage leave_msg("voice:user-left", leave_json.str());
-    websocket_server_->sendToUsers(remaining_participants, leave_msg);
+    websocket_server_->sendToUsers(*remaining_participants, leave_msg);
 }
 
 void AcademicSocialServer::handleVoiceOffer(int user_id, const WebSocketMessage& message) {
@@ -3241,17 +3991,16 @@ void AcademicSocialServer::handleVoiceOffer(int user_id, const WebSocketMessage&
 
     // Verify both users are in the same channel
     {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        auto it = voice_channel_participants_.find(channel_id);
-        if (it == voice_channel_participants_.end()) {
+        VoiceRoomRegistry::Snapshot members = voice_rooms_.participants(channel_id);
+        if (members->empty()) {
             std::cout << "Channel " << channel_id << " not found" << std::endl;
             return;
         }
-        if (it->second.find(user_id) == it->second.end()) {
+        if (members->find(user_id) == members->end()) {
             std::cout << "Sender user " << user_id << " not in channel " << channel_id << std::endl;
             return;
         }
-        if (it->second.find(target_user_id) == it->second.end()) {
+        if (members->find(target_user_id) == members->end()) {
             std::cout << "Target user " << target_user_id << " not in channel " << channel_id << std::endl;
             return;
         }
@@ -3287,11 +4036,7 @@ void AcademicSocialServer::handleVoiceAnswer(int user_id, const WebSocketMessage
 
     // Verify both users are in the same channel
     {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        auto it = voice_channel_participants_.find(channel_id);
-        if (it == voice_channel_participants_.end() ||
-            it->second.find(user_id) == it->second.end() ||
-            it->second.find(target_user_id) == it->second.end()) {
+        if (!voice_rooms_.containsBoth(channel_id, user_id, target_user_id)) {
             std::cerr << "Cannot forward answer: Users not in same voice channel" << std::endl;
             std::cerr << "   Sender: " << user_id << ", Target: " << target_user_id
                       << ", Channel: " << channel_id << std::endl;
@@ -3360,14 +4105,7 @@ void AcademicSocialServer::handleVoiceMute(int user_id, const WebSocketMessage&
     }
 
     // Get participants in the channel
-    std::set<int> participants;
-    {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        auto it = voice_channel_participants_.find(channel_id);
-        if (it != voice_channel_participants_.end()) {
-            participants = it->second;
-        }
-    }
+    VoiceRoomRegistry::Snapshot participants = voice_rooms_.participants(channel_id);
 
     // Broadcast mute status to all users in channel
     std::ostringstream mute_json;
@@ -3376,7 +4114,7 @@ void AcademicSocialServer::handleVoiceMute(int user_id, const WebSocketMessage&
               << ",\"muted\":" << (muted ? "true" : "false") << "}";
 
     WebSocketMessage mute_msg("voice:user-muted", mute_json.str());
-    websocket_server_->sendToUsers(participants, mute_msg);
+    websocket_server_->sendToUsers(*participants, mute_msg);
 }
 
 void AcademicSocialServer::handleVoiceVideoToggle(int user_id, const WebSocketMessage& message) {
@@ -3403,14 +4141,7 @@ void AcademicSocialServer::handleVoiceVideoToggle(int user_id, const WebSocketMe
     }
 
     // Get participants in the channel
-    std::set<int> participants;
-    {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        auto it = voice_channel_participants_.find(channel_id);
-        if (it != voice_channel_participants_.end()) {
-            participants = it->second;
-        }
-    }
+    VoiceRoomRegistry::Snapshot participants = voice_rooms_.participants(channel_id);
 
     // Broadcast video toggle status to all users in channel
     std::ostringstream video_json;
@@ -3419,38 +4150,60 @@ void AcademicSocialServer::handleVoiceVideoToggle(int user_id, const WebSocketMe
                << ",\"video_enabled\":" << (video_enabled ? "true" : "false") << "}";
 
     WebSocketMessage video_msg("voice:user-video-toggled", video_json.str());
-    websocket_server_->sendToUsers(participants, video_msg);
+    websocket_server_->sendToUsers(*participants, video_msg);
+}
+
+void AcademicSocialServer::handleUserConnect(int user_id) {
+    // Only the first socket changes anything friends can see
+    if (presence_tracker_->connect(user_id)) {
+        broadcastPresence(presence_tracker_->get(user_id), "user:online");
+    }
+}
+
+void AcademicSocialServer::handlePresenceUpdate(int user_id, const WebSocketMessage& message) {
+    utils::JsonDocument payload = utils::JsonDocument::parse(message.payload);
+    std::string status = payload.getString("status").value_or("");
+    std::string custom_status = payload.getString("custom_status").value_or("");
+
+    if (!services::PresenceTracker::isValidStatus(status) || custom_status.size() > 140) {
+        std::cerr << "Invalid presence update from user " << user_id << std::endl;
+        return;
+    }
+
+    auto presence = presence_tracker_->setStatus(user_id, status, custom_status);
+    if (presence.has_value()) {
+        broadcastPresence(presence.value(), "user:presence");
+    }
+}
+
+void AcademicSocialServer::broadcastPresence(const UserPresence& presence, const std::string& type) {
+    if (!websocket_server_) return;
+
+    // Friends only, plus the user's own other sockets; sendToUsers skips
+    // anyone who is not connected
+    std::vector<int> friend_ids = social_graph_.friendsOf(presence.user_id);
+    std::set<int> recipients(friend_ids.begin(), friend_ids.end());
+    recipients.insert(presence.user_id);
+
+    websocket_server_->sendToUsers(recipients, WebSocketMessage(type, presence.to_json()));
 }
 
 void AcademicSocialServer::handleUserDisconnect(int user_id) {
+    if (presence_tracker_->disconnect(user_id)) {
+        broadcastPresence(presence_tracker_->get(user_id), "user:offline");
+    }
+
     std::cout << "Cleaning up voice sessions for disconnected user: " << user_id << std::endl;
 
-    // Find all channels the user was in
-    std::vector<int> channels_to_notify;
-    {
-        std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-        for (auto& [channel_id, participants] : voice_channel_participants_) {
-            if (participants.find(user_id) != participants.end()) {
-                channels_to_notify.push_back(channel_id);
-                participants.erase(user_id);
-
-                // Clean up empty channels
-                if (participants.empty()) {
-                    voice_channel_participants_.erase(channel_id);
-                }
-            }
-        }
-    }
+    // The registry's user -> rooms index finds the user's rooms directly and
+    // queues the voice_sessions update for the next batched flush
+    auto rooms_left = voice_rooms_.leaveAll(user_id);
 
     // Notify other users in those channels that this user left
-    for (int channel_id : channels_to_notify) {
-        std::set<int> remaining_participants;
-        {
-            std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-            auto it = voice_channel_participants_.find(channel_id);
-            if (it != voice_channel_participants_.end()) {
-                remaining_participants = it->second;
-            }
+    for (const auto& [channel_id, remaining_participants] : rooms_left) {
+        if (remaining_participants->empty()) {
+            armVoiceChannelExpiry(channel_id);
+            continue;
         }
 
         std::ostringstream leave_json;
@@ -3458,55 +4211,241 @@ void AcademicSocialServer::handleUserDisconnect(int user_id) {
                    << ",\"user_id\":" << user_id << "}";
 
         WebSocketMessage leave_msg("voice:user-left", leave_json.str());
-        websocket_server_->sendToUsers(remaining_participants, leave_msg);
+        websocket_server_->sendToUsers(*remaining_participants, leave_msg);
 
         std::cout << "Notified channel " << channel_id << " that user " << user_id << " left" << std::endl;
     }
+}
+
+void AcademicSocialServer::flushVoiceSessionEnds() {
+    if (!voice_channel_repository_) {
+        return;
+    }
 
-    // End all active voice sessions in the database
-    if (voice_channel_repository_) {
-        int sessions_ended = voice_channel_repository_->endAllUserSessions(user_id);
-        std::cout << "Ended " << sessions_ended << " voice session(s) for user " << user_id << std::endl;
+    std::vector<VoiceRoomRegistry::SessionEnd> ends = voice_rooms_.takePendingSessionEnds();
+    if (ends.empty()) {
+        return;
+    }
+
+    std::vector<int> user_ids;
+    std::vector<int> ended_at;
+    user_ids.reserve(ends.size());
+    ended_at.reserve(ends.size());
+    for (const auto& end : ends) {
+        user_ids.push_back(end.user_id);
+        ended_at.push_back(static_cast<int>(end.ended_at));
+    }
+
+    int sessions_ended = voice_channel_repository_->endUserSessionsBatch(user_ids, ended_at);
+    if (sessions_ended < 0) {
+        std::cerr << "Failed to end voice sessions for " << ends.size() << " disconnect(s); will retry" << std::endl;
+        voice_rooms_.requeueSessionEnds(ends);
+        return;
+    }
+    if (sessions_ended > 0) {
+        std::cout << "Ended " << sessions_ended << " voice session(s) for "
+                  << ends.size() << " disconnected user(s)" << std::endl;
     }
 }
 
-void AcademicSocialServer::runVoiceChannelCleanup() {
-    std::cout << "Voice channel cleanup task started" << std::endl;
+void AcademicSocialServer::scheduleBackgroundJobs() {
+    // Batched writes behind in-memory state
+    scheduler_.scheduleEvery(std::chrono::seconds(1), [this]() {
+        flushVoiceSessionEnds();
+        reapExpiredVoiceChannels();
+        if (post_repository_) {
+            post_repository_->flushReactionCounts();
+        }
+    });
+
+    // Notifications: short interval bounds push latency for uncoalesced ones
+    scheduler_.scheduleEvery(std::chrono::milliseconds(250), [this]() {
+        notification_dispatcher_->flush();
+    });
+
+    // Presence: last_seen in the table lags memory by at most this much
+    scheduler_.scheduleEvery(std::chrono::seconds(5), [this]() {
+        presence_tracker_->flush();
+    });
+
+    // Replica health and lag; a lagging replica leaves rotation until it catches up
+    if (database_->replicaCount() > 0) {
+        replica_monitor_.scheduleEvery(std::chrono::seconds(2), [this]() {
+            database_->checkReplicas();
+        });
+    }
+
+    // Social graph: fold accepted/deleted friendships into the compact arrays
+    scheduler_.scheduleEvery(std::chrono::seconds(60), [this]() {
+        social_graph_.compact();
+    });
+
+    // Drift correction for materialized counters
+    maintenance_.scheduleEvery(std::chrono::hours(1), [this]() {
+        repairCounters();
+    });
 
-    while (cleanup_running_) {
-        // Sleep for 5 minutes before checking
-        for (int i = 0; i < 300 && cleanup_running_; i++) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+    // Channels that emptied before a restart have no armed timer; catch them
+    // at startup and then hourly
+    sweepInactiveVoiceChannels();
+    maintenance_.scheduleEvery(std::chrono::hours(1), [this]() {
+        sweepInactiveVoiceChannels();
+    });
+}
+
+void AcademicSocialServer::armVoiceChannelExpiry(int channel_id) {
+    std::lock_guard<std::mutex> lock(voice_expiry_mutex_);
+    if (voice_channel_expiry_.count(channel_id) > 0) {
+        return;
+    }
+    voice_channel_expiry_[channel_id] = scheduler_.schedule(VOICE_CHANNEL_IDLE_TIMEOUT, [this, channel_id]() {
+        std::lock_guard<std::mutex> lock(voice_expiry_mutex_);
+        // Cancelled by a rejoin while this was already firing
+        if (voice_channel_expiry_.erase(channel_id) == 0) {
+            return;
         }
+        expired_voice_channels_.push_back(channel_id);
+    });
+}
 
-        if (!cleanup_running_) break;
+void AcademicSocialServer::cancelVoiceChannelExpiry(int channel_id) {
+    std::lock_guard<std::mutex> lock(voice_expiry_mutex_);
+    auto it = voice_channel_expiry_.find(channel_id);
+    if (it != voice_channel_expiry_.end()) {
+        scheduler_.cancel(it->second);
+        voice_channel_expiry_.erase(it);
+    }
+    // Expired but not yet reaped: keep it
+    expired_voice_channels_.erase(
+        std::remove(expired_voice_channels_.begin(), expired_voice_channels_.end(), channel_id),
+        expired_voice_channels_.end());
+}
 
-        // Find and delete empty inactive channels
-        if (voice_channel_repository_) {
-            std::vector<int> inactive_channels = voice_channel_repository_->findEmptyInactiveChannels(30);
+void AcademicSocialServer::reapExpiredVoiceChannels() {
+    std::vector<int> expired;
+    {
+        std::lock_guard<std::mutex> lock(voice_expiry_mutex_);
+        expired.swap(expired_voice_channels_);
+    }
+    if (expired.empty() || !voice_channel_repository_) {
+        return;
+    }
 
-            if (!inactive_channels.empty()) {
-                std::cout << "Found " << inactive_channels.size()
-                         << " voice channel(s) empty for more than 30 minutes" << std::endl;
+    // One DELETE for everything that expired this tick; channels someone
+    // rejoined in the meantime are skipped by the repository
+    std::vector<int> deleted = voice_channel_repository_->deleteEmptyChannels(expired);
+    for (int channel_id : deleted) {
+        voice_rooms_.removeRoom(channel_id);
+        std::cout << "Closed empty voice channel: " << channel_id << std::endl;
+    }
+}
 
-                for (int channel_id : inactive_channels) {
-                    if (voice_channel_repository_->deleteById(channel_id)) {
-                        std::cout << "Closed empty voice channel: " << channel_id << std::endl;
+void AcademicSocialServer::sweepInactiveVoiceChannels() {
+    if (!voice_channel_repository_) {
+        return;
+    }
 
-                        // Clean up in-memory state if present
-                        {
-                            std::lock_guard<std::mutex> lock(voice_channels_mutex_);
-                            voice_channel_participants_.erase(channel_id);
-                        }
-                    } else {
-                        std::cerr << "Failed to close voice channel: " << channel_id << std::endl;
-                    }
-                }
-            }
+    auto idle_minutes = std::chrono::duration_cast<std::chrono::minutes>(VOICE_CHANNEL_IDLE_TIMEOUT).count();
+    std::vector<int> inactive_channels =
+        voice_channel_repository_->findEmptyInactiveChannels(static_cast<int>(idle_minutes));
+    if (inactive_channels.empty()) {
+        return;
+    }
+
+    std::vector<int> deleted = voice_channel_repository_->deleteEmptyChannels(inactive_channels);
+    for (int channel_id : deleted) {
+        voice_rooms_.removeRoom(channel_id);
+    }
+    if (!deleted.empty()) {
+        std::cout << "Closed " << deleted.size() << " voice channel(s) empty for more than "
+                  << idle_minutes << " minutes" << std::endl;
+    }
+}
+
+void AcademicSocialServer::repairCounters() {
+    auto& corrected = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_counter_repairs_total", "Materialized counter rows corrected by the repair job", {});
+
+    int fixed = 0;
+    if (group_repository_) fixed += group_repository_->repairMemberCounts();
+    if (post_repository_) fixed += post_repository_->repairReactionCounts();
+    if (voice_channel_repository_) fixed += voice_channel_repository_->repairActiveUserCounts();
+    if (notification_repository_) fixed += notification_repository_->repairUnreadCounts();
+    if (conversation_repository_) fixed += conversation_repository_->repairInbox();
+
+    if (fixed > 0) {
+        std::cout << "Counter repair corrected " << fixed << " row(s)" << std::endl;
+        corrected.inc(static_cast<uint64_t>(fixed));
+    }
+}
+
+void AcademicSocialServer::loadAutocompleteIndexes() {
+    std::vector<utils::PrefixIndex::Match> entries;
+
+    if (hashtag_repository_) {
+        for (const auto& hashtag : hashtag_repository_->findAllUsage()) {
+            entries.push_back({hashtag.getId().value_or(0), hashtag.getTag(), hashtag.getUsageCount()});
+        }
+        hashtag_index_.rebuild(entries);
+    }
+
+    entries.clear();
+    if (user_repository_) {
+        for (const auto& user : user_repository_->findAllUsernamePopularity()) {
+            entries.push_back({user.id, user.username, user.friend_count});
         }
+        username_index_.rebuild(entries);
+    }
+
+    std::cout << "Autocomplete indexes loaded: " << hashtag_index_.size() << " hashtag(s), "
+              << username_index_.size() << " username(s)" << std::endl;
+}
+
+void AcademicSocialServer::loadTrendingHashtags() {
+    if (!hashtag_repository_) return;
+
+    // Replay the longest window; older uses have decayed to nothing anyway
+    auto usages = hashtag_repository_->findRecentUsage(7 * 24 * 3600);
+    for (const auto& usage : usages) {
+        auto used_at = utils::TrendingTracker::Clock::time_point(
+            std::chrono::duration_cast<utils::TrendingTracker::Clock::duration>(
+                std::chrono::duration<double>(usage.used_at)));
+        trending_hashtags_.record(usage.tag, usage.university, used_at);
     }
 
-    std::cout << "Voice channel cleanup task stopped" << std::endl;
+    std::cout << "Trending hashtags replayed " << usages.size() << " recent use(s)" << std::endl;
+}
+
+void AcademicSocialServer::loadPresence() {
+    if (!user_presence_repository_ || !presence_tracker_) return;
+
+    auto rows = user_presence_repository_->findAll();
+    presence_tracker_->load(rows);
+
+    // Rows a previous run left online are corrected by the first flush
+    std::cout << "Presence loaded for " << rows.size() << " user(s), "
+              << presence_tracker_->dirty() << " stale online" << std::endl;
+}
+
+void AcademicSocialServer::loadSocialGraph() {
+    if (!friendship_repository_) return;
+
+    social_graph_.rebuild(friendship_repository_->findAcceptedPairs());
+
+    std::cout << "Social graph loaded: " << social_graph_.userCount() << " user(s), "
+              << social_graph_.friendshipCount() << " friendship(s)" << std::endl;
+}
+
+void AcademicSocialServer::deliverNotifications(const std::vector<Notification>& notifications) {
+    if (!websocket_server_) return;
+
+    // One fan-out per drained batch; offline recipients are skipped there
+    // and read theirs from /api/notifications later
+    std::map<int, std::vector<WebSocketMessage>> by_recipient;
+    for (const auto& notification : notifications) {
+        by_recipient[notification.user_id].emplace_back("notification:new", notification.to_json());
+    }
+    websocket_server_->sendToUsers(by_recipient);
 }
 
 // Voice/Murmur handler implementations
@@ -3517,8 +4456,13 @@ HttpResponse AcademicSocialServer::handleCreateVoiceChannel(const HttpRequest& r
         return createErrorResponse(401, "Unauthorized");
     }
     
-    std::string name = extractJsonField(request.body, "name");
-    std::string channel_type = extractJsonField(request.body, "channel_type");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+    
+    std::string name = body.getString("name").value_or("");
+    std::string channel_type = body.getString("channel_type").value_or("");
     
     if (name.empty()) {
         return createErrorResponse(400, "Channel name is required");
@@ -3537,14 +4481,22 @@ HttpResponse AcademicSocialServer::handleCreateVoiceChannel(const HttpRequest& r
     int group_id = 0;
     int organization_id = 0;
     
-    std::string group_id_str = extractJsonField(request.body, "group_id");
-    if (!group_id_str.empty()) {
-        group_id = std::stoi(group_id_str);
+    auto group_id_value = body["group_id"];
+    if (group_id_value.exists() && !group_id_value.isNull()) {
+        auto parsed = group_id_value.getInt();
+        if (!parsed.has_value()) {
+            return createErrorResponse(400, "group_id must be an integer");
+        }
+        group_id = static_cast<int>(parsed.value());
     }
     
-    std::string org_id_str = extractJsonField(request.body, "organization_id");
-    if (!org_id_str.empty()) {
-        organization_id = std::stoi(org_id_str);
+    auto org_id_value = body["organization_id"];
+    if (org_id_value.exists() && !org_id_value.isNull()) {
+        auto parsed = org_id_value.getInt();
+        if (!parsed.has_value()) {
+            return createErrorResponse(400, "organization_id must be an integer");
+        }
+        organization_id = static_cast<int>(parsed.value());
     }
     
     // Create channel using VoiceService
@@ -3607,27 +4559,30 @@ HttpResponse AcademicSocialServer::handleGetVoiceChannels(const HttpRequest& req
         channels = voice_channel_repository_->findAll(limit, offset);
     }
     
-    // Get active user counts for each channel
-    std::ostringstream oss;
-    oss << "{\"channels\":[";
-    
-    for (size_t i = 0; i < channels.size(); ++i) {
-        oss << "{";
-        oss << "\"id\":" << channels[i].id << ",";
-        oss << "\"name\":\"" << channels[i].name << "\",";
-        oss << "\"channel_type\":\"" << channels[i].channel_type << "\",";
-        oss << "\"active_users\":" << voice_channel_repository_->getActiveUserCount(channels[i].id) << ",";
-        oss << "\"created_at\":\"" << channels[i].created_at << "\"";
-        oss << "}";
-        
-        if (i < channels.size() - 1) {
-            oss << ",";
-        }
+    // Get active user counts for all channels with one query
+    utils::BatchLoader<int, int> active_users(
+        [this](const std::vector<int>& ids) { return voice_channel_repository_->getActiveUserCounts(ids); }, 0);
+    for (const auto& channel : channels) {
+        active_users.prime(channel.id);
     }
-    
-    oss << "],\"count\":" << channels.size() << "}";
-    
-    return createJsonResponse(200, oss.str());
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("channels").beginArray();
+    for (const auto& channel : channels) {
+        writer.beginObject();
+        writer.field("id", channel.id);
+        writer.field("name", channel.name);
+        writer.field("channel_type", channel.channel_type);
+        writer.field("active_users", active_users.load(channel.id));
+        writer.field("created_at", std::to_string(channel.created_at));
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.field("count", channels.size());
+    writer.endObject();
+
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetVoiceChannel(const HttpRequest& request) {
@@ -3762,58 +4717,311 @@ HttpResponse AcademicSocialServer::handleDeleteVoiceChannel(const HttpRequest& r
 // ==================== Hashtag Handlers ====================
 
 HttpResponse AcademicSocialServer::handleGetTrendingHashtags(const HttpRequest& request) {
-    // Parse limit parameter
     int limit = 10;
-    std::regex limit_regex("[?&]limit=(\\d+)");
-    std::smatch match;
-    if (std::regex_search(request.path, match, limit_regex)) {
-        limit = std::stoi(match[1].str());
+    std::string limit_str = getQueryParam(request.path, "limit");
+    if (!limit_str.empty()) {
+        try {
+            limit = std::stoi(limit_str);
+        } catch (...) {
+            return createErrorResponse(400, "Invalid limit");
+        }
+        limit = std::max(1, std::min(limit, 50));
     }
 
-    auto hashtags = hashtag_repository_->findTrending(limit);
+    std::string window = getQueryParam(request.path, "window");
+    if (window.empty()) {
+        window = "24h";
+    }
+    if (!trending_hashtags_.hasWindow(window)) {
+        return createErrorResponse(400, "Invalid window. Must be '1h', '24h', or '7d'");
+    }
 
-    std::ostringstream oss;
-    oss << "{\"hashtags\":[";
-    for (size_t i = 0; i < hashtags.size(); ++i) {
-        oss << hashtags[i].toJson();
-        if (i < hashtags.size() - 1) oss << ",";
+    // Empty university means trending across all universities
+    std::string university = getQueryParam(request.path, "university");
+    auto trending = trending_hashtags_.top(window, university, static_cast<size_t>(limit));
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.field("window", window);
+    if (!university.empty()) {
+        writer.field("university", university);
     }
-    oss << "]}";
+    writer.key("hashtags").beginArray();
+    for (const auto& entry : trending) {
+        writer.beginObject()
+              .field("tag", entry.tag)
+              .field("score", entry.score)
+              .endObject();
+    }
+    writer.endArray();
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleSearchHashtags(const HttpRequest& request) {
-    // Parse query and limit parameters
-    std::string query = "";
+    // Tags are stored lowercased by TextParser, so fold the (percent-decoded,
+    // possibly non-ASCII) prefix the same way
+    std::string query = utils::TextParser::toLower(getQueryParam(request.path, "q"));
+    if (query.empty()) {
+        return createErrorResponse(400, "Query parameter 'q' is required");
+    }
+
+    int limit = 10;
+    std::string limit_str = getQueryParam(request.path, "limit");
+    if (!limit_str.empty()) {
+        try {
+            limit = std::stoi(limit_str);
+        } catch (...) {
+            return createErrorResponse(400, "Invalid limit");
+        }
+    }
+    limit = std::max(1, std::min(limit, 10));
+
+    // Served from the in-memory prefix index (top 10 per prefix)
+    auto matches = hashtag_index_.complete(query, static_cast<size_t>(limit));
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("hashtags").beginArray();
+    for (const auto& match : matches) {
+        Hashtag hashtag(match.text);
+        hashtag.setId(match.id);
+        hashtag.setUsageCount(static_cast<int>(match.score));
+        hashtag.writeJson(writer);
+    }
+    writer.endArray();
+    writer.endObject();
+
+    return createJsonResponse(200, writer.str());
+}
+
+// Search cursor format: "<rank>:<id>" of the last hit on the previous page
+static bool parseSearchCursor(const std::string& cursor, double& rank, int& id) {
+    size_t colon = cursor.find(':');
+    if (colon == std::string::npos) return false;
+    try {
+        size_t used = 0;
+        rank = std::stod(cursor.substr(0, colon), &used);
+        if (used != colon) return false;
+        id = std::stoi(cursor.substr(colon + 1), &used);
+        return used == cursor.size() - colon - 1 && id > 0;
+    } catch (...) {
+        return false;
+    }
+}
+
+static std::string formatSearchCursor(double rank, int id) {
+    // ts_rank is a float4; 9 significant digits round-trip it exactly
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%.9g:%d", rank, id);
+    return buffer;
+}
+
+HttpResponse AcademicSocialServer::handleSearch(const HttpRequest& request) {
+    int viewer_id = getUserIdFromAuth(request);
+    if (viewer_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
+    }
+
+    std::string query = getQueryParam(request.path, "q");
+    if (query.empty()) {
+        return createErrorResponse(400, "Query parameter 'q' is required");
+    }
+    if (query.size() > 256) {
+        return createErrorResponse(400, "Query is too long");
+    }
+
+    std::string type = getQueryParam(request.path, "type");
+    if (type.empty()) {
+        type = "all";
+    }
+    if (type != "all" && type != "posts" && type != "users") {
+        return createErrorResponse(400, "Invalid type. Must be 'posts', 'users', or 'all'");
+    }
+
     int limit = 20;
+    std::string limit_str = getQueryParam(request.path, "limit");
+    if (!limit_str.empty()) {
+        try {
+            limit = std::stoi(limit_str);
+        } catch (...) {
+            return createErrorResponse(400, "Invalid limit");
+        }
+        limit = std::max(1, std::min(limit, 50));
+    }
 
-    std::regex query_regex("[?&]q=([^&]+)");
-    std::regex limit_regex("[?&]limit=(\\d+)");
-    std::smatch match;
+    // A cursor continues one result list, so it needs a single type
+    double after_rank = 0.0;
+    int after_id = 0;
+    std::string cursor = getQueryParam(request.path, "cursor");
+    if (!cursor.empty()) {
+        if (type == "all") {
+            return createErrorResponse(400, "cursor requires type=posts or type=users");
+        }
+        if (!parseSearchCursor(cursor, after_rank, after_id)) {
+            return createErrorResponse(400, "Invalid cursor");
+        }
+    }
 
-    if (std::regex_search(request.path, match, query_regex)) {
-        query = match[1].str();
+    bool want_posts = type != "users";
+    bool want_users = type != "posts";
+
+    // Post hits depend on what the viewer may see; user hits do not
+    std::ostringstream cache_key;
+    cache_key << type << '|' << limit << '|' << cursor << '|'
+              << (want_posts ? viewer_id : 0) << '|' << query;
+    if (auto cached = search_cache_.get(cache_key.str())) {
+        return createJsonResponse(200, *cached);
+    }
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.field("query", query);
+
+    if (want_posts) {
+        auto hits = post_repository_->search(query, viewer_id, limit, after_rank, after_id);
+        writer.key("posts").beginObject();
+        writer.key("results").beginArray();
+        for (const auto& hit : hits) {
+            writer.beginObject();
+            writer.key("post");
+            hit.post.writeJson(writer);
+            writer.field("rank", hit.rank);
+            writer.field("headline", hit.headline);
+            writer.endObject();
+        }
+        writer.endArray();
+        if (static_cast<int>(hits.size()) == limit) {
+            writer.field("next_cursor", formatSearchCursor(hits.back().rank, hits.back().post.getId().value_or(0)));
+        } else {
+            writer.nullField("next_cursor");
+        }
+        writer.endObject();
+    }
+
+    if (want_users) {
+        auto hits = user_repository_->search(query, limit, after_rank, after_id);
+        writer.key("users").beginObject();
+        writer.key("results").beginArray();
+        for (const auto& hit : hits) {
+            writer.beginObject();
+            writer.key("user");
+            hit.user.writeJson(writer);
+            writer.field("rank", hit.rank);
+            writer.endObject();
+        }
+        writer.endArray();
+        if (static_cast<int>(hits.size()) == limit) {
+            writer.field("next_cursor", formatSearchCursor(hits.back().rank, hits.back().user.getId().value_or(0)));
+        } else {
+            writer.nullField("next_cursor");
+        }
+        writer.endObject();
     }
-    if (std::regex_search(request.path, match, limit_regex)) {
-        limit = std::stoi(match[1].str());
+
+    writer.endObject();
+
+    search_cache_.put(cache_key.str(), writer.str());
+    return createJsonResponse(200, writer.str());
+}
+
+HttpResponse AcademicSocialServer::handleAutocompleteUsers(const HttpRequest& request) {
+    int user_id = getUserIdFromAuth(request);
+    if (user_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
     }
 
+    std::string query = getQueryParam(request.path, "q");
     if (query.empty()) {
         return createErrorResponse(400, "Query parameter 'q' is required");
     }
 
-    auto hashtags = hashtag_repository_->searchTags(query, limit);
+    int limit = 10;
+    std::string limit_str = getQueryParam(request.path, "limit");
+    if (!limit_str.empty()) {
+        try {
+            limit = std::stoi(limit_str);
+        } catch (...) {
+            return createErrorResponse(400, "Invalid limit");
+        }
+        limit = std::max(1, std::min(limit, 10));
+    }
 
-    std::ostringstream oss;
-    oss << "{\"hashtags\":[";
-    for (size_t i = 0; i < hashtags.size(); ++i) {
-        oss << hashtags[i].toJson();
-        if (i < hashtags.size() - 1) oss << ",";
+    // Most-connected users first; ties in username order
+    auto matches = username_index_.complete(query, static_cast<size_t>(limit));
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("users").beginArray();
+    for (const auto& match : matches) {
+        writer.beginObject()
+              .field("id", match.id)
+              .field("username", match.text)
+              .endObject();
     }
-    oss << "]}";
+    writer.endArray();
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
+}
+
+HttpResponse AcademicSocialServer::handleGetUserPresence(const HttpRequest& request) {
+    int user_id = getUserIdFromAuth(request);
+    if (user_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
+    }
+
+    int target_id = extractIdFromPath(request.path, "/api/users/");
+    if (target_id < 0) {
+        return createErrorResponse(400, "Invalid user ID");
+    }
+
+    return createJsonResponse(200, presence_tracker_->get(target_id).to_json());
+}
+
+HttpResponse AcademicSocialServer::handleGetPresence(const HttpRequest& request) {
+    int user_id = getUserIdFromAuth(request);
+    if (user_id < 0) {
+        return createErrorResponse(401, "Unauthorized");
+    }
+
+    std::vector<UserPresence> presences;
+    std::string ids_param = getQueryParam(request.path, "user_ids");
+    if (ids_param.empty()) {
+        // No ids: the caller's friends who are online
+        for (const auto& presence : presence_tracker_->getByUserIds(social_graph_.friendsOf(user_id))) {
+            if (presence.status != "offline") {
+                presences.push_back(presence);
+            }
+        }
+    } else {
+        std::vector<int> user_ids;
+        std::stringstream ids_stream(ids_param);
+        std::string id_str;
+        while (std::getline(ids_stream, id_str, ',')) {
+            try {
+                user_ids.push_back(std::stoi(id_str));
+            } catch (...) {
+                return createErrorResponse(400, "Invalid user_ids");
+            }
+        }
+        if (user_ids.size() > 200) {
+            return createErrorResponse(400, "At most 200 user_ids");
+        }
+        presences = presence_tracker_->getByUserIds(user_ids);
+    }
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("presence").beginArray();
+    for (const auto& presence : presences) {
+        presence.write_json(writer);
+    }
+    writer.endArray();
+    writer.endObject();
+
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetPostsByHashtag(const HttpRequest& request) {
@@ -3884,16 +5092,20 @@ HttpResponse AcademicSocialServer::handleCreateAnnouncement(const HttpRequest& r
         return createErrorResponse(403, "Only group admins and moderators can create announcements");
     }
 
-    std::string title = extractJsonField(request.body, "title");
-    std::string content = extractJsonField(request.body, "content");
-    std::string is_pinned_str = extractJsonField(request.body, "is_pinned");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+
+    std::string title = body.getString("title").value_or("");
+    std::string content = body.getString("content").value_or("");
 
     if (title.empty() || content.empty()) {
         return createErrorResponse(400, "title and content are required");
     }
 
     Announcement announcement(group_id, user_id, title, content);
-    if (!is_pinned_str.empty() && is_pinned_str == "true") {
+    if (body.getBool("is_pinned").value_or(false)) {
         announcement.setPinned(true);
     }
 
@@ -3908,7 +5120,26 @@ HttpResponse AcademicSocialServer::handleCreateAnnouncement(const HttpRequest& r
             }
         }
 
-        // TODO: Create notifications for all group members
+        // One INSERT ... SELECT for the whole group, written on the next flush
+        std::vector<int> recipients = group_repository_->getMemberIds(group_id);
+        recipients.erase(std::remove(recipients.begin(), recipients.end(), user_id), recipients.end());
+
+        Notification notification;
+        notification.type = "announcement";
+        notification.title = title;
+        notification.message = content;
+        if (notification.message.size() > 200) {
+            size_t cut = 200;
+            while (cut > 0 && (static_cast<unsigned char>(notification.message[cut]) & 0xC0) == 0x80) {
+                --cut; // Keep whole UTF-8 characters
+            }
+            notification.message = notification.message.substr(0, cut) + "...";
+        }
+        notification.related_user_id = user_id;
+        notification.related_group_id = group_id;
+        notification.action_url = "/groups/" + std::to_string(group_id);
+        notification_dispatcher_->notifyAll(std::move(recipients), std::move(notification));
+
         return createJsonResponse(201, created->toJson());
     }
 
@@ -3959,15 +5190,16 @@ HttpResponse AcademicSocialServer::handleGetAnnouncements(const HttpRequest& req
 
     auto announcements = announcement_repository_->findByGroupId(group_id, false, limit, offset);
 
-    std::ostringstream oss;
-    oss << "{\"announcements\":[";
-    for (size_t i = 0; i < announcements.size(); ++i) {
-        oss << announcements[i].toJson();
-        if (i < announcements.size() - 1) oss << ",";
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("announcements").beginArray();
+    for (const auto& announcement : announcements) {
+        announcement.writeJson(writer);
     }
-    oss << "]}";
+    writer.endArray();
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 HttpResponse AcademicSocialServer::handleGetAnnouncement(const HttpRequest& request) {
@@ -4016,8 +5248,13 @@ HttpResponse AcademicSocialServer::handleUpdateAnnouncement(const HttpRequest& r
         return createErrorResponse(404, "Announcement not found");
     }
 
-    std::string title = extractJsonField(request.body, "title");
-    std::string content = extractJsonField(request.body, "content");
+    utils::JsonDocument body = utils::JsonDocument::parse(request.body);
+    if (!body.isValid()) {
+        return createErrorResponse(400, body.getError());
+    }
+
+    std::string title = body.getString("title").value_or("");
+    std::string content = body.getString("content").value_or("");
 
     if (!title.empty()) {
         announcement->setTitle(title);
@@ -4153,30 +5390,44 @@ HttpResponse AcademicSocialServer::handleGetUserMentions(const HttpRequest& requ
 
     auto post_ids = mention_repository_->findPostIdsByUserId(user_id, limit, offset);
 
-    // Fetch the actual posts
-    std::ostringstream oss;
-    oss << "{\"mentions\":[";
-    for (size_t i = 0; i < post_ids.size(); ++i) {
-        auto post = post_repository_->findById(post_ids[i]);
-        if (post.has_value()) {
-            // Populate author information
-            auto author = user_repository_->findById(post->getAuthorId());
-            if (author.has_value()) {
-                post->setAuthorUsername(author->getUsername());
-                if (author->getName().has_value()) {
-                    post->setAuthorName(author->getName().value());
-                }
-                if (author->getAvatarUrl().has_value()) {
-                    post->setAuthorAvatarUrl(author->getAvatarUrl().value());
-                }
+    // Fetch the actual posts and their authors with one query each
+    std::unordered_map<int, Post> posts;
+    for (auto& post : post_repository_->findByIds(post_ids)) {
+        int post_id = post.getId().value();
+        posts.emplace(post_id, std::move(post));
+    }
+    auto authors = makeUserLoader();
+    for (const auto& entry : posts) {
+        authors.prime(entry.second.getAuthorId());
+    }
+
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.key("mentions").beginArray();
+    for (int post_id : post_ids) {
+        auto it = posts.find(post_id);
+        if (it == posts.end()) {
+            continue;
+        }
+        Post& post = it->second;
+
+        // Populate author information
+        const auto& author = authors.load(post.getAuthorId());
+        if (author.has_value()) {
+            post.setAuthorUsername(author->getUsername());
+            if (author->getName().has_value()) {
+                post.setAuthorName(author->getName().value());
+            }
+            if (author->getAvatarUrl().has_value()) {
+                post.setAuthorAvatarUrl(author->getAvatarUrl().value());
             }
-            oss << post->toJson();
-            if (i < post_ids.size() - 1) oss << ",";
         }
+        post.writeJson(writer);
     }
-    oss << "]}";
+    writer.endArray();
+    writer.endObject();
 
-    return createJsonResponse(200, oss.str());
+    return createJsonResponse(200, writer.str());
 }
 
 // -------------------- Study Buddy Matching Handlers --------------------
@@ -4288,7 +5539,13 @@ HttpResponse AcademicSocialServer::handleRefreshStudyBuddyMatches(const HttpRequ
         return createErrorResponse(401, "Unauthorized");
     }
 
+    // Old suggestions are deleted and new ones saved together, so a failed
+    // refresh leaves the previous suggestions in place
+    db::UnitOfWork unit(*database_);
     int count = study_buddy_matching_service_->refreshMatches(user_id);
+    if (!unit.commit()) {
+        return createErrorResponse(500, "Failed to refresh matches");
+    }
 
     std::ostringstream oss;
     oss << "{\"matches_generated\":" << count << "}";
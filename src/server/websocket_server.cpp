@@ -1,13 +1,15 @@
 #include "server/websocket_server.h"
 #include "security/jwt.h"
 #include "config/env.h"
+#include "utils/metrics.h"
+#include "utils/json_writer.h"
 #include <iostream>
 #include <sstream>
-#include <iomanip>
 #include <cstring>
 #include <cerrno>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <openssl/sha.h>
@@ -22,31 +24,6 @@ namespace server {
 // WebSocket GUID for handshake
 static const std::string WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
 
-// Helper function to escape JSON strings
-static std::string escapeJsonString(const std::string& input) {
-    std::ostringstream output;
-    for (char c : input) {
-        switch (c) {
-            case '"':  output << "\\\""; break;
-            case '\\': output << "\\\\"; break;
-            case '\b': output << "\\b"; break;
-            case '\f': output << "\\f"; break;
-            case '\n': output << "\\n"; break;
-            case '\r': output << "\\r"; break;
-            case '\t': output << "\\t"; break;
-            default:
-                // Escape control characters
-                if (c < 0x20) {
-                    output << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                } else {
-                    output << c;
-                }
-                break;
-        }
-    }
-    return output.str();
-}
-
 // Helper function to validate Origin header format
 static bool isValidOrigin(const std::string& origin) {
     // Validate that the origin matches a proper URL format
@@ -56,6 +33,57 @@ static bool isValidOrigin(const std::string& origin) {
     return std::regex_match(origin, origin_regex);
 }
 
+// WebSocket metrics, resolved once so recording stays a single atomic op
+static utils::Gauge& connectionsGauge() {
+    static utils::Gauge& gauge = utils::MetricsRegistry::getInstance().gauge(
+        "sohbet_websocket_connections", "Currently open WebSocket connections");
+    return gauge;
+}
+
+static utils::Gauge& sendsInFlightGauge() {
+    static utils::Gauge& gauge = utils::MetricsRegistry::getInstance().gauge(
+        "sohbet_websocket_sends_in_flight", "Frames currently being written to client sockets");
+    return gauge;
+}
+
+static utils::Counter& bytesSentCounter() {
+    static utils::Counter& counter = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_websocket_sent_bytes_total", "Bytes written to WebSocket clients");
+    return counter;
+}
+
+static utils::Counter& messagesSentCounter() {
+    static utils::Counter& counter = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_websocket_sent_messages_total", "Frames written to WebSocket clients");
+    return counter;
+}
+
+static utils::Counter& bytesReceivedCounter() {
+    static utils::Counter& counter = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_websocket_received_bytes_total", "Bytes read from WebSocket clients");
+    return counter;
+}
+
+static utils::Counter& receivedMessagesCounter(const std::string& type) {
+    return utils::MetricsRegistry::getInstance().counter(
+        "sohbet_websocket_received_messages_total", "Messages received by type", {{"type", type}});
+}
+
+static utils::Counter& unhandledMessagesCounter() {
+    static utils::Counter& counter = receivedMessagesCounter("unhandled");
+    return counter;
+}
+
+static utils::Histogram& fanoutHistogram() {
+    static utils::Histogram& histogram = utils::MetricsRegistry::getInstance().histogram(
+        "sohbet_websocket_fanout_duration_seconds", "Time to deliver one message to all target users");
+    return histogram;
+}
+
+// A send blocked this long on a client that stopped reading gives up, so
+// no fan-out caller (scheduler jobs included) waits on one stalled socket
+static const int SEND_TIMEOUT_SECONDS = 5;
+
 // Base64 encoding helper
 static std::string base64_encode(const unsigned char* input, int length) {
     BIO *bio, *b64;
@@ -77,9 +105,18 @@ static std::string base64_encode(const unsigned char* input, int length) {
 }
 
 // WebSocketConnection implementation
+void WebSocketConnection::markClosed() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    closed_ = true;
+}
+
 bool WebSocketConnection::sendMessage(const std::string& message) {
     // Lock to ensure thread-safe sending (prevents interleaved data)
     std::lock_guard<std::mutex> lock(send_mutex_);
+    if (closed_) {
+        return false;
+    }
+    sendsInFlightGauge().inc();
 
     size_t total_sent = 0;
     size_t remaining = message.length();
@@ -95,14 +132,22 @@ bool WebSocketConnection::sendMessage(const std::string& message) {
                 // Interrupted by signal, retry
                 continue;
             }
-            // Other error (connection closed, etc.)
+            // Other error (connection closed, send timeout, etc.)
             std::cerr << "WebSocket send error: " << strerror(errno) << std::endl;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // A partial frame leaves the stream unusable; end the
+                // connection so its reader cleans it up
+                shutdown(socket_fd_, SHUT_RDWR);
+                closed_ = true;
+            }
+            sendsInFlightGauge().dec();
             return false;
         }
 
         if (sent == 0) {
             // Connection closed
             std::cerr << "WebSocket connection closed during send" << std::endl;
+            sendsInFlightGauge().dec();
             return false;
         }
 
@@ -110,6 +155,9 @@ bool WebSocketConnection::sendMessage(const std::string& message) {
         remaining -= sent;
     }
 
+    sendsInFlightGauge().dec();
+    bytesSentCounter().inc(total_sent);
+    messagesSentCounter().inc();
     return true;
 }
 
@@ -176,19 +224,30 @@ bool WebSocketServer::start() {
     return true;
 }
 
+void WebSocketServer::startShared() {
+    running_ = true;
+    std::cout << "[WebSocket] ✓ Accepting upgrades on the shared HTTP port " << port_ << std::endl;
+}
+
 void WebSocketServer::stop() {
     if (running_) {
         running_ = false;
         
         // Close all client connections
+        std::map<int, std::shared_ptr<WebSocketConnection>> closing;
         {
             std::lock_guard<std::mutex> lock(connections_mutex_);
-            for (auto& pair : connections_) {
-                close(pair.first);
-            }
-            connections_.clear();
+            closing.swap(connections_);
             user_sockets_.clear();
         }
+        connectionsGauge().set(0);
+        // markClosed() waits out a send in progress; shutdown() first so a
+        // send blocked on a stalled client returns
+        for (auto& pair : closing) {
+            shutdown(pair.first, SHUT_RDWR);
+            pair.second->markClosed();
+            close(pair.first);
+        }
         
         // Close server socket
         if (server_socket_ >= 0) {
@@ -241,6 +300,23 @@ void WebSocketServer::handleClient(int client_socket) {
         close(client_socket);
         return;
     }
+
+    serveConnection(client_socket, request, "");
+}
+
+void WebSocketServer::adoptConnection(int client_socket, const std::string& request, const std::string& buffered) {
+    // The HTTP server already read the upgrade request; answer it directly
+    std::cout << "[WebSocket] Upgrading shared-port connection socket=" << client_socket << std::endl;
+    if (!running_ || !completeHandshake(client_socket, request)) {
+        std::cerr << "[WebSocket] ❌ Handshake failed for socket=" << client_socket << std::endl;
+        close(client_socket);
+        return;
+    }
+
+    serveConnection(client_socket, request, buffered);
+}
+
+void WebSocketServer::serveConnection(int client_socket, const std::string& request, const std::string& buffered) {
     std::cout << "[WebSocket] ✓ Handshake successful for socket=" << client_socket << std::endl;
 
     // Authenticate the connection
@@ -255,6 +331,11 @@ void WebSocketServer::handleClient(int client_socket) {
     std::cout << "[WebSocket] ✓ Authentication successful for socket=" << client_socket
               << ", user_id=" << user_id << std::endl;
     
+    struct timeval send_timeout;
+    send_timeout.tv_sec = SEND_TIMEOUT_SECONDS;
+    send_timeout.tv_usec = 0;
+    setsockopt(client_socket, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
     // Create connection object
     auto connection = std::make_shared<WebSocketConnection>(client_socket, user_id);
     
@@ -264,30 +345,46 @@ void WebSocketServer::handleClient(int client_socket) {
         connections_[client_socket] = connection;
         user_sockets_[user_id].insert(client_socket);
     }
+    connectionsGauge().inc();
 
     std::cout << "[WebSocket] 🔌 Client connected: user_id=" << user_id
               << ", socket=" << client_socket
               << ", total_connections=" << connections_.size() << std::endl;
 
-    // Send online status notification
-    WebSocketMessage online_msg("user:online", "{\"user_id\":" + std::to_string(user_id) + "}");
-    broadcast(online_msg);
+    // Presence (and who hears about it) is up to the connect handler
+    ConnectHandler connect_handler;
+    ActivityHandler activity_handler;
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        connect_handler = connect_handler_;
+        activity_handler = activity_handler_;
+    }
+    if (connect_handler) {
+        connect_handler(user_id);
+    }
     
-    // Read messages from client
+    // Read messages from client, starting with any bytes that arrived
+    // together with the upgrade request
     char buffer[4096];
+    std::string pending = buffered;
     size_t message_count = 0;
     while (running_) {
-        ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer), 0);
-        if (bytes_read <= 0) {
-            if (bytes_read < 0) {
-                std::cerr << "[WebSocket] Read error for user_id=" << user_id
-                          << ", socket=" << client_socket << ": " << strerror(errno) << std::endl;
+        if (pending.empty()) {
+            ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer), 0);
+            if (bytes_read <= 0) {
+                if (bytes_read < 0) {
+                    std::cerr << "[WebSocket] Read error for user_id=" << user_id
+                              << ", socket=" << client_socket << ": " << strerror(errno) << std::endl;
+                }
+                break; // Connection closed or error
             }
-            break; // Connection closed or error
+            pending.assign(buffer, bytes_read);
         }
+        bytesReceivedCounter().inc(pending.size());
+        std::string frame;
+        frame.swap(pending);
 
         try {
-            std::string frame(buffer, bytes_read);
             std::string decoded = decodeFrame(frame);
 
             if (!decoded.empty()) {
@@ -301,13 +398,20 @@ void WebSocketServer::handleClient(int client_socket) {
 
                 // Find handler for this message type
                 MessageHandler handler;
+                utils::Counter* received = &unhandledMessagesCounter();
                 {
                     std::lock_guard<std::mutex> lock(handlers_mutex_);
                     auto it = handlers_.find(message.type);
                     if (it != handlers_.end()) {
-                        handler = it->second;
+                        handler = it->second.handler;
+                        received = it->second.received;
                     }
                 }
+                received->inc();
+
+                if (activity_handler) {
+                    activity_handler(user_id);
+                }
 
                 // Call handler if found
                 if (handler) {
@@ -331,16 +435,15 @@ void WebSocketServer::handleClient(int client_socket) {
               << ", messages_processed=" << message_count
               << ", remaining_connections=" << connections_.size() << std::endl;
 
-    // Send offline status notification
-    WebSocketMessage offline_msg("user:offline", "{\"user_id\":" + std::to_string(user_id) + "}");
-    broadcast(offline_msg);
-
-    // Call disconnect handler if registered
+    // Call disconnect handler if registered (outside the lock: it may
+    // query the database)
+    DisconnectHandler disconnect_handler;
     {
         std::lock_guard<std::mutex> lock(handlers_mutex_);
-        if (disconnect_handler_) {
-            disconnect_handler_(user_id);
-        }
+        disconnect_handler = disconnect_handler_;
+    }
+    if (disconnect_handler) {
+        disconnect_handler(user_id);
     }
 }
 
@@ -353,7 +456,11 @@ bool WebSocketServer::performWebSocketHandshake(int client_socket, std::string&
     
     buffer[bytes_read] = '\0';
     request = std::string(buffer);
-    
+
+    return completeHandshake(client_socket, request);
+}
+
+bool WebSocketServer::completeHandshake(int client_socket, const std::string& request) {
     // Extract Sec-WebSocket-Key
     std::regex key_regex("Sec-WebSocket-Key: ([^\r\n]+)");
     std::smatch matches;
@@ -474,9 +581,12 @@ WebSocketMessage WebSocketServer::parseMessage(const std::string& raw_message) {
 }
 
 std::string WebSocketServer::formatMessage(const WebSocketMessage& message) {
-    std::ostringstream oss;
-    oss << "{\"type\":\"" << message.type << "\",\"payload\":" << message.payload << "}";
-    return oss.str();
+    utils::JsonWriter writer;
+    writer.beginObject();
+    writer.field("type", message.type);
+    writer.rawField("payload", message.payload);
+    writer.endObject();
+    return writer.str();
 }
 
 std::string WebSocketServer::decodeFrame(const std::string& frame) {
@@ -564,8 +674,10 @@ std::string WebSocketServer::encodeFrame(const std::string& message) {
 }
 
 void WebSocketServer::registerHandler(const std::string& type, MessageHandler handler) {
+    // The received-messages series is resolved here, once per type
+    utils::Counter& received = receivedMessagesCounter(type);
     std::lock_guard<std::mutex> lock(handlers_mutex_);
-    handlers_[type] = handler;
+    handlers_[type] = RegisteredHandler{handler, &received};
 }
 
 void WebSocketServer::registerDisconnectHandler(DisconnectHandler handler) {
@@ -573,40 +685,112 @@ void WebSocketServer::registerDisconnectHandler(DisconnectHandler handler) {
     disconnect_handler_ = handler;
 }
 
-bool WebSocketServer::sendToUser(int user_id, const WebSocketMessage& message) {
-    std::string encoded = encodeFrame(formatMessage(message));
-    
-    std::lock_guard<std::mutex> lock(connections_mutex_);
+void WebSocketServer::registerConnectHandler(ConnectHandler handler) {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    connect_handler_ = handler;
+}
+
+void WebSocketServer::registerActivityHandler(ActivityHandler handler) {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    activity_handler_ = handler;
+}
+
+std::vector<std::shared_ptr<WebSocketConnection>> WebSocketServer::connectionsOf(int user_id) const {
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
     auto it = user_sockets_.find(user_id);
     if (it == user_sockets_.end()) {
-        return false;
+        return targets;
     }
-    
-    bool sent = false;
     for (int socket_fd : it->second) {
         auto conn_it = connections_.find(socket_fd);
         if (conn_it != connections_.end()) {
-            if (conn_it->second->sendMessage(encoded)) {
-                sent = true;
-            }
+            targets.push_back(conn_it->second);
+        }
+    }
+    return targets;
+}
+
+bool WebSocketServer::sendToUser(int user_id, const WebSocketMessage& message) {
+    std::string encoded = encodeFrame(formatMessage(message));
+
+    // Written after releasing connections_mutex_, as in sendToUsers
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        targets = connectionsOf(user_id);
+    }
+
+    bool sent = false;
+    for (const auto& connection : targets) {
+        if (connection->sendMessage(encoded)) {
+            sent = true;
         }
     }
-    
     return sent;
 }
 
 void WebSocketServer::sendToUsers(const std::set<int>& user_ids, const WebSocketMessage& message) {
-    for (int user_id : user_ids) {
-        sendToUser(user_id, message);
+    utils::ScopedTimer timer(fanoutHistogram());
+    // Encode once for every recipient, and write to sockets after releasing
+    // connections_mutex_ so a slow client does not stall connects/disconnects
+    std::string encoded = encodeFrame(formatMessage(message));
+
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (int user_id : user_ids) {
+            auto connections = connectionsOf(user_id);
+            targets.insert(targets.end(), connections.begin(), connections.end());
+        }
+    }
+
+    for (const auto& connection : targets) {
+        connection->sendMessage(encoded);
+    }
+}
+
+void WebSocketServer::sendToUsers(const std::map<int, std::vector<WebSocketMessage>>& messages_by_user) {
+    utils::ScopedTimer timer(fanoutHistogram());
+
+    // Recipients are resolved under one lock; offline users are skipped
+    std::vector<std::pair<const std::vector<WebSocketMessage>*,
+                          std::vector<std::shared_ptr<WebSocketConnection>>>> deliveries;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (const auto& entry : messages_by_user) {
+            auto targets = connectionsOf(entry.first);
+            if (!targets.empty()) {
+                deliveries.emplace_back(&entry.second, std::move(targets));
+            }
+        }
+    }
+
+    // Encoding and writing happen after the lock is released
+    for (const auto& delivery : deliveries) {
+        for (const auto& message : *delivery.first) {
+            std::string encoded = encodeFrame(formatMessage(message));
+            for (const auto& connection : delivery.second) {
+                connection->sendMessage(encoded);
+            }
+        }
     }
 }
 
 void WebSocketServer::broadcast(const WebSocketMessage& message) {
+    utils::ScopedTimer timer(fanoutHistogram());
     std::string encoded = encodeFrame(formatMessage(message));
-    
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    for (auto& pair : connections_) {
-        pair.second->sendMessage(encoded);
+
+    std::vector<std::shared_ptr<WebSocketConnection>> targets;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        targets.reserve(connections_.size());
+        for (const auto& pair : connections_) {
+            targets.push_back(pair.second);
+        }
+    }
+
+    for (const auto& connection : targets) {
+        connection->sendMessage(encoded);
     }
 }
 
@@ -628,24 +812,32 @@ std::set<int> WebSocketServer::getOnlineUsers() const {
 }
 
 void WebSocketServer::removeConnection(int socket_fd) {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-    
-    auto it = connections_.find(socket_fd);
-    if (it != connections_.end()) {
-        int user_id = it->second->getUserId();
-        
+    std::shared_ptr<WebSocketConnection> connection;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+
+        auto it = connections_.find(socket_fd);
+        if (it == connections_.end()) {
+            return;
+        }
+        connection = std::move(it->second);
+
         // Remove from user_sockets_
-        auto user_it = user_sockets_.find(user_id);
+        auto user_it = user_sockets_.find(connection->getUserId());
         if (user_it != user_sockets_.end()) {
             user_it->second.erase(socket_fd);
             if (user_it->second.empty()) {
                 user_sockets_.erase(user_it);
             }
         }
-        
+
         // Remove from connections_
         connections_.erase(it);
+        connectionsGauge().dec();
     }
+
+    // Waits for a send in progress, so never under connections_mutex_
+    connection->markClosed();
 }
 
 } // namespace server
@@ -0,0 +1,211 @@
+#include "services/chat_ingest_queue.h"
+#include "utils/logger.h"
+#include "utils/metrics.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace sohbet {
+namespace services {
+
+// Pause after a failed commit before the writer tries again
+static const std::chrono::milliseconds RETRY_DELAY(100);
+
+// Flush metrics, resolved once so each commit only records
+struct ChatMetrics {
+    utils::Histogram& commit_duration;
+    utils::Counter& commits;
+    utils::Counter& stored;
+    utils::Counter& dropped;
+};
+
+static ChatMetrics& chatMetrics() {
+    auto& registry = utils::MetricsRegistry::getInstance();
+    static ChatMetrics metrics{
+        registry.histogram("sohbet_chat_commit_duration_seconds", "Time to store one batch of chat messages"),
+        registry.counter("sohbet_chat_commits_total", "Group commits of chat messages"),
+        registry.counter("sohbet_chat_messages_total", "Chat messages by outcome", {{"outcome", "stored"}}),
+        registry.counter("sohbet_chat_messages_total", "Chat messages by outcome", {{"outcome", "dropped"}}),
+    };
+    return metrics;
+}
+
+static uint64_t initialSequence() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+ChatIngestQueue::ChatIngestQueue(PersistFunction persist, AckFunction ack,
+                                 std::chrono::milliseconds linger, size_t max_batch, size_t max_attempts)
+    : persist_(std::move(persist)), ack_(std::move(ack)), linger_(linger),
+      max_batch_(max_batch == 0 ? 1 : max_batch), max_attempts_(max_attempts == 0 ? 1 : max_attempts),
+      next_sequence_(initialSequence()) {
+}
+
+ChatIngestQueue::~ChatIngestQueue() {
+    stop();
+}
+
+void ChatIngestQueue::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writer_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    writer_ = std::thread(&ChatIngestQueue::run, this);
+}
+
+void ChatIngestQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    // Every failed commit uses up an attempt, so this ends even if the
+    // database is gone
+    while (pending() > 0) {
+        flush();
+    }
+}
+
+QueuedMessage ChatIngestQueue::enqueue(Message message, std::vector<int> recipients, std::string client_ref) {
+    Entry entry;
+    entry.queued.message = std::move(message);
+    entry.queued.message.id = 0;
+    entry.queued.recipients = std::move(recipients);
+    entry.queued.client_ref = std::move(client_ref);
+
+    QueuedMessage accepted;
+    bool wake;
+    {
+        // Taken under the lock so the queue is in sequence order
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry.queued.sequence = next_sequence_++;
+        accepted = entry.queued;
+        queue_.push_back(std::move(entry));
+        // The writer needs waking for the first message and when a full
+        // batch cuts its linger short
+        wake = queue_.size() == 1 || queue_.size() == max_batch_;
+    }
+    if (wake) {
+        wake_.notify_one();
+    }
+    return accepted;
+}
+
+size_t ChatIngestQueue::flush() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    std::vector<Entry> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = std::min(queue_.size(), max_batch_);
+        batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + count));
+        queue_.erase(queue_.begin(), queue_.begin() + count);
+    }
+    if (batch.empty()) {
+        return 0;
+    }
+
+    std::vector<Message> messages;
+    std::vector<int> conversation_ids;
+    std::unordered_set<int> seen;
+    messages.reserve(batch.size());
+    for (const auto& entry : batch) {
+        messages.push_back(entry.queued.message);
+        if (seen.insert(entry.queued.message.conversation_id).second) {
+            conversation_ids.push_back(entry.queued.message.conversation_id);
+        }
+    }
+
+    ChatMetrics& metrics = chatMetrics();
+    auto started = std::chrono::steady_clock::now();
+    std::vector<int> ids = persist_(messages, conversation_ids);
+    metrics.commit_duration.observe(std::chrono::steady_clock::now() - started);
+
+    if (ids.size() == batch.size()) {
+        metrics.commits.inc();
+        metrics.stored.inc(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].queued.message.id = ids[i];
+            ack_(batch[i].queued, true);
+        }
+        return batch.size();
+    }
+
+    // One bad row (invalid text, a conversation deleted since the membership
+    // check) fails the whole commit, so store the messages one at a time and
+    // keep only the ones that still fail. Acks stay in sequence order among
+    // the messages stored here; a retried message is acked when it lands.
+    std::vector<bool> stored(batch.size(), false);
+    size_t stored_count = 0;
+    if (batch.size() > 1) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const Message& message = batch[i].queued.message;
+            std::vector<int> single = persist_({message}, {message.conversation_id});
+            if (single.size() == 1) {
+                batch[i].queued.message.id = single[0];
+                stored[i] = true;
+                ++stored_count;
+            }
+        }
+    }
+
+    std::vector<Entry> retry;
+    size_t dropped = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Entry& entry = batch[i];
+        if (stored[i]) {
+            ack_(entry.queued, true);
+            continue;
+        }
+        if (++entry.attempts < max_attempts_) {
+            retry.push_back(std::move(entry));
+            continue;
+        }
+        ++dropped;
+        ack_(entry.queued, false);
+    }
+    LOG_WARN("Chat message commit failed; " + std::to_string(stored_count) + " message(s) stored one by one, " +
+             std::to_string(retry.size()) + " will be retried, " + std::to_string(dropped) + " dropped");
+    metrics.stored.inc(stored_count);
+    metrics.dropped.inc(dropped);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.insert(queue_.begin(), std::make_move_iterator(retry.begin()), std::make_move_iterator(retry.end()));
+    return stored_count;
+}
+
+size_t ChatIngestQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void ChatIngestQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            break;  // stop() stores the rest
+        }
+
+        // Give a burst a moment to arrive so it shares this commit
+        if (linger_.count() > 0 && queue_.size() < max_batch_) {
+            wake_.wait_for(lock, linger_, [this] { return stopping_ || queue_.size() >= max_batch_; });
+        }
+
+        lock.unlock();
+        bool stored = flush() > 0;
+        lock.lock();
+
+        if (!stored && !queue_.empty()) {
+            wake_.wait_for(lock, RETRY_DELAY, [this] { return stopping_; });
+        }
+    }
+}
+
+} // namespace services
+} // namespace sohbet
@@ -0,0 +1,245 @@
+#include "services/notification_dispatcher.h"
+#include "utils/logger.h"
+#include "utils/metrics.h"
+#include <algorithm>
+
+namespace sohbet {
+namespace services {
+
+// Recipients per fan-out INSERT; one int[] parameter, so this only bounds
+// statement size and time
+static const size_t FAN_OUT_CHUNK = 5000;
+
+// Longest wait between retries of one item
+static const std::chrono::milliseconds MAX_RETRY_DELAY = std::chrono::seconds(60);
+
+// Dispatcher metrics, resolved once: single rows and fan-outs are the
+// only kinds
+struct KindCounters {
+    utils::Counter& stored;
+    utils::Counter& dropped;
+};
+
+static KindCounters resolveKind(const char* kind) {
+    auto& registry = utils::MetricsRegistry::getInstance();
+    return KindCounters{
+        registry.counter("sohbet_notifications_stored_total", "Notifications written by the dispatcher",
+                         {{"kind", kind}}),
+        registry.counter("sohbet_notifications_dropped_total",
+                         "Notifications given up on after repeated write failures", {{"kind", kind}}),
+    };
+}
+
+static KindCounters& singleCounters() {
+    static KindCounters counters = resolveKind("single");
+    return counters;
+}
+
+static KindCounters& fanOutCounters() {
+    static KindCounters counters = resolveKind("fan_out");
+    return counters;
+}
+
+static utils::Counter& coalescedCounter() {
+    static utils::Counter& counter = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_notifications_coalesced_total", "Notification requests merged into a pending one");
+    return counter;
+}
+
+NotificationDispatcher::NotificationDispatcher(PersistFunction persist, FanOutFunction fan_out,
+                                               DeliverFunction deliver,
+                                               std::chrono::milliseconds coalesce_window, size_t max_batch,
+                                               int max_attempts, std::chrono::milliseconds retry_delay)
+    : persist_(std::move(persist)), fan_out_(std::move(fan_out)), deliver_(std::move(deliver)),
+      coalesce_window_(coalesce_window), max_batch_(max_batch == 0 ? 1 : max_batch),
+      max_attempts_(max_attempts < 1 ? 1 : max_attempts), retry_delay_(retry_delay) {
+}
+
+void NotificationDispatcher::notify(NotificationRequest request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (request.coalesce_key.empty()) {
+        ready_.push_back(Queued{std::move(request.notification)});
+        return;
+    }
+
+    std::string key = std::to_string(request.notification.user_id) + "|" + request.coalesce_key;
+    auto it = coalescing_.find(key);
+    if (it == coalescing_.end()) {
+        Coalesced entry;
+        if (request.notification.related_user_id.has_value()) {
+            entry.actors.insert(request.notification.related_user_id.value());
+        }
+        entry.first_seen = Clock::now();
+        entry.request = std::move(request);
+        coalescing_.emplace(std::move(key), std::move(entry));
+        return;
+    }
+
+    // Later actors join the pending notification; the newest one is shown
+    Coalesced& entry = it->second;
+    if (request.notification.related_user_id.has_value()) {
+        entry.actors.insert(request.notification.related_user_id.value());
+        entry.request.notification.related_user_id = request.notification.related_user_id;
+        entry.request.notification.message = request.notification.message;
+    }
+    coalescedCounter().inc();
+}
+
+void NotificationDispatcher::notifyAll(std::vector<int> user_ids, Notification notification) {
+    if (user_ids.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    fan_outs_.push_back(FanOut{std::move(user_ids), std::move(notification)});
+}
+
+Notification NotificationDispatcher::finish(Coalesced& entry) {
+    Notification notification = std::move(entry.request.notification);
+    if (entry.actors.size() > 1 && !entry.request.coalesced_message.empty()) {
+        std::string message = entry.request.coalesced_message;
+        size_t pos = message.find("{count}");
+        if (pos != std::string::npos) {
+            message.replace(pos, 7, std::to_string(entry.actors.size()));
+        }
+        notification.message = std::move(message);
+    }
+    return notification;
+}
+
+bool NotificationDispatcher::scheduleRetry(int& attempts, Clock::time_point& retry_at,
+                                           Clock::time_point now) const {
+    if (++attempts >= max_attempts_) {
+        return false;
+    }
+    auto delay = retry_delay_;
+    for (int i = 1; i < attempts && delay < MAX_RETRY_DELAY; ++i) {
+        delay *= 2;
+    }
+    retry_at = now + std::min(delay, MAX_RETRY_DELAY);
+    return true;
+}
+
+size_t NotificationDispatcher::flush(bool force) {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    auto now = Clock::now();
+    std::vector<Queued> batch;
+    std::vector<FanOut> fan_outs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Items waiting out a retry delay stay queued
+        auto waiting = std::stable_partition(ready_.begin(), ready_.end(), [&](const Queued& item) {
+            return force || item.retry_at <= now;
+        });
+        batch.assign(std::make_move_iterator(ready_.begin()), std::make_move_iterator(waiting));
+        ready_.erase(ready_.begin(), waiting);
+
+        auto waiting_fan_outs = std::stable_partition(fan_outs_.begin(), fan_outs_.end(), [&](const FanOut& item) {
+            return force || item.retry_at <= now;
+        });
+        fan_outs.assign(std::make_move_iterator(fan_outs_.begin()), std::make_move_iterator(waiting_fan_outs));
+        fan_outs_.erase(fan_outs_.begin(), waiting_fan_outs);
+
+        for (auto it = coalescing_.begin(); it != coalescing_.end();) {
+            if (force || now - it->second.first_seen >= coalesce_window_) {
+                batch.push_back(Queued{finish(it->second)});
+                it = coalescing_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    size_t stored = 0;
+    std::vector<Queued> failed;
+
+    auto store = [&](const std::vector<Notification>& rows) {
+        stored += rows.size();
+        singleCounters().stored.inc(rows.size());
+        deliver_(rows);
+    };
+    auto retryOrDrop = [&](Queued item) {
+        if (scheduleRetry(item.attempts, item.retry_at, now)) {
+            failed.push_back(std::move(item));
+            return;
+        }
+        singleCounters().dropped.inc();
+        LOG_ERROR("Dropping notification for user " + std::to_string(item.notification.user_id) + " after " +
+                  std::to_string(item.attempts) + " failed writes");
+    };
+
+    // The writes run without mutex_ so notify() is never blocked on the database
+    for (size_t start = 0; start < batch.size(); start += max_batch_) {
+        size_t end = std::min(batch.size(), start + max_batch_);
+        std::vector<Notification> chunk;
+        chunk.reserve(end - start);
+        for (size_t i = start; i < end; ++i) {
+            chunk.push_back(batch[i].notification);
+        }
+        std::vector<Notification> rows = persist_(chunk);
+        if (!rows.empty()) {
+            store(rows);
+            continue;
+        }
+        if (chunk.size() == 1) {
+            retryOrDrop(std::move(batch[start]));
+            continue;
+        }
+
+        // One bad row fails the whole INSERT; write them singly to find it
+        for (size_t i = start; i < end; ++i) {
+            rows = persist_({batch[i].notification});
+            if (rows.empty()) {
+                retryOrDrop(std::move(batch[i]));
+            } else {
+                store(rows);
+            }
+        }
+    }
+
+    std::vector<FanOut> failed_fan_outs;
+    for (auto& fan_out : fan_outs) {
+        for (size_t start = 0; start < fan_out.user_ids.size(); start += FAN_OUT_CHUNK) {
+            size_t end = std::min(fan_out.user_ids.size(), start + FAN_OUT_CHUNK);
+            std::vector<int> chunk(fan_out.user_ids.begin() + start, fan_out.user_ids.begin() + end);
+            std::vector<Notification> rows = fan_out_(chunk, fan_out.notification);
+            if (rows.empty()) {
+                FanOut retry{std::move(chunk), fan_out.notification, fan_out.attempts, fan_out.retry_at};
+                if (scheduleRetry(retry.attempts, retry.retry_at, now)) {
+                    failed_fan_outs.push_back(std::move(retry));
+                } else {
+                    fanOutCounters().dropped.inc(retry.user_ids.size());
+                    LOG_ERROR("Dropping notification fan-out to " + std::to_string(retry.user_ids.size()) +
+                              " user(s) after " + std::to_string(retry.attempts) + " failed writes");
+                }
+                continue;
+            }
+            stored += rows.size();
+            fanOutCounters().stored.inc(rows.size());
+            deliver_(rows);
+        }
+    }
+
+    if (!failed.empty() || !failed_fan_outs.empty()) {
+        LOG_WARN("Notification write failed; " + std::to_string(failed.size() + failed_fan_outs.size()) +
+                 " item(s) will be retried");
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.insert(ready_.begin(), std::make_move_iterator(failed.begin()), std::make_move_iterator(failed.end()));
+        fan_outs_.insert(fan_outs_.begin(), std::make_move_iterator(failed_fan_outs.begin()),
+                         std::make_move_iterator(failed_fan_outs.end()));
+    }
+
+    return stored;
+}
+
+size_t NotificationDispatcher::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = ready_.size() + coalescing_.size();
+    for (const auto& fan_out : fan_outs_) {
+        total += fan_out.user_ids.size();
+    }
+    return total;
+}
+
+} // namespace services
+} // namespace sohbet
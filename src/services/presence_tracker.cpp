@@ -0,0 +1,191 @@
+#include "services/presence_tracker.h"
+#include "utils/logger.h"
+#include "utils/metrics.h"
+#include <algorithm>
+
+namespace sohbet {
+namespace services {
+
+static utils::Counter& rowsWrittenCounter() {
+    static utils::Counter& counter = utils::MetricsRegistry::getInstance().counter(
+        "sohbet_presence_rows_written_total", "user_presence rows written by batched flushes");
+    return counter;
+}
+
+PresenceTracker::PresenceTracker(PersistFunction persist, size_t max_batch)
+    : persist_(std::move(persist)), max_batch_(max_batch == 0 ? 1 : max_batch) {
+}
+
+bool PresenceTracker::isValidStatus(const std::string& status) {
+    return status == "online" || status == "away" || status == "busy";
+}
+
+UserPresence PresenceTracker::toPresence(int user_id, const Entry& entry) {
+    return UserPresence(entry.id, user_id, entry.connections > 0 ? entry.status : "offline",
+                        entry.custom_status, entry.last_seen, entry.updated_at);
+}
+
+void PresenceTracker::load(const std::vector<UserPresence>& rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& row : rows) {
+        Entry& entry = entries_[row.user_id];
+        if (entry.connections > 0) {
+            continue;  // Already live; memory wins
+        }
+        entry.id = row.id;
+        entry.status = isValidStatus(row.status) ? row.status : "online";
+        entry.custom_status = row.custom_status;
+        entry.last_seen = row.last_seen;
+        entry.updated_at = row.updated_at;
+        if (row.status != "offline") {
+            dirty_.insert(row.user_id);
+        }
+    }
+}
+
+bool PresenceTracker::connect(int user_id, std::time_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[user_id];
+    entry.last_seen = now;
+    dirty_.insert(user_id);
+    if (entry.connections++ > 0) {
+        return false;
+    }
+    entry.updated_at = now;
+    return true;
+}
+
+bool PresenceTracker::disconnect(int user_id, std::time_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(user_id);
+    if (it == entries_.end() || it->second.connections == 0) {
+        return false;
+    }
+    Entry& entry = it->second;
+    entry.last_seen = now;
+    dirty_.insert(user_id);
+    if (--entry.connections > 0) {
+        return false;
+    }
+    entry.updated_at = now;
+    return true;
+}
+
+void PresenceTracker::touch(int user_id, std::time_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(user_id);
+    // Heartbeats within the same second change nothing worth writing
+    if (it == entries_.end() || it->second.connections == 0 || it->second.last_seen >= now) {
+        return;
+    }
+    it->second.last_seen = now;
+    dirty_.insert(user_id);
+}
+
+std::optional<UserPresence> PresenceTracker::setStatus(int user_id, const std::string& status,
+                                                       const std::string& custom_status, std::time_t now) {
+    if (!isValidStatus(status)) {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[user_id];
+    if (entry.status == status && entry.custom_status == custom_status) {
+        return std::nullopt;
+    }
+    entry.status = status;
+    entry.custom_status = custom_status;
+    entry.updated_at = now;
+    dirty_.insert(user_id);
+    if (entry.connections == 0) {
+        return std::nullopt;
+    }
+    entry.last_seen = std::max(entry.last_seen, now);
+    return toPresence(user_id, entry);
+}
+
+UserPresence PresenceTracker::get(int user_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(user_id);
+    if (it == entries_.end()) {
+        return UserPresence(0, user_id, "offline", "", 0, 0);
+    }
+    return toPresence(user_id, it->second);
+}
+
+std::vector<UserPresence> PresenceTracker::getByUserIds(const std::vector<int>& user_ids) const {
+    std::vector<UserPresence> presences;
+    presences.reserve(user_ids.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int user_id : user_ids) {
+        auto it = entries_.find(user_id);
+        presences.push_back(it == entries_.end() ? UserPresence(0, user_id, "offline", "", 0, 0)
+                                                 : toPresence(user_id, it->second));
+    }
+    return presences;
+}
+
+std::vector<UserPresence> PresenceTracker::getOnlineUsers() const {
+    std::vector<UserPresence> presences;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [user_id, entry] : entries_) {
+            if (entry.connections > 0) {
+                presences.push_back(toPresence(user_id, entry));
+            }
+        }
+    }
+    std::sort(presences.begin(), presences.end(), [](const UserPresence& a, const UserPresence& b) {
+        return a.updated_at != b.updated_at ? a.updated_at > b.updated_at : a.user_id < b.user_id;
+    });
+    return presences;
+}
+
+size_t PresenceTracker::flush() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    // Snapshot current values; changes after this point re-mark the user dirty
+    std::vector<UserPresence> rows;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rows.reserve(dirty_.size());
+        for (int user_id : dirty_) {
+            auto it = entries_.find(user_id);
+            if (it != entries_.end()) {
+                rows.push_back(toPresence(user_id, it->second));
+            }
+        }
+        dirty_.clear();
+    }
+
+    size_t written = 0;
+    std::vector<int> failed;
+    for (size_t start = 0; start < rows.size(); start += max_batch_) {
+        size_t end = std::min(rows.size(), start + max_batch_);
+        std::vector<UserPresence> chunk(rows.begin() + start, rows.begin() + end);
+        if (!persist_(chunk)) {
+            for (const auto& row : chunk) {
+                failed.push_back(row.user_id);
+            }
+            continue;
+        }
+        written += chunk.size();
+    }
+
+    if (written > 0) {
+        rowsWrittenCounter().inc(written);
+    }
+    if (!failed.empty()) {
+        LOG_WARN("Presence flush failed; " + std::to_string(failed.size()) + " user(s) will be retried");
+        std::lock_guard<std::mutex> lock(mutex_);
+        dirty_.insert(failed.begin(), failed.end());
+    }
+    return written;
+}
+
+size_t PresenceTracker::dirty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirty_.size();
+}
+
+} // namespace services
+} // namespace sohbet
@@ -0,0 +1,221 @@
+#include "utils/compression.h"
+#include <zlib.h>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+namespace sohbet {
+namespace utils {
+
+// ============================================================================
+// Content Negotiation
+// ============================================================================
+
+const char* contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Gzip: return "gzip";
+        case ContentEncoding::Deflate: return "deflate";
+        default: return "";
+    }
+}
+
+static std::string_view trim(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// q-value of one "coding;q=0.5" element; malformed values count as 1
+static double parseQuality(std::string_view params) {
+    size_t pos = params.find("q=");
+    if (pos == std::string_view::npos) {
+        pos = params.find("Q=");
+    }
+    if (pos == std::string_view::npos) {
+        return 1.0;
+    }
+    std::string value(trim(params.substr(pos + 2)));
+    char* end = nullptr;
+    double q = std::strtod(value.c_str(), &end);
+    if (end == value.c_str() || q < 0.0 || q > 1.0) {
+        return 1.0;
+    }
+    return q;
+}
+
+ContentEncoding negotiateEncoding(std::string_view accept_encoding) {
+    double gzip_q = -1.0;
+    double deflate_q = -1.0;
+    double any_q = -1.0;
+
+    size_t start = 0;
+    while (start <= accept_encoding.size()) {
+        size_t end = accept_encoding.find(',', start);
+        if (end == std::string_view::npos) {
+            end = accept_encoding.size();
+        }
+        std::string_view element = accept_encoding.substr(start, end - start);
+        start = end + 1;
+
+        size_t semicolon = element.find(';');
+        std::string_view coding = trim(element.substr(0, semicolon));
+        double q = semicolon == std::string_view::npos ? 1.0 : parseQuality(element.substr(semicolon + 1));
+
+        if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip")) {
+            gzip_q = q;
+        } else if (equalsIgnoreCase(coding, "deflate")) {
+            deflate_q = q;
+        } else if (coding == "*") {
+            any_q = q;
+        }
+    }
+
+    // Codings not listed explicitly inherit the wildcard's weight
+    if (gzip_q < 0.0) gzip_q = any_q;
+    if (deflate_q < 0.0) deflate_q = any_q;
+
+    if (gzip_q > 0.0 && gzip_q >= deflate_q) {
+        return ContentEncoding::Gzip;
+    }
+    if (deflate_q > 0.0) {
+        return ContentEncoding::Deflate;
+    }
+    return ContentEncoding::Identity;
+}
+
+bool isCompressibleContentType(std::string_view content_type) {
+    std::string_view type = trim(content_type.substr(0, content_type.find(';')));
+    if (type.size() >= 5 && equalsIgnoreCase(type.substr(0, 5), "text/")) {
+        return true;
+    }
+    static const char* const compressible[] = {
+        "application/json",
+        "application/javascript",
+        "application/xml",
+        "image/svg+xml",
+    };
+    for (const char* candidate : compressible) {
+        if (equalsIgnoreCase(type, candidate)) {
+            return true;
+        }
+    }
+    // Structured syntax suffixes, e.g. application/problem+json
+    return type.size() > 5 && (equalsIgnoreCase(type.substr(type.size() - 5), "+json") ||
+                               equalsIgnoreCase(type.substr(type.size() - 4), "+xml"));
+}
+
+// ============================================================================
+// ResponseCompressor Implementation
+// ============================================================================
+
+struct ResponseCompressor::Stream {
+    z_stream zs{};
+    ContentEncoding encoding;
+    bool initialized = false;
+
+    Stream(ContentEncoding enc, int level) : encoding(enc) {
+        // windowBits 15 = 32 KB window; +16 selects the gzip wrapper
+        int window_bits = enc == ContentEncoding::Gzip ? 15 + 16 : 15;
+        initialized = deflateInit2(&zs, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~Stream() {
+        if (initialized) {
+            deflateEnd(&zs);
+        }
+    }
+};
+
+ResponseCompressor& ResponseCompressor::getInstance() {
+    static ResponseCompressor instance;
+    return instance;
+}
+
+ResponseCompressor::ResponseCompressor(int level, size_t max_pooled_streams)
+    : level_(level), max_pooled_streams_(max_pooled_streams) {
+}
+
+ResponseCompressor::~ResponseCompressor() = default;
+
+std::unique_ptr<ResponseCompressor::Stream> ResponseCompressor::acquire(ContentEncoding encoding) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& pool = encoding == ContentEncoding::Gzip ? gzip_pool_ : deflate_pool_;
+        if (!pool.empty()) {
+            std::unique_ptr<Stream> stream = std::move(pool.back());
+            pool.pop_back();
+            return stream;
+        }
+    }
+
+    auto stream = std::make_unique<Stream>(encoding, level_);
+    if (!stream->initialized) {
+        return nullptr;
+    }
+    return stream;
+}
+
+void ResponseCompressor::release(std::unique_ptr<Stream> stream) {
+    if (deflateReset(&stream->zs) != Z_OK) {
+        return; // Drop broken streams rather than pooling them
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& pool = stream->encoding == ContentEncoding::Gzip ? gzip_pool_ : deflate_pool_;
+    if (pool.size() < max_pooled_streams_) {
+        pool.push_back(std::move(stream));
+    }
+}
+
+bool ResponseCompressor::compress(std::string_view input, ContentEncoding encoding, std::string& output) {
+    if (encoding == ContentEncoding::Identity || input.size() > UINT32_MAX) {
+        return false;
+    }
+
+    std::unique_ptr<Stream> stream = acquire(encoding);
+    if (!stream) {
+        return false;
+    }
+
+    z_stream& zs = stream->zs;
+    std::string compressed;
+    compressed.resize(deflateBound(&zs, static_cast<uLong>(input.size())));
+
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in = static_cast<uInt>(input.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    zs.avail_out = static_cast<uInt>(compressed.size());
+
+    // deflateBound() guarantees a single Z_FINISH call completes
+    int result = deflate(&zs, Z_FINISH);
+    bool ok = result == Z_STREAM_END;
+    if (ok) {
+        compressed.resize(zs.total_out);
+        output = std::move(compressed);
+    }
+
+    release(std::move(stream));
+    return ok;
+}
+
+size_t ResponseCompressor::pooledStreams() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return gzip_pool_.size() + deflate_pool_.size();
+}
+
+} // namespace utils
+} // namespace sohbet
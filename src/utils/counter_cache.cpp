@@ -0,0 +1,86 @@
+#include "utils/counter_cache.h"
+#include "utils/metrics.h"
+
+namespace sohbet {
+namespace utils {
+
+// ============================================================================
+// CounterCache Implementation
+// ============================================================================
+
+CounterCache::CounterCache(std::string name, FlushFunction flush_fn)
+    : name_(std::move(name)), flush_fn_(std::move(flush_fn)) {
+}
+
+void CounterCache::add(int key, int64_t delta) {
+    if (delta == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_[key] += delta;
+}
+
+int64_t CounterCache::pending(int key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t total = 0;
+    auto it = pending_.find(key);
+    if (it != pending_.end()) {
+        total += it->second;
+    }
+    it = in_flight_.find(key);
+    if (it != in_flight_.end()) {
+        total += it->second;
+    }
+    return total;
+}
+
+size_t CounterCache::pendingKeys() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+size_t CounterCache::flush() {
+    std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+            if (it->second != 0) {
+                in_flight_.emplace(it->first, it->second);
+            }
+        }
+        pending_.clear();
+    }
+    if (in_flight_.empty()) {
+        return 0;
+    }
+
+    // The write runs without mutex_ so add() keeps going meanwhile
+    bool ok = flush_fn_(in_flight_);
+
+    auto& metrics = MetricsRegistry::getInstance();
+    size_t written = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ok) {
+            written = in_flight_.size();
+        } else {
+            // Keep the deltas for the next attempt
+            for (const auto& entry : in_flight_) {
+                pending_[entry.first] += entry.second;
+            }
+        }
+        in_flight_.clear();
+    }
+
+    metrics.counter("sohbet_counter_cache_flushes_total", "Write-behind counter flushes",
+                    {{"cache", name_}, {"result", ok ? "ok" : "error"}}).inc();
+    if (ok) {
+        metrics.counter("sohbet_counter_cache_flushed_keys_total", "Counter rows written by flushes",
+                        {{"cache", name_}}).inc(written);
+    }
+    return written;
+}
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,422 @@
+#include "utils/http_parser.h"
+#include <algorithm>
+#include <cstring>
+
+namespace sohbet {
+namespace utils {
+
+// Requests with more headers than this are rejected rather than grown
+static const size_t MAX_HEADERS = 100;
+
+// Longest chunk extension or trailer line; both are skipped, so there is no
+// reason to read on
+static const size_t MAX_CHUNK_LINE = 4096;
+
+// ============================================================================
+// Character classes
+// ============================================================================
+
+// RFC 9110 tchar: the characters allowed in methods and header names
+static const bool* tokenTable() {
+    static bool table[256] = {};
+    static bool initialized = [] {
+        for (int c = '0'; c <= '9'; ++c) table[c] = true;
+        for (int c = 'a'; c <= 'z'; ++c) table[c] = true;
+        for (int c = 'A'; c <= 'Z'; ++c) table[c] = true;
+        for (const char* p = "!#$%&'*+-.^_`|~"; *p; ++p) table[static_cast<unsigned char>(*p)] = true;
+        return true;
+    }();
+    (void)initialized;
+    return table;
+}
+
+static inline bool isToken(char c) {
+    return tokenTable()[static_cast<unsigned char>(c)];
+}
+
+// Visible characters and obs-text; no controls or spaces
+static inline bool isTargetChar(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return u > 0x20 && u != 0x7f;
+}
+
+static inline bool isValueChar(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return u == '\t' || (u >= 0x20 && u != 0x7f);
+}
+
+static inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+static std::string_view trim(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+static std::string_view rebaseView(std::string_view view, const char* old_base, const char* new_base) {
+    if (view.data() == nullptr) {
+        return view;
+    }
+    return std::string_view(new_base + (view.data() - old_base), view.size());
+}
+
+// ============================================================================
+// HttpHeaderTable
+// ============================================================================
+
+bool HttpHeaderTable::equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HttpHeaderTable::add(std::string_view name, std::string_view value) {
+    if (size_ < INLINE_CAPACITY) {
+        inline_[size_] = HttpHeader{name, value};
+    } else {
+        overflow_.push_back(HttpHeader{name, value});
+    }
+    ++size_;
+}
+
+void HttpHeaderTable::clear() {
+    overflow_.clear();
+    size_ = 0;
+}
+
+const HttpHeader& HttpHeaderTable::operator[](size_t index) const {
+    return index < INLINE_CAPACITY ? inline_[index] : overflow_[index - INLINE_CAPACITY];
+}
+
+std::optional<std::string_view> HttpHeaderTable::get(std::string_view name) const {
+    for (size_t i = 0; i < size_; ++i) {
+        const HttpHeader& header = (*this)[i];
+        if (equalsIgnoreCase(header.name, name)) {
+            return header.value;
+        }
+    }
+    return std::nullopt;
+}
+
+void HttpHeaderTable::rebase(const char* old_base, const char* new_base) {
+    for (size_t i = 0; i < size_; ++i) {
+        HttpHeader& header = i < INLINE_CAPACITY ? inline_[i] : overflow_[i - INLINE_CAPACITY];
+        header.name = rebaseView(header.name, old_base, new_base);
+        header.value = rebaseView(header.value, old_base, new_base);
+    }
+}
+
+// ============================================================================
+// HttpRequestHead
+// ============================================================================
+
+bool HttpRequestHead::transferEncoding(bool& chunked) const {
+    chunked = false;
+    bool present = false;
+    // Repeated headers form one list; the last coding frames the message
+    for (size_t i = 0; i < headers.size(); ++i) {
+        const HttpHeader& header = headers[i];
+        if (!HttpHeaderTable::equalsIgnoreCase(header.name, "Transfer-Encoding")) {
+            continue;
+        }
+        std::string_view codings = header.value;
+        size_t count = 0;
+        while (!codings.empty()) {
+            size_t comma = codings.find(',');
+            std::string_view coding = trim(codings.substr(0, comma));
+            codings = comma == std::string_view::npos ? std::string_view() : codings.substr(comma + 1);
+            if (coding.empty()) {
+                continue;
+            }
+            // Chunked followed by another coding leaves no way to frame the body
+            if (chunked) {
+                return false;
+            }
+            chunked = HttpHeaderTable::equalsIgnoreCase(coding, "chunked");
+            ++count;
+        }
+        if (count == 0) {
+            return false;
+        }
+        present = true;
+    }
+    return !present || chunked;
+}
+
+bool HttpRequestHead::contentLength(size_t& length) const {
+    std::optional<size_t> found;
+    for (size_t i = 0; i < headers.size(); ++i) {
+        const HttpHeader& header = headers[i];
+        if (!HttpHeaderTable::equalsIgnoreCase(header.name, "Content-Length")) {
+            continue;
+        }
+        std::string_view digits = trim(header.value);
+        if (digits.empty() || digits.size() > 15) {
+            return false;
+        }
+        size_t value = 0;
+        for (char c : digits) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            value = value * 10 + static_cast<size_t>(c - '0');
+        }
+        // Differing duplicates are a request smuggling vector
+        if (found.has_value() && found.value() != value) {
+            return false;
+        }
+        found = value;
+    }
+    length = found.value_or(0);
+    return true;
+}
+
+void HttpRequestHead::rebase(const char* old_base, const char* new_base) {
+    if (old_base == new_base) {
+        return;
+    }
+    method = rebaseView(method, old_base, new_base);
+    target = rebaseView(target, old_base, new_base);
+    headers.rebase(old_base, new_base);
+}
+
+// ============================================================================
+// Request head parser
+// ============================================================================
+
+// Offset just past the blank line ending the head, or npos
+static size_t findHeadEnd(std::string_view data, size_t from) {
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    const char* p = begin + from;
+    while (p < end) {
+        const char* lf = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (lf == nullptr) {
+            return std::string_view::npos;
+        }
+        if (lf + 1 < end && lf[1] == '\n') {
+            return (lf + 2) - begin;
+        }
+        if (lf + 2 < end && lf[1] == '\r' && lf[2] == '\n') {
+            return (lf + 3) - begin;
+        }
+        p = lf + 1;
+    }
+    return std::string_view::npos;
+}
+
+// Consume "\r\n" or "\n" at pos
+static bool consumeLineEnd(std::string_view data, size_t& pos) {
+    size_t end = pos;
+    if (end < data.size() && data[end] == '\r') {
+        ++end;
+    }
+    if (end < data.size() && data[end] == '\n') {
+        pos = end + 1;
+        return true;
+    }
+    return false;
+}
+
+HttpParseStatus parseHttpRequestHead(std::string_view data, HttpRequestHead& head, size_t previous_size) {
+    head.headers.clear();
+    head.length = 0;
+
+    // Empty lines before the request line are ignored (RFC 9112 2.2)
+    size_t pos = 0;
+    while (pos < data.size() && (data[pos] == '\r' || data[pos] == '\n')) {
+        ++pos;
+    }
+
+    // Nothing new can complete a head already found missing, except in the
+    // last few bytes before the new data
+    size_t scan_from = previous_size > pos + 3 ? previous_size - 3 : pos;
+    size_t head_end = findHeadEnd(data, scan_from);
+    if (head_end == std::string_view::npos) {
+        return HttpParseStatus::Incomplete;
+    }
+    std::string_view text = data.substr(0, head_end);
+
+    // Request line: method SP target SP HTTP/1.x
+    size_t start = pos;
+    while (pos < text.size() && isToken(text[pos])) ++pos;
+    if (pos == start || pos >= text.size() || text[pos] != ' ') {
+        return HttpParseStatus::Invalid;
+    }
+    head.method = text.substr(start, pos - start);
+    ++pos;
+
+    start = pos;
+    while (pos < text.size() && isTargetChar(text[pos])) ++pos;
+    if (pos == start || pos >= text.size() || text[pos] != ' ') {
+        return HttpParseStatus::Invalid;
+    }
+    head.target = text.substr(start, pos - start);
+    ++pos;
+
+    if (text.substr(pos, 7) != "HTTP/1." || pos + 7 >= text.size() || text[pos + 7] < '0' || text[pos + 7] > '9') {
+        return HttpParseStatus::Invalid;
+    }
+    head.minor_version = text[pos + 7] - '0';
+    pos += 8;
+    if (!consumeLineEnd(text, pos)) {
+        return HttpParseStatus::Invalid;
+    }
+
+    // Header fields until the blank line
+    while (true) {
+        if (consumeLineEnd(text, pos)) {
+            break;
+        }
+        if (pos >= text.size()) {
+            return HttpParseStatus::Invalid;
+        }
+        // A leading space or tab is obsolete line folding
+        start = pos;
+        while (pos < text.size() && isToken(text[pos])) ++pos;
+        if (pos == start || pos >= text.size() || text[pos] != ':') {
+            return HttpParseStatus::Invalid;
+        }
+        std::string_view name = text.substr(start, pos - start);
+        ++pos;
+
+        start = pos;
+        while (pos < text.size() && isValueChar(text[pos])) ++pos;
+        std::string_view value = trim(text.substr(start, pos - start));
+        if (!consumeLineEnd(text, pos)) {
+            return HttpParseStatus::Invalid;
+        }
+
+        if (head.headers.size() >= MAX_HEADERS) {
+            return HttpParseStatus::Invalid;
+        }
+        head.headers.add(name, value);
+    }
+
+    head.length = pos;
+    return HttpParseStatus::Complete;
+}
+
+// ============================================================================
+// Chunked transfer decoding
+// ============================================================================
+
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+HttpParseStatus HttpChunkedDecoder::feed(std::string_view input, std::string& output) {
+    size_t pos = 0;
+    while (pos < input.size() && state_ != State::Done) {
+        char c = input[pos];
+        switch (state_) {
+            case State::Size: {
+                int digit = hexValue(c);
+                if (digit >= 0) {
+                    // 15 hex digits is far past any size we would accept
+                    if (++size_digits_ > 15) return HttpParseStatus::Invalid;
+                    chunk_size_ = chunk_size_ * 16 + static_cast<size_t>(digit);
+                    ++pos;
+                    break;
+                }
+                if (size_digits_ == 0) return HttpParseStatus::Invalid;
+                if (c == ';' || c == ' ' || c == '\t') {
+                    state_ = State::Extension;
+                    line_length_ = 0;
+                } else if (c == '\r') {
+                    state_ = State::SizeLf;
+                } else if (c == '\n') {
+                    state_ = chunk_size_ == 0 ? State::Trailer : State::Data;
+                } else {
+                    return HttpParseStatus::Invalid;
+                }
+                ++pos;
+                break;
+            }
+            case State::Extension:
+                if (++line_length_ > MAX_CHUNK_LINE) return HttpParseStatus::Invalid;
+                if (c == '\r') {
+                    state_ = State::SizeLf;
+                } else if (c == '\n') {
+                    state_ = chunk_size_ == 0 ? State::Trailer : State::Data;
+                }
+                ++pos;
+                break;
+            case State::SizeLf:
+                if (c != '\n') return HttpParseStatus::Invalid;
+                state_ = chunk_size_ == 0 ? State::Trailer : State::Data;
+                ++pos;
+                break;
+            case State::Data: {
+                size_t take = std::min(chunk_size_, input.size() - pos);
+                output.append(input.data() + pos, take);
+                pos += take;
+                chunk_size_ -= take;
+                if (chunk_size_ == 0) {
+                    state_ = State::DataCr;
+                }
+                break;
+            }
+            case State::DataCr:
+            case State::DataLf:
+                if (c == '\r' && state_ == State::DataCr) {
+                    state_ = State::DataLf;
+                } else if (c == '\n') {
+                    state_ = State::Size;
+                    size_digits_ = 0;
+                } else {
+                    return HttpParseStatus::Invalid;
+                }
+                ++pos;
+                break;
+            case State::Trailer:
+                if (c == '\r') {
+                    state_ = State::TrailerCr;
+                } else if (c == '\n') {
+                    state_ = State::Done;
+                } else {
+                    state_ = State::TrailerLine;
+                    line_length_ = 1;
+                }
+                ++pos;
+                break;
+            case State::TrailerCr:
+                if (c != '\n') return HttpParseStatus::Invalid;
+                state_ = State::Done;
+                ++pos;
+                break;
+            case State::TrailerLine:
+                if (++line_length_ > MAX_CHUNK_LINE) return HttpParseStatus::Invalid;
+                if (c == '\n') {
+                    state_ = State::Trailer;
+                }
+                ++pos;
+                break;
+            case State::Done:
+                break;
+        }
+    }
+
+    if (state_ != State::Done) {
+        return HttpParseStatus::Incomplete;
+    }
+    remaining_ = input.size() - pos;
+    return HttpParseStatus::Complete;
+}
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,520 @@
+#include "utils/json_parser.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace sohbet {
+namespace utils {
+
+// ============================================================================
+// JsonParser Implementation
+// ============================================================================
+
+class JsonParser {
+public:
+    JsonParser(std::string_view text, JsonDocument& doc) : text_(text), doc_(doc) {}
+
+    bool run() {
+        skipWhitespace();
+        if (pos_ >= text_.size()) {
+            return fail("empty document");
+        }
+        if (!parseValue(0)) {
+            return false;
+        }
+        skipWhitespace();
+        if (pos_ != text_.size()) {
+            return fail("unexpected data after value");
+        }
+        return true;
+    }
+
+private:
+    using Node = JsonDocument::Node;
+
+    bool fail(const char* message) {
+        doc_.error_ = "Invalid JSON at offset " + std::to_string(pos_) + ": " + message;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            ++pos_;
+        }
+    }
+
+    uint32_t push(JsonType type, size_t offset) {
+        doc_.nodes_.push_back(Node{type, false, 0, 0, static_cast<uint32_t>(offset), 0});
+        return static_cast<uint32_t>(doc_.nodes_.size() - 1);
+    }
+
+    void finish(uint32_t index, size_t end_offset) {
+        Node& node = doc_.nodes_[index];
+        node.end = static_cast<uint32_t>(doc_.nodes_.size());
+        node.length = static_cast<uint32_t>(end_offset - node.offset);
+    }
+
+    bool parseValue(int depth) {
+        if (pos_ >= text_.size()) {
+            return fail("unexpected end of input");
+        }
+        switch (text_[pos_]) {
+            case '{': return parseObject(depth);
+            case '[': return parseArray(depth);
+            case '"': return parseString();
+            case 't': return parseLiteral("true", JsonType::Bool);
+            case 'f': return parseLiteral("false", JsonType::Bool);
+            case 'n': return parseLiteral("null", JsonType::Null);
+            default:  return parseNumber();
+        }
+    }
+
+    bool parseObject(int depth) {
+        if (depth >= JsonDocument::MAX_DEPTH) {
+            return fail("nesting too deep");
+        }
+        uint32_t index = push(JsonType::Object, pos_);
+        ++pos_; // '{'
+        uint32_t count = 0;
+
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+            finish(index, pos_);
+            return true;
+        }
+
+        while (true) {
+            skipWhitespace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                return fail("expected string key");
+            }
+            if (!parseString()) {
+                return false;
+            }
+            skipWhitespace();
+            if (pos_ >= text_.size() || text_[pos_] != ':') {
+                return fail("expected ':'");
+            }
+            ++pos_;
+            skipWhitespace();
+            if (!parseValue(depth + 1)) {
+                return false;
+            }
+            ++count;
+
+            skipWhitespace();
+            if (pos_ >= text_.size()) {
+                return fail("unterminated object");
+            }
+            if (text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (text_[pos_] == '}') {
+                ++pos_;
+                break;
+            }
+            return fail("expected ',' or '}'");
+        }
+
+        doc_.nodes_[index].count = count;
+        finish(index, pos_);
+        return true;
+    }
+
+    bool parseArray(int depth) {
+        if (depth >= JsonDocument::MAX_DEPTH) {
+            return fail("nesting too deep");
+        }
+        uint32_t index = push(JsonType::Array, pos_);
+        ++pos_; // '['
+        uint32_t count = 0;
+
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+            finish(index, pos_);
+            return true;
+        }
+
+        while (true) {
+            skipWhitespace();
+            if (!parseValue(depth + 1)) {
+                return false;
+            }
+            ++count;
+
+            skipWhitespace();
+            if (pos_ >= text_.size()) {
+                return fail("unterminated array");
+            }
+            if (text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (text_[pos_] == ']') {
+                ++pos_;
+                break;
+            }
+            return fail("expected ',' or ']'");
+        }
+
+        doc_.nodes_[index].count = count;
+        finish(index, pos_);
+        return true;
+    }
+
+    // True if any byte is '"', '\\' or a control character
+    static bool wordHasSpecial(uint64_t word) {
+        constexpr uint64_t ONES = 0x0101010101010101ULL;
+        constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+        uint64_t control = (word - ONES * 0x20) & ~word;
+        uint64_t quote = word ^ (ONES * '"');
+        uint64_t backslash = word ^ (ONES * '\\');
+        quote = (quote - ONES) & ~quote;
+        backslash = (backslash - ONES) & ~backslash;
+        return ((control | quote | backslash) & HIGHS) != 0;
+    }
+
+    static bool isHex(char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    bool parseString() {
+        ++pos_; // opening quote
+        uint32_t index = push(JsonType::String, pos_);
+        bool escaped = false;
+
+        const char* data = text_.data();
+        const size_t size = text_.size();
+
+        while (pos_ < size) {
+            // Skip plain characters eight at a time
+            while (pos_ + 8 <= size) {
+                uint64_t word;
+                std::memcpy(&word, data + pos_, 8);
+                if (wordHasSpecial(word)) {
+                    break;
+                }
+                pos_ += 8;
+            }
+            if (pos_ >= size) {
+                break;
+            }
+
+            unsigned char c = static_cast<unsigned char>(data[pos_]);
+            if (c == '"') {
+                doc_.nodes_[index].escaped = escaped;
+                finish(index, pos_);
+                ++pos_; // closing quote
+                return true;
+            }
+            if (c < 0x20) {
+                return fail("control character in string");
+            }
+            if (c == '\\') {
+                escaped = true;
+                if (pos_ + 1 >= text_.size()) {
+                    break;
+                }
+                char e = text_[pos_ + 1];
+                if (e == 'u') {
+                    if (pos_ + 6 > text_.size() || !isHex(text_[pos_ + 2]) || !isHex(text_[pos_ + 3]) ||
+                        !isHex(text_[pos_ + 4]) || !isHex(text_[pos_ + 5])) {
+                        return fail("invalid \\u escape");
+                    }
+                    pos_ += 6;
+                    continue;
+                }
+                if (e != '"' && e != '\\' && e != '/' && e != 'b' && e != 'f' &&
+                    e != 'n' && e != 'r' && e != 't') {
+                    return fail("invalid escape sequence");
+                }
+                pos_ += 2;
+                continue;
+            }
+            ++pos_;
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseLiteral(std::string_view literal, JsonType type) {
+        if (text_.substr(pos_, literal.size()) != literal) {
+            return fail("invalid literal");
+        }
+        uint32_t index = push(type, pos_);
+        pos_ += literal.size();
+        finish(index, pos_);
+        return true;
+    }
+
+    bool digitAt(size_t i) const {
+        return i < text_.size() && text_[i] >= '0' && text_[i] <= '9';
+    }
+
+    bool parseNumber() {
+        size_t start = pos_;
+        if (pos_ < text_.size() && text_[pos_] == '-') {
+            ++pos_;
+        }
+        if (!digitAt(pos_)) {
+            return fail("unexpected character");
+        }
+        if (text_[pos_] == '0') {
+            ++pos_;
+        } else {
+            while (digitAt(pos_)) ++pos_;
+        }
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            ++pos_;
+            if (!digitAt(pos_)) {
+                return fail("invalid number");
+            }
+            while (digitAt(pos_)) ++pos_;
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+                ++pos_;
+            }
+            if (!digitAt(pos_)) {
+                return fail("invalid number");
+            }
+            while (digitAt(pos_)) ++pos_;
+        }
+        uint32_t index = push(JsonType::Number, start);
+        finish(index, pos_);
+        return true;
+    }
+
+    std::string_view text_;
+    JsonDocument& doc_;
+    size_t pos_ = 0;
+};
+
+// ============================================================================
+// JsonDocument Implementation
+// ============================================================================
+
+JsonDocument JsonDocument::parse(std::string_view text) {
+    JsonDocument doc;
+    doc.text_ = text;
+
+    if (text.size() > std::numeric_limits<uint32_t>::max()) {
+        doc.error_ = "Invalid JSON: document too large";
+        return doc;
+    }
+
+    // Typical bodies have one node per ~8 bytes; avoid regrowing for small ones
+    doc.nodes_.reserve(text.size() / 8 + 4);
+
+    JsonParser parser(text, doc);
+    if (!parser.run()) {
+        doc.nodes_.clear();
+    }
+    return doc;
+}
+
+JsonValue JsonDocument::root() const {
+    if (nodes_.empty()) {
+        return JsonValue();
+    }
+    return JsonValue(this, 0);
+}
+
+// ============================================================================
+// JsonValue Implementation
+// ============================================================================
+
+namespace {
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+unsigned readHex4(std::string_view s, size_t i) {
+    return (hexValue(s[i]) << 12) | (hexValue(s[i + 1]) << 8) | (hexValue(s[i + 2]) << 4) | hexValue(s[i + 3]);
+}
+
+void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Decode a validated string body (escapes already checked by the parser)
+std::string decodeString(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    size_t i = 0;
+    while (i < s.size()) {
+        size_t run = s.find('\\', i);
+        if (run == std::string_view::npos) {
+            out.append(s.data() + i, s.size() - i);
+            break;
+        }
+        out.append(s.data() + i, run - i);
+        i = run + 1;
+        char e = s[i++];
+        switch (e) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned cp = readHex4(s, i);
+                i += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 <= s.size() && s[i] == '\\' && s[i + 1] == 'u') {
+                    unsigned low = readHex4(s, i + 2);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                // Unpaired surrogates become U+FFFD
+                if (cp >= 0xD800 && cp <= 0xDFFF) {
+                    cp = 0xFFFD;
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default: out += e; break; // '"', '\\', '/'
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+JsonType JsonValue::type() const {
+    return doc_->nodes_[index_].type;
+}
+
+std::string_view JsonValue::raw() const {
+    if (!exists()) {
+        return std::string_view();
+    }
+    const auto& node = doc_->nodes_[index_];
+    return doc_->text_.substr(node.offset, node.length);
+}
+
+std::optional<std::string> JsonValue::getString() const {
+    if (!isString()) {
+        return std::nullopt;
+    }
+    const auto& node = doc_->nodes_[index_];
+    std::string_view contents = doc_->text_.substr(node.offset, node.length);
+    if (!node.escaped) {
+        return std::string(contents);
+    }
+    return decodeString(contents);
+}
+
+std::optional<int64_t> JsonValue::getInt() const {
+    if (!exists()) {
+        return std::nullopt;
+    }
+    const auto& node = doc_->nodes_[index_];
+    if (node.type != JsonType::Number && !(node.type == JsonType::String && !node.escaped)) {
+        return std::nullopt;
+    }
+    std::string_view literal = doc_->text_.substr(node.offset, node.length);
+    int64_t value = 0;
+    auto result = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+    if (result.ec != std::errc() || result.ptr != literal.data() + literal.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<double> JsonValue::getDouble() const {
+    if (!exists()) {
+        return std::nullopt;
+    }
+    const auto& node = doc_->nodes_[index_];
+    if (node.type != JsonType::Number && !(node.type == JsonType::String && !node.escaped)) {
+        return std::nullopt;
+    }
+    std::string_view literal = doc_->text_.substr(node.offset, node.length);
+    double value = 0.0;
+    auto result = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+    if (result.ec != std::errc() || result.ptr != literal.data() + literal.size() || !std::isfinite(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<bool> JsonValue::getBool() const {
+    if (!exists()) {
+        return std::nullopt;
+    }
+    std::string_view text = raw();
+    if (type() == JsonType::Bool) {
+        return text == "true";
+    }
+    if (type() == JsonType::String) {
+        if (text == "true") return true;
+        if (text == "false") return false;
+    }
+    return std::nullopt;
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+    if (!isObject()) {
+        return JsonValue();
+    }
+    const auto& nodes = doc_->nodes_;
+    uint32_t child = index_ + 1;
+    for (uint32_t i = 0; i < nodes[index_].count; ++i) {
+        const auto& key_node = nodes[child];
+        uint32_t value_index = child + 1;
+        std::string_view name = doc_->text_.substr(key_node.offset, key_node.length);
+        if (key_node.escaped ? decodeString(name) == key : name == key) {
+            return JsonValue(doc_, value_index);
+        }
+        child = nodes[value_index].end;
+    }
+    return JsonValue();
+}
+
+JsonValue JsonValue::at(size_t index) const {
+    if (!isArray() || index >= doc_->nodes_[index_].count) {
+        return JsonValue();
+    }
+    uint32_t child = index_ + 1;
+    for (size_t i = 0; i < index; ++i) {
+        child = doc_->nodes_[child].end;
+    }
+    return JsonValue(doc_, child);
+}
+
+size_t JsonValue::size() const {
+    if (!isArray() && !isObject()) {
+        return 0;
+    }
+    return doc_->nodes_[index_].count;
+}
+
+} // namespace utils
+} // namespace sohbet
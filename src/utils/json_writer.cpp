@@ -0,0 +1,265 @@
+#include "utils/json_writer.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace sohbet {
+namespace utils {
+
+namespace {
+
+// Pooled output buffers, one per nesting level of live writers on this thread
+struct ThreadBuffers {
+    std::vector<std::unique_ptr<std::string>> buffers;
+    size_t depth = 0;
+};
+
+thread_local ThreadBuffers thread_buffers;
+
+// Buffers that grew past this are released instead of being kept for reuse
+constexpr size_t MAX_RETAINED_CAPACITY = 1 << 20;
+
+// 0 = copy as-is, otherwise the character following the backslash
+// ('u' means a \u00XX escape)
+struct EscapeTable {
+    char table[256];
+
+    constexpr EscapeTable() : table() {
+        for (int c = 0; c < 0x20; ++c) {
+            table[c] = 'u';
+        }
+        table[static_cast<unsigned char>('\b')] = 'b';
+        table[static_cast<unsigned char>('\f')] = 'f';
+        table[static_cast<unsigned char>('\n')] = 'n';
+        table[static_cast<unsigned char>('\r')] = 'r';
+        table[static_cast<unsigned char>('\t')] = 't';
+        table[static_cast<unsigned char>('"')] = '"';
+        table[static_cast<unsigned char>('\\')] = '\\';
+    }
+};
+
+constexpr EscapeTable ESCAPES;
+
+constexpr uint64_t ONES = 0x0101010101010101ULL;
+constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+
+// True if any of the 8 bytes is a control character, '"' or '\\'.
+// Bytes >= 0x80 (UTF-8 sequences) are never flagged.
+inline bool wordNeedsEscape(uint64_t word) {
+    uint64_t control = (word - ONES * 0x20) & ~word;
+    uint64_t quote = word ^ (ONES * '"');
+    uint64_t backslash = word ^ (ONES * '\\');
+    quote = (quote - ONES) & ~quote;
+    backslash = (backslash - ONES) & ~backslash;
+    return ((control | quote | backslash) & HIGHS) != 0;
+}
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+} // namespace
+
+// ============================================================================
+// JsonWriter Implementation
+// ============================================================================
+
+JsonWriter::JsonWriter() : pooled_(true) {
+    ThreadBuffers& pool = thread_buffers;
+    if (pool.depth == pool.buffers.size()) {
+        pool.buffers.push_back(std::make_unique<std::string>());
+    }
+    out_ = pool.buffers[pool.depth++].get();
+    out_->clear();
+}
+
+JsonWriter::JsonWriter(std::string& out) : out_(&out), pooled_(false) {
+}
+
+JsonWriter::~JsonWriter() {
+    if (!pooled_) {
+        return;
+    }
+    if (out_->capacity() > MAX_RETAINED_CAPACITY) {
+        std::string().swap(*out_);
+    }
+    --thread_buffers.depth;
+}
+
+void JsonWriter::separate() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    uint64_t bit = 1ULL << (depth_ & (MAX_DEPTH - 1));
+    if (has_items_ & bit) {
+        out_->push_back(',');
+    }
+    has_items_ |= bit;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_->push_back('{');
+    ++depth_;
+    has_items_ &= ~(1ULL << (depth_ & (MAX_DEPTH - 1)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out_->push_back('}');
+    --depth_;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_->push_back('[');
+    ++depth_;
+    has_items_ &= ~(1ULL << (depth_ & (MAX_DEPTH - 1)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out_->push_back(']');
+    --depth_;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    out_->push_back('"');
+    escape(name, *out_);
+    out_->append("\":", 2);
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view str) {
+    separate();
+    out_->push_back('"');
+    escape(str, *out_);
+    out_->push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separate();
+    if (b) {
+        out_->append("true", 4);
+    } else {
+        out_->append("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    // JSON has no representation for NaN or infinity
+    if (!std::isfinite(number)) {
+        return null();
+    }
+    separate();
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), number);
+    out_->append(buf, result.ptr - buf);
+    return *this;
+}
+
+void JsonWriter::writeInt(int64_t number) {
+    separate();
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), number);
+    out_->append(buf, result.ptr - buf);
+}
+
+void JsonWriter::writeUInt(uint64_t number) {
+    separate();
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), number);
+    out_->append(buf, result.ptr - buf);
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out_->append("null", 4);
+    return *this;
+}
+
+JsonWriter& JsonWriter::timestamp(std::time_t time) {
+    std::tm tm{};
+    gmtime_r(&time, &tm);
+
+    int year = tm.tm_year + 1900;
+    char buf[24] = {
+        '"',
+        static_cast<char>('0' + (year / 1000) % 10), static_cast<char>('0' + (year / 100) % 10),
+        static_cast<char>('0' + (year / 10) % 10), static_cast<char>('0' + year % 10), '-',
+        static_cast<char>('0' + (tm.tm_mon + 1) / 10), static_cast<char>('0' + (tm.tm_mon + 1) % 10), '-',
+        static_cast<char>('0' + tm.tm_mday / 10), static_cast<char>('0' + tm.tm_mday % 10), 'T',
+        static_cast<char>('0' + tm.tm_hour / 10), static_cast<char>('0' + tm.tm_hour % 10), ':',
+        static_cast<char>('0' + tm.tm_min / 10), static_cast<char>('0' + tm.tm_min % 10), ':',
+        static_cast<char>('0' + tm.tm_sec / 10), static_cast<char>('0' + tm.tm_sec % 10), 'Z',
+        '"'
+    };
+
+    separate();
+    out_->append(buf, 22);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    out_->append(json.data(), json.size());
+    return *this;
+}
+
+void JsonWriter::escape(std::string_view input, std::string& out) {
+    const char* data = input.data();
+    const size_t size = input.size();
+    size_t i = 0;
+    size_t run_start = 0;
+
+    while (i < size) {
+        // Skip over runs of safe bytes eight at a time
+        while (i + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            if (wordNeedsEscape(word)) {
+                break;
+            }
+            i += 8;
+        }
+
+        // Byte-wise scan to the escapable byte (at most 8 bytes away) or the tail
+        while (i < size && ESCAPES.table[static_cast<unsigned char>(data[i])] == 0) {
+            ++i;
+        }
+
+        out.append(data + run_start, i - run_start);
+        if (i == size) {
+            break;
+        }
+
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        char escaped = ESCAPES.table[c];
+        if (escaped == 'u') {
+            const char sequence[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+            out.append(sequence, 6);
+        } else {
+            const char sequence[2] = {'\\', escaped};
+            out.append(sequence, 2);
+        }
+        ++i;
+        run_start = i;
+    }
+}
+
+std::string JsonWriter::escape(std::string_view input) {
+    std::string out;
+    out.reserve(input.size() + 8);
+    escape(input, out);
+    return out;
+}
+
+} // namespace utils
+} // namespace sohbet
@@ -1,4 +1,5 @@
 #include "utils/logger.h"
+#include "utils/json_writer.h"
 #include <cstdlib>
 #include <ctime>
 
@@ -61,48 +62,26 @@ std::string Logger::levelToString(LogLevel level) const {
     }
 }
 
-std::string Logger::escapeJson(const std::string& str) const {
-    std::ostringstream oss;
-    for (char c : str) {
-        switch (c) {
-            case '"':  oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if (c < 0x20) {
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
-                        << static_cast<int>(c);
-                } else {
-                    oss << c;
-                }
-                break;
-        }
-    }
-    return oss.str();
-}
-
 void Logger::log(LogLevel level, const std::string& message, const std::string& context) {
     if (level < min_level_) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(mutex_);
-
     // Output as structured JSON for Grafana/Loki
-    std::cout << "{"
-              << "\"timestamp\":\"" << getCurrentTimestamp() << "\","
-              << "\"level\":\"" << levelToString(level) << "\","
-              << "\"message\":\"" << escapeJson(message) << "\"";
+    JsonWriter writer;
+    writer.beginObject();
+    writer.field("timestamp", getCurrentTimestamp());
+    writer.field("level", levelToString(level));
+    writer.field("message", message);
 
     if (!context.empty()) {
-        std::cout << ",\"context\":\"" << escapeJson(context) << "\"";
+        writer.field("context", context);
     }
 
-    std::cout << "}" << std::endl;
+    writer.endObject();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << writer.buffer() << std::endl;
 }
 
 void Logger::debug(const std::string& message, const std::string& context) {
@@ -0,0 +1,212 @@
+#include "utils/metrics.h"
+#include <cstdio>
+
+namespace sohbet {
+namespace utils {
+
+// Exported Prometheus bucket boundaries, in seconds
+static const double EXPORT_BOUNDS_SECONDS[] = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+// ============================================================================
+// Histogram Implementation
+// ============================================================================
+
+int Histogram::bucketIndex(uint64_t micros) {
+    if (micros < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(micros);
+    }
+    int exponent = 63 - __builtin_clzll(micros);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    int mantissa = static_cast<int>((micros >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + mantissa;
+}
+
+uint64_t Histogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t mantissa = static_cast<uint64_t>(index % SUB_BUCKETS);
+    return ((SUB_BUCKETS + mantissa + 1) << (exponent - SUB_BUCKET_BITS)) - 1;
+}
+
+uint64_t Histogram::quantileMicros(double q) const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+// ============================================================================
+// MetricsRegistry Implementation
+// ============================================================================
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+std::string MetricsRegistry::formatLabels(Labels labels) {
+    std::string out;
+    for (const auto& label : labels) {
+        if (!out.empty()) out += ',';
+        out += label.first;
+        out += "=\"";
+        for (char c : label.second) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '"':  out += "\\\""; break;
+                case '\n': out += "\\n"; break;
+                default:   out += c; break;
+            }
+        }
+        out += '"';
+    }
+    return out;
+}
+
+template <typename T>
+T& MetricsRegistry::getOrCreate(std::map<std::string, Family<T>>& families,
+                                const std::string& name, const std::string& help, Labels labels) {
+    std::string key = formatLabels(labels);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto family_it = families.find(name);
+        if (family_it != families.end()) {
+            auto series_it = family_it->second.series.find(key);
+            if (series_it != family_it->second.series.end()) {
+                return *series_it->second;
+            }
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto& family = families[name];
+    if (family.help.empty()) {
+        family.help = help;
+    }
+    auto& slot = family.series[key];
+    if (!slot) {
+        slot = std::make_unique<T>();
+    }
+    return *slot;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, Labels labels) {
+    return getOrCreate(counters_, name, help, labels);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, Labels labels) {
+    return getOrCreate(gauges_, name, help, labels);
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, Labels labels) {
+    return getOrCreate(histograms_, name, help, labels);
+}
+
+static void appendHeader(std::string& out, const std::string& name,
+                         const std::string& help, const char* type) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+static void appendSeriesName(std::string& out, const std::string& name, const std::string& labels) {
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::string out;
+    char number[64];
+
+    for (const auto& [name, family] : counters_) {
+        appendHeader(out, name, family.help, "counter");
+        for (const auto& [labels, metric] : family.series) {
+            appendSeriesName(out, name, labels);
+            out += ' ' + std::to_string(metric->value()) + '\n';
+        }
+    }
+
+    for (const auto& [name, family] : gauges_) {
+        appendHeader(out, name, family.help, "gauge");
+        for (const auto& [labels, metric] : family.series) {
+            appendSeriesName(out, name, labels);
+            out += ' ' + std::to_string(metric->value()) + '\n';
+        }
+    }
+
+    const size_t bound_count = sizeof(EXPORT_BOUNDS_SECONDS) / sizeof(EXPORT_BOUNDS_SECONDS[0]);
+    for (const auto& [name, family] : histograms_) {
+        appendHeader(out, name, family.help, "histogram");
+        for (const auto& [labels, metric] : family.series) {
+            std::string prefix = labels.empty() ? "" : labels + ",";
+
+            // Fold the fine-grained buckets into the exported boundaries
+            uint64_t cumulative = 0;
+            int bucket = 0;
+            for (size_t b = 0; b < bound_count; ++b) {
+                uint64_t bound_micros = static_cast<uint64_t>(EXPORT_BOUNDS_SECONDS[b] * 1e6);
+                while (bucket < Histogram::BUCKET_COUNT && Histogram::bucketUpperBound(bucket) <= bound_micros) {
+                    cumulative += metric->bucketCount(bucket);
+                    ++bucket;
+                }
+                std::snprintf(number, sizeof(number), "%g", EXPORT_BOUNDS_SECONDS[b]);
+                out += name + "_bucket{" + prefix + "le=\"" + number + "\"} " + std::to_string(cumulative) + '\n';
+            }
+            for (; bucket < Histogram::BUCKET_COUNT; ++bucket) {
+                cumulative += metric->bucketCount(bucket);
+            }
+            out += name + "_bucket{" + prefix + "le=\"+Inf\"} " + std::to_string(cumulative) + '\n';
+
+            std::snprintf(number, sizeof(number), "%.6f", static_cast<double>(metric->sumMicros()) / 1e6);
+            appendSeriesName(out, name + "_sum", labels);
+            out += ' ';
+            out += number;
+            out += '\n';
+            appendSeriesName(out, name + "_count", labels);
+            out += ' ' + std::to_string(cumulative) + '\n';
+        }
+    }
+
+    return out;
+}
+
+CacheLookupMetrics::CacheLookupMetrics(const std::string& cache) {
+    if (cache.empty()) {
+        return;
+    }
+    auto& registry = MetricsRegistry::getInstance();
+    hit_ = &registry.counter("sohbet_cache_lookups_total", "Cache lookups by cache and outcome",
+                             {{"cache", cache}, {"result", "hit"}});
+    miss_ = &registry.counter("sohbet_cache_lookups_total", "Cache lookups by cache and outcome",
+                              {{"cache", cache}, {"result", "miss"}});
+}
+
+} // namespace utils
+} // namespace sohbet
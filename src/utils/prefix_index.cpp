@@ -0,0 +1,300 @@
+#include "utils/prefix_index.h"
+#include <algorithm>
+#include <mutex>
+
+namespace sohbet {
+namespace utils {
+
+// ============================================================================
+// PrefixIndex Implementation
+// ============================================================================
+
+PrefixIndex::PrefixIndex(size_t top_k)
+    : top_k_(top_k == 0 ? 1 : top_k) {
+    nodes_.emplace_back(); // Root
+}
+
+std::string PrefixIndex::normalize(const std::string& text) {
+    std::string key = text;
+    for (char& c : key) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return key;
+}
+
+bool PrefixIndex::better(uint32_t a, uint32_t b) const {
+    const Entry& ea = entries_[a];
+    const Entry& eb = entries_[b];
+    if (ea.score != eb.score) {
+        return ea.score > eb.score;
+    }
+    return ea.key < eb.key;
+}
+
+int32_t PrefixIndex::findChild(uint32_t node, char c) const {
+    const auto& children = nodes_[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), c,
+                               [this](uint32_t child, char value) { return nodes_[child].label[0] < value; });
+    if (it != children.end() && nodes_[*it].label[0] == c) {
+        return static_cast<int32_t>(*it);
+    }
+    return -1;
+}
+
+void PrefixIndex::addChild(uint32_t parent, uint32_t child) {
+    auto& children = nodes_[parent].children;
+    char c = nodes_[child].label[0];
+    auto it = std::lower_bound(children.begin(), children.end(), c,
+                               [this](uint32_t existing, char value) { return nodes_[existing].label[0] < value; });
+    children.insert(it, child);
+}
+
+std::vector<uint32_t> PrefixIndex::insertPath(const std::string& key) {
+    std::vector<uint32_t> path{0};
+    uint32_t node = 0;
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+        int32_t child = findChild(node, key[pos]);
+        if (child < 0) {
+            Node leaf;
+            leaf.label = key.substr(pos);
+            nodes_.push_back(std::move(leaf));
+            uint32_t leaf_index = static_cast<uint32_t>(nodes_.size() - 1);
+            addChild(node, leaf_index);
+            path.push_back(leaf_index);
+            return path;
+        }
+
+        uint32_t c = static_cast<uint32_t>(child);
+        const std::string& label = nodes_[c].label;
+        size_t common = 0;
+        while (common < label.size() && pos + common < key.size() && label[common] == key[pos + common]) {
+            ++common;
+        }
+
+        if (common == label.size()) {
+            node = c;
+            pos += common;
+            path.push_back(c);
+            continue;
+        }
+
+        // Split the edge: parent -> mid (shared part) -> c (rest)
+        Node mid;
+        mid.label = label.substr(0, common);
+        mid.top = nodes_[c].top;
+        mid.children.push_back(c);
+        nodes_[c].label = nodes_[c].label.substr(common);
+        nodes_.push_back(std::move(mid));
+        uint32_t mid_index = static_cast<uint32_t>(nodes_.size() - 1);
+
+        auto& siblings = nodes_[node].children;
+        std::replace(siblings.begin(), siblings.end(), c, mid_index);
+
+        pos += common;
+        path.push_back(mid_index);
+        node = mid_index;
+    }
+
+    return path;
+}
+
+std::vector<uint32_t> PrefixIndex::findPath(const std::string& key) const {
+    std::vector<uint32_t> path{0};
+    uint32_t node = 0;
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+        int32_t child = findChild(node, key[pos]);
+        if (child < 0) {
+            return {};
+        }
+        const std::string& label = nodes_[child].label;
+        if (key.compare(pos, label.size(), label) != 0) {
+            return {};
+        }
+        node = static_cast<uint32_t>(child);
+        pos += label.size();
+        path.push_back(node);
+    }
+    return path;
+}
+
+void PrefixIndex::refresh(const std::vector<uint32_t>& path) {
+    // Bottom-up: each node's list is the best of its own entry and its
+    // children's lists, which are already up to date
+    std::vector<uint32_t> candidates;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        Node& node = nodes_[*it];
+        candidates.clear();
+        if (node.entry >= 0) {
+            candidates.push_back(static_cast<uint32_t>(node.entry));
+        }
+        for (uint32_t child : node.children) {
+            const auto& top = nodes_[child].top;
+            candidates.insert(candidates.end(), top.begin(), top.end());
+        }
+
+        size_t keep = std::min(top_k_, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [this](uint32_t a, uint32_t b) { return better(a, b); });
+        node.top.assign(candidates.begin(), candidates.begin() + keep);
+    }
+}
+
+void PrefixIndex::refreshSubtree(uint32_t root) {
+    // Iterative post-order so deep tries cannot overflow the stack
+    std::vector<std::pair<uint32_t, bool>> stack{{root, false}};
+    while (!stack.empty()) {
+        auto [node, children_done] = stack.back();
+        stack.pop_back();
+        if (!children_done) {
+            stack.push_back({node, true});
+            for (uint32_t child : nodes_[node].children) {
+                stack.push_back({child, false});
+            }
+        } else {
+            refresh({node});
+        }
+    }
+}
+
+void PrefixIndex::detach(uint32_t entry_index) {
+    std::vector<uint32_t> path = findPath(entries_[entry_index].key);
+    if (path.empty()) {
+        return;
+    }
+    nodes_[path.back()].entry = -1;
+    entries_[entry_index].live = false;
+    refresh(path);
+}
+
+void PrefixIndex::rebuild(const std::vector<Match>& entries) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    nodes_.clear();
+    nodes_.emplace_back();
+    entries_.clear();
+    by_id_.clear();
+
+    for (const auto& match : entries) {
+        std::string key = normalize(match.text);
+        auto existing = by_id_.find(match.id);
+        if (existing != by_id_.end()) {
+            // Duplicate id in the input: keep the last one
+            entries_[existing->second].live = false;
+            std::vector<uint32_t> old_path = findPath(entries_[existing->second].key);
+            nodes_[old_path.back()].entry = -1;
+        }
+        std::vector<uint32_t> path = insertPath(key);
+        Node& terminal = nodes_[path.back()];
+        if (terminal.entry >= 0) {
+            by_id_.erase(entries_[terminal.entry].id);
+            entries_[terminal.entry].live = false;
+        }
+        entries_.push_back(Entry{match.id, match.text, key, match.score, true});
+        uint32_t entry_index = static_cast<uint32_t>(entries_.size() - 1);
+        nodes_[path.back()].entry = static_cast<int32_t>(entry_index);
+        by_id_[match.id] = entry_index;
+    }
+
+    refreshSubtree(0);
+}
+
+void PrefixIndex::upsert(int id, const std::string& text, int64_t score) {
+    std::string key = normalize(text);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    auto existing = by_id_.find(id);
+    if (existing != by_id_.end()) {
+        Entry& entry = entries_[existing->second];
+        if (entry.key == key) {
+            entry.text = text;
+            entry.score = score;
+            refresh(findPath(key));
+            return;
+        }
+        // Text changed: the entry moves to another path
+        detach(existing->second);
+        by_id_.erase(existing);
+    }
+
+    std::vector<uint32_t> path = insertPath(key);
+    Node& terminal = nodes_[path.back()];
+    if (terminal.entry >= 0) {
+        // Another id with the same text: the newer one replaces it
+        by_id_.erase(entries_[terminal.entry].id);
+        entries_[terminal.entry].live = false;
+    }
+
+    entries_.push_back(Entry{id, text, key, score, true});
+    uint32_t entry_index = static_cast<uint32_t>(entries_.size() - 1);
+    nodes_[path.back()].entry = static_cast<int32_t>(entry_index);
+    by_id_[id] = entry_index;
+    refresh(path);
+}
+
+bool PrefixIndex::addScore(int id, int64_t delta) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_id_.find(id);
+    if (it == by_id_.end()) {
+        return false;
+    }
+    Entry& entry = entries_[it->second];
+    entry.score += delta;
+    refresh(findPath(entry.key));
+    return true;
+}
+
+bool PrefixIndex::remove(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_id_.find(id);
+    if (it == by_id_.end()) {
+        return false;
+    }
+    detach(it->second);
+    by_id_.erase(it);
+    return true;
+}
+
+std::vector<PrefixIndex::Match> PrefixIndex::complete(const std::string& prefix, size_t limit) const {
+    std::string key = normalize(prefix);
+    std::vector<Match> matches;
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        int32_t child = findChild(node, key[pos]);
+        if (child < 0) {
+            return matches;
+        }
+        // The prefix may end partway along this edge
+        const std::string& label = nodes_[child].label;
+        size_t overlap = std::min(label.size(), key.size() - pos);
+        if (key.compare(pos, overlap, label, 0, overlap) != 0) {
+            return matches;
+        }
+        node = static_cast<uint32_t>(child);
+        pos += overlap;
+    }
+
+    const auto& top = nodes_[node].top;
+    size_t count = std::min({limit, top_k_, top.size()});
+    matches.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Entry& entry = entries_[top[i]];
+        matches.push_back(Match{entry.id, entry.text, entry.score});
+    }
+    return matches;
+}
+
+size_t PrefixIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return by_id_.size();
+}
+
+} // namespace utils
+} // namespace sohbet
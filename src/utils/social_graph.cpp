@@ -0,0 +1,322 @@
+#include "utils/social_graph.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace sohbet {
+namespace utils {
+
+SocialGraph::SocialGraph(size_t max_delta) : max_delta_(max_delta == 0 ? 1 : max_delta) {
+    offsets_.push_back(0);
+}
+
+void SocialGraph::rebuild(const std::vector<std::pair<int, int>>& friendships) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    rebuildLocked(friendships);
+}
+
+void SocialGraph::rebuildLocked(std::vector<std::pair<int, int>> edges) {
+    // Normalize to (smaller, larger) and drop repeats and self-loops
+    for (auto& edge : edges) {
+        if (edge.first > edge.second) std::swap(edge.first, edge.second);
+    }
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+                               [](const std::pair<int, int>& edge) { return edge.first == edge.second; }),
+                edges.end());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // Rows in user id order; each edge appears in both endpoints' rows
+    std::vector<int> users;
+    users.reserve(edges.size() * 2);
+    for (const auto& edge : edges) {
+        users.push_back(edge.first);
+        users.push_back(edge.second);
+    }
+    std::sort(users.begin(), users.end());
+    users.erase(std::unique(users.begin(), users.end()), users.end());
+
+    vertex_.clear();
+    vertex_.reserve(users.size());
+    for (size_t i = 0; i < users.size(); ++i) {
+        vertex_[users[i]] = static_cast<uint32_t>(i);
+    }
+
+    offsets_.assign(users.size() + 1, 0);
+    for (const auto& edge : edges) {
+        ++offsets_[vertex_[edge.first] + 1];
+        ++offsets_[vertex_[edge.second] + 1];
+    }
+    for (size_t i = 1; i < offsets_.size(); ++i) {
+        offsets_[i] += offsets_[i - 1];
+    }
+
+    neighbors_.assign(edges.size() * 2, 0);
+    std::vector<uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (const auto& edge : edges) {
+        neighbors_[next[vertex_[edge.first]]++] = edge.second;
+        neighbors_[next[vertex_[edge.second]]++] = edge.first;
+    }
+    for (size_t i = 0; i < users.size(); ++i) {
+        std::sort(neighbors_.begin() + offsets_[i], neighbors_.begin() + offsets_[i + 1]);
+    }
+
+    base_edges_ = edges.size();
+    added_.clear();
+    removed_.clear();
+    added_edges_ = 0;
+    removed_edges_ = 0;
+}
+
+void SocialGraph::addFriendship(int user1_id, int user2_id) {
+    if (user1_id == user2_id) return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    auto removed = removed_.find(user1_id);
+    if (removed != removed_.end() && removed->second.erase(user2_id) > 0) {
+        // Undoes a pending removal of a compacted friendship
+        removed_[user2_id].erase(user1_id);
+        --removed_edges_;
+        return;
+    }
+    if (inBase(user1_id, user2_id)) return;
+    if (added_[user1_id].insert(user2_id).second) {
+        added_[user2_id].insert(user1_id);
+        ++added_edges_;
+    }
+
+    if (added_edges_ + removed_edges_ > max_delta_) {
+        compactLocked();
+    }
+}
+
+void SocialGraph::removeFriendship(int user1_id, int user2_id) {
+    if (user1_id == user2_id) return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    auto added = added_.find(user1_id);
+    if (added != added_.end() && added->second.erase(user2_id) > 0) {
+        added_[user2_id].erase(user1_id);
+        --added_edges_;
+        return;
+    }
+    if (!inBase(user1_id, user2_id)) return;
+    if (removed_[user1_id].insert(user2_id).second) {
+        removed_[user2_id].insert(user1_id);
+        ++removed_edges_;
+    }
+
+    if (added_edges_ + removed_edges_ > max_delta_) {
+        compactLocked();
+    }
+}
+
+SocialGraph::Range SocialGraph::baseRow(int user_id) const {
+    auto it = vertex_.find(user_id);
+    if (it == vertex_.end()) {
+        return {nullptr, nullptr};
+    }
+    const int* data = neighbors_.data();
+    return {data + offsets_[it->second], data + offsets_[it->second + 1]};
+}
+
+bool SocialGraph::inBase(int user1_id, int user2_id) const {
+    // Search the shorter of the two rows
+    Range first = baseRow(user1_id);
+    Range second = baseRow(user2_id);
+    if (second.second - second.first < first.second - first.first) {
+        return std::binary_search(second.first, second.second, user1_id);
+    }
+    return std::binary_search(first.first, first.second, user2_id);
+}
+
+SocialGraph::Range SocialGraph::row(int user_id, std::vector<int>& scratch) const {
+    Range base = baseRow(user_id);
+    auto added = added_.find(user_id);
+    auto removed = removed_.find(user_id);
+    bool has_added = added != added_.end() && !added->second.empty();
+    bool has_removed = removed != removed_.end() && !removed->second.empty();
+    if (!has_added && !has_removed) {
+        return base;
+    }
+
+    scratch.clear();
+    for (const int* it = base.first; it != base.second; ++it) {
+        if (!has_removed || removed->second.count(*it) == 0) {
+            scratch.push_back(*it);
+        }
+    }
+    if (has_added) {
+        size_t middle = scratch.size();
+        scratch.insert(scratch.end(), added->second.begin(), added->second.end());
+        std::inplace_merge(scratch.begin(), scratch.begin() + middle, scratch.end());
+    }
+    return {scratch.data(), scratch.data() + scratch.size()};
+}
+
+bool SocialGraph::areFriends(int user1_id, int user2_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto added = added_.find(user1_id);
+    if (added != added_.end() && added->second.count(user2_id) > 0) return true;
+    auto removed = removed_.find(user1_id);
+    if (removed != removed_.end() && removed->second.count(user2_id) > 0) return false;
+    return inBase(user1_id, user2_id);
+}
+
+std::vector<int> SocialGraph::friendsOf(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<int> scratch;
+    Range friends = row(user_id, scratch);
+    return std::vector<int>(friends.first, friends.second);
+}
+
+size_t SocialGraph::friendCount(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<int> scratch;
+    Range friends = row(user_id, scratch);
+    return static_cast<size_t>(friends.second - friends.first);
+}
+
+int SocialGraph::mutualFriendCount(int user1_id, int user2_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<int> scratch1, scratch2;
+    Range a = row(user1_id, scratch1);
+    Range b = row(user2_id, scratch2);
+
+    int count = 0;
+    while (a.first != a.second && b.first != b.second) {
+        if (*a.first < *b.first) {
+            ++a.first;
+        } else if (*b.first < *a.first) {
+            ++b.first;
+        } else {
+            ++count;
+            ++a.first;
+            ++b.first;
+        }
+    }
+    return count;
+}
+
+std::vector<SocialGraph::Suggestion> SocialGraph::suggestLocked(int user_id, size_t limit) const {
+    std::vector<int> own_scratch, friend_scratch;
+    Range own = row(user_id, own_scratch);
+
+    // Every path user -> friend -> candidate is one mutual friend
+    std::unordered_map<int, int> mutual;
+    for (const int* f = own.first; f != own.second; ++f) {
+        Range theirs = row(*f, friend_scratch);
+        for (const int* candidate = theirs.first; candidate != theirs.second; ++candidate) {
+            if (*candidate != user_id) {
+                ++mutual[*candidate];
+            }
+        }
+    }
+
+    std::vector<Suggestion> suggestions;
+    suggestions.reserve(mutual.size());
+    for (const auto& entry : mutual) {
+        if (!std::binary_search(own.first, own.second, entry.first)) {
+            suggestions.push_back({entry.first, entry.second});
+        }
+    }
+
+    auto better = [](const Suggestion& a, const Suggestion& b) {
+        return a.mutual_count != b.mutual_count ? a.mutual_count > b.mutual_count : a.user_id < b.user_id;
+    };
+    if (suggestions.size() > limit) {
+        std::partial_sort(suggestions.begin(), suggestions.begin() + limit, suggestions.end(), better);
+        suggestions.resize(limit);
+    } else {
+        std::sort(suggestions.begin(), suggestions.end(), better);
+    }
+    return suggestions;
+}
+
+std::vector<SocialGraph::Suggestion> SocialGraph::suggest(int user_id, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return suggestLocked(user_id, limit);
+}
+
+std::unordered_map<int, std::vector<SocialGraph::Suggestion>> SocialGraph::suggestAll(
+    const std::vector<int>& user_ids, size_t limit, size_t threads) const {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, std::max<size_t>(1, user_ids.size()));
+
+    std::vector<std::vector<Suggestion>> results(user_ids.size());
+    {
+        // Workers read under this one shared lock, held until they finish
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([this, &user_ids, &results, limit, threads, t] {
+                for (size_t i = t; i < user_ids.size(); i += threads) {
+                    results[i] = suggestLocked(user_ids[i], limit);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::unordered_map<int, std::vector<Suggestion>> by_user;
+    for (size_t i = 0; i < user_ids.size(); ++i) {
+        by_user[user_ids[i]] = std::move(results[i]);
+    }
+    return by_user;
+}
+
+void SocialGraph::compact() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (added_edges_ + removed_edges_ > 0) {
+        compactLocked();
+    }
+}
+
+void SocialGraph::compactLocked() {
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(base_edges_ + added_edges_);
+
+    std::vector<int> scratch;
+    for (const auto& vertex : vertex_) {
+        Range friends = row(vertex.first, scratch);
+        for (const int* f = friends.first; f != friends.second; ++f) {
+            if (vertex.first < *f) edges.emplace_back(vertex.first, *f);
+        }
+    }
+    // Friendships where the smaller id has no row yet; pairs already taken
+    // from a row above are dropped as repeats by rebuildLocked()
+    for (const auto& entry : added_) {
+        if (vertex_.count(entry.first) > 0) continue;
+        for (int f : entry.second) {
+            if (entry.first < f) edges.emplace_back(entry.first, f);
+        }
+    }
+
+    rebuildLocked(std::move(edges));
+}
+
+size_t SocialGraph::userCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t count = vertex_.size();
+    for (const auto& entry : added_) {
+        if (!entry.second.empty() && vertex_.count(entry.first) == 0) ++count;
+    }
+    return count;
+}
+
+size_t SocialGraph::friendshipCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return base_edges_ + added_edges_ - removed_edges_;
+}
+
+size_t SocialGraph::pendingChanges() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return added_edges_ + removed_edges_;
+}
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,309 @@
+#include "utils/text_parser.h"
+#include <algorithm>
+#include <cstring>
+
+namespace sohbet {
+namespace utils {
+
+static const uint32_t INVALID_CODE_POINT = 0xFFFFFFFF;
+
+// Letter, digit and combining-mark blocks accepted inside hashtags
+// (sorted, inclusive). Coarse by design: whole script blocks rather than
+// per-character Unicode properties.
+static const uint32_t TAG_RANGES[][2] = {
+    {0x00C0, 0x00D6}, {0x00D8, 0x00F6}, {0x00F8, 0x02AF},  // Latin-1 letters, Latin Extended, IPA
+    {0x0300, 0x036F},                                      // Combining diacritics
+    {0x0370, 0x037D}, {0x037F, 0x0386}, {0x0388, 0x03FF},  // Greek
+    {0x0400, 0x052F},                                      // Cyrillic
+    {0x0531, 0x0587},                                      // Armenian
+    {0x05D0, 0x05EA},                                      // Hebrew
+    {0x0620, 0x064A}, {0x0660, 0x0669}, {0x066E, 0x06D3},  // Arabic
+    {0x0900, 0x097F},                                      // Devanagari
+    {0x0E00, 0x0E7F},                                      // Thai
+    {0x1E00, 0x1EFF},                                      // Latin Extended Additional
+    {0x3040, 0x30FF},                                      // Hiragana, Katakana
+    {0x4E00, 0x9FFF},                                      // CJK ideographs
+    {0xAC00, 0xD7A3},                                      // Hangul syllables
+};
+
+static bool isAsciiWord(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool isUrlStop(unsigned char c) {
+    return c <= ' ' || c == '<' || c == '>' || c == '"' || c == 0x7F;
+}
+
+// Length of "http://" or "https://" at pos (case-insensitive), 0 if absent
+static size_t schemeLength(std::string_view text, size_t pos) {
+    for (std::string_view scheme : {std::string_view("https://"), std::string_view("http://")}) {
+        if (text.size() - pos < scheme.size()) {
+            continue;
+        }
+        bool match = true;
+        for (size_t i = 0; i < scheme.size() && match; ++i) {
+            char c = text[pos + i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+            match = c == scheme[i];
+        }
+        if (match) {
+            return scheme.size();
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// TextParser Implementation
+// ============================================================================
+
+uint32_t TextParser::decode(std::string_view text, size_t pos, size_t& length) {
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    length = 1;
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    uint32_t code_point;
+    size_t needed;
+    uint32_t minimum;
+    if ((lead & 0xE0) == 0xC0) {
+        code_point = lead & 0x1F; needed = 1; minimum = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        code_point = lead & 0x0F; needed = 2; minimum = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        code_point = lead & 0x07; needed = 3; minimum = 0x10000;
+    } else {
+        return INVALID_CODE_POINT;
+    }
+
+    if (text.size() - pos <= needed) {
+        return INVALID_CODE_POINT;
+    }
+    for (size_t i = 1; i <= needed; ++i) {
+        unsigned char c = static_cast<unsigned char>(text[pos + i]);
+        if ((c & 0xC0) != 0x80) {
+            return INVALID_CODE_POINT;
+        }
+        code_point = (code_point << 6) | (c & 0x3F);
+    }
+
+    // Overlong forms, surrogates and values past U+10FFFF are invalid
+    if (code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        return INVALID_CODE_POINT;
+    }
+    length = needed + 1;
+    return code_point;
+}
+
+void TextParser::encode(uint32_t code_point, std::string& out) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+bool TextParser::isTagCodePoint(uint32_t code_point) {
+    if (code_point < 0x80) {
+        return isAsciiWord(static_cast<unsigned char>(code_point));
+    }
+    auto it = std::upper_bound(std::begin(TAG_RANGES), std::end(TAG_RANGES), code_point,
+                               [](uint32_t value, const uint32_t (&range)[2]) { return value < range[0]; });
+    return it != std::begin(TAG_RANGES) && code_point <= (*(it - 1))[1];
+}
+
+uint32_t TextParser::lowerCodePoint(uint32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= 'A' && cp <= 'Z') ? cp + 32 : cp;
+    }
+    // Latin-1 Supplement
+    if (cp >= 0x00C0 && cp <= 0x00DE && cp != 0x00D7) return cp + 32;
+    // Latin Extended-A: alternating upper/lower pairs, with the Turkish dotted İ
+    if (cp == 0x0130) return 'i';
+    if (cp >= 0x0100 && cp <= 0x0137) return (cp % 2 == 0) ? cp + 1 : cp;
+    if (cp >= 0x0139 && cp <= 0x0148) return (cp % 2 == 1) ? cp + 1 : cp;
+    if (cp >= 0x014A && cp <= 0x0177) return (cp % 2 == 0) ? cp + 1 : cp;
+    if (cp == 0x0178) return 0x00FF;
+    if (cp >= 0x0179 && cp <= 0x017E) return (cp % 2 == 1) ? cp + 1 : cp;
+    // Greek
+    if (cp == 0x0386) return 0x03AC;
+    if (cp >= 0x0388 && cp <= 0x038A) return cp + 37;
+    if (cp == 0x038C) return 0x03CC;
+    if (cp == 0x038E || cp == 0x038F) return cp + 63;
+    if (cp >= 0x0391 && cp <= 0x03AB && cp != 0x03A2) return cp + 32;
+    // Cyrillic
+    if (cp >= 0x0400 && cp <= 0x040F) return cp + 80;
+    if (cp >= 0x0410 && cp <= 0x042F) return cp + 32;
+    if ((cp >= 0x0460 && cp <= 0x0481) || (cp >= 0x048A && cp <= 0x04BF) || (cp >= 0x04D0 && cp <= 0x052F)) {
+        return (cp % 2 == 0) ? cp + 1 : cp;
+    }
+    // Latin Extended Additional (Vietnamese and others)
+    if ((cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF)) {
+        return (cp % 2 == 0) ? cp + 1 : cp;
+    }
+    return cp;
+}
+
+std::string TextParser::toLower(std::string_view text) {
+    std::string result;
+    result.reserve(text.size());
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        if (c < 0x80) {
+            result += (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : static_cast<char>(c);
+            ++pos;
+            continue;
+        }
+        size_t length;
+        uint32_t code_point = decode(text, pos, length);
+        if (code_point == INVALID_CODE_POINT) {
+            result += static_cast<char>(c);
+        } else {
+            encode(lowerCodePoint(code_point), result);
+        }
+        pos += length;
+    }
+    return result;
+}
+
+std::vector<TextToken> TextParser::tokenize(std::string_view text) {
+    std::vector<TextToken> tokens;
+    size_t pos = 0;
+    bool after_word = false;  // Previous code point continues a word
+
+    while (pos < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+
+        if ((c == '#' || c == '@') && !after_word) {
+            size_t start = pos + 1;
+            size_t end = start;
+            if (c == '#') {
+                while (end < text.size()) {
+                    size_t length;
+                    if (!isTagCodePoint(decode(text, end, length))) break;
+                    end += length;
+                }
+            } else {
+                while (end < text.size() && isAsciiWord(static_cast<unsigned char>(text[end]))) {
+                    ++end;
+                }
+            }
+
+            if (end > start) {
+                tokens.push_back(TextToken{c == '#' ? TextToken::Kind::Hashtag : TextToken::Kind::Mention,
+                                           text.substr(start, end - start), pos, end - pos});
+                // "#exam#finals" is two tags, so a sigil may follow directly
+                after_word = false;
+                pos = end;
+            } else {
+                after_word = false;
+                ++pos;
+            }
+            continue;
+        }
+
+        if ((c == 'h' || c == 'H') && !after_word) {
+            size_t scheme = schemeLength(text, pos);
+            if (scheme > 0) {
+                size_t end = pos + scheme;
+                while (end < text.size() && !isUrlStop(static_cast<unsigned char>(text[end]))) {
+                    ++end;
+                }
+                // Sentence punctuation after a link is not part of it; a
+                // closing paren is kept only when the URL opened one
+                while (end > pos + scheme) {
+                    char last = text[end - 1];
+                    if (last == ')') {
+                        std::string_view url = text.substr(pos, end - pos);
+                        if (std::count(url.begin(), url.end(), '(') >= std::count(url.begin(), url.end(), ')')) break;
+                    } else if (!std::strchr(".,;:!?'", last)) {
+                        break;
+                    }
+                    --end;
+                }
+                if (end > pos + scheme) {
+                    tokens.push_back(TextToken{TextToken::Kind::Url, text.substr(pos, end - pos), pos, end - pos});
+                    after_word = true;
+                    pos = end;
+                    continue;
+                }
+            }
+        }
+
+        if (c < 0x80) {
+            after_word = isAsciiWord(c);
+            ++pos;
+            continue;
+        }
+        size_t length;
+        uint32_t code_point = decode(text, pos, length);
+        after_word = code_point != INVALID_CODE_POINT && isTagCodePoint(code_point);
+        pos += length;
+    }
+
+    return tokens;
+}
+
+std::set<std::string> TextParser::extractHashtags(const std::string& text) {
+    std::set<std::string> hashtags;
+    for (const auto& token : tokenize(text)) {
+        if (token.kind == TextToken::Kind::Hashtag) {
+            // Lowercase for consistency (#Ödev and #ÖDEV are one tag)
+            hashtags.insert(toLower(token.value));
+        }
+    }
+    return hashtags;
+}
+
+std::set<std::string> TextParser::extractMentions(const std::string& text) {
+    std::set<std::string> mentions;
+    for (const auto& token : tokenize(text)) {
+        if (token.kind == TextToken::Kind::Mention) {
+            mentions.emplace(token.value);
+        }
+    }
+    return mentions;
+}
+
+std::string TextParser::makeClickable(const std::string& text) {
+    std::string result;
+    result.reserve(text.size() + text.size() / 2);
+
+    size_t last = 0;
+    for (const auto& token : tokenize(text)) {
+        result.append(text, last, token.offset - last);
+        switch (token.kind) {
+            case TextToken::Kind::Hashtag:
+                result.append("<a href=\"/hashtags/").append(token.value)
+                      .append("\" class=\"hashtag\">#").append(token.value).append("</a>");
+                break;
+            case TextToken::Kind::Mention:
+                result.append("<a href=\"/users/").append(token.value)
+                      .append("\" class=\"mention\">@").append(token.value).append("</a>");
+                break;
+            case TextToken::Kind::Url:
+                result.append("<a href=\"").append(token.value)
+                      .append("\" class=\"link\" rel=\"nofollow noopener\">").append(token.value).append("</a>");
+                break;
+        }
+        last = token.offset + token.length;
+    }
+    result.append(text, last, std::string::npos);
+    return result;
+}
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,145 @@
+#include "utils/timer_wheel.h"
+#include "utils/logger.h"
+#include <exception>
+
+namespace sohbet {
+namespace utils {
+
+// ============================================================================
+// TimerWheel Implementation
+// ============================================================================
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, size_t slots)
+    : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)),
+      slots_(slots == 0 ? 1 : slots) {
+}
+
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+uint64_t TimerWheel::toTicks(std::chrono::milliseconds delay) const {
+    if (delay.count() <= 0) {
+        return 1;
+    }
+    // Round up so a timer never fires early
+    return static_cast<uint64_t>((delay.count() + tick_.count() - 1) / tick_.count());
+}
+
+void TimerWheel::place(TimerId id, Timer& timer, uint64_t ticks) {
+    // The slot `ticks` ahead is first visited after ((ticks - 1) % slots) + 1
+    // ticks, then once per revolution
+    timer.rounds = (ticks - 1) / slots_.size();
+    slots_[(current_ + ticks) % slots_.size()].push_back(id);
+}
+
+TimerWheel::TimerId TimerWheel::arm(uint64_t ticks, uint64_t interval_ticks, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TimerId id = next_id_++;
+    Timer& timer = timers_[id];
+    timer.callback = std::move(callback);
+    timer.interval_ticks = interval_ticks;
+    place(id, timer, ticks);
+    return id;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    return arm(toTicks(delay), 0, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::scheduleEvery(std::chrono::milliseconds interval, Callback callback) {
+    uint64_t ticks = toTicks(interval);
+    return arm(ticks, ticks, std::move(callback));
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    // The id stays in its slot and is skipped when that slot comes up
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.erase(id) > 0;
+}
+
+size_t TimerWheel::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.size();
+}
+
+size_t TimerWheel::tick() {
+    std::vector<Callback> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        current_ = (current_ + 1) % slots_.size();
+
+        std::vector<TimerId> slot;
+        slot.swap(slots_[current_]);
+
+        for (TimerId id : slot) {
+            auto it = timers_.find(id);
+            if (it == timers_.end()) {
+                continue; // Cancelled
+            }
+            Timer& timer = it->second;
+            if (timer.rounds > 0) {
+                --timer.rounds;
+                slots_[current_].push_back(id);
+                continue;
+            }
+            if (timer.interval_ticks > 0) {
+                due.push_back(timer.callback);
+                place(id, timer, timer.interval_ticks);
+            } else {
+                due.push_back(std::move(timer.callback));
+                timers_.erase(it);
+            }
+        }
+    }
+
+    for (auto& callback : due) {
+        try {
+            callback();
+        } catch (const std::exception& e) {
+            LOG_ERROR(std::string("Scheduled job failed: ") + e.what());
+        }
+    }
+    return due.size();
+}
+
+void TimerWheel::start() {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&TimerWheel::run, this);
+}
+
+void TimerWheel::stop() {
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    run_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TimerWheel::run() {
+    // Tick against absolute deadlines so callback time does not accumulate drift
+    auto next = std::chrono::steady_clock::now() + tick_;
+    std::unique_lock<std::mutex> lock(run_mutex_);
+    while (running_) {
+        if (run_cv_.wait_until(lock, next, [this] { return !running_; })) {
+            break;
+        }
+        lock.unlock();
+        tick();
+        lock.lock();
+        next += tick_;
+    }
+}
+
+} // namespace utils
+} // namespace sohbet
@@ -0,0 +1,197 @@
+#include "utils/trending_tracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sohbet {
+namespace utils {
+
+// Forward-decay weights grow as e^(age / tau); rescale long before overflow
+static const double MAX_LANDMARK_AGE = 64.0; // In time constants
+static const size_t MAX_SKETCH_DEPTH = 16;
+
+static uint64_t mix(uint64_t x) {
+    // splitmix64 finalizer: spreads one std::hash value across sketch rows
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// ============================================================================
+// TrendingTracker Implementation
+// ============================================================================
+
+TrendingTracker::TrendingTracker(std::vector<Window> windows, size_t top_k,
+                                 size_t sketch_width, size_t sketch_depth)
+    : top_k_(top_k == 0 ? 1 : top_k),
+      width_(sketch_width == 0 ? 1 : sketch_width),
+      depth_(std::min<size_t>(std::max<size_t>(sketch_depth, 1), MAX_SKETCH_DEPTH)) {
+    double now = seconds(Clock::now());
+    for (auto& window : windows) {
+        WindowState state;
+        state.tau = std::max<double>(1.0, static_cast<double>(window.time_constant.count()));
+        state.spec = std::move(window);
+        state.landmark = now;
+        state.cells.assign(width_ * depth_, 0.0);
+        windows_.push_back(std::move(state));
+    }
+}
+
+double TrendingTracker::seconds(Clock::time_point at) {
+    return std::chrono::duration<double>(at.time_since_epoch()).count();
+}
+
+double TrendingTracker::addToSketch(WindowState& window, const std::string& key, double weight) {
+    // Conservative update: only raise the cells that hold the current
+    // minimum, which keeps the overestimate from colliding keys down
+    uint64_t hash = std::hash<std::string>{}(key);
+    size_t indices[MAX_SKETCH_DEPTH];
+    size_t rows = depth_;
+
+    double estimate = std::numeric_limits<double>::max();
+    for (size_t row = 0; row < rows; ++row) {
+        indices[row] = row * width_ + mix(hash + row * 0x9e3779b97f4a7c15ULL) % width_;
+        estimate = std::min(estimate, window.cells[indices[row]]);
+    }
+
+    double updated = estimate + weight;
+    for (size_t row = 0; row < rows; ++row) {
+        double& cell = window.cells[indices[row]];
+        cell = std::max(cell, updated);
+    }
+    return updated;
+}
+
+void TrendingTracker::swapItems(Heap& heap, size_t a, size_t b) {
+    std::swap(heap.items[a], heap.items[b]);
+    heap.positions[heap.items[a].second] = a;
+    heap.positions[heap.items[b].second] = b;
+}
+
+void TrendingTracker::siftDown(Heap& heap, size_t index) {
+    size_t size = heap.items.size();
+    while (true) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < size && heap.items[left].first < heap.items[smallest].first) smallest = left;
+        if (right < size && heap.items[right].first < heap.items[smallest].first) smallest = right;
+        if (smallest == index) return;
+        swapItems(heap, index, smallest);
+        index = smallest;
+    }
+}
+
+void TrendingTracker::siftUp(Heap& heap, size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (heap.items[parent].first <= heap.items[index].first) return;
+        swapItems(heap, index, parent);
+        index = parent;
+    }
+}
+
+void TrendingTracker::offer(Heap& heap, const std::string& tag, double estimate) {
+    auto it = heap.positions.find(tag);
+    if (it != heap.positions.end()) {
+        // Estimates only grow between rescales, so the item moves down
+        heap.items[it->second].first = estimate;
+        siftDown(heap, it->second);
+        return;
+    }
+
+    if (heap.items.size() < top_k_) {
+        heap.items.emplace_back(estimate, tag);
+        heap.positions[tag] = heap.items.size() - 1;
+        siftUp(heap, heap.items.size() - 1);
+        return;
+    }
+
+    if (estimate > heap.items[0].first) {
+        heap.positions.erase(heap.items[0].second);
+        heap.items[0] = {estimate, tag};
+        heap.positions[tag] = 0;
+        siftDown(heap, 0);
+    }
+}
+
+void TrendingTracker::rescale(WindowState& window, double now) {
+    // Every stored weight shrinks by the same factor, so heap order holds
+    double factor = std::exp(-(now - window.landmark) / window.tau);
+    for (double& cell : window.cells) {
+        cell *= factor;
+    }
+    for (auto& [scope, heap] : window.heaps) {
+        for (auto& item : heap.items) {
+            item.first *= factor;
+        }
+    }
+    window.landmark = now;
+}
+
+void TrendingTracker::record(const std::string& tag, const std::string& scope, Clock::time_point at) {
+    double t = seconds(at);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& window : windows_) {
+        if ((t - window.landmark) / window.tau > MAX_LANDMARK_AGE) {
+            rescale(window, t);
+        }
+        double weight = std::exp((t - window.landmark) / window.tau);
+
+        offer(window.heaps[""], tag, addToSketch(window, tag, weight));
+        if (!scope.empty()) {
+            std::string key = scope;
+            key += '\x1f';
+            key += tag;
+            offer(window.heaps[scope], tag, addToSketch(window, key, weight));
+        }
+    }
+}
+
+bool TrendingTracker::hasWindow(const std::string& window) const {
+    for (const auto& state : windows_) {
+        if (state.spec.name == window) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<TrendingTracker::Entry> TrendingTracker::top(const std::string& window, const std::string& scope,
+                                                         size_t limit, Clock::time_point now, double min_score) const {
+    std::vector<Entry> entries;
+    double t = seconds(now);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& state : windows_) {
+        if (state.spec.name != window) {
+            continue;
+        }
+        auto heap = state.heaps.find(scope);
+        if (heap == state.heaps.end()) {
+            return entries;
+        }
+
+        double decay = std::exp(-(t - state.landmark) / state.tau);
+        for (const auto& [stored, tag] : heap->second.items) {
+            double score = stored * decay;
+            if (score >= min_score) {
+                entries.push_back(Entry{tag, score});
+            }
+        }
+        break;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.score != b.score ? a.score > b.score : a.tag < b.tag;
+    });
+    if (entries.size() > limit) {
+        entries.resize(limit);
+    }
+    return entries;
+}
+
+} // namespace utils
+} // namespace sohbet
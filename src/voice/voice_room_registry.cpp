@@ -0,0 +1,228 @@
+#include "voice/voice_room_registry.h"
+
+namespace sohbet {
+
+const VoiceRoomRegistry::Snapshot VoiceRoomRegistry::empty_ = std::make_shared<const Participants>();
+
+VoiceRoomRegistry::VoiceRoomRegistry(size_t shard_count)
+    : room_shards_(new RoomShard[shard_count == 0 ? 1 : shard_count]),
+      user_shards_(new UserShard[shard_count == 0 ? 1 : shard_count]),
+      shard_count_(shard_count == 0 ? 1 : shard_count) {
+}
+
+VoiceRoomRegistry::RoomShard& VoiceRoomRegistry::roomShard(int channel_id) const {
+    return room_shards_[static_cast<unsigned int>(channel_id) % shard_count_];
+}
+
+VoiceRoomRegistry::UserShard& VoiceRoomRegistry::userShard(int user_id) const {
+    return user_shards_[static_cast<unsigned int>(user_id) % shard_count_];
+}
+
+VoiceRoomRegistry::Change VoiceRoomRegistry::join(int channel_id, int user_id) {
+    Change change;
+    RoomShard& shard = roomShard(channel_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Snapshot& current = shard.rooms[channel_id];
+    if (current && current->count(user_id) > 0) {
+        change.participants = current;
+        return change;
+    }
+
+    // Copy-on-write: readers holding the old snapshot are unaffected
+    auto next = current ? std::make_shared<Participants>(*current) : std::make_shared<Participants>();
+    next->insert(user_id);
+    current = next;
+
+    {
+        UserShard& users = userShard(user_id);
+        std::lock_guard<std::mutex> user_lock(users.mutex);
+        users.rooms_by_user[user_id].insert(channel_id);
+    }
+
+    change.changed = true;
+    change.participants = current;
+    return change;
+}
+
+size_t VoiceRoomRegistry::merge(int channel_id, const std::vector<int>& user_ids) {
+    if (user_ids.empty()) {
+        return 0;
+    }
+
+    RoomShard& shard = roomShard(channel_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Snapshot& current = shard.rooms[channel_id];
+    auto next = current ? std::make_shared<Participants>(*current) : std::make_shared<Participants>();
+
+    size_t added = 0;
+    for (int user_id : user_ids) {
+        if (!next->insert(user_id).second) {
+            continue;
+        }
+        ++added;
+        UserShard& users = userShard(user_id);
+        std::lock_guard<std::mutex> user_lock(users.mutex);
+        users.rooms_by_user[user_id].insert(channel_id);
+    }
+
+    if (added > 0 || !current) {
+        current = next;
+    }
+    return added;
+}
+
+VoiceRoomRegistry::Change VoiceRoomRegistry::leave(int channel_id, int user_id) {
+    Change change;
+    change.participants = empty_;
+
+    RoomShard& shard = roomShard(channel_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.rooms.find(channel_id);
+    if (it == shard.rooms.end()) {
+        return change;
+    }
+    if (it->second->count(user_id) == 0) {
+        change.participants = it->second;
+        return change;
+    }
+
+    auto next = std::make_shared<Participants>(*it->second);
+    next->erase(user_id);
+    if (next->empty()) {
+        shard.rooms.erase(it);
+    } else {
+        it->second = next;
+        change.participants = next;
+    }
+
+    {
+        UserShard& users = userShard(user_id);
+        std::lock_guard<std::mutex> user_lock(users.mutex);
+        auto rooms_it = users.rooms_by_user.find(user_id);
+        if (rooms_it != users.rooms_by_user.end()) {
+            rooms_it->second.erase(channel_id);
+            if (rooms_it->second.empty()) {
+                users.rooms_by_user.erase(rooms_it);
+            }
+        }
+    }
+
+    change.changed = true;
+    return change;
+}
+
+std::vector<std::pair<int, VoiceRoomRegistry::Snapshot>> VoiceRoomRegistry::leaveAll(int user_id) {
+    std::unordered_set<int> channel_ids;
+    {
+        UserShard& users = userShard(user_id);
+        std::lock_guard<std::mutex> user_lock(users.mutex);
+        auto it = users.rooms_by_user.find(user_id);
+        if (it != users.rooms_by_user.end()) {
+            channel_ids.swap(it->second);
+            users.rooms_by_user.erase(it);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_session_ends_.push_back({user_id, std::time(nullptr)});
+    }
+
+    std::vector<std::pair<int, Snapshot>> left;
+    left.reserve(channel_ids.size());
+    for (int channel_id : channel_ids) {
+        RoomShard& shard = roomShard(channel_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.rooms.find(channel_id);
+        if (it == shard.rooms.end() || it->second->count(user_id) == 0) {
+            continue;
+        }
+
+        auto next = std::make_shared<Participants>(*it->second);
+        next->erase(user_id);
+        if (next->empty()) {
+            shard.rooms.erase(it);
+            left.emplace_back(channel_id, empty_);
+        } else {
+            it->second = next;
+            left.emplace_back(channel_id, next);
+        }
+    }
+    return left;
+}
+
+void VoiceRoomRegistry::removeRoom(int channel_id) {
+    RoomShard& shard = roomShard(channel_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.rooms.find(channel_id);
+    if (it == shard.rooms.end()) {
+        return;
+    }
+
+    for (int user_id : *it->second) {
+        UserShard& users = userShard(user_id);
+        std::lock_guard<std::mutex> user_lock(users.mutex);
+        auto rooms_it = users.rooms_by_user.find(user_id);
+        if (rooms_it != users.rooms_by_user.end()) {
+            rooms_it->second.erase(channel_id);
+            if (rooms_it->second.empty()) {
+                users.rooms_by_user.erase(rooms_it);
+            }
+        }
+    }
+    shard.rooms.erase(it);
+}
+
+VoiceRoomRegistry::Snapshot VoiceRoomRegistry::participants(int channel_id) const {
+    RoomShard& shard = roomShard(channel_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.rooms.find(channel_id);
+    return it != shard.rooms.end() ? it->second : empty_;
+}
+
+bool VoiceRoomRegistry::containsBoth(int channel_id, int user_a, int user_b) const {
+    Snapshot members = participants(channel_id);
+    return members->count(user_a) > 0 && members->count(user_b) > 0;
+}
+
+std::vector<int> VoiceRoomRegistry::roomsOf(int user_id) const {
+    UserShard& users = userShard(user_id);
+    std::lock_guard<std::mutex> user_lock(users.mutex);
+    auto it = users.rooms_by_user.find(user_id);
+    if (it == users.rooms_by_user.end()) {
+        return {};
+    }
+    return std::vector<int>(it->second.begin(), it->second.end());
+}
+
+size_t VoiceRoomRegistry::roomCount() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        std::lock_guard<std::mutex> lock(room_shards_[i].mutex);
+        for (const auto& room : room_shards_[i].rooms) {
+            if (room.second && !room.second->empty()) {
+                ++total;
+            }
+        }
+    }
+    return total;
+}
+
+std::vector<VoiceRoomRegistry::SessionEnd> VoiceRoomRegistry::takePendingSessionEnds() {
+    std::vector<SessionEnd> ends;
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    ends.swap(pending_session_ends_);
+    return ends;
+}
+
+void VoiceRoomRegistry::requeueSessionEnds(const std::vector<SessionEnd>& ends) {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_session_ends_.insert(pending_session_ends_.end(), ends.begin(), ends.end());
+}
+
+} // namespace sohbet
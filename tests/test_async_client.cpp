@@ -0,0 +1,122 @@
+#include "db/async_client.h"
+#include "db/database.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace sohbet::db;
+
+void testQueryBinding() {
+    std::cout << "Testing query placeholders and binding..." << std::endl;
+
+    assert(toPostgresPlaceholders("SELECT ? + ?, ?") == "SELECT $1 + $2, $3");
+    assert(toPostgresPlaceholders("SELECT 1") == "SELECT 1");
+
+    AsyncQuery query("SELECT * FROM t WHERE a = ? AND b = ? AND c = ? AND d = ANY(?::int[]) AND e = ? AND f = ?");
+    query.bindInt(7).bindText("x'y").bindNull().bindIntArray({1, 2, 3}).bindInt64(9007199254740993LL).bindDouble(0.1);
+    assert(query.sql() == "SELECT * FROM t WHERE a = $1 AND b = $2 AND c = $3 AND d = ANY($4::int[]) AND e = $5 AND f = $6");
+    assert(query.params().size() == 6);
+    assert(query.params()[0].value() == "7");
+    assert(query.params()[1].value() == "x'y");
+    assert(!query.params()[2].has_value());
+    assert(query.params()[3].value() == "{1,2,3}");
+    assert(query.params()[4].value() == "9007199254740993");
+    assert(std::strtod(query.params()[5]->c_str(), nullptr) == 0.1);
+
+    std::cout << "Query binding test passed!" << std::endl;
+}
+
+void testEmptyResult() {
+    std::cout << "Testing empty result access..." << std::endl;
+
+    QueryResult result;
+    assert(result.ok());
+    assert(result.rowCount() == 0);
+    assert(result.affectedRows() == 0);
+    assert(result.isNull(0, 0));
+    assert(result.getInt(3, 1) == 0);
+    assert(result.getText(0, -1).empty());
+
+    std::cout << "Empty result test passed!" << std::endl;
+}
+
+void testNotRunning() {
+    std::cout << "Testing submit without a connection..." << std::endl;
+
+    // Nothing listens on port 1, so the connection is refused at once
+    AsyncClient client("host=127.0.0.1 port=1 connect_timeout=2", 2);
+    assert(!client.start());
+    assert(!client.isRunning());
+
+    QueryResult result = client.query(AsyncQuery("SELECT 1")).get();
+    assert(!result.ok());
+    assert(result.rowCount() == 0);
+
+    assert(client.execute({}).get().empty());
+    assert(client.pending() == 0);
+    client.stop();  // Harmless when never started
+
+    std::cout << "Not running test passed!" << std::endl;
+}
+
+// Needs a live server: set SOHBET_TEST_DATABASE_URL to run
+void testPipeline(const std::string& url) {
+    std::cout << "Testing pipelined batches against " << url << "..." << std::endl;
+
+    AsyncClient client(url, 2, 16);
+    assert(client.start());
+
+    std::vector<AsyncQuery> batch;
+    batch.push_back(AsyncQuery("SELECT ?::int + 1, NULL::text").bindInt(41));
+    batch.push_back(AsyncQuery("SELECT generate_series(1, ?)").bindInt(3));
+    auto results = client.execute(std::move(batch)).get();
+    assert(results.size() == 2);
+    assert(results[0].ok() && results[0].getInt(0, 0) == 42 && results[0].isNull(0, 1));
+    assert(results[1].rowCount() == 3 && results[1].getInt(2, 0) == 3);
+
+    // A failure aborts the rest of its batch but not the next batch
+    std::vector<AsyncQuery> failing;
+    failing.push_back(AsyncQuery("SELECT 1/0"));
+    failing.push_back(AsyncQuery("SELECT 1"));
+    auto failed = client.execute(std::move(failing));
+    auto after = client.query(AsyncQuery("SELECT 'ok'"));
+    auto failed_results = failed.get();
+    assert(!failed_results[0].ok() && !failed_results[1].ok());
+    assert(after.get().getText(0, 0) == "ok");
+
+    // Far more batches than the pipeline depth stay queued, then all finish
+    std::vector<std::future<QueryResult>> futures;
+    for (int i = 0; i < 500; ++i) {
+        futures.push_back(client.query(AsyncQuery("SELECT ?::int").bindInt(i)));
+    }
+    for (int i = 0; i < 500; ++i) {
+        assert(futures[i].get().getInt(0, 0) == i);
+    }
+    assert(client.pending() == 0);
+
+    client.stop();
+    assert(!client.query(AsyncQuery("SELECT 1")).get().ok());
+
+    std::cout << "Pipeline test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running AsyncClient Tests ===" << std::endl;
+
+    testQueryBinding();
+    testEmptyResult();
+    testNotRunning();
+
+    const char* url = std::getenv("SOHBET_TEST_DATABASE_URL");
+    if (url && *url) {
+        testPipeline(url);
+    } else {
+        std::cout << "SOHBET_TEST_DATABASE_URL not set; skipping live pipeline test" << std::endl;
+    }
+
+    std::cout << "=== All AsyncClient Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include "services/chat_ingest_queue.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using sohbet::Message;
+using sohbet::services::ChatIngestQueue;
+using sohbet::services::QueuedMessage;
+
+// In-memory stand-in for the messages table and the WebSocket acks
+struct FakeBackend {
+    std::mutex mutex;
+    int next_id = 1;
+    bool fail = false;
+    int commits = 0;
+    std::vector<Message> stored;
+    std::vector<std::vector<int>> touched;
+    std::vector<QueuedMessage> acked;
+    std::vector<QueuedMessage> dropped;
+
+    ChatIngestQueue make(std::chrono::milliseconds linger, size_t max_batch = 500, size_t max_attempts = 3) {
+        return ChatIngestQueue(
+            [this](const std::vector<Message>& messages, const std::vector<int>& conversation_ids) {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::vector<int> ids;
+                if (fail) return ids;
+                // Rows the database rejects fail the whole commit
+                for (const auto& message : messages) {
+                    if (message.content == "bad") return ids;
+                }
+                ++commits;
+                for (const auto& message : messages) {
+                    ids.push_back(next_id++);
+                    stored.push_back(message);
+                }
+                touched.push_back(conversation_ids);
+                return ids;
+            },
+            [this](const QueuedMessage& queued, bool persisted) {
+                std::lock_guard<std::mutex> lock(mutex);
+                (persisted ? acked : dropped).push_back(queued);
+            },
+            linger, max_batch, max_attempts);
+    }
+};
+
+static Message chat(int conversation_id, int sender_id, const std::string& content) {
+    Message message;
+    message.conversation_id = conversation_id;
+    message.sender_id = sender_id;
+    message.content = content;
+    return message;
+}
+
+void testGroupCommit() {
+    std::cout << "Testing group commit..." << std::endl;
+
+    FakeBackend backend;
+    ChatIngestQueue queue = backend.make(std::chrono::milliseconds(0));
+
+    QueuedMessage first = queue.enqueue(chat(1, 10, "a"), {10, 11}, "ref-a");
+    QueuedMessage second = queue.enqueue(chat(1, 11, "b"));
+    QueuedMessage third = queue.enqueue(chat(2, 10, "c"));
+    assert(first.sequence > 0);
+    assert(second.sequence == first.sequence + 1 && third.sequence == second.sequence + 1);
+    assert(first.message.id == 0);
+    assert(queue.pending() == 3);
+
+    // Nothing is stored until a flush, and then all of it in one commit
+    assert(backend.stored.empty());
+    assert(queue.flush() == 3);
+    assert(backend.commits == 1);
+    assert(backend.stored.size() == 3 && backend.stored[2].content == "c");
+    assert(queue.pending() == 0);
+
+    // last_message_at is bumped once per conversation
+    assert(backend.touched.size() == 1);
+    assert(backend.touched[0] == std::vector<int>({1, 2}));
+
+    // Acks come in sequence order with the stored ids and the caller's data
+    assert(backend.acked.size() == 3);
+    assert(backend.acked[0].sequence == first.sequence && backend.acked[0].message.id == 1);
+    assert(backend.acked[0].client_ref == "ref-a");
+    assert(backend.acked[0].recipients == std::vector<int>({10, 11}));
+    assert(backend.acked[2].sequence == third.sequence && backend.acked[2].message.id == 3);
+
+    assert(queue.flush() == 0);
+    assert(backend.commits == 1);
+
+    std::cout << "Group commit test passed!" << std::endl;
+}
+
+void testBatchLimit() {
+    std::cout << "Testing batch limit..." << std::endl;
+
+    FakeBackend backend;
+    ChatIngestQueue queue = backend.make(std::chrono::milliseconds(0), 2);
+    for (int i = 0; i < 5; ++i) {
+        queue.enqueue(chat(1, 10, std::to_string(i)));
+    }
+
+    assert(queue.flush() == 2);
+    assert(queue.flush() == 2);
+    assert(queue.flush() == 1);
+    assert(backend.commits == 3);
+    for (int i = 0; i < 5; ++i) {
+        assert(backend.stored[i].content == std::to_string(i));
+    }
+
+    std::cout << "Batch limit test passed!" << std::endl;
+}
+
+void testRetryAndDrop() {
+    std::cout << "Testing failed commits..." << std::endl;
+
+    FakeBackend backend;
+    ChatIngestQueue queue = backend.make(std::chrono::milliseconds(0), 500, 2);
+    QueuedMessage old_message = queue.enqueue(chat(1, 10, "old"));
+
+    // The first failure keeps the message, in front of newer ones
+    backend.fail = true;
+    assert(queue.flush() == 0);
+    assert(queue.pending() == 1);
+    assert(backend.dropped.empty());
+
+    queue.enqueue(chat(1, 10, "new"));
+    backend.fail = false;
+    assert(queue.flush() == 2);
+    assert(backend.stored[0].content == "old" && backend.stored[1].content == "new");
+    assert(backend.acked[0].sequence == old_message.sequence);
+
+    // After max_attempts failures the message is given up and reported
+    backend.fail = true;
+    QueuedMessage lost = queue.enqueue(chat(1, 10, "lost"));
+    assert(queue.flush() == 0);
+    assert(queue.flush() == 0);
+    assert(queue.pending() == 0);
+    assert(backend.dropped.size() == 1 && backend.dropped[0].sequence == lost.sequence);
+    assert(backend.dropped[0].message.id == 0);
+
+    std::cout << "Failed commit test passed!" << std::endl;
+}
+
+void testBadRowIsolated() {
+    std::cout << "Testing a bad row in a batch..." << std::endl;
+
+    FakeBackend backend;
+    ChatIngestQueue queue = backend.make(std::chrono::milliseconds(0), 500, 2);
+    QueuedMessage before = queue.enqueue(chat(1, 10, "a"));
+    QueuedMessage bad = queue.enqueue(chat(2, 11, "bad"));
+    QueuedMessage after = queue.enqueue(chat(3, 12, "c"));
+
+    // The others are stored one at a time; only the bad row is kept back
+    assert(queue.flush() == 2);
+    assert(backend.stored.size() == 2);
+    assert(backend.acked.size() == 2);
+    assert(backend.acked[0].sequence == before.sequence && backend.acked[0].message.id > 0);
+    assert(backend.acked[1].sequence == after.sequence);
+    assert(queue.pending() == 1);
+    assert(backend.dropped.empty());
+
+    // ...and reported once it runs out of attempts
+    assert(queue.flush() == 0);
+    assert(queue.pending() == 0);
+    assert(backend.dropped.size() == 1 && backend.dropped[0].sequence == bad.sequence);
+
+    std::cout << "Bad row test passed!" << std::endl;
+}
+
+void testWriterThread() {
+    std::cout << "Testing writer thread..." << std::endl;
+
+    FakeBackend backend;
+    ChatIngestQueue queue = backend.make(std::chrono::milliseconds(5), 64);
+    queue.start();
+
+    const int senders = 4;
+    const int per_sender = 250;
+    std::vector<std::thread> threads;
+    for (int s = 0; s < senders; ++s) {
+        threads.emplace_back([&queue, s] {
+            for (int i = 0; i < per_sender; ++i) {
+                queue.enqueue(chat(s + 1, s + 100, std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The writer stores everything by itself
+    for (int wait = 0; wait < 200 && queue.pending() > 0; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    queue.stop();
+    assert(queue.pending() == 0);
+
+    std::lock_guard<std::mutex> lock(backend.mutex);
+    assert(backend.stored.size() == senders * per_sender);
+    // Messages shared commits
+    assert(backend.commits < senders * per_sender);
+
+    // Acks are in sequence order, and each sender's messages in send order
+    std::vector<int> next(senders, 0);
+    for (size_t i = 0; i < backend.acked.size(); ++i) {
+        if (i > 0) {
+            assert(backend.acked[i].sequence > backend.acked[i - 1].sequence);
+            assert(backend.acked[i].message.id > backend.acked[i - 1].message.id);
+        }
+        int sender = backend.acked[i].message.conversation_id - 1;
+        assert(backend.acked[i].message.content == std::to_string(next[sender]++));
+    }
+
+    std::cout << "Writer thread test passed!" << std::endl;
+}
+
+void testStopStoresRest() {
+    std::cout << "Testing stop..." << std::endl;
+
+    FakeBackend backend;
+    {
+        // A long linger: only stop() gets these stored
+        ChatIngestQueue queue = backend.make(std::chrono::seconds(30));
+        queue.start();
+        queue.enqueue(chat(1, 10, "a"));
+        queue.enqueue(chat(1, 10, "b"));
+        queue.stop();
+        assert(queue.pending() == 0);
+        queue.stop();  // Harmless twice
+    }
+    assert(backend.stored.size() == 2);
+
+    // With the database gone, stop() still returns and reports the losses
+    FakeBackend down;
+    down.fail = true;
+    {
+        ChatIngestQueue queue = down.make(std::chrono::milliseconds(0));
+        queue.enqueue(chat(1, 10, "a"));
+    }  // Destructor stops
+    assert(down.dropped.size() == 1);
+
+    std::cout << "Stop test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running ChatIngestQueue Tests ===" << std::endl;
+
+    testGroupCommit();
+    testBatchLimit();
+    testRetryAndDrop();
+    testBadRowIsolated();
+    testWriterThread();
+    testStopStoresRest();
+
+    std::cout << "=== All ChatIngestQueue Tests Passed! ===" << std::endl;
+    return 0;
+}
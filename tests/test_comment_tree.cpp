@@ -0,0 +1,117 @@
+#include "models/comment_tree.h"
+#include "utils/json_parser.h"
+#include <iostream>
+#include <cassert>
+#include <optional>
+#include <vector>
+
+using sohbet::CommentTree;
+
+static CommentTree::Node row(int id, std::optional<int> parent_id, int depth, int reply_count = 0) {
+    CommentTree::Node node;
+    node.comment = sohbet::Comment(7, 100 + id, "comment " + std::to_string(id));
+    node.comment.setId(id);
+    node.comment.setParentId(parent_id);
+    node.depth = depth;
+    node.reply_count = reply_count;
+    return node;
+}
+
+void testLayout() {
+    std::cout << "Testing tree layout..." << std::endl;
+
+    // Rows as the query returns them: by depth, then sibling order
+    //   1          4
+    //   ├─ 2       └─ 6
+    //   │  └─ 8
+    //   └─ 5
+    CommentTree tree = CommentTree::build({
+        row(1, std::nullopt, 0, 2),
+        row(4, std::nullopt, 0, 3),
+        row(2, 1, 1, 1),
+        row(6, 4, 1),
+        row(5, 1, 1),
+        row(8, 2, 2),
+    });
+
+    assert(tree.threadCount() == 2);
+    const auto& nodes = tree.nodes();
+    assert(nodes.size() == 6);
+    assert(nodes[0].comment.getId() == 1 && nodes[1].comment.getId() == 4);
+
+    // Each comment's replies are one contiguous run, in the input order
+    const auto& first = nodes[0];
+    assert(first.loaded_replies == 2);
+    assert(nodes[first.first_reply].comment.getId() == 2);
+    assert(nodes[first.first_reply + 1].comment.getId() == 5);
+
+    const auto& second = nodes[1];
+    assert(second.loaded_replies == 1 && second.reply_count == 3);
+    assert(nodes[second.first_reply].comment.getId() == 6);
+
+    const auto& two = nodes[first.first_reply];
+    assert(two.loaded_replies == 1 && nodes[two.first_reply].comment.getId() == 8);
+    assert(nodes[two.first_reply].depth == 2);
+    assert(nodes[two.first_reply].loaded_replies == 0);
+
+    std::cout << "Tree layout test passed!" << std::endl;
+}
+
+void testOrphansAndEmpty() {
+    std::cout << "Testing orphans, reply pages and empty trees..." << std::endl;
+
+    // A reply whose parent is not on the page is dropped
+    CommentTree tree = CommentTree::build({row(1, std::nullopt, 0), row(3, 99, 1)});
+    assert(tree.threadCount() == 1);
+    assert(tree.nodes().size() == 1);
+
+    // A page of one comment's replies: depth 0 rows are the threads
+    CommentTree replies = CommentTree::build({row(5, 1, 0, 1), row(6, 1, 0), row(9, 5, 1)});
+    assert(replies.threadCount() == 2);
+    assert(replies.nodes()[0].loaded_replies == 1);
+    assert(replies.toJson().find("\"parent_id\":1,") != std::string::npos);
+
+    CommentTree empty = CommentTree::build({});
+    assert(empty.empty() && empty.threadCount() == 0);
+    assert(empty.toJson() == "[]");
+
+    std::cout << "Orphans/empty test passed!" << std::endl;
+}
+
+void testJson() {
+    std::cout << "Testing tree JSON..." << std::endl;
+
+    std::vector<CommentTree::Node> rows = {
+        row(1, std::nullopt, 0, 4),
+        row(2, 1, 1),
+        row(3, 1, 1),
+    };
+    rows[2].created_at_us = 1760000000123456LL;
+    CommentTree tree = CommentTree::build(std::move(rows));
+    std::string json = tree.toJson();
+    std::cout << "Serialized JSON: " << json << std::endl;
+
+    sohbet::utils::JsonDocument doc = sohbet::utils::JsonDocument::parse(json);
+    assert(doc.isValid());
+    assert(json.find("\"reply_count\":4") != std::string::npos);
+    assert(json.find("\"replies\":[{\"id\":2,") != std::string::npos);
+    assert(json.find("\"parent_id\":null") != std::string::npos);
+    assert(json.find("\"parent_id\":1") != std::string::npos);
+    assert(json.find("\"content\":\"comment 3\"") != std::string::npos);
+    // Each comment carries the cursor that continues after it
+    assert(json.find("\"cursor\":\"1760000000123456:3\"") != std::string::npos);
+    assert(tree.nodes()[2].cursor() == "1760000000123456:3");
+
+    std::cout << "Tree JSON test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running CommentTree Tests ===" << std::endl;
+
+    testLayout();
+    testOrphansAndEmpty();
+    testJson();
+
+    std::cout << "=== All CommentTree Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "utils/compression.h"
+#include <zlib.h>
+#include <iostream>
+#include <cassert>
+#include <string>
+
+using namespace sohbet::utils;
+
+// Inflate gzip or zlib data (windowBits 15 + 32 auto-detects the wrapper)
+static std::string inflateAll(const std::string& data) {
+    z_stream zs{};
+    assert(inflateInit2(&zs, 15 + 32) == Z_OK);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+
+    std::string out;
+    char chunk[4096];
+    int result;
+    do {
+        zs.next_out = reinterpret_cast<Bytef*>(chunk);
+        zs.avail_out = sizeof(chunk);
+        result = inflate(&zs, Z_NO_FLUSH);
+        assert(result == Z_OK || result == Z_STREAM_END);
+        out.append(chunk, sizeof(chunk) - zs.avail_out);
+    } while (result != Z_STREAM_END);
+    inflateEnd(&zs);
+    return out;
+}
+
+void testNegotiation() {
+    std::cout << "Testing Accept-Encoding negotiation..." << std::endl;
+
+    assert(negotiateEncoding("") == ContentEncoding::Identity);
+    assert(negotiateEncoding("gzip, deflate, br") == ContentEncoding::Gzip);
+    assert(negotiateEncoding("deflate") == ContentEncoding::Deflate);
+    assert(negotiateEncoding("GZIP") == ContentEncoding::Gzip);
+    assert(negotiateEncoding("br") == ContentEncoding::Identity);
+    assert(negotiateEncoding("gzip;q=0.5, deflate;q=0.8") == ContentEncoding::Deflate);
+    assert(negotiateEncoding("gzip;q=0, deflate;q=0") == ContentEncoding::Identity);
+    assert(negotiateEncoding("*") == ContentEncoding::Gzip);
+    assert(negotiateEncoding("*;q=0.5, gzip;q=0") == ContentEncoding::Deflate);
+    assert(negotiateEncoding("identity") == ContentEncoding::Identity);
+
+    std::cout << "Negotiation test passed!" << std::endl;
+}
+
+void testCompressibleTypes() {
+    std::cout << "Testing compressible content types..." << std::endl;
+
+    assert(isCompressibleContentType("application/json"));
+    assert(isCompressibleContentType("application/json; charset=utf-8"));
+    assert(isCompressibleContentType("text/plain; version=0.0.4"));
+    assert(isCompressibleContentType("image/svg+xml"));
+    assert(isCompressibleContentType("application/problem+json"));
+    assert(!isCompressibleContentType("image/jpeg"));
+    assert(!isCompressibleContentType("image/png"));
+    assert(!isCompressibleContentType("image/webp"));
+    assert(!isCompressibleContentType("application/octet-stream"));
+
+    std::cout << "Compressible content types test passed!" << std::endl;
+}
+
+void testRoundTripAndReuse() {
+    std::cout << "Testing compression round trip and stream reuse..." << std::endl;
+
+    std::string body = "{\"posts\":[";
+    for (int i = 0; i < 200; ++i) {
+        body += "{\"id\":" + std::to_string(i) + ",\"content\":\"Kütüphanede çalışma grubu\"},";
+    }
+    body += "{}]}";
+
+    ResponseCompressor compressor(6, 2);
+    std::string gz;
+    std::string zl;
+
+    // Repeat to exercise streams coming back from the pool after reset
+    for (int round = 0; round < 3; ++round) {
+        assert(compressor.compress(body, ContentEncoding::Gzip, gz));
+        assert(gz.size() < body.size() / 4);
+        assert(static_cast<unsigned char>(gz[0]) == 0x1f && static_cast<unsigned char>(gz[1]) == 0x8b);
+        assert(inflateAll(gz) == body);
+
+        assert(compressor.compress(body, ContentEncoding::Deflate, zl));
+        assert(inflateAll(zl) == body);
+    }
+    assert(compressor.pooledStreams() == 2);
+
+    std::string untouched = "keep";
+    assert(!compressor.compress(body, ContentEncoding::Identity, untouched));
+    assert(untouched == "keep");
+
+    std::cout << "Round trip test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running Compression Tests ===" << std::endl;
+
+    testNegotiation();
+    testCompressibleTypes();
+    testRoundTripAndReuse();
+
+    std::cout << "=== All Compression Tests Passed! ===" << std::endl;
+    return 0;
+}
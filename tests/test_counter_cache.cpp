@@ -0,0 +1,74 @@
+#include "utils/counter_cache.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+using sohbet::utils::CounterCache;
+
+void testCoalescing() {
+    std::cout << "Testing delta coalescing..." << std::endl;
+
+    std::vector<CounterCache::Deltas> writes;
+    CounterCache cache("test", [&writes](const CounterCache::Deltas& deltas) {
+        writes.push_back(deltas);
+        return true;
+    });
+
+    assert(cache.flush() == 0); // Nothing pending: no write
+    assert(writes.empty());
+
+    for (int i = 0; i < 100; ++i) {
+        cache.add(1, 1);
+    }
+    cache.add(2, 1);
+    cache.add(2, -1); // Cancels out
+    cache.add(3, -2);
+
+    assert(cache.pending(1) == 100);
+    assert(cache.pending(2) == 0);
+    assert(cache.pending(4) == 0);
+
+    assert(cache.flush() == 2);
+    assert(writes.size() == 1);
+    assert(writes[0].size() == 2);
+    assert(writes[0].at(1) == 100);
+    assert(writes[0].at(3) == -2);
+    assert(cache.pending(1) == 0);
+    assert(cache.pendingKeys() == 0);
+
+    std::cout << "Coalescing test passed!" << std::endl;
+}
+
+void testFailedFlushIsRetried() {
+    std::cout << "Testing failed flush re-merge..." << std::endl;
+
+    bool fail = true;
+    CounterCache::Deltas written;
+    CounterCache cache("test", [&](const CounterCache::Deltas& deltas) {
+        if (fail) return false;
+        written = deltas;
+        return true;
+    });
+
+    cache.add(7, 5);
+    assert(cache.flush() == 0);
+    assert(cache.pending(7) == 5); // Kept after the failed write
+
+    cache.add(7, 2);
+    fail = false;
+    assert(cache.flush() == 1);
+    assert(written.at(7) == 7);
+    assert(cache.pending(7) == 0);
+
+    std::cout << "Failed flush test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running CounterCache Tests ===" << std::endl;
+
+    testCoalescing();
+    testFailedFlushIsRetried();
+
+    std::cout << "=== All CounterCache Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,306 @@
+#include "utils/http_parser.h"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sohbet::utils;
+
+static const std::string SAMPLE =
+    "POST /api/posts?limit=5 HTTP/1.1\r\n"
+    "Host: sohbet.local\r\n"
+    "authorization: Bearer abc.def\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 13\r\n"
+    "X-Empty:\r\n"
+    "\r\n"
+    "{\"a\":\"b\\r\\n\"}";
+
+void testParseRequest() {
+    std::cout << "Testing request head parsing..." << std::endl;
+
+    HttpRequestHead head;
+    assert(parseHttpRequestHead(SAMPLE, head) == HttpParseStatus::Complete);
+    assert(head.method == "POST");
+    assert(head.target == "/api/posts?limit=5");
+    assert(head.minor_version == 1);
+    assert(head.headers.size() == 5);
+    assert(SAMPLE.substr(head.length) == "{\"a\":\"b\\r\\n\"}");
+
+    // Views point into the input, not copies
+    assert(head.method.data() == SAMPLE.data());
+
+    // Case-insensitive lookup
+    assert(head.headers.get("Authorization").value() == "Bearer abc.def");
+    assert(head.headers.get("CONTENT-TYPE").value() == "application/json");
+    assert(head.headers.get("x-empty").value().empty());
+    assert(!head.headers.get("Cookie").has_value());
+
+    size_t length = 0;
+    assert(head.contentLength(length) && length == 13);
+    bool chunked = true;
+    assert(head.transferEncoding(chunked) && !chunked);
+
+    // Bare LF line endings and leading blank lines
+    HttpRequestHead lf;
+    assert(parseHttpRequestHead("\r\nGET / HTTP/1.0\nHost: x\n\n", lf) == HttpParseStatus::Complete);
+    assert(lf.minor_version == 0);
+    assert(lf.headers.get("host").value() == "x");
+
+    std::cout << "Request head test passed!" << std::endl;
+}
+
+void testIncompleteAndInvalid() {
+    std::cout << "Testing incomplete and invalid input..." << std::endl;
+
+    HttpRequestHead head;
+    for (size_t cut = 0; cut < SAMPLE.find("\r\n\r\n") + 3; ++cut) {
+        assert(parseHttpRequestHead(std::string_view(SAMPLE).substr(0, cut), head) == HttpParseStatus::Incomplete);
+    }
+
+    const char* invalid[] = {
+        "GET /\r\n\r\n",                                 // No version
+        "GET  / HTTP/1.1\r\n\r\n",                       // Empty target
+        "G(T / HTTP/1.1\r\n\r\n",                        // Bad method token
+        "GET / HTTP/2.0\r\n\r\n",
+        "GET / HTTP/1.1\r\nBad Name: x\r\n\r\n",
+        "GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n",     // Obsolete line folding
+        "GET / HTTP/1.1\r\nA: b\x01c\r\n\r\n",           // Control character
+        "GET / HTTP/1.1\r\nA: b\rc\r\n\r\n",             // Stray CR
+    };
+    for (const char* request : invalid) {
+        assert(parseHttpRequestHead(request, head) == HttpParseStatus::Invalid);
+    }
+
+    // Content-Length must be digits and agree with any duplicate
+    size_t length = 0;
+    assert(parseHttpRequestHead("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", head) == HttpParseStatus::Complete);
+    assert(!head.contentLength(length));
+    assert(parseHttpRequestHead("POST / HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 4\r\n\r\n", head) ==
+           HttpParseStatus::Complete);
+    assert(!head.contentLength(length));
+    assert(parseHttpRequestHead("POST / HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 3\r\n\r\n", head) ==
+           HttpParseStatus::Complete);
+    assert(head.contentLength(length) && length == 3);
+
+    std::cout << "Incomplete/invalid test passed!" << std::endl;
+}
+
+void testManyHeaders() {
+    std::cout << "Testing header table overflow..." << std::endl;
+
+    std::string request = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < 40; ++i) {
+        request += "X-H" + std::to_string(i) + ": v" + std::to_string(i) + "\r\n";
+    }
+    request += "\r\n";
+
+    HttpRequestHead head;
+    assert(parseHttpRequestHead(request, head) == HttpParseStatus::Complete);
+    assert(head.headers.size() == 40);
+    assert(head.headers.get("x-h39").value() == "v39");
+    assert(head.headers[20].name == "X-H20");
+
+    // Views follow the bytes when the buffer moves
+    std::string moved = request;
+    head.rebase(request.data(), moved.data());
+    request.assign(request.size(), '?');
+    assert(head.method == "GET");
+    assert(head.headers.get("X-H39").value() == "v39");
+
+    std::string too_many = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < 101; ++i) {
+        too_many += "A: b\r\n";
+    }
+    too_many += "\r\n";
+    assert(parseHttpRequestHead(too_many, head) == HttpParseStatus::Invalid);
+
+    std::cout << "Header table test passed!" << std::endl;
+}
+
+void testChunked() {
+    std::cout << "Testing chunked body decoding..." << std::endl;
+
+    HttpRequestHead head;
+    assert(parseHttpRequestHead("POST / HTTP/1.1\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n", head) ==
+           HttpParseStatus::Complete);
+    bool chunked = false;
+    assert(head.transferEncoding(chunked) && chunked);
+
+    // Transfer-Encoding that does not end in chunked is rejected, never
+    // framed by Content-Length instead (RFC 9112 §6.3)
+    const char* unframed[] = {
+        "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\nContent-Length: 3\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked, gzip\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: identity\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked, chunked\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: \r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: ,\r\n\r\n",
+    };
+    for (const char* request : unframed) {
+        HttpRequestHead rejected;
+        assert(parseHttpRequestHead(request, rejected) == HttpParseStatus::Complete);
+        bool rejected_chunked = false;
+        assert(!rejected.transferEncoding(rejected_chunked));
+    }
+
+    HttpRequestHead split;
+    assert(parseHttpRequestHead("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\ntransfer-encoding: chunked\r\n\r\n",
+                                split) == HttpParseStatus::Complete);
+    assert(split.transferEncoding(chunked) && chunked);
+
+    // Binary data, an extension and a trailer; then the next request
+    std::string body("\x00\r\n\xff", 4);
+    std::string encoded = "4;name=value\r\n" + body + "\r\n" + "A\r\n0123456789\r\n0\r\nX-Trailer: 1\r\n\r\nGET";
+
+    std::string decoded;
+    HttpChunkedDecoder decoder;
+    assert(decoder.feed(encoded, decoded) == HttpParseStatus::Complete);
+    assert(decoded == body + "0123456789");
+    assert(decoder.remaining() == 3);
+
+    // Same input one byte at a time
+    std::string bytewise;
+    HttpChunkedDecoder incremental;
+    HttpParseStatus status = HttpParseStatus::Incomplete;
+    for (size_t i = 0; i < encoded.size() - 3; ++i) {
+        assert(status == HttpParseStatus::Incomplete);
+        status = incremental.feed(std::string_view(encoded).substr(i, 1), bytewise);
+    }
+    assert(status == HttpParseStatus::Complete);
+    assert(bytewise == decoded);
+
+    const char* invalid[] = {"g\r\n", "\r\n", "4\r\nabcdX", "4\rx", "1234567890123456\r\n"};
+    for (const char* input : invalid) {
+        std::string out;
+        HttpChunkedDecoder bad;
+        assert(bad.feed(input, out) == HttpParseStatus::Invalid);
+    }
+
+    // Extensions and trailer lines are skipped, but only up to 4 KiB each
+    std::string extension(4000, 'e');
+    std::string trailer = "X-Trailer: " + std::string(4000, 't') + "\r\n";
+    std::string within;
+    HttpChunkedDecoder long_lines;
+    assert(long_lines.feed("1;" + extension + "\r\nx\r\n0\r\n" + trailer + "\r\n", within) ==
+           HttpParseStatus::Complete);
+    assert(within == "x");
+
+    std::string endless(8192, 'e');
+    const std::string oversized[] = {"1;" + endless, "1;" + endless + "\r\nx\r\n0\r\n\r\n",
+                                     "0\r\nX-Trailer: " + endless, "0\r\n" + endless + "\r\n\r\n"};
+    for (const auto& input : oversized) {
+        std::string out;
+        HttpChunkedDecoder bad;
+        assert(bad.feed(input, out) == HttpParseStatus::Invalid);
+    }
+
+    std::cout << "Chunked test passed!" << std::endl;
+}
+
+// Random mutations of valid requests, split at random points: the parser must
+// never read out of bounds (run under ASan) and incremental parsing must agree
+// with parsing the whole input at once
+void testFuzz() {
+    std::cout << "Fuzzing parser and chunked decoder..." << std::endl;
+
+    std::mt19937 rng(12345);
+    static const char ALPHABET[] = "GETPOST /?=&:;,-_\r\n\t HTTP/1.1 0123456789abcdefABCDEF\x00\x7f\xc3\xa7";
+    const std::string alphabet(ALPHABET, sizeof(ALPHABET) - 1);
+    const std::string seeds[] = {
+        SAMPLE,
+        "GET /ws HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n",
+        "PUT /x HTTP/1.1\nTransfer-Encoding: chunked\n\n3\r\nabc\r\n0\r\n\r\n",
+        "POST /x HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\nContent-Length: 3\r\n\r\nabc",
+    };
+    const size_t seed_count = sizeof(seeds) / sizeof(seeds[0]);
+
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        std::string input = seeds[iteration % seed_count];
+        int mutations = static_cast<int>(rng() % 6);
+        for (int m = 0; m < mutations && !input.empty(); ++m) {
+            size_t at = rng() % input.size();
+            switch (rng() % 3) {
+                case 0: input[at] = alphabet[rng() % alphabet.size()]; break;
+                case 1: input.erase(at, 1 + rng() % 4); break;
+                default: input.insert(at, 1, alphabet[rng() % alphabet.size()]); break;
+            }
+        }
+
+        HttpRequestHead whole;
+        HttpParseStatus expected = parseHttpRequestHead(input, whole);
+        if (expected == HttpParseStatus::Complete) {
+            assert(whole.length <= input.size());
+            for (size_t i = 0; i < whole.headers.size(); ++i) {
+                const HttpHeader& header = whole.headers[i];
+                assert(header.name.data() >= input.data());
+                assert(header.value.data() + header.value.size() <= input.data() + whole.length);
+            }
+        }
+
+        // Feed growing prefixes like recv() would
+        HttpRequestHead head;
+        size_t previous = 0;
+        HttpParseStatus status = HttpParseStatus::Incomplete;
+        while (previous < input.size()) {
+            size_t next = std::min(input.size(), previous + 1 + rng() % 16);
+            status = parseHttpRequestHead(std::string_view(input).substr(0, next), head, previous);
+            previous = next;
+            if (status != HttpParseStatus::Incomplete) break;
+        }
+        if (status == HttpParseStatus::Complete) {
+            assert(expected == HttpParseStatus::Complete);
+            assert(head.length == whole.length);
+            assert(head.headers.size() == whole.headers.size());
+
+            // Framing is chunked, Content-Length, or rejected; never both
+            bool chunked_whole = false, chunked_head = false;
+            bool framed = whole.transferEncoding(chunked_whole);
+            assert(head.transferEncoding(chunked_head) == framed);
+            assert(chunked_head == chunked_whole);
+            if (framed && !chunked_whole) {
+                assert(!whole.headers.get("Transfer-Encoding").has_value());
+            }
+        } else if (expected != HttpParseStatus::Invalid) {
+            assert(status == expected);
+        }
+
+        // The rest as a chunked body, whole and in pieces
+        std::string rest = input.substr(expected == HttpParseStatus::Complete ? whole.length : 0);
+        std::string decoded_whole;
+        HttpChunkedDecoder decoder_whole;
+        HttpParseStatus chunked_expected = decoder_whole.feed(rest, decoded_whole);
+
+        std::string decoded_pieces;
+        HttpChunkedDecoder decoder_pieces;
+        HttpParseStatus chunked_status = HttpParseStatus::Incomplete;
+        for (size_t at = 0; at < rest.size() && chunked_status == HttpParseStatus::Incomplete;) {
+            size_t take = std::min(rest.size() - at, static_cast<size_t>(1 + rng() % 8));
+            chunked_status = decoder_pieces.feed(std::string_view(rest).substr(at, take), decoded_pieces);
+            at += take;
+        }
+        if (!rest.empty()) {
+            assert(chunked_status == chunked_expected);
+        }
+        if (chunked_expected == HttpParseStatus::Complete) {
+            assert(decoded_pieces == decoded_whole);
+        }
+    }
+
+    std::cout << "Fuzz test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running HttpParser Tests ===" << std::endl;
+
+    testParseRequest();
+    testIncompleteAndInvalid();
+    testManyHeaders();
+    testChunked();
+    testFuzz();
+
+    std::cout << "=== All HttpParser Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "models/conversation.h"
+#include "repositories/conversation_repository.h"
+#include "repositories/message_repository.h"
+#include "utils/json_parser.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using sohbet::db::Database;
+using sohbet::repositories::ConversationRepository;
+using sohbet::repositories::MessageRepository;
+
+void testInboxEntryJson() {
+    std::cout << "Testing InboxEntry JSON..." << std::endl;
+
+    sohbet::InboxEntry entry;
+    entry.conversation_id = 12;
+    entry.other_user_id = 7;
+    entry.other_username = "ayse";
+    entry.other_name = "Ayşe Demir";
+    entry.last_message_id = 300;
+    entry.last_message_sender_id = 7;
+    entry.last_message_preview = "Yarın \"kütüphane\"?";
+    entry.last_message_at = 1700000000;
+    entry.unread_count = 3;
+
+    std::string json = entry.to_json();
+    std::cout << "Serialized JSON: " << json << std::endl;
+
+    sohbet::utils::JsonDocument doc = sohbet::utils::JsonDocument::parse(json);
+    assert(doc.isValid());
+    assert(json.find("\"conversation_id\":12") != std::string::npos);
+    assert(json.find("\"other_user\":{\"id\":7,\"username\":\"ayse\"") != std::string::npos);
+    assert(json.find("\"avatar_url\":null") != std::string::npos);
+    assert(json.find("\"last_message\":{\"id\":300,\"sender_id\":7") != std::string::npos);
+    assert(json.find("\\\"kütüphane\\\"") != std::string::npos);
+    assert(json.find("\"unread_count\":3") != std::string::npos);
+
+    std::cout << "InboxEntry JSON test passed!" << std::endl;
+}
+
+void testInboxEntryWithoutMessages() {
+    std::cout << "Testing InboxEntry without messages..." << std::endl;
+
+    sohbet::InboxEntry entry;
+    entry.conversation_id = 5;
+    entry.other_user_id = 9;
+    entry.other_username = "mehmet";
+    entry.last_message_at = 1700000000;
+
+    std::string json = entry.to_json();
+    assert(sohbet::utils::JsonDocument::parse(json).isValid());
+    assert(json.find("\"last_message\":null") != std::string::npos);
+    assert(json.find("\"unread_count\":0") != std::string::npos);
+
+    std::cout << "InboxEntry without messages test passed!" << std::endl;
+}
+
+// Needs a live server: set SOHBET_TEST_DATABASE_URL to run. The tests work
+// in a scratch schema holding just the tables the inbox triggers touch, with
+// migration 009 applied from the source tree.
+static std::shared_ptr<Database> openInboxSchema(const std::string& url) {
+    auto db = std::make_shared<Database>(url);
+    assert(db->isOpen());
+    assert(db->execute("DROP SCHEMA IF EXISTS inbox_test CASCADE; CREATE SCHEMA inbox_test; "
+                       "SET search_path TO inbox_test"));
+    assert(db->execute(R"(
+        CREATE TABLE users (
+            id BIGSERIAL PRIMARY KEY,
+            username TEXT UNIQUE NOT NULL,
+            name TEXT,
+            avatar_url TEXT
+        );
+        CREATE TABLE conversations (
+            id BIGSERIAL PRIMARY KEY,
+            user1_id BIGINT NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+            user2_id BIGINT NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+            created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+            last_message_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+            UNIQUE(user1_id, user2_id),
+            CHECK (user1_id < user2_id)
+        );
+        CREATE TABLE messages (
+            id BIGSERIAL PRIMARY KEY,
+            conversation_id BIGINT NOT NULL REFERENCES conversations(id) ON DELETE CASCADE,
+            sender_id BIGINT NOT NULL REFERENCES users(id) ON DELETE CASCADE,
+            content TEXT NOT NULL,
+            media_url TEXT,
+            read_at TIMESTAMP,
+            delivered_at TIMESTAMP,
+            created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+        );
+        INSERT INTO users (username) VALUES ('ali'), ('ayse'), ('mehmet'), ('zeynep');
+    )"));
+
+    std::ifstream file("migrations/009_conversation_inbox.sql");
+    assert(file.is_open());
+    std::stringstream sql;
+    sql << file.rdbuf();
+    assert(db->execute(sql.str()));
+    return db;
+}
+
+static const sohbet::InboxEntry* findEntry(const std::vector<sohbet::InboxEntry>& entries, int conversation_id) {
+    for (const auto& entry : entries) {
+        if (entry.conversation_id == conversation_id) return &entry;
+    }
+    return nullptr;
+}
+
+void testInboxTriggers(const std::shared_ptr<Database>& db) {
+    std::cout << "Testing inbox triggers..." << std::endl;
+
+    ConversationRepository conversations(db);
+    MessageRepository messages(db);
+    auto conversation = conversations.findOrCreateConversation(1, 2);
+    assert(conversation.has_value());
+    int id = conversation->id;
+
+    // Both participants get a row as soon as the conversation exists
+    assert(findEntry(conversations.getInbox(1), id) != nullptr);
+    assert(findEntry(conversations.getInbox(2), id) != nullptr);
+
+    // Only the recipient's unread count grows; the sender's own row does not
+    auto first = messages.createMessage(id, 1, "merhaba");
+    auto second = messages.createMessage(id, 1, "nasılsın?");
+    assert(first.has_value() && second.has_value());
+    const auto* sender = findEntry(conversations.getInbox(1), id);
+    const auto* recipient = findEntry(conversations.getInbox(2), id);
+    assert(sender->unread_count == 0);
+    assert(recipient->unread_count == 2);
+    assert(recipient->last_message_id == second->id);
+    assert(recipient->last_message_sender_id == 1);
+    assert(recipient->last_message_preview == "nasılsın?");
+
+    // The recipient replying leaves their own count alone
+    auto reply = messages.createMessage(id, 2, "iyiyim");
+    assert(reply.has_value());
+    assert(findEntry(conversations.getInbox(2), id)->unread_count == 2);
+    assert(findEntry(conversations.getInbox(1), id)->unread_count == 1);
+
+    // Mark-read clears only the reader's count
+    assert(messages.markAllAsRead(id, 2));
+    assert(findEntry(conversations.getInbox(2), id)->unread_count == 0);
+    assert(findEntry(conversations.getInbox(1), id)->unread_count == 1);
+
+    // Deleting the last message falls back to the one before it
+    assert(messages.deleteMessage(reply->id));
+    for (int user_id : {1, 2}) {
+        const auto* entry = findEntry(conversations.getInbox(user_id), id);
+        assert(entry->last_message_id == second->id);
+        assert(entry->last_message_preview == "nasılsın?");
+    }
+    assert(findEntry(conversations.getInbox(1), id)->unread_count == 0);
+
+    // Deleting an older message keeps the preview
+    assert(messages.deleteMessage(first->id));
+    assert(findEntry(conversations.getInbox(2), id)->last_message_id == second->id);
+
+    assert(conversations.repairInbox() == 0);   // Triggers left nothing to fix
+
+    std::cout << "Inbox trigger test passed!" << std::endl;
+}
+
+void testInboxCursor(const std::shared_ptr<Database>& db) {
+    std::cout << "Testing inbox cursor..." << std::endl;
+
+    ConversationRepository conversations(db);
+    MessageRepository messages(db);
+    std::vector<int> ids;
+    for (int other : {2, 3, 4}) {
+        auto conversation = conversations.findOrCreateConversation(1, other);
+        assert(conversation.has_value());
+        ids.push_back(conversation->id);
+    }
+    // Ties on last_message_at are broken by conversation_id
+    assert(db->execute("UPDATE conversation_inbox SET last_message_at = TIMESTAMP '2025-01-01 12:00:00.123456' "
+                       "WHERE user_id = 1"));
+
+    auto first_page = conversations.getInbox(1, 2);
+    assert(first_page.size() == 2);
+    assert(first_page[0].conversation_id == ids[2]);
+    assert(first_page[1].conversation_id == ids[1]);
+
+    // The last conversation of the page moving to the top must not bring
+    // the page back, nor skip what followed it
+    assert(messages.createMessage(ids[1], 3, "yeni").has_value());
+
+    const auto& last = first_page.back();
+    auto second_page = conversations.getInbox(1, 2, last.last_message_at_us, last.conversation_id);
+    assert(second_page.size() == 1);
+    assert(second_page[0].conversation_id == ids[0]);
+
+    std::cout << "Inbox cursor test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running InboxEntry Tests ===" << std::endl;
+
+    testInboxEntryJson();
+    testInboxEntryWithoutMessages();
+
+    const char* url = std::getenv("SOHBET_TEST_DATABASE_URL");
+    if (url && *url) {
+        auto db = openInboxSchema(url);
+        testInboxTriggers(db);
+        testInboxCursor(db);
+        db->execute("DROP SCHEMA inbox_test CASCADE");
+    } else {
+        std::cout << "SOHBET_TEST_DATABASE_URL not set; skipping inbox trigger tests" << std::endl;
+    }
+
+    std::cout << "=== All InboxEntry Tests Passed! ===" << std::endl;
+    return 0;
+}
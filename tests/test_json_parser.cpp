@@ -0,0 +1,133 @@
+#include "utils/json_parser.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using sohbet::utils::JsonDocument;
+using sohbet::utils::JsonValue;
+
+void testTypedGetters() {
+    std::cout << "Testing typed getters..." << std::endl;
+
+    std::string text = R"({"name":"Ada","year":2023,"ratio":0.75,"active":true,"none":null,
+                           "id_str":"42","neg":-7})";
+    JsonDocument doc = JsonDocument::parse(text);
+    assert(doc.isValid());
+
+    assert(doc.getString("name").value() == "Ada");
+    assert(doc.getInt("year").value() == 2023);
+    assert(doc.getDouble("ratio").value() == 0.75);
+    assert(doc.getBool("active").value() == true);
+    assert(doc["none"].isNull());
+    assert(doc.getInt("id_str").value() == 42);
+    assert(doc.getInt("neg").value() == -7);
+
+    // Wrong types and missing keys yield nullopt
+    assert(!doc.getString("year").has_value());
+    assert(!doc.getInt("name").has_value());
+    assert(!doc.getInt("ratio").has_value());
+    assert(!doc.getString("missing").has_value());
+    assert(!doc.has("missing"));
+    assert(doc.has("none"));
+
+    std::cout << "Typed getters test passed!" << std::endl;
+}
+
+void testKeysOnlyMatchAtTopLevel() {
+    std::cout << "Testing key lookup scope..." << std::endl;
+
+    // "name" appears inside a nested object and inside a string value;
+    // neither may shadow the real top-level key
+    std::string text = R"({"profile":{"name":"inner"},"bio":"my \"name\": fake","name":"outer"})";
+    JsonDocument doc = JsonDocument::parse(text);
+    assert(doc.isValid());
+    assert(doc.getString("name").value() == "outer");
+    assert(doc["profile"]["name"].getString().value() == "inner");
+    assert(doc.getString("bio").value() == "my \"name\": fake");
+
+    std::cout << "Key lookup scope test passed!" << std::endl;
+}
+
+void testStringDecoding() {
+    std::cout << "Testing string decoding..." << std::endl;
+
+    std::string text = R"({"s":"a\\b\/c\n\tçğ😀","key":1})";
+    JsonDocument doc = JsonDocument::parse(text);
+    assert(doc.isValid());
+    assert(doc.getString("s").value() == "a\\b/c\n\tçğ\xF0\x9F\x98\x80");
+    assert(doc.getInt("key").value() == 1);
+
+    std::cout << "String decoding test passed!" << std::endl;
+}
+
+void testArrays() {
+    std::cout << "Testing arrays..." << std::endl;
+
+    std::string text = R"({"langs":["tr","en",3],"urls":[ "a" , "b" ]})";
+    JsonDocument doc = JsonDocument::parse(text);
+    assert(doc.isValid());
+
+    JsonValue langs = doc["langs"];
+    assert(langs.isArray());
+    assert(langs.size() == 3);
+    assert(langs.at(1).getString().value() == "en");
+    assert(!langs.at(3).exists());
+
+    std::vector<std::string> collected;
+    langs.forEach([&collected](JsonValue item) {
+        if (auto s = item.getString()) collected.push_back(*s);
+    });
+    assert(collected.size() == 2);
+
+    assert(doc["urls"].raw() == R"([ "a" , "b" ])");
+
+    std::cout << "Arrays test passed!" << std::endl;
+}
+
+void testValidationErrors() {
+    std::cout << "Testing validation errors..." << std::endl;
+
+    const char* invalid[] = {
+        "",
+        "   ",
+        "{",
+        "{\"a\":}",
+        "{\"a\":1,}",
+        "[1,2",
+        "{\"a\":01}",
+        "{\"a\":1.}",
+        "{\"a\":\"unterminated}",
+        "{\"a\":\"bad \\x escape\"}",
+        "{\"a\":tru}",
+        "{a:1}",
+        "{\"a\":1} trailing",
+        "{\"a\":\"tab\there\"}",
+    };
+    for (const char* text : invalid) {
+        JsonDocument doc = JsonDocument::parse(text);
+        assert(!doc.isValid());
+        assert(doc.getError().find("Invalid JSON") == 0);
+        assert(!doc.getString("a").has_value());
+    }
+
+    // Nesting limit guards the recursive parser
+    std::string deep(JsonDocument::MAX_DEPTH + 1, '[');
+    deep += std::string(JsonDocument::MAX_DEPTH + 1, ']');
+    assert(!JsonDocument::parse(deep).isValid());
+
+    std::cout << "Validation errors test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running JsonParser Tests ===" << std::endl;
+
+    testTypedGetters();
+    testKeysOnlyMatchAtTopLevel();
+    testStringDecoding();
+    testArrays();
+    testValidationErrors();
+
+    std::cout << "=== All JsonParser Tests Passed! ===" << std::endl;
+    return 0;
+}
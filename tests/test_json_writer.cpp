@@ -0,0 +1,127 @@
+#include "utils/json_writer.h"
+#include "models/user.h"
+#include "models/post.h"
+#include <iostream>
+#include <cassert>
+#include <optional>
+#include <string>
+
+using sohbet::utils::JsonWriter;
+
+void testStructure() {
+    std::cout << "Testing JsonWriter structure..." << std::endl;
+
+    JsonWriter writer;
+    writer.beginObject();
+    writer.field("id", 42);
+    writer.field("name", "Ada");
+    writer.key("tags").beginArray().value("a").value("b").endArray();
+    writer.key("empty").beginArray().endArray();
+    writer.key("nested").beginObject().field("ok", true).endObject();
+    writer.field("missing", std::optional<int>());
+    writer.field("present", std::optional<int>(7));
+    writer.rawField("raw", "[1,2]");
+    writer.endObject();
+
+    assert(writer.str() ==
+           "{\"id\":42,\"name\":\"Ada\",\"tags\":[\"a\",\"b\"],\"empty\":[],"
+           "\"nested\":{\"ok\":true},\"missing\":null,\"present\":7,\"raw\":[1,2]}");
+
+    std::cout << "JsonWriter structure test passed!" << std::endl;
+}
+
+void testEscaping() {
+    std::cout << "Testing JsonWriter escaping..." << std::endl;
+
+    assert(JsonWriter::escape("plain text") == "plain text");
+    assert(JsonWriter::escape("say \"hi\"") == "say \\\"hi\\\"");
+    assert(JsonWriter::escape("a\\b") == "a\\\\b");
+    assert(JsonWriter::escape("line1\nline2\r\t") == "line1\\nline2\\r\\t");
+    assert(JsonWriter::escape(std::string("\x01\x1f", 2)) == "\\u0001\\u001f");
+    assert(JsonWriter::escape(std::string("nul\0x", 5)) == "nul\\u0000x");
+
+    // UTF-8 passes through untouched
+    assert(JsonWriter::escape("Şişli Üniversitesi") == "Şişli Üniversitesi");
+
+    // Escapes at every offset of the 8-byte fast path
+    for (size_t pos = 0; pos < 20; ++pos) {
+        std::string input(20, 'x');
+        input[pos] = '"';
+        std::string expected = std::string(pos, 'x') + "\\\"" + std::string(19 - pos, 'x');
+        assert(JsonWriter::escape(input) == expected);
+    }
+
+    std::cout << "JsonWriter escaping test passed!" << std::endl;
+}
+
+void testNumbers() {
+    std::cout << "Testing JsonWriter numbers..." << std::endl;
+
+    JsonWriter writer;
+    writer.beginArray();
+    writer.value(-17).value(0u).value(static_cast<long long>(9007199254740993LL));
+    writer.value(1.5).value(0.1).value(1.0 / 0.0);
+    writer.endArray();
+
+    assert(writer.str() == "[-17,0,9007199254740993,1.5,0.1,null]");
+
+    std::cout << "JsonWriter numbers test passed!" << std::endl;
+}
+
+void testTimestamp() {
+    std::cout << "Testing JsonWriter timestamps..." << std::endl;
+
+    JsonWriter writer;
+    writer.beginObject().timestampField("at", static_cast<std::time_t>(1700000000)).endObject();
+    assert(writer.str() == "{\"at\":\"2023-11-14T22:13:20Z\"}");
+
+    std::cout << "JsonWriter timestamp test passed!" << std::endl;
+}
+
+void testNestedWriters() {
+    std::cout << "Testing nested pooled writers..." << std::endl;
+
+    sohbet::User user("quote\"user", "user@example.com");
+    user.setId(3);
+
+    JsonWriter outer;
+    outer.beginObject();
+    // toJson() uses its own pooled writer while the outer one is live
+    std::string user_json = user.toJson();
+    outer.rawField("user", user_json);
+    outer.key("again");
+    user.writeJson(outer);
+    outer.endObject();
+
+    assert(user_json.find("\"username\":\"quote\\\"user\"") != std::string::npos);
+    assert(outer.str() == "{\"user\":" + user_json + ",\"again\":" + user_json + "}");
+
+    std::cout << "Nested pooled writers test passed!" << std::endl;
+}
+
+void testModelEscaping() {
+    std::cout << "Testing model serialization escaping..." << std::endl;
+
+    sohbet::Post post(1, "He said \"merhaba\"\n");
+    post.setAuthorUsername("back\\slash");
+    std::string json = post.toJson();
+
+    assert(json.find("\"content\":\"He said \\\"merhaba\\\"\\n\"") != std::string::npos);
+    assert(json.find("\"username\":\"back\\\\slash\"") != std::string::npos);
+
+    std::cout << "Model serialization escaping test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running JsonWriter Tests ===" << std::endl;
+
+    testStructure();
+    testEscaping();
+    testNumbers();
+    testTimestamp();
+    testNestedWriters();
+    testModelEscaping();
+
+    std::cout << "=== All JsonWriter Tests Passed! ===" << std::endl;
+    return 0;
+}
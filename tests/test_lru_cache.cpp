@@ -0,0 +1,81 @@
+#include "utils/lru_cache.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using sohbet::utils::LruCache;
+
+void testEvictsLeastRecentlyUsed() {
+    std::cout << "Testing LRU eviction..." << std::endl;
+
+    LruCache<int, std::string> cache(2);
+    cache.put(1, "one");
+    cache.put(2, "two");
+    assert(cache.get(1) == std::optional<std::string>("one")); // 1 is now most recent
+
+    cache.put(3, "three"); // Evicts 2
+    assert(cache.size() == 2);
+    assert(!cache.get(2).has_value());
+    assert(cache.get(1).has_value());
+    assert(cache.get(3).has_value());
+
+    cache.put(1, "uno"); // Replace keeps size
+    assert(cache.size() == 2);
+    assert(cache.get(1) == std::optional<std::string>("uno"));
+
+    assert(cache.erase(1));
+    assert(!cache.erase(1));
+    cache.clear();
+    assert(cache.size() == 0);
+
+    std::cout << "LRU eviction test passed!" << std::endl;
+}
+
+void testTtlExpiry() {
+    std::cout << "Testing TTL expiry..." << std::endl;
+
+    LruCache<std::string, int> cache(8, std::chrono::milliseconds(20));
+    cache.put("q", 42);
+    assert(cache.get("q") == std::optional<int>(42));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    assert(!cache.get("q").has_value());
+    assert(cache.size() == 0); // Expired entry dropped on lookup
+
+    std::cout << "TTL expiry test passed!" << std::endl;
+}
+
+void testUpdateInPlace() {
+    std::cout << "Testing in-place update..." << std::endl;
+
+    LruCache<int, std::string> cache(2);
+    cache.put(1, "one");
+    cache.put(2, "two");
+    assert(cache.update(1, [](std::string& value) { value += "!"; }));
+    assert(!cache.update(3, [](std::string& value) { value = "three"; }));
+    assert(cache.size() == 2);
+
+    // Updating does not make 1 recent, so it is still evicted first
+    cache.put(3, "three");
+    assert(!cache.get(1).has_value());
+    assert(cache.get(2) == std::optional<std::string>("two"));
+
+    cache.put(2, "deux");
+    assert(cache.update(2, [](std::string& value) { value += "!"; }));
+    assert(cache.get(2) == std::optional<std::string>("deux!"));
+
+    std::cout << "In-place update test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running LruCache Tests ===" << std::endl;
+
+    testEvictsLeastRecentlyUsed();
+    testTtlExpiry();
+    testUpdateInPlace();
+
+    std::cout << "=== All LruCache Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "utils/metrics.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sohbet::utils;
+
+void testHistogramBuckets() {
+    std::cout << "Testing Histogram bucket layout..." << std::endl;
+
+    // Small values map to exact buckets
+    for (uint64_t v = 0; v < 8; ++v) {
+        assert(Histogram::bucketIndex(v) == static_cast<int>(v));
+        assert(Histogram::bucketUpperBound(static_cast<int>(v)) == v);
+    }
+
+    // Every value must fall inside the bounds of its bucket
+    for (uint64_t v = 1; v < (1ULL << 24); v = v * 3 / 2 + 1) {
+        int index = Histogram::bucketIndex(v);
+        assert(v <= Histogram::bucketUpperBound(index));
+        if (index > 0) {
+            assert(v > Histogram::bucketUpperBound(index - 1));
+        }
+    }
+
+    // Huge values are clamped into the last bucket
+    assert(Histogram::bucketIndex(~0ULL) == Histogram::BUCKET_COUNT - 1);
+
+    std::cout << "Histogram bucket layout test passed!" << std::endl;
+}
+
+void testHistogramQuantiles() {
+    std::cout << "Testing Histogram quantiles..." << std::endl;
+
+    Histogram histogram;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        histogram.observeMicros(v);
+    }
+
+    assert(histogram.count() == 1000);
+    assert(histogram.sumMicros() == 500500);
+
+    // Log-linear buckets keep ~12.5% relative precision
+    uint64_t p50 = histogram.quantileMicros(0.5);
+    uint64_t p99 = histogram.quantileMicros(0.99);
+    assert(p50 >= 500 && p50 <= 575);
+    assert(p99 >= 990 && p99 <= 1140);
+
+    std::cout << "Histogram quantiles test passed!" << std::endl;
+}
+
+void testRegistryReturnsStableSeries() {
+    std::cout << "Testing MetricsRegistry series lookup..." << std::endl;
+
+    auto& registry = MetricsRegistry::getInstance();
+    Counter& a = registry.counter("test_requests_total", "Test counter", {{"route", "/a"}});
+    Counter& b = registry.counter("test_requests_total", "Test counter", {{"route", "/b"}});
+    Counter& a_again = registry.counter("test_requests_total", "Test counter", {{"route", "/a"}});
+
+    assert(&a == &a_again);
+    assert(&a != &b);
+
+    a.inc();
+    a_again.inc(2);
+    assert(a.value() == 3);
+    assert(b.value() == 0);
+
+    std::cout << "MetricsRegistry series lookup test passed!" << std::endl;
+}
+
+void testConcurrentRecording() {
+    std::cout << "Testing concurrent recording..." << std::endl;
+
+    auto& registry = MetricsRegistry::getInstance();
+    Histogram& histogram = registry.histogram("test_concurrent_seconds", "Concurrent histogram");
+    Gauge& gauge = registry.gauge("test_concurrent_gauge", "Concurrent gauge");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&histogram, &gauge]() {
+            for (int i = 0; i < 10000; ++i) {
+                histogram.observeMicros(static_cast<uint64_t>(i));
+                gauge.inc();
+                gauge.dec();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    assert(histogram.count() == 80000);
+    assert(gauge.value() == 0);
+
+    std::cout << "Concurrent recording test passed!" << std::endl;
+}
+
+void testPrometheusRendering() {
+    std::cout << "Testing Prometheus rendering..." << std::endl;
+
+    auto& registry = MetricsRegistry::getInstance();
+    registry.counter("test_render_total", "Rendered counter", {{"path", "a\"b"}}).inc(5);
+    Histogram& histogram = registry.histogram("test_render_seconds", "Rendered histogram", {{"route", "/x"}});
+    histogram.observeMicros(200);      // 0.2ms
+    histogram.observeMicros(3000);     // 3ms
+    histogram.observeMicros(20000000); // 20s, beyond the last bound
+
+    std::string text = registry.renderPrometheus();
+
+    assert(text.find("# TYPE test_render_total counter") != std::string::npos);
+    assert(text.find("test_render_total{path=\"a\\\"b\"} 5") != std::string::npos);
+    assert(text.find("# TYPE test_render_seconds histogram") != std::string::npos);
+    assert(text.find("test_render_seconds_bucket{route=\"/x\",le=\"0.0005\"} 1") != std::string::npos);
+    assert(text.find("test_render_seconds_bucket{route=\"/x\",le=\"0.005\"} 2") != std::string::npos);
+    assert(text.find("test_render_seconds_bucket{route=\"/x\",le=\"10\"} 2") != std::string::npos);
+    assert(text.find("test_render_seconds_bucket{route=\"/x\",le=\"+Inf\"} 3") != std::string::npos);
+    assert(text.find("test_render_seconds_count{route=\"/x\"} 3") != std::string::npos);
+
+    std::cout << "Prometheus rendering test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running Metrics Tests ===" << std::endl;
+
+    testHistogramBuckets();
+    testHistogramQuantiles();
+    testRegistryReturnsStableSeries();
+    testConcurrentRecording();
+    testPrometheusRendering();
+
+    std::cout << "=== All Metrics Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,262 @@
+#include "services/notification_dispatcher.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using sohbet::Notification;
+using sohbet::services::NotificationDispatcher;
+using sohbet::services::NotificationRequest;
+
+// In-memory stand-in for the notifications table and the WebSocket push
+struct FakeBackend {
+    int next_id = 1;
+    bool fail = false;
+    int reject_user = 0;    // Rows for this recipient fail their whole INSERT
+    int persist_calls = 0;
+    int fan_out_calls = 0;
+    std::vector<Notification> stored;
+    std::vector<Notification> delivered;
+
+    NotificationDispatcher make(std::chrono::milliseconds window, size_t max_batch = 500,
+                                int max_attempts = 8,
+                                std::chrono::milliseconds retry_delay = std::chrono::milliseconds(500)) {
+        return NotificationDispatcher(
+            [this](const std::vector<Notification>& rows) {
+                ++persist_calls;
+                std::vector<Notification> result;
+                if (fail) return result;
+                for (const auto& row : rows) {
+                    if (row.user_id == reject_user) return result;
+                }
+                for (auto row : rows) {
+                    row.id = next_id++;
+                    result.push_back(row);
+                }
+                stored.insert(stored.end(), result.begin(), result.end());
+                return result;
+            },
+            [this](const std::vector<int>& user_ids, const Notification& notification) {
+                ++fan_out_calls;
+                std::vector<Notification> result;
+                if (fail) return result;
+                for (int user_id : user_ids) {
+                    Notification row = notification;
+                    row.id = next_id++;
+                    row.user_id = user_id;
+                    result.push_back(row);
+                }
+                stored.insert(stored.end(), result.begin(), result.end());
+                return result;
+            },
+            [this](const std::vector<Notification>& rows) {
+                delivered.insert(delivered.end(), rows.begin(), rows.end());
+            },
+            window, max_batch, max_attempts, retry_delay);
+    }
+};
+
+static NotificationRequest reaction(int recipient, int actor, int post_id) {
+    NotificationRequest request;
+    request.notification.user_id = recipient;
+    request.notification.type = "post_reaction";
+    request.notification.title = "New reaction";
+    request.notification.message = "user" + std::to_string(actor) + " reacted to your post";
+    request.notification.related_user_id = actor;
+    request.notification.related_post_id = post_id;
+    request.coalesce_key = "post_reaction:" + std::to_string(post_id);
+    request.coalesced_message = "{count} people reacted to your post";
+    return request;
+}
+
+void testCoalescesBurst() {
+    std::cout << "Testing coalescing within the window..." << std::endl;
+
+    FakeBackend backend;
+    auto dispatcher = backend.make(std::chrono::milliseconds(30));
+
+    for (int actor = 10; actor < 22; ++actor) {
+        dispatcher.notify(reaction(1, actor, 5));
+    }
+    dispatcher.notify(reaction(1, 10, 5));   // Same actor again: not counted twice
+    dispatcher.notify(reaction(1, 30, 6));   // Different post: separate notification
+    dispatcher.notify(reaction(2, 30, 5));   // Different recipient: separate notification
+    assert(dispatcher.pending() == 3);
+
+    // Window still open: nothing written yet
+    assert(dispatcher.flush() == 0);
+    assert(backend.persist_calls == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    assert(dispatcher.flush() == 3);
+    assert(backend.persist_calls == 1);   // One batch for all three
+    assert(dispatcher.pending() == 0);
+
+    bool found = false;
+    for (const auto& row : backend.delivered) {
+        if (row.user_id == 1 && row.related_post_id == 5) {
+            assert(row.message == "12 people reacted to your post");
+            assert(row.related_user_id == 10);  // Newest actor
+            found = true;
+        }
+        if (row.user_id == 1 && row.related_post_id == 6) {
+            assert(row.message == "user30 reacted to your post");
+        }
+    }
+    assert(found);
+    assert(backend.delivered.size() == 3);
+
+    std::cout << "Coalescing test passed!" << std::endl;
+}
+
+void testImmediateBatching() {
+    std::cout << "Testing batching of uncoalesced notifications..." << std::endl;
+
+    FakeBackend backend;
+    auto dispatcher = backend.make(std::chrono::seconds(60), 4);
+
+    for (int i = 0; i < 10; ++i) {
+        NotificationRequest request;
+        request.notification.user_id = i + 1;
+        request.notification.type = "mention";
+        request.notification.message = "You were mentioned";
+        dispatcher.notify(request);
+    }
+
+    assert(dispatcher.flush() == 10);
+    assert(backend.persist_calls == 3);  // 4 + 4 + 2
+    assert(backend.delivered.size() == 10);
+
+    std::cout << "Batching test passed!" << std::endl;
+}
+
+void testFanOut() {
+    std::cout << "Testing announcement fan-out..." << std::endl;
+
+    FakeBackend backend;
+    auto dispatcher = backend.make(std::chrono::seconds(60));
+
+    std::vector<int> members;
+    for (int id = 1; id <= 12000; ++id) members.push_back(id);
+
+    Notification announcement;
+    announcement.type = "announcement";
+    announcement.title = "Exam moved";
+    announcement.message = "The midterm is now on Friday";
+    announcement.related_group_id = 3;
+    dispatcher.notifyAll(members, announcement);
+    assert(dispatcher.pending() == 12000);
+
+    assert(dispatcher.flush() == 12000);
+    assert(backend.fan_out_calls == 3);  // Chunks of 5000
+    assert(backend.persist_calls == 0);
+    assert(backend.delivered.size() == 12000);
+    assert(backend.delivered.back().user_id == 12000);
+    assert(backend.delivered.back().related_group_id == 3);
+
+    std::cout << "Fan-out test passed!" << std::endl;
+}
+
+void testRetryAfterFailureAndForce() {
+    std::cout << "Testing retry after a failed write..." << std::endl;
+
+    FakeBackend backend;
+    auto dispatcher = backend.make(std::chrono::seconds(60));
+
+    backend.fail = true;
+    NotificationRequest request;
+    request.notification.user_id = 7;
+    request.notification.message = "hello";
+    dispatcher.notify(request);
+    dispatcher.notifyAll({1, 2}, request.notification);
+    dispatcher.notify(reaction(7, 8, 9));
+
+    assert(dispatcher.flush() == 0);
+    assert(dispatcher.pending() == 4);  // 1 + 2 recipients + 1 coalescing
+    assert(backend.delivered.empty());
+
+    // force takes the coalescing entry even though its window is open
+    backend.fail = false;
+    assert(dispatcher.flush(true) == 4);
+    assert(dispatcher.pending() == 0);
+    assert(backend.delivered.size() == 4);
+
+    std::cout << "Retry test passed!" << std::endl;
+}
+
+void testRejectedRowIsIsolated() {
+    std::cout << "Testing a row the database keeps rejecting..." << std::endl;
+
+    FakeBackend backend;
+    auto dispatcher = backend.make(std::chrono::seconds(60), 500, 3, std::chrono::milliseconds(0));
+    backend.reject_user = 13;
+
+    for (int user_id = 11; user_id <= 14; ++user_id) {
+        NotificationRequest request;
+        request.notification.user_id = user_id;
+        request.notification.message = "hello";
+        dispatcher.notify(request);
+    }
+
+    // The batch fails, then each row is written on its own
+    assert(dispatcher.flush() == 3);
+    assert(backend.persist_calls == 1 + 4);
+    assert(backend.delivered.size() == 3);
+    for (const auto& row : backend.delivered) {
+        assert(row.user_id != 13);
+    }
+    assert(dispatcher.pending() == 1);
+
+    // The bad row is retried until it runs out of attempts, then dropped
+    assert(dispatcher.flush() == 0);
+    assert(dispatcher.pending() == 1);
+    assert(dispatcher.flush() == 0);
+    assert(dispatcher.pending() == 0);
+    assert(backend.persist_calls == 1 + 4 + 2);
+
+    assert(dispatcher.flush() == 0);
+    assert(backend.persist_calls == 7);
+
+    std::cout << "Rejected row test passed!" << std::endl;
+}
+
+void testRetryBackoff() {
+    std::cout << "Testing retry backoff..." << std::endl;
+
+    FakeBackend backend;
+    auto dispatcher = backend.make(std::chrono::seconds(60), 500, 8, std::chrono::milliseconds(50));
+    backend.fail = true;
+
+    NotificationRequest request;
+    request.notification.user_id = 7;
+    dispatcher.notify(request);
+    assert(dispatcher.flush() == 0);
+    assert(backend.persist_calls == 1);
+
+    // Waiting out the delay: the next flush does not touch the database
+    backend.fail = false;
+    assert(dispatcher.flush() == 0);
+    assert(backend.persist_calls == 1);
+    assert(dispatcher.pending() == 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    assert(dispatcher.flush() == 1);
+    assert(dispatcher.pending() == 0);
+
+    std::cout << "Retry backoff test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running NotificationDispatcher Tests ===" << std::endl;
+
+    testCoalescesBurst();
+    testImmediateBatching();
+    testFanOut();
+    testRetryAfterFailureAndForce();
+    testRejectedRowIsIsolated();
+    testRetryBackoff();
+
+    std::cout << "=== All NotificationDispatcher Tests Passed! ===" << std::endl;
+    return 0;
+}
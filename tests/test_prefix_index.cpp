@@ -0,0 +1,149 @@
+#include "utils/prefix_index.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using sohbet::utils::PrefixIndex;
+
+static std::vector<std::string> texts(const std::vector<PrefixIndex::Match>& matches) {
+    std::vector<std::string> result;
+    for (const auto& match : matches) result.push_back(match.text);
+    return result;
+}
+
+void testCompletionOrder() {
+    std::cout << "Testing prefix completion order..." << std::endl;
+
+    PrefixIndex index(3);
+    index.upsert(1, "algorithms", 120);
+    index.upsert(2, "algebra", 45);
+    index.upsert(3, "alg", 10);
+    index.upsert(4, "biology", 80);
+    index.upsert(5, "Algo", 45); // Ties break by text; matching ignores case
+
+    assert((texts(index.complete("alg", 10)) == std::vector<std::string>{"algorithms", "algebra", "Algo"}));
+    assert((texts(index.complete("ALGE", 10)) == std::vector<std::string>{"algebra"}));
+    assert((texts(index.complete("algor", 1)) == std::vector<std::string>{"algorithms"}));
+    assert(index.complete("x", 10).empty());
+    assert(index.complete("algebras", 10).empty());
+    assert(index.complete("", 1)[0].text == "algorithms");
+    assert(index.size() == 5);
+
+    std::cout << "Completion order test passed!" << std::endl;
+}
+
+void testIncrementalUpdates() {
+    std::cout << "Testing incremental updates..." << std::endl;
+
+    PrefixIndex index(2);
+    index.upsert(1, "study", 1);
+    index.upsert(2, "studygroup", 2);
+    index.upsert(3, "student", 3);
+    assert((texts(index.complete("stud", 2)) == std::vector<std::string>{"student", "studygroup"}));
+
+    assert(index.addScore(1, 10));
+    assert((texts(index.complete("stud", 2)) == std::vector<std::string>{"study", "student"}));
+    assert(!index.addScore(99, 1));
+
+    assert(index.remove(3));
+    assert(!index.remove(3));
+    assert((texts(index.complete("stud", 2)) == std::vector<std::string>{"study", "studygroup"}));
+
+    index.upsert(2, "seminar", 2); // Renamed entry moves
+    assert((texts(index.complete("stud", 2)) == std::vector<std::string>{"study"}));
+    assert((texts(index.complete("sem", 2)) == std::vector<std::string>{"seminar"}));
+
+    std::cout << "Incremental update test passed!" << std::endl;
+}
+
+void testMatchesBruteForce() {
+    std::cout << "Testing against brute force..." << std::endl;
+
+    const size_t k = 5;
+    PrefixIndex index(k);
+    std::map<int, std::pair<std::string, int64_t>> reference;
+    std::mt19937 rng(42);
+    const std::string alphabet = "abc";
+
+    for (int step = 0; step < 3000; ++step) {
+        int id = static_cast<int>(rng() % 200);
+        int action = static_cast<int>(rng() % 4);
+        if (action == 0 && reference.count(id)) {
+            index.remove(id);
+            reference.erase(id);
+        } else if (action == 1 && reference.count(id)) {
+            int64_t delta = static_cast<int64_t>(rng() % 7) - 3;
+            index.addScore(id, delta);
+            reference[id].second += delta;
+        } else {
+            std::string text;
+            size_t length = 1 + rng() % 6;
+            for (size_t i = 0; i < length; ++i) text += alphabet[rng() % alphabet.size()];
+            int64_t score = static_cast<int64_t>(rng() % 50);
+            // Same text under another id replaces that entry
+            for (auto it = reference.begin(); it != reference.end();) {
+                if (it->first != id && it->second.first == text) it = reference.erase(it);
+                else ++it;
+            }
+            index.upsert(id, text, score);
+            reference[id] = {text, score};
+        }
+
+        if (step % 50 == 0) {
+            for (const std::string prefix : {"", "a", "ab", "abc", "ba", "cc", "cab"}) {
+                std::vector<std::pair<int64_t, std::string>> expected;
+                for (const auto& [entry_id, value] : reference) {
+                    if (value.first.compare(0, prefix.size(), prefix) == 0) {
+                        expected.push_back({-value.second, value.first});
+                    }
+                }
+                std::sort(expected.begin(), expected.end());
+                if (expected.size() > k) expected.resize(k);
+
+                auto matches = index.complete(prefix, k);
+                assert(matches.size() == expected.size());
+                for (size_t i = 0; i < matches.size(); ++i) {
+                    assert(matches[i].text == expected[i].second);
+                    assert(matches[i].score == -expected[i].first);
+                }
+            }
+        }
+    }
+    assert(index.size() == reference.size());
+
+    std::cout << "Brute force test passed!" << std::endl;
+}
+
+void testRebuild() {
+    std::cout << "Testing bulk rebuild..." << std::endl;
+
+    PrefixIndex index(2);
+    index.upsert(9, "stale", 100);
+    index.rebuild({{1, "exam", 5}, {2, "examweek", 9}, {3, "essay", 7}, {2, "examprep", 3}});
+
+    assert(index.size() == 3);
+    assert(index.complete("stale", 2).empty());
+    assert((texts(index.complete("e", 2)) == std::vector<std::string>{"essay", "exam"}));
+    assert((texts(index.complete("exam", 2)) == std::vector<std::string>{"exam", "examprep"}));
+
+    index.upsert(4, "exams", 6); // Incremental updates keep working after a rebuild
+    assert((texts(index.complete("exam", 2)) == std::vector<std::string>{"exams", "exam"}));
+
+    std::cout << "Rebuild test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running PrefixIndex Tests ===" << std::endl;
+
+    testCompletionOrder();
+    testIncrementalUpdates();
+    testMatchesBruteForce();
+    testRebuild();
+
+    std::cout << "=== All PrefixIndex Tests Passed! ===" << std::endl;
+    return 0;
+}
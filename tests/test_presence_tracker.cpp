@@ -0,0 +1,164 @@
+#include "services/presence_tracker.h"
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <vector>
+
+using sohbet::UserPresence;
+using sohbet::services::PresenceTracker;
+
+// In-memory stand-in for the user_presence table
+struct FakeTable {
+    bool fail = false;
+    int upserts = 0;
+    std::map<int, UserPresence> rows;
+
+    PresenceTracker::PersistFunction persist() {
+        return [this](const std::vector<UserPresence>& batch) {
+            ++upserts;
+            if (fail) return false;
+            for (const auto& row : batch) {
+                rows[row.user_id] = row;
+            }
+            return true;
+        };
+    }
+};
+
+void testConnectAndDisconnect() {
+    std::cout << "Testing connect/disconnect across sockets..." << std::endl;
+
+    FakeTable table;
+    PresenceTracker tracker(table.persist());
+
+    assert(tracker.get(1).status == "offline");
+    assert(tracker.get(1).last_seen == 0);
+
+    assert(tracker.connect(1, 100));      // First socket: now online
+    assert(!tracker.connect(1, 101));     // Second tab: no change
+    assert(tracker.get(1).status == "online");
+    assert(tracker.getOnlineUsers().size() == 1);
+
+    assert(!tracker.disconnect(1, 110));  // One tab left open
+    assert(tracker.get(1).status == "online");
+    assert(tracker.disconnect(1, 120));   // Last socket
+    assert(tracker.get(1).status == "offline");
+    assert(tracker.get(1).last_seen == 120);
+    assert(!tracker.disconnect(1, 130));  // Unbalanced close is ignored
+    assert(tracker.getOnlineUsers().empty());
+
+    std::cout << "Connect/disconnect test passed!" << std::endl;
+}
+
+void testWriteBehind() {
+    std::cout << "Testing batched write-behind..." << std::endl;
+
+    FakeTable table;
+    PresenceTracker tracker(table.persist(), 2);
+
+    tracker.connect(1, 100);
+    tracker.connect(2, 100);
+    tracker.connect(3, 100);
+    for (std::time_t t = 101; t < 160; ++t) {
+        tracker.touch(1, t);              // Heartbeats only mark dirty
+    }
+    tracker.touch(4, 150);                // Not connected: ignored
+    assert(table.upserts == 0);
+    assert(tracker.dirty() == 3);
+
+    assert(tracker.flush() == 3);
+    assert(table.upserts == 2);           // 2 + 1
+    assert(table.rows.at(1).last_seen == 159);
+    assert(table.rows.at(1).status == "online");
+    assert(table.rows.count(4) == 0);
+    assert(tracker.dirty() == 0);
+
+    // Nothing changed: nothing written
+    assert(tracker.flush() == 0);
+    assert(table.upserts == 2);
+
+    tracker.touch(1, 159);                // Same second: not dirty
+    assert(tracker.dirty() == 0);
+
+    std::cout << "Write-behind test passed!" << std::endl;
+}
+
+void testStatusAndRetry() {
+    std::cout << "Testing status changes and retry..." << std::endl;
+
+    FakeTable table;
+    PresenceTracker tracker(table.persist());
+
+    assert(!tracker.setStatus(1, "invisible", "", 100).has_value());
+
+    // Chosen while offline: stored, but nothing to announce yet
+    assert(!tracker.setStatus(1, "busy", "Studying", 100).has_value());
+    assert(tracker.get(1).status == "offline");
+
+    tracker.connect(1, 110);
+    UserPresence presence = tracker.get(1);
+    assert(presence.status == "busy");
+    assert(presence.custom_status == "Studying");
+
+    auto changed = tracker.setStatus(1, "away", "", 120);
+    assert(changed.has_value());
+    assert(changed->status == "away");
+    assert(!tracker.setStatus(1, "away", "", 121).has_value());  // No change
+
+    table.fail = true;
+    assert(tracker.flush() == 0);
+    assert(tracker.dirty() == 1);         // Kept for the next flush
+
+    table.fail = false;
+    assert(tracker.flush() == 1);
+    assert(table.rows.at(1).status == "away");
+
+    std::cout << "Status and retry test passed!" << std::endl;
+}
+
+void testLoadAndBatchLookup() {
+    std::cout << "Testing startup load and batch lookup..." << std::endl;
+
+    FakeTable table;
+    PresenceTracker tracker(table.persist());
+
+    // A previous run stopped with user 1 online
+    tracker.load({
+        UserPresence(10, 1, "busy", "In the lab", 500, 500),
+        UserPresence(11, 2, "offline", "", 400, 400),
+    });
+    assert(tracker.dirty() == 1);
+    assert(tracker.get(1).status == "offline");
+    assert(tracker.get(1).custom_status == "In the lab");
+
+    assert(tracker.flush() == 1);
+    assert(table.rows.at(1).status == "offline");
+
+    tracker.connect(2, 600);
+    auto presences = tracker.getByUserIds({2, 3, 1});
+    assert(presences.size() == 3);
+    assert(presences[0].user_id == 2 && presences[0].status == "online");
+    assert(presences[0].id == 11);
+    assert(presences[1].user_id == 3 && presences[1].status == "offline");
+    assert(presences[2].user_id == 1 && presences[2].last_seen == 500);
+
+    tracker.connect(1, 700);
+    assert(tracker.get(1).status == "busy");  // Chosen status survives reconnects
+    auto online = tracker.getOnlineUsers();
+    assert(online.size() == 2);
+    assert(online[0].user_id == 1);       // Most recently updated first
+
+    std::cout << "Load test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running PresenceTracker Tests ===" << std::endl;
+
+    testConnectAndDisconnect();
+    testWriteBehind();
+    testStatusAndRetry();
+    testLoadAndBatchLookup();
+
+    std::cout << "=== All PresenceTracker Tests Passed! ===" << std::endl;
+    return 0;
+}
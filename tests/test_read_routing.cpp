@@ -0,0 +1,126 @@
+#include "db/database.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+
+using namespace sohbet::db;
+
+void testReadOnlyClassification() {
+    std::cout << "Testing read-only query classification..." << std::endl;
+
+    assert(isReadOnlyQuery("SELECT * FROM posts WHERE id = ?"));
+    assert(isReadOnlyQuery("  select id, updated_at, deleted_at FROM users"));
+    assert(isReadOnlyQuery("WITH recent AS (SELECT id FROM posts) SELECT * FROM recent"));
+    assert(isReadOnlyQuery("SELECT 'INSERT INTO x' AS text, \"update\" FROM t -- DELETE\n"));
+    assert(isReadOnlyQuery("SELECT 'it''s' /* FOR UPDATE */ FROM t"));
+
+    assert(!isReadOnlyQuery("INSERT INTO posts (content) VALUES (?)"));
+    assert(!isReadOnlyQuery("UPDATE users SET name = ?"));
+    assert(!isReadOnlyQuery("DELETE FROM users"));
+    assert(!isReadOnlyQuery("WITH gone AS (DELETE FROM t RETURNING id) SELECT * FROM gone"));
+    assert(!isReadOnlyQuery("SELECT * FROM t WHERE id = 1 FOR UPDATE"));
+    assert(!isReadOnlyQuery("SELECT * FROM t FOR KEY SHARE"));
+    assert(!isReadOnlyQuery("SELECT * INTO backup FROM t"));
+    assert(!isReadOnlyQuery("SELECT nextval('posts_id_seq')"));
+    assert(!isReadOnlyQuery("SELECT pg_advisory_xact_lock(1)"));
+    assert(!isReadOnlyQuery("CREATE TABLE t (id INT)"));
+    assert(!isReadOnlyQuery(""));
+
+    std::cout << "Classification test passed!" << std::endl;
+}
+
+void testSessionScope() {
+    std::cout << "Testing session scopes..." << std::endl;
+
+    assert(SessionScope::currentUser() == 0);
+    {
+        SessionScope outer(7);
+        assert(SessionScope::currentUser() == 7);
+        {
+            SessionScope inner(-1);   // Unauthenticated
+            assert(SessionScope::currentUser() == 0);
+        }
+        assert(SessionScope::currentUser() == 7);
+    }
+    assert(SessionScope::currentUser() == 0);
+
+    std::cout << "Session scope test passed!" << std::endl;
+}
+
+// Needs two servers (a second independent instance will do): set
+// SOHBET_TEST_DATABASE_URL and SOHBET_TEST_REPLICA_URL to run
+void testRouting(const std::string& primary, const std::string& replica) {
+    std::cout << "Testing statement routing..." << std::endl;
+
+    Database db(primary, {replica});
+    assert(db.replicaCount() == 1);
+    assert(db.replicaStatus()[0].healthy);
+    assert(db.replicaStatus()[0].lag_ms >= 0);
+
+    {
+        Statement read(db, "SELECT 1");
+        assert(read.onReplica());
+        assert(read.step() == SQLITE_ROW);
+    }
+    {
+        Statement forced(db, "SELECT 1", Routing::Primary);
+        assert(!forced.onReplica());
+    }
+    {
+        Statement locking(db, "SELECT 1 FOR UPDATE");
+        assert(!locking.onReplica());
+    }
+    {
+        UnitOfWork unit(db);
+        Statement joined(db, "SELECT 1");
+        assert(!joined.onReplica());
+    }
+
+    // Read-your-writes: the writer's reads stay on the primary for a while,
+    // everyone else's do not
+    db.setMaxReplicaLag(std::chrono::seconds(5));
+    {
+        SessionScope session(42);
+        {
+            Statement before(db, "SELECT 1");
+            assert(before.onReplica());
+        }
+        assert(db.execute("CREATE TEMP TABLE read_routing_probe (id INT)"));
+        Statement after(db, "SELECT 1");
+        assert(!after.onReplica());
+    }
+    {
+        SessionScope other(43);
+        Statement read(db, "SELECT 1");
+        assert(read.onReplica());
+    }
+
+    // Writes made elsewhere (e.g. db::AsyncClient) are recorded explicitly
+    db.recordWriteBy(44);
+    {
+        SessionScope async_writer(44);
+        Statement read(db, "SELECT 1");
+        assert(!read.onReplica());
+    }
+
+    std::cout << "Routing test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running Read Routing Tests ===" << std::endl;
+
+    testReadOnlyClassification();
+    testSessionScope();
+
+    const char* primary = std::getenv("SOHBET_TEST_DATABASE_URL");
+    const char* replica = std::getenv("SOHBET_TEST_REPLICA_URL");
+    if (primary && *primary && replica && *replica) {
+        testRouting(primary, replica);
+    } else {
+        std::cout << "SOHBET_TEST_DATABASE_URL/SOHBET_TEST_REPLICA_URL not set; skipping routing test" << std::endl;
+    }
+
+    std::cout << "=== All Read Routing Tests Passed! ===" << std::endl;
+    return 0;
+}
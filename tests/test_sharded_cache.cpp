@@ -0,0 +1,193 @@
+#include "utils/sharded_cache.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using sohbet::utils::ShardedCache;
+
+void testReadThrough() {
+    std::cout << "Testing read-through loads..." << std::endl;
+
+    ShardedCache<int, std::string> cache(100, std::chrono::milliseconds(0), "", 4);
+    int loads = 0;
+    auto load = [&loads](int key) -> std::optional<std::string> {
+        ++loads;
+        if (key < 0) return std::nullopt;
+        return "user" + std::to_string(key);
+    };
+
+    assert(!cache.get(1).has_value());
+    assert(cache.getOrLoad(1, load) == std::optional<std::string>("user1"));
+    assert(cache.getOrLoad(1, load) == std::optional<std::string>("user1"));
+    assert(loads == 1);
+    assert(cache.get(1).has_value());
+
+    // Not found is not cached
+    assert(!cache.getOrLoad(-1, load).has_value());
+    assert(!cache.getOrLoad(-1, load).has_value());
+    assert(loads == 3);
+
+    cache.invalidate(1);
+    assert(!cache.get(1).has_value());
+    assert(cache.getOrLoad(1, load).has_value());
+    assert(loads == 4);
+
+    cache.put(2, "two");
+    assert(cache.getOrLoad(2, load) == std::optional<std::string>("two"));
+    assert(cache.size() == 2);
+    cache.clear();
+    assert(cache.size() == 0);
+
+    std::cout << "Read-through test passed!" << std::endl;
+}
+
+void testCapacityAndTtl() {
+    std::cout << "Testing capacity and TTL..." << std::endl;
+
+    ShardedCache<int, int> bounded(8, std::chrono::milliseconds(0), "", 4);
+    for (int i = 0; i < 100; ++i) {
+        bounded.put(i, i);
+    }
+    assert(bounded.size() <= 8);
+
+    ShardedCache<int, int> expiring(10, std::chrono::milliseconds(20));
+    expiring.put(1, 1);
+    assert(expiring.get(1).has_value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    assert(!expiring.get(1).has_value());
+
+    std::cout << "Capacity/TTL test passed!" << std::endl;
+}
+
+void testSingleFlight() {
+    std::cout << "Testing single-flight loads..." << std::endl;
+
+    ShardedCache<int, int> cache(100, std::chrono::milliseconds(0), "test_single_flight");
+    std::atomic<int> loads{0};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> threads;
+    std::vector<int> results(32, 0);
+    for (int t = 0; t < 32; ++t) {
+        threads.emplace_back([&, t] {
+            while (!go) std::this_thread::yield();
+            auto value = cache.getOrLoad(7, [&loads](int key) -> std::optional<int> {
+                ++loads;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return key * 6;
+            });
+            results[t] = value.value_or(0);
+        });
+    }
+    go = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Everyone got the value, from a single load
+    assert(loads == 1);
+    for (int result : results) {
+        assert(result == 42);
+    }
+
+    std::cout << "Single-flight test passed!" << std::endl;
+}
+
+void testInvalidateDuringLoad() {
+    std::cout << "Testing invalidation during a load..." << std::endl;
+
+    ShardedCache<int, std::string> cache(100, std::chrono::milliseconds(0));
+    std::atomic<bool> loading{false};
+
+    std::thread loader([&] {
+        auto value = cache.getOrLoad(1, [&loading](int) -> std::optional<std::string> {
+            loading = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return std::string("old");
+        });
+        assert(value == std::optional<std::string>("old"));
+    });
+    while (!loading) std::this_thread::yield();
+    cache.invalidate(1);   // e.g. the row was updated while it was being read
+    loader.join();
+
+    // The stale result was handed to its caller but not cached
+    assert(!cache.get(1).has_value());
+    assert(cache.getOrLoad(1, [](int) -> std::optional<std::string> { return std::string("new"); }) ==
+           std::optional<std::string>("new"));
+
+    std::cout << "Invalidation during load test passed!" << std::endl;
+}
+
+void testGuardedFill() {
+    std::cout << "Testing guarded fills..." << std::endl;
+
+    ShardedCache<int, std::string> cache(100, std::chrono::milliseconds(0), "", 4);
+
+    uint64_t stamp = cache.stamp();
+    cache.fill(1, "one", stamp);
+    assert(cache.get(1) == std::optional<std::string>("one"));
+
+    // A batch read that raced an invalidation is not cached
+    stamp = cache.stamp();
+    cache.invalidate(1);
+    cache.fill(1, "stale", stamp);
+    cache.fill(2, "two", stamp);
+    assert(!cache.get(1).has_value());
+    assert(!cache.get(2).has_value());
+
+    // Nor is one that lands while a load of the key is running
+    std::atomic<bool> loading{false};
+    std::atomic<bool> filled{false};
+    std::thread loader([&] {
+        cache.getOrLoad(3, [&](int) -> std::optional<std::string> {
+            loading = true;
+            while (!filled) std::this_thread::yield();
+            return std::nullopt;
+        });
+    });
+    while (!loading) std::this_thread::yield();
+    cache.fill(3, "batch", cache.stamp());
+    filled = true;
+    loader.join();
+    assert(!cache.get(3).has_value());
+
+    std::cout << "Guarded fill test passed!" << std::endl;
+}
+
+void testLoaderException() {
+    std::cout << "Testing loader exceptions..." << std::endl;
+
+    ShardedCache<int, int> cache(100, std::chrono::milliseconds(0));
+    bool thrown = false;
+    try {
+        cache.getOrLoad(1, [](int) -> std::optional<int> { throw std::runtime_error("db down"); });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // The failed load is not left behind
+    assert(cache.getOrLoad(1, [](int) -> std::optional<int> { return 5; }) == std::optional<int>(5));
+
+    std::cout << "Loader exception test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running ShardedCache Tests ===" << std::endl;
+
+    testReadThrough();
+    testCapacityAndTtl();
+    testSingleFlight();
+    testInvalidateDuringLoad();
+    testGuardedFill();
+    testLoaderException();
+
+    std::cout << "=== All ShardedCache Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include "utils/social_graph.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+using sohbet::utils::SocialGraph;
+
+void testFriendChecks() {
+    std::cout << "Testing friend checks..." << std::endl;
+
+    SocialGraph graph;
+    // Pairs may come in either direction, repeated, or as self-loops
+    graph.rebuild({{1, 2}, {3, 1}, {1, 4}, {2, 1}, {5, 5}, {2, 3}});
+
+    assert(graph.areFriends(1, 2) && graph.areFriends(2, 1));
+    assert(graph.areFriends(1, 3) && graph.areFriends(3, 2));
+    assert(!graph.areFriends(2, 4));
+    assert(!graph.areFriends(5, 5));
+    assert(!graph.areFriends(1, 99));
+    assert(graph.friendsOf(1) == std::vector<int>({2, 3, 4}));
+    assert(graph.friendsOf(99).empty());
+    assert(graph.friendCount(1) == 3);
+    assert(graph.userCount() == 4);
+    assert(graph.friendshipCount() == 4);
+
+    std::cout << "Friend check test passed!" << std::endl;
+}
+
+void testDeltaAndCompaction() {
+    std::cout << "Testing delta and compaction..." << std::endl;
+
+    SocialGraph graph(100);
+    graph.rebuild({{1, 2}, {1, 3}});
+
+    graph.addFriendship(4, 1);
+    graph.addFriendship(7, 8);          // Both users new to the graph
+    graph.removeFriendship(1, 2);
+    graph.removeFriendship(5, 6);       // Never friends: no-op
+    graph.addFriendship(1, 3);          // Already friends: no-op
+    assert(graph.pendingChanges() == 3);
+
+    assert(graph.areFriends(1, 4) && graph.areFriends(8, 7));
+    assert(!graph.areFriends(2, 1));
+    assert(graph.friendsOf(1) == std::vector<int>({3, 4}));
+    assert(graph.friendshipCount() == 3);
+    assert(graph.userCount() == 6);
+
+    // Re-adding a removed friendship and removing an added one cancel out
+    graph.addFriendship(2, 1);
+    graph.removeFriendship(7, 8);
+    assert(graph.pendingChanges() == 1);
+    assert(graph.friendsOf(1) == std::vector<int>({2, 3, 4}));
+
+    graph.compact();
+    assert(graph.pendingChanges() == 0);
+    assert(graph.friendsOf(1) == std::vector<int>({2, 3, 4}));
+    assert(graph.friendsOf(4) == std::vector<int>({1}));
+    assert(!graph.areFriends(7, 8));
+    assert(graph.friendshipCount() == 3);
+
+    // A new user befriending a higher id that already has a row
+    SocialGraph joined;
+    joined.rebuild({{9, 10}});
+    joined.addFriendship(5, 9);
+    joined.compact();
+    assert(joined.areFriends(5, 9) && joined.areFriends(9, 5));
+    assert(joined.friendsOf(9) == std::vector<int>({5, 10}));
+    assert(joined.friendshipCount() == 2);
+
+    // A small delta limit compacts on its own
+    SocialGraph small(2);
+    small.addFriendship(1, 2);
+    small.addFriendship(2, 3);
+    small.addFriendship(3, 4);
+    assert(small.pendingChanges() == 0);
+    small.addFriendship(10, 11);
+    small.addFriendship(11, 12);
+    assert(small.pendingChanges() == 2);
+    assert(small.friendsOf(11) == std::vector<int>({10, 12}));
+    assert(small.friendsOf(2) == std::vector<int>({1, 3}));
+    assert(small.friendshipCount() == 5);
+
+    std::cout << "Delta/compaction test passed!" << std::endl;
+}
+
+void testMutualFriendsAndSuggestions() {
+    std::cout << "Testing mutual friends and suggestions..." << std::endl;
+
+    SocialGraph graph;
+    // 1's friends are 2, 3, 4; 5 knows 2, 3, 4; 6 knows 2, 3; 7 knows 4
+    graph.rebuild({{1, 2}, {1, 3}, {1, 4},
+                   {5, 2}, {5, 3}, {5, 4},
+                   {6, 2}, {6, 3},
+                   {7, 4}});
+    graph.addFriendship(8, 2);          // Pending changes count too
+
+    assert(graph.mutualFriendCount(1, 5) == 3);
+    assert(graph.mutualFriendCount(5, 1) == 3);
+    assert(graph.mutualFriendCount(1, 6) == 2);
+    assert(graph.mutualFriendCount(1, 8) == 1);
+    assert(graph.mutualFriendCount(1, 99) == 0);
+
+    auto suggestions = graph.suggest(1, 10);
+    assert(suggestions.size() == 4);
+    assert(suggestions[0].user_id == 5 && suggestions[0].mutual_count == 3);
+    assert(suggestions[1].user_id == 6 && suggestions[1].mutual_count == 2);
+    // Ties by id
+    assert(suggestions[2].user_id == 7 && suggestions[2].mutual_count == 1);
+    assert(suggestions[3].user_id == 8 && suggestions[3].mutual_count == 1);
+
+    auto top = graph.suggest(1, 2);
+    assert(top.size() == 2 && top[0].user_id == 5 && top[1].user_id == 6);
+
+    // Friends are never suggested
+    graph.addFriendship(1, 5);
+    for (const auto& suggestion : graph.suggest(1, 10)) {
+        assert(suggestion.user_id != 5 && suggestion.user_id != 1);
+    }
+    assert(graph.suggest(99, 10).empty());
+
+    std::cout << "Mutual friends/suggestions test passed!" << std::endl;
+}
+
+void testSuggestAll() {
+    std::cout << "Testing parallel suggestions..." << std::endl;
+
+    // A ring where everyone also knows the users two and three steps away
+    const int users = 300;
+    std::vector<std::pair<int, int>> pairs;
+    for (int u = 0; u < users; ++u) {
+        pairs.emplace_back(u, (u + 1) % users);
+        pairs.emplace_back(u, (u + 3) % users);
+        if (u % 7 == 0) pairs.emplace_back(u, (u + 50) % users);
+    }
+    SocialGraph graph;
+    graph.rebuild(pairs);
+    graph.addFriendship(0, 150);
+    graph.removeFriendship(10, 11);
+
+    std::vector<int> ids;
+    for (int u = 0; u < users; ++u) ids.push_back(u);
+
+    auto all = graph.suggestAll(ids, 5, 4);
+    assert(all.size() == ids.size());
+    for (int u : ids) {
+        auto expected = graph.suggest(u, 5);
+        const auto& got = all.at(u);
+        assert(got.size() == expected.size());
+        for (size_t i = 0; i < got.size(); ++i) {
+            assert(got[i].user_id == expected[i].user_id);
+            assert(got[i].mutual_count == expected[i].mutual_count);
+        }
+    }
+
+    assert(graph.suggestAll({}, 5).empty());
+
+    std::cout << "Parallel suggestion test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running SocialGraph Tests ===" << std::endl;
+
+    testFriendChecks();
+    testDeltaAndCompaction();
+    testMutualFriendsAndSuggestions();
+    testSuggestAll();
+
+    std::cout << "=== All SocialGraph Tests Passed! ===" << std::endl;
+    return 0;
+}
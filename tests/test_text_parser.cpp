@@ -0,0 +1,97 @@
+#include "utils/text_parser.h"
+#include <iostream>
+#include <cassert>
+#include <set>
+#include <string>
+
+using sohbet::utils::TextParser;
+using sohbet::utils::TextToken;
+
+void testHashtags() {
+    std::cout << "Testing hashtag extraction..." << std::endl;
+
+    auto tags = TextParser::extractHashtags("Final haftası #Ödev #ÖDEV #study_group, #exam#finals!");
+    assert((tags == std::set<std::string>{"ödev", "study_group", "exam", "finals"}));
+
+    // Turkish letters are part of the tag, not a terminator
+    tags = TextParser::extractHashtags("#ağbilimi #Üniversite #İstanbul #ŞEHİR");
+    assert((tags == std::set<std::string>{"ağbilimi", "üniversite", "istanbul", "şehir"}));
+
+    // Not at a word boundary, or nothing after the sigil
+    tags = TextParser::extractHashtags("C# and F# are languages; # alone; issue#12");
+    assert(tags.empty());
+
+    std::cout << "Hashtag test passed!" << std::endl;
+}
+
+void testMentions() {
+    std::cout << "Testing mention extraction..." << std::endl;
+
+    auto mentions = TextParser::extractMentions("@Elif_Y and @can, mail me at me@example.com (@deniz)");
+    assert((mentions == std::set<std::string>{"Elif_Y", "can", "deniz"}));
+
+    // Usernames are ASCII; the mention ends at the first other character
+    mentions = TextParser::extractMentions("@ayşe");
+    assert((mentions == std::set<std::string>{"ay"}));
+
+    std::cout << "Mention test passed!" << std::endl;
+}
+
+void testUrls() {
+    std::cout << "Testing URL tokens..." << std::endl;
+
+    std::string text = "Notes: https://odtu.edu.tr/ders?id=5#hafta3, and (see HTTP://x.org/a_(b)). #done";
+    auto tokens = TextParser::tokenize(text);
+    assert(tokens.size() == 3);
+    assert(tokens[0].kind == TextToken::Kind::Url);
+    assert(tokens[0].value == "https://odtu.edu.tr/ders?id=5#hafta3");
+    assert(tokens[1].kind == TextToken::Kind::Url);
+    assert(tokens[1].value == "HTTP://x.org/a_(b)");
+    assert(tokens[2].kind == TextToken::Kind::Hashtag && tokens[2].value == "done");
+    assert(text.substr(tokens[2].offset, tokens[2].length) == "#done");
+
+    // A bare scheme is not a link
+    assert(TextParser::tokenize("http:// ").empty());
+
+    std::cout << "URL test passed!" << std::endl;
+}
+
+void testMakeClickable() {
+    std::cout << "Testing makeClickable..." << std::endl;
+
+    std::string html = TextParser::makeClickable("Hi @can, see #ödev at https://a.b/c.");
+    assert(html == "Hi <a href=\"/users/can\" class=\"mention\">@can</a>, see "
+                   "<a href=\"/hashtags/ödev\" class=\"hashtag\">#ödev</a> at "
+                   "<a href=\"https://a.b/c\" class=\"link\" rel=\"nofollow noopener\">https://a.b/c</a>.");
+    assert(TextParser::makeClickable("plain text") == "plain text");
+
+    std::cout << "makeClickable test passed!" << std::endl;
+}
+
+void testToLowerAndInvalidUtf8() {
+    std::cout << "Testing lowercasing and invalid UTF-8..." << std::endl;
+
+    assert(TextParser::toLower("ÇĞIİÖŞÜ çğıiöşü") == "çğiiöşü çğıiöşü");
+    assert(TextParser::toLower("ΑΘΉΝΑ МОСКВА Ŵ") == "αθήνα москва ŵ");
+
+    // Stray continuation and truncated sequences pass through and split tags
+    std::string broken = "#ab\x80" "cd #e\xC3";
+    assert(TextParser::toLower(broken) == broken);
+    auto tags = TextParser::extractHashtags(broken);
+    assert((tags == std::set<std::string>{"ab", "e"}));
+
+    std::cout << "Lowercasing test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running TextParser Tests ===" << std::endl;
+
+    testHashtags();
+    testMentions();
+    testUrls();
+    testMakeClickable();
+    testToLowerAndInvalidUtf8();
+
+    std::cout << "=== All TextParser Tests Passed! ===" << std::endl;
+    return 0;
+}
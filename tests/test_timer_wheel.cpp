@@ -0,0 +1,110 @@
+#include "utils/timer_wheel.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using sohbet::utils::TimerWheel;
+using std::chrono::milliseconds;
+
+void testOneShotAndCancel() {
+    std::cout << "Testing one-shot timers and cancel..." << std::endl;
+
+    TimerWheel wheel(milliseconds(10), 8);
+    std::vector<int> fired;
+
+    wheel.schedule(milliseconds(30), [&fired]() { fired.push_back(3); });
+    wheel.schedule(milliseconds(5), [&fired]() { fired.push_back(1); }); // Rounds up to 1 tick
+    auto cancelled = wheel.schedule(milliseconds(20), [&fired]() { fired.push_back(2); });
+    assert(wheel.pending() == 3);
+
+    assert(wheel.cancel(cancelled));
+    assert(!wheel.cancel(cancelled));
+
+    assert(wheel.tick() == 1);
+    assert(wheel.tick() == 0);
+    assert(wheel.tick() == 1);
+    assert((fired == std::vector<int>{1, 3}));
+    assert(wheel.pending() == 0);
+
+    std::cout << "One-shot test passed!" << std::endl;
+}
+
+void testLongDelaysUseRounds() {
+    std::cout << "Testing delays longer than one revolution..." << std::endl;
+
+    TimerWheel wheel(milliseconds(1), 4);
+    int fired_at = 0;
+    int ticks = 0;
+    wheel.schedule(milliseconds(11), [&]() { fired_at = ticks; });
+
+    for (ticks = 1; ticks <= 12; ++ticks) {
+        wheel.tick();
+    }
+    assert(fired_at == 11);
+
+    std::cout << "Long delay test passed!" << std::endl;
+}
+
+void testPeriodic() {
+    std::cout << "Testing periodic timers..." << std::endl;
+
+    TimerWheel wheel(milliseconds(1), 4);
+    int runs = 0;
+    auto id = wheel.scheduleEvery(milliseconds(3), [&runs]() { ++runs; });
+
+    for (int i = 0; i < 9; ++i) {
+        wheel.tick();
+    }
+    assert(runs == 3);
+    assert(wheel.pending() == 1);
+
+    assert(wheel.cancel(id));
+    for (int i = 0; i < 9; ++i) {
+        wheel.tick();
+    }
+    assert(runs == 3);
+
+    // Callbacks may re-arm timers (e.g. a rejoin cancelling an expiry)
+    int chained = 0;
+    wheel.schedule(milliseconds(1), [&]() {
+        wheel.schedule(milliseconds(1), [&chained]() { ++chained; });
+    });
+    wheel.tick();
+    wheel.tick();
+    assert(chained == 1);
+
+    std::cout << "Periodic test passed!" << std::endl;
+}
+
+void testBackgroundThread() {
+    std::cout << "Testing background thread..." << std::endl;
+
+    TimerWheel wheel(milliseconds(5), 16);
+    std::atomic<int> runs{0};
+    wheel.scheduleEvery(milliseconds(5), [&runs]() { ++runs; });
+    wheel.start();
+    std::this_thread::sleep_for(milliseconds(100));
+    wheel.stop();
+
+    int seen = runs.load();
+    assert(seen >= 5);
+    std::this_thread::sleep_for(milliseconds(30));
+    assert(runs.load() == seen); // Nothing runs after stop()
+
+    std::cout << "Background thread test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running TimerWheel Tests ===" << std::endl;
+
+    testOneShotAndCancel();
+    testLongDelaysUseRounds();
+    testPeriodic();
+    testBackgroundThread();
+
+    std::cout << "=== All TimerWheel Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "utils/trending_tracker.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+using sohbet::utils::TrendingTracker;
+using namespace std::chrono;
+
+static const TrendingTracker::Clock::time_point T0 = TrendingTracker::Clock::now();
+
+static std::vector<TrendingTracker::Window> windows() {
+    return {{"1h", hours(1)}, {"24h", hours(24)}};
+}
+
+void testRanksByRecentUse() {
+    std::cout << "Testing ranking by decayed use..." << std::endl;
+
+    TrendingTracker tracker(windows());
+    for (int i = 0; i < 10; ++i) tracker.record("finals", "", T0);
+    for (int i = 0; i < 4; ++i) tracker.record("hackathon", "", T0 + hours(3));
+
+    // Three hours later in the 1h window, the older burst has decayed by e^-3
+    auto hourly = tracker.top("1h", "", 10, T0 + hours(3));
+    assert(hourly.size() == 2);
+    assert(hourly[0].tag == "hackathon");
+    assert(std::fabs(hourly[0].score - 4.0) < 1e-6);
+    assert(std::fabs(hourly[1].score - 10.0 * std::exp(-3.0)) < 1e-6);
+
+    // In the 24h window the larger burst still wins
+    auto daily = tracker.top("24h", "", 10, T0 + hours(3));
+    assert(daily[0].tag == "finals");
+
+    assert(tracker.top("24h", "", 1, T0 + hours(3)).size() == 1);
+    assert(tracker.top("7d", "", 10, T0).empty());
+    assert(tracker.hasWindow("1h") && !tracker.hasWindow("7d"));
+
+    std::cout << "Ranking test passed!" << std::endl;
+}
+
+void testScopes() {
+    std::cout << "Testing university scopes..." << std::endl;
+
+    TrendingTracker tracker(windows());
+    tracker.record("bogazici", "Boğaziçi Üniversitesi", T0);
+    tracker.record("bogazici", "Boğaziçi Üniversitesi", T0);
+    tracker.record("odtu", "ODTÜ", T0);
+
+    auto boun = tracker.top("24h", "Boğaziçi Üniversitesi", 10, T0);
+    assert(boun.size() == 1 && boun[0].tag == "bogazici");
+    assert(std::fabs(boun[0].score - 2.0) < 1e-6);
+
+    // Every event also feeds the global scope
+    auto global = tracker.top("24h", "", 10, T0);
+    assert(global.size() == 2 && global[0].tag == "bogazici" && global[1].tag == "odtu");
+
+    assert(tracker.top("24h", "Unknown", 10, T0).empty());
+
+    std::cout << "Scope test passed!" << std::endl;
+}
+
+void testStaleTagsDropOut() {
+    std::cout << "Testing decay below threshold..." << std::endl;
+
+    TrendingTracker tracker(windows());
+    tracker.record("orientation", "", T0);
+    assert(tracker.top("1h", "", 10, T0 + hours(10)).empty());   // e^-10 < 0.01
+    assert(tracker.top("24h", "", 10, T0 + hours(10)).size() == 1);
+
+    std::cout << "Decay threshold test passed!" << std::endl;
+}
+
+void testBoundedMemoryKeepsHeavyHitters() {
+    std::cout << "Testing heavy hitters with bounded candidates..." << std::endl;
+
+    // Far more distinct tags than candidates: the frequent ones must survive
+    TrendingTracker tracker(windows(), 5, 1024, 4);
+    for (int round = 0; round < 20; ++round) {
+        for (int hot = 0; hot < 3; ++hot) {
+            tracker.record("hot" + std::to_string(hot), "", T0 + seconds(round));
+        }
+        for (int cold = 0; cold < 200; ++cold) {
+            tracker.record("cold" + std::to_string(round * 200 + cold), "", T0 + seconds(round));
+        }
+    }
+
+    auto top = tracker.top("24h", "", 3, T0 + seconds(20));
+    assert(top.size() == 3);
+    for (const auto& entry : top) {
+        assert(entry.tag.rfind("hot", 0) == 0);
+        assert(entry.score >= 19.0); // Sketch never under-counts
+    }
+
+    std::cout << "Heavy hitter test passed!" << std::endl;
+}
+
+void testLandmarkRescale() {
+    std::cout << "Testing landmark rescale over long runs..." << std::endl;
+
+    // 1000 hours is far past the rescale threshold for the 1h window
+    TrendingTracker tracker(windows());
+    for (int hour = 0; hour <= 1000; ++hour) {
+        tracker.record("weekly", "", T0 + hours(hour));
+    }
+
+    // Steady one-per-hour use converges to 1 / (1 - e^-1) in the 1h window
+    auto hourly = tracker.top("1h", "", 1, T0 + hours(1000));
+    assert(hourly.size() == 1);
+    assert(std::isfinite(hourly[0].score));
+    assert(std::fabs(hourly[0].score - 1.0 / (1.0 - std::exp(-1.0))) < 1e-6);
+
+    std::cout << "Rescale test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running TrendingTracker Tests ===" << std::endl;
+
+    testRanksByRecentUse();
+    testScopes();
+    testStaleTagsDropOut();
+    testBoundedMemoryKeepsHeavyHitters();
+    testLandmarkRescale();
+
+    std::cout << "=== All TrendingTracker Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "db/database.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <string>
+
+using namespace sohbet::db;
+
+static int countRows(Database& db) {
+    Statement count(db, "SELECT COUNT(*) FROM unit_of_work_probe", Routing::Primary);
+    assert(count.step() == SQLITE_ROW);
+    return count.getInt(0);
+}
+
+static bool insertRow(Database& db, int id) {
+    Statement insert(db, "INSERT INTO unit_of_work_probe (id) VALUES (?)");
+    insert.bindInt(1, id);
+    return insert.step() == SQLITE_DONE;
+}
+
+// Both tests need a server: set SOHBET_TEST_DATABASE_URL to run
+void testScopeTracking(const std::string& url) {
+    std::cout << "Testing scope tracking..." << std::endl;
+
+    Database db(url);
+    assert(UnitOfWork::current(db) == nullptr);
+    {
+        UnitOfWork unit(db);
+        assert(UnitOfWork::current(db) == &unit);
+        assert(unit.isActive() && !unit.isNested());
+    }
+    assert(UnitOfWork::current(db) == nullptr);
+
+    std::cout << "Scope tracking test passed!" << std::endl;
+}
+
+void testUnitOfWork(const std::string& url) {
+    std::cout << "Testing unit of work transactions..." << std::endl;
+
+    Database db(url);
+    assert(db.isOpen());
+    // Temp tables live as long as the connection, across transactions
+    assert(db.execute("CREATE TEMP TABLE unit_of_work_probe (id INT PRIMARY KEY)"));
+
+    // Commit: every joined statement lands together
+    {
+        UnitOfWork unit(db);
+        assert(insertRow(db, 1));
+        assert(insertRow(db, 2));
+        assert(db.execute("INSERT INTO unit_of_work_probe (id) VALUES (3)"));
+        assert(unit.commit());
+        assert(!unit.isActive());
+    }
+    assert(countRows(db) == 3);
+
+    // Destroyed without commit(): rolled back
+    {
+        UnitOfWork unit(db);
+        assert(insertRow(db, 4));
+        assert(countRows(db) == 4);     // Visible inside the scope
+    }
+    assert(countRows(db) == 3);
+
+    // A failed statement makes commit() roll back the whole scope
+    {
+        UnitOfWork unit(db);
+        assert(insertRow(db, 5));
+        assert(!insertRow(db, 1));      // Duplicate key
+        assert(unit.failed());
+        assert(!unit.commit());
+    }
+    assert(countRows(db) == 3);
+
+    // A nested scope is a savepoint: rolling it back keeps the outer work
+    {
+        UnitOfWork outer(db);
+        assert(insertRow(db, 6));
+        {
+            UnitOfWork inner(db);
+            assert(inner.isNested());
+            assert(UnitOfWork::current(db) == &inner);
+            assert(insertRow(db, 7));
+            inner.rollback();
+        }
+        {
+            UnitOfWork inner(db);
+            assert(!insertRow(db, 6));  // Fails only the savepoint
+            assert(!inner.commit());
+        }
+        {
+            UnitOfWork inner(db);
+            assert(insertRow(db, 8));
+            assert(inner.commit());     // RELEASE SAVEPOINT
+        }
+        assert(UnitOfWork::current(db) == &outer);
+        assert(!outer.failed());
+        assert(outer.commit());
+    }
+    assert(countRows(db) == 5);
+    {
+        Statement rows(db, "SELECT id FROM unit_of_work_probe ORDER BY id", Routing::Primary);
+        int expected[] = {1, 2, 3, 6, 8};
+        for (int id : expected) {
+            assert(rows.step() == SQLITE_ROW);
+            assert(rows.getInt(0) == id);
+        }
+        assert(rows.step() == SQLITE_DONE);
+    }
+
+    std::cout << "Unit of work test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running UnitOfWork Tests ===" << std::endl;
+
+    const char* url = std::getenv("SOHBET_TEST_DATABASE_URL");
+    if (url && *url) {
+        testScopeTracking(url);
+        testUnitOfWork(url);
+    } else {
+        std::cout << "SOHBET_TEST_DATABASE_URL not set; skipping unit of work tests" << std::endl;
+    }
+
+    std::cout << "=== All UnitOfWork Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "voice/voice_room_registry.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+using namespace sohbet;
+
+void test_join_leave() {
+    std::cout << "Testing join/leave..." << std::endl;
+
+    VoiceRoomRegistry rooms(4);
+
+    auto first = rooms.join(10, 1);
+    assert(first.changed);
+    assert(first.participants->size() == 1);
+
+    auto second = rooms.join(10, 2);
+    assert(second.changed);
+    assert(second.participants->size() == 2);
+    assert(first.participants->size() == 1); // Old snapshot is immutable
+
+    assert(!rooms.join(10, 2).changed);
+    assert(rooms.containsBoth(10, 1, 2));
+    assert(!rooms.containsBoth(10, 1, 3));
+
+    auto left = rooms.leave(10, 1);
+    assert(left.changed);
+    assert(left.participants->size() == 1 && left.participants->count(2) == 1);
+    assert(!rooms.leave(10, 1).changed);
+
+    rooms.leave(10, 2);
+    assert(rooms.participants(10)->empty());
+    assert(rooms.roomCount() == 0);
+    assert(rooms.roomsOf(2).empty());
+
+    std::cout << "Join/leave tests passed!" << std::endl;
+}
+
+void test_disconnect_uses_index() {
+    std::cout << "Testing disconnect cleanup..." << std::endl;
+
+    VoiceRoomRegistry rooms(4);
+    rooms.join(1, 7);
+    rooms.join(2, 7);
+    rooms.join(2, 8);
+    assert(rooms.merge(3, {8, 9}) == 2);
+    assert(rooms.roomsOf(7).size() == 2);
+
+    auto left = rooms.leaveAll(7);
+    assert(left.size() == 2);
+    for (const auto& [channel_id, remaining] : left) {
+        if (channel_id == 1) assert(remaining->empty());
+        if (channel_id == 2) assert(remaining->size() == 1 && remaining->count(8) == 1);
+    }
+    assert(rooms.roomsOf(7).empty());
+    assert(rooms.roomCount() == 2);
+
+    // Disconnects are queued for one batched voice_sessions update
+    rooms.leaveAll(9);
+    auto ends = rooms.takePendingSessionEnds();
+    assert(ends.size() == 2);
+    assert(ends[0].user_id == 7 && ends[1].user_id == 9);
+    assert(rooms.takePendingSessionEnds().empty());
+    rooms.requeueSessionEnds(ends);
+    assert(rooms.takePendingSessionEnds().size() == 2);
+
+    rooms.removeRoom(2);
+    assert(rooms.roomsOf(8).size() == 1);
+
+    std::cout << "Disconnect cleanup tests passed!" << std::endl;
+}
+
+void test_concurrent_rooms() {
+    std::cout << "Testing concurrent joins..." << std::endl;
+
+    VoiceRoomRegistry rooms(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&rooms, t]() {
+            for (int user = 0; user < 200; ++user) {
+                rooms.join(t, user);
+                rooms.participants(t);
+                if (user % 2 == 0) rooms.leave(t, user);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (int t = 0; t < 8; ++t) {
+        assert(rooms.participants(t)->size() == 100);
+    }
+    assert(rooms.roomsOf(1).size() == 8);
+
+    std::cout << "Concurrent join tests passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Running VoiceRoomRegistry Tests ===" << std::endl;
+
+    test_join_leave();
+    test_disconnect_uses_index();
+    test_concurrent_rooms();
+
+    std::cout << "=== All VoiceRoomRegistry Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -1,8 +1,13 @@
 #include "server/websocket_server.h"
+#include "security/jwt.h"
+#include "config/env.h"
 #include <iostream>
 #include <cassert>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace sohbet::server;
 
@@ -43,6 +48,71 @@ void test_websocket_connection() {
     std::cout << "✓ WebSocket connection test passed" << std::endl;
 }
 
+// Masked client-to-server text frame (payload < 126 bytes)
+static std::string maskedTextFrame(const std::string& payload) {
+    const unsigned char mask[4] = {0x12, 0x34, 0x56, 0x78};
+    std::string frame;
+    frame += static_cast<char>(0x81);
+    frame += static_cast<char>(0x80 | payload.size());
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        frame += static_cast<char>(payload[i] ^ mask[i % 4]);
+    }
+    return frame;
+}
+
+void test_websocket_adopt_connection() {
+    std::cout << "Testing shared-port connection adoption..." << std::endl;
+
+    WebSocketServer server(8083);
+    std::atomic<int> pings{0};
+    server.registerHandler("test:ping",
+        [&pings](int user_id, const WebSocketMessage&) {
+            assert(user_id == 7);
+            pings++;
+        });
+    server.startShared();
+
+    int fds[2];
+    int paired = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(paired == 0);
+
+    std::string token = sohbet::security::generate_jwt_token("adopted", 7, "Student",
+                                                              sohbet::config::get_jwt_secret());
+    std::string request = "GET /?token=" + token + " HTTP/1.1\r\n"
+                          "Host: localhost\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+
+    // A frame that arrived in the same read as the upgrade request
+    std::string buffered = maskedTextFrame(R"({"type":"test:ping","payload":{}})");
+
+    std::thread session([&]() { server.adoptConnection(fds[0], request, buffered); });
+
+    char response[1024];
+    ssize_t n = recv(fds[1], response, sizeof(response) - 1, 0);
+    assert(n > 0);
+    response[n] = '\0';
+    assert(std::string(response).find("101 Switching Protocols") != std::string::npos);
+    assert(std::string(response).find("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") != std::string::npos);
+
+    for (int i = 0; i < 100 && (pings == 0 || !server.isUserOnline(7)); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(server.isUserOnline(7));
+    assert(pings == 1);
+
+    // Client hangs up; the session ends and the user goes offline
+    close(fds[1]);
+    session.join();
+    assert(!server.isUserOnline(7));
+
+    server.stop();
+    std::cout << "✓ Shared-port connection adoption test passed" << std::endl;
+}
+
 int main() {
     std::cout << "Running WebSocket Server Tests..." << std::endl;
     std::cout << "=================================" << std::endl;
@@ -51,6 +121,7 @@ int main() {
         test_websocket_initialization();
         test_websocket_message_creation();
         test_websocket_connection();
+        test_websocket_adopt_connection();
         
         std::cout << "=================================" << std::endl;
         std::cout << "All WebSocket tests passed! ✓" << std::endl;